@@ -0,0 +1,149 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_ASSETMAP_HPP
+#define OUZEL_ASSETS_ASSETMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "../hash/Fnv1.hpp"
+
+namespace ouzel::assets
+{
+    // Name of an asset with its precalculated hash, it only refers to the name,
+    // so a key that is kept (e.g. a static one) should be created from a string literal
+    class AssetKey final
+    {
+    public:
+        constexpr AssetKey(std::string_view initName) noexcept:
+            name{initName}, hash{hash::fnv1::hash<std::uint64_t>(initName)}
+        {
+        }
+
+        constexpr AssetKey(const char* initName) noexcept:
+            AssetKey{std::string_view{initName}}
+        {
+        }
+
+        AssetKey(const std::string& initName) noexcept:
+            AssetKey{std::string_view{initName}}
+        {
+        }
+
+        constexpr auto getName() const noexcept { return name; }
+        constexpr auto getHash() const noexcept { return hash; }
+
+    private:
+        std::string_view name;
+        std::uint64_t hash;
+    };
+
+    // Open addressing hash table (with linear probing) of the asset names,
+    // the values are stored in the order of insertion and keep their addresses until the map is cleared
+    template <class T>
+    class AssetMap final
+    {
+    public:
+        struct Entry final
+        {
+            std::string name;
+            std::uint64_t hash;
+            T value;
+        };
+
+        auto begin() noexcept { return entries.begin(); }
+        auto end() noexcept { return entries.end(); }
+        auto begin() const noexcept { return entries.begin(); }
+        auto end() const noexcept { return entries.end(); }
+
+        auto size() const noexcept { return entries.size(); }
+        auto empty() const noexcept { return entries.empty(); }
+
+        T* find(const AssetKey& key) noexcept
+        {
+            const auto index = findIndex(key);
+            return index != npos ? &entries[index].value : nullptr;
+        }
+
+        const T* find(const AssetKey& key) const noexcept
+        {
+            const auto index = findIndex(key);
+            return index != npos ? &entries[index].value : nullptr;
+        }
+
+        T& insertOrAssign(const AssetKey& key, T value)
+        {
+            const auto index = findIndex(key);
+            if (index != npos)
+                return entries[index].value = std::move(value);
+
+            // keep the load factor under 1/2
+            if ((entries.size() + 1) * 2 > slots.size())
+                rehash(slots.empty() ? 16 : slots.size() * 2);
+
+            entries.push_back(Entry{std::string{key.getName()}, key.getHash(), std::move(value)});
+            insertSlot(key.getHash(), static_cast<std::uint32_t>(entries.size()));
+            return entries.back().value;
+        }
+
+        void clear() noexcept
+        {
+            entries.clear();
+            slots.clear();
+            shift = 64;
+        }
+
+    private:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        std::size_t findIndex(const AssetKey& key) const noexcept
+        {
+            if (slots.empty()) return npos;
+
+            const auto mask = slots.size() - 1;
+            for (auto slot = getSlot(key.getHash());; slot = (slot + 1) & mask)
+            {
+                const auto index = slots[slot];
+                if (index == 0) return npos; // empty slot
+
+                const auto& entry = entries[index - 1];
+                if (entry.hash == key.getHash() && entry.name == key.getName())
+                    return index - 1;
+            }
+        }
+
+        void insertSlot(std::uint64_t hash, std::uint32_t index) noexcept
+        {
+            const auto mask = slots.size() - 1;
+            auto slot = getSlot(hash);
+            while (slots[slot] != 0) slot = (slot + 1) & mask;
+            slots[slot] = index;
+        }
+
+        // Fibonacci hashing, the low bits of FNV-1 only depend on the low bits of the characters
+        std::size_t getSlot(std::uint64_t hash) const noexcept
+        {
+            return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ULL) >> shift);
+        }
+
+        void rehash(std::size_t newSize)
+        {
+            shift = 64;
+            for (auto size = newSize; size > 1; size >>= 1) --shift;
+
+            slots.assign(newSize, 0);
+            for (std::size_t i = 0; i < entries.size(); ++i)
+                insertSlot(entries[i].hash, static_cast<std::uint32_t>(i + 1));
+        }
+
+        std::deque<Entry> entries;
+        std::vector<std::uint32_t> slots; // index of the entry + 1, zero for empty slots
+        std::uint32_t shift = 64;
+    };
+}
+
+#endif // OUZEL_ASSETS_ASSETMAP_HPP
@@ -13,13 +13,15 @@ namespace ouzel::assets
 
     bool BmfLoader::loadAsset(Bundle& bundle,
                               const std::string& name,
-                              const std::vector<std::byte>& data,
+                              const storage::FileView& data,
+                              bool,
+                              bool,
                               bool)
     {
         try
         {
             // TODO: move the loader here
-            auto font = std::make_unique<gui::BMFont>(data);
+            auto font = std::make_unique<gui::BMFont>(std::vector<std::byte>(data.begin(), data.end()));
             bundle.setFont(name, std::move(font));
         }
         catch (const std::exception&)
@@ -1,140 +1,493 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <cctype>
 #include <stdexcept>
+#include <thread>
 #include "Bundle.hpp"
 #include "Cache.hpp"
+#include "ImageLoader.hpp"
 #include "Loader.hpp"
-#include "../formats/Json.hpp"
+#include "../audio/VorbisClip.hpp"
+#include "../core/Engine.hpp"
+#include "../formats/JsonDocument.hpp"
+#include "../utils/Log.hpp"
 
 namespace ouzel::assets
 {
     Bundle::Bundle(Cache& initCache, storage::FileSystem& initFileSystem):
         cache(initCache), fileSystem(initFileSystem)
     {
+        updateHandler.updateHandler = [this](const UpdateEvent&) {
+            applyReloads();
+            return false;
+        };
+
         cache.addBundle(this);
     }
 
     Bundle::~Bundle()
     {
+        fileWatcher.reset(); // stop the watcher thread before anything else is destroyed
         cache.removeBundle(this);
     }
 
     void Bundle::loadAsset(Loader::Type loaderType, const std::string& name,
-                           const std::string& filename, bool mipmaps)
+                           const std::string& filename, bool mipmaps,
+                           bool premultiplyAlpha, bool distanceField)
     {
-        const auto data = fileSystem.readFile(filename);
+        loadAssetData(loaderType, name, fileSystem.mapFile(filename), mipmaps, premultiplyAlpha, distanceField);
+        addSource(loaderType, name, filename, mipmaps, premultiplyAlpha, distanceField);
+    }
+
+    void Bundle::addSource(Loader::Type loaderType, const std::string& name,
+                           const std::string& filename, bool mipmaps, bool premultiplyAlpha,
+                           bool distanceField)
+    {
+        std::lock_guard lock(reloadMutex);
 
+        const auto i = std::find_if(sources.begin(), sources.end(), [loaderType, &name](const Source& source) noexcept {
+            return source.type == loaderType && source.name == name;
+        });
+
+        Source& source = (i != sources.end()) ? *i : sources.emplace_back();
+        source = Source{loaderType, name, filename, mipmaps, premultiplyAlpha, distanceField, storage::Path{}};
+        if (fileWatcher) watchSource(source);
+    }
+
+    void Bundle::loadAssetData(Loader::Type loaderType, const std::string& name,
+                               const storage::FileView& data, bool mipmaps,
+                               bool premultiplyAlpha, bool distanceField)
+    {
         const auto& loaders = cache.getLoaders();
 
         for (auto i = loaders.rbegin(); i != loaders.rend(); ++i)
         {
             Loader* loader = i->get();
             if (loader->getType() == loaderType &&
-                loader->loadAsset(*this, name, data, mipmaps))
+                loader->loadAsset(*this, name, data, mipmaps, premultiplyAlpha, distanceField))
                 return;
         }
 
-        throw std::runtime_error("Failed to load asset " + filename);
+        throw std::runtime_error("Failed to load asset " + name);
     }
 
     void Bundle::loadAssets(const std::string& filename)
     {
-        const auto data = json::parse(fileSystem.readFile(filename));
+        const auto data = fileSystem.readFile(filename);
+        const json::Document document(reinterpret_cast<const char*>(data.data()), data.size());
 
-        for (const auto& asset : data["assets"])
+        std::vector<Asset> assets;
+
+        for (const json::Node& asset : document.getRoot()["assets"])
         {
             const auto file = asset["filename"].as<std::string>();
             const auto name = asset.hasMember("name") ? asset["name"].as<std::string>() : file;
             const auto mipmaps = asset.hasMember("mipmaps") ? asset["mipmaps"].as<bool>() : true;
-            loadAsset(static_cast<Loader::Type>(asset["type"].as<std::uint32_t>()), name, file, mipmaps);
+            const auto stream = asset.hasMember("stream") ? asset["stream"].as<bool>() : false;
+            const auto premultiplyAlpha = asset.hasMember("premultiplyAlpha") ? asset["premultiplyAlpha"].as<bool>() : false;
+            const auto distanceField = asset.hasMember("distanceField") ? asset["distanceField"].as<bool>() : false;
+            const auto type = static_cast<Loader::Type>(asset["type"].as<std::uint32_t>());
+
+            assets.emplace_back(type, name, file, mipmaps, stream, premultiplyAlpha, distanceField);
         }
+
+        loadAssets(assets);
     }
 
     void Bundle::loadAssets(const std::vector<Asset>& assets)
     {
-        for (const Asset& asset : assets)
-            loadAsset(asset.type, asset.name, asset.filename, asset.mipmaps);
+        // images can only be decoded up front if they are not handled by a custom loader
+        const auto& loaders = cache.getLoaders();
+        const auto imageLoader = std::find_if(loaders.rbegin(), loaders.rend(), [](const auto& loader) noexcept {
+            return loader->getType() == Loader::Type::image;
+        });
+        const bool predecode = imageLoader != loaders.rend() && dynamic_cast<ImageLoader*>(imageLoader->get());
+
+        // the images are decoded in windows of one image per thread, so that only the images of
+        // the current window are kept in memory before their textures are created
+        const std::size_t windowSize = std::max(std::thread::hardware_concurrency(), 1U);
+        std::vector<std::size_t> windowAssets; // indices of the assets whose images are in the window
+        std::vector<EncodedImage> encodedImages;
+        std::vector<graphics::Image> images;
+        std::size_t windowPosition = 0;
+        std::size_t scanPosition = 0; // the assets before it have been mapped or skipped
+
+        for (std::size_t i = 0; i < assets.size(); ++i)
+        {
+            const Asset& asset = assets[i];
+
+            if (asset.stream && asset.type == Loader::Type::sound)
+            {
+                loadStreamingSound(asset.name, asset.filename);
+                continue;
+            }
+
+            if (predecode && asset.type == Loader::Type::image &&
+                windowPosition == windowAssets.size() && i >= scanPosition)
+            {
+                windowAssets.clear();
+                encodedImages.clear();
+                images.clear();
+                windowPosition = 0;
+
+                for (scanPosition = i; scanPosition < assets.size() && windowAssets.size() < windowSize; ++scanPosition)
+                {
+                    if (assets[scanPosition].type != Loader::Type::image) continue;
+
+                    try
+                    {
+                        auto data = fileSystem.mapFile(assets[scanPosition].filename);
+                        if (isTextureContainer(data)) continue;
+
+                        windowAssets.push_back(scanPosition);
+                        encodedImages.push_back(EncodedImage{std::move(data), assets[scanPosition].premultiplyAlpha});
+                    }
+                    catch (const std::exception&)
+                    {
+                        // reported when the asset is loaded
+                    }
+                }
+
+                images = decodeImages(encodedImages);
+            }
+
+            if (windowPosition < windowAssets.size() && windowAssets[windowPosition] == i)
+            {
+                auto& image = images[windowPosition];
+
+                // the images that failed to decode are decoded again on this thread to report the error
+                if (image.getData().empty())
+                    image = decodeImage(encodedImages[windowPosition].data, asset.premultiplyAlpha);
+
+                // the pixels are moved into the texture and released as soon as it is uploaded
+                setTexture(asset.name, std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                                           std::move(image).getData(),
+                                                                           image.getSize(),
+                                                                           asset.premultiplyAlpha ? graphics::Flags::premultipliedAlpha : graphics::Flags::none,
+                                                                           asset.mipmaps ? 0 : 1,
+                                                                           image.getPixelFormat()));
+                addSource(asset.type, asset.name, asset.filename, asset.mipmaps, asset.premultiplyAlpha, false);
+                ++windowPosition;
+            }
+            else
+                loadAsset(asset.type, asset.name, asset.filename, asset.mipmaps, asset.premultiplyAlpha, asset.distanceField);
+        }
+    }
+
+    void Bundle::loadPackedAssets(const std::string& filename)
+    {
+        const packed::Reader reader(fileSystem.mapFile(filename));
+
+        for (std::uint32_t i = 0; i < reader.getEntryCount(); ++i)
+            loadPackedAsset(reader, reader.getEntry(i));
+    }
+
+    void Bundle::loadPackedAssets(const std::string& filename, const std::vector<std::string>& names)
+    {
+        const packed::Reader reader(fileSystem.mapFile(filename));
+
+        for (const auto& name : names)
+        {
+            const auto entry = reader.find(name);
+            if (!entry)
+                throw std::runtime_error("Asset " + name + " not found in " + filename);
+
+            loadPackedAsset(reader, *entry);
+        }
+    }
+
+    void Bundle::loadPackedAsset(const packed::Reader& reader, const packed::Entry& entry)
+    {
+        const std::string name(entry.name);
+        const auto data = reader.getData(entry);
+
+        switch (entry.encoding)
+        {
+            case packed::Encoding::source:
+                loadAssetData(entry.type, name, data, entry.mipmaps, false, false);
+                break;
+            case packed::Encoding::texture:
+            {
+                if (data.size() < packed::textureHeaderSize)
+                    throw std::runtime_error("Invalid texture " + name);
+
+                auto width = decodeLittleEndian<std::uint32_t>(data.data());
+                auto height = decodeLittleEndian<std::uint32_t>(data.data() + 4);
+                const auto levelCount = decodeLittleEndian<std::uint32_t>(data.data() + 8);
+                const auto textureFormat = static_cast<packed::TextureFormat>(decodeLittleEndian<std::uint32_t>(data.data() + 12));
+                const Size2U size(width, height);
+
+                std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels;
+                std::size_t offset = packed::textureHeaderSize;
+
+                for (std::uint32_t level = 0; level < (entry.mipmaps ? levelCount : 1); ++level)
+                {
+                    const auto levelSize = packed::getLevelDataSize(textureFormat, width, height);
+                    if (offset > data.size() || data.size() - offset < levelSize)
+                        throw std::runtime_error("Invalid texture " + name);
+
+                    const auto levelData = reinterpret_cast<const std::uint8_t*>(data.data() + offset);
+                    levels.emplace_back(Size2U(width, height),
+                                        std::vector<std::uint8_t>(levelData, levelData + levelSize));
+
+                    offset += packed::getLevelSize(textureFormat, width, height);
+                    width = std::max(width >> 1, std::uint32_t(1));
+                    height = std::max(height >> 1, std::uint32_t(1));
+                }
+
+                setTexture(name, std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                                     levels, size,
+                                                                     graphics::Flags::none,
+                                                                     packed::getPixelFormat(textureFormat)));
+                break;
+            }
+            default:
+                throw std::runtime_error("Unsupported encoding of " + name);
+        }
+    }
+
+    void Bundle::loadStreamingSound(const std::string& name, const std::string& filename)
+    {
+        auto extension = std::string(storage::Path(filename).getExtension());
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](char c) noexcept { return static_cast<char>(std::tolower(c)); });
+
+        if (extension != "ogg")
+            throw std::runtime_error("Streaming is only supported for Vorbis files: " + filename);
+
+        auto sound = std::make_unique<audio::VorbisClip>(*engine->getAudio(),
+                                                         fileSystem.getFileRegion(filename));
+        setSound(name, std::move(sound));
+    }
+
+    void Bundle::setHotReload(bool enable)
+    {
+        if (enable == isHotReloadEnabled()) return;
+
+        if (enable)
+        {
+            fileWatcher = std::make_unique<storage::FileWatcher>([this](const storage::Path& path) {
+                reloadFile(path);
+            });
+
+            std::lock_guard lock(reloadMutex);
+            for (auto& source : sources)
+                watchSource(source);
+
+            engine->getEventDispatcher().addEventHandler(updateHandler);
+        }
+        else
+        {
+            fileWatcher.reset();
+            updateHandler.remove();
+
+            std::lock_guard lock(reloadMutex);
+            reloads.clear();
+        }
+    }
+
+    void Bundle::watchSource(Source& source)
+    {
+        // the other assets are referenced by raw pointers (e.g. from the voices and the mesh renderers),
+        // which would be left dangling if a reload destroyed them
+        if (source.type != Loader::Type::image &&
+            source.type != Loader::Type::sprite &&
+            source.type != Loader::Type::particleSystem)
+        {
+            source.path = storage::Path{};
+            return;
+        }
+
+        try
+        {
+            // files in archives can not be modified
+            source.path = fileSystem.getPath(source.filename);
+            fileWatcher->addFile(source.path);
+        }
+        catch (const std::exception&)
+        {
+            source.path = storage::Path{};
+        }
     }
 
-    std::shared_ptr<graphics::Texture> Bundle::getTexture(const std::string& name) const
+    void Bundle::reloadFile(const storage::Path& path)
     {
-        const auto i = textures.find(name);
+        std::vector<Source> modifiedSources;
 
-        if (i != textures.end())
-            return i->second;
+        {
+            std::lock_guard lock(reloadMutex);
+            for (const auto& source : sources)
+                if (source.path == path)
+                    modifiedSources.push_back(source);
+        }
+
+        if (modifiedSources.empty()) return;
+
+        try
+        {
+            const storage::FileView data{fileSystem.readFile(path, false)};
 
-        return nullptr;
+            for (const auto& source : modifiedSources)
+            {
+                Reload reload{source, data, graphics::Image{}};
+                if (source.type == Loader::Type::image && !isTextureContainer(data))
+                    reload.image = decodeImage(data, source.premultiplyAlpha);
+
+                std::lock_guard lock(reloadMutex);
+                reloads.push_back(std::move(reload));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            // the file can be incomplete while it is being saved, it will be reloaded on the next change
+            logger.log(Log::Level::warning) << "Failed to reload " << std::string(path) << ": " << e.what();
+        }
+    }
+
+    void Bundle::applyReloads()
+    {
+        std::vector<Reload> pendingReloads;
+
+        {
+            std::lock_guard lock(reloadMutex);
+            pendingReloads.swap(reloads);
+        }
+
+        for (auto& reload : pendingReloads)
+        {
+            try
+            {
+                const auto& source = reload.source;
+
+                if (source.type == Loader::Type::image)
+                {
+                    graphics::Texture texture;
+
+                    // only the texture containers are not decoded on the watcher thread
+                    if (!reload.image.getData().empty())
+                        texture = graphics::Texture(*engine->getGraphics(),
+                                                    std::move(reload.image).getData(),
+                                                    reload.image.getSize(),
+                                                    source.premultiplyAlpha ? graphics::Flags::premultipliedAlpha : graphics::Flags::none,
+                                                    source.mipmaps ? 0 : 1,
+                                                    reload.image.getPixelFormat());
+                    else
+                    {
+                        if (source.premultiplyAlpha)
+                            throw std::runtime_error("Alpha can not be premultiplied in a texture container");
+
+                        auto container = decodeTextureContainer(reload.data);
+                        if (!source.mipmaps) container.levels.resize(1);
+
+                        texture = graphics::Texture(*engine->getGraphics(),
+                                                    container.levels,
+                                                    container.size,
+                                                    graphics::Flags::none,
+                                                    container.pixelFormat);
+                    }
+
+                    // the existing texture is replaced in place, so that everything that uses it gets the new one
+                    if (const auto existingTexture = textures.find(source.name); existingTexture && *existingTexture)
+                    {
+                        auto& oldTexture = **existingTexture;
+                        texture.setFilter(oldTexture.getFilter());
+                        texture.setAddressX(oldTexture.getAddressX());
+                        texture.setAddressY(oldTexture.getAddressY());
+                        texture.setAddressZ(oldTexture.getAddressZ());
+                        texture.setBorderColor(oldTexture.getBorderColor());
+                        texture.setMaxAnisotropy(oldTexture.getMaxAnisotropy());
+                        oldTexture = std::move(texture);
+                    }
+                    else
+                        setTexture(source.name, std::make_shared<graphics::Texture>(std::move(texture)));
+                }
+                else
+                {
+                    // the sprite and particle system data is copied by the renderers, the ones created from its name load it again
+                    loadAssetData(source.type, source.name, reload.data, source.mipmaps, source.premultiplyAlpha, source.distanceField);
+                    ++cache.reloadCount;
+                }
+
+                logger.log(Log::Level::info) << "Reloaded " << source.filename;
+            }
+            catch (const std::exception& e)
+            {
+                logger.log(Log::Level::warning) << "Failed to reload " << reload.source.filename << ": " << e.what();
+            }
+        }
+    }
+
+    std::shared_ptr<graphics::Texture> Bundle::getTexture(const AssetKey& key) const
+    {
+        const auto i = textures.find(key);
+        return i ? *i : nullptr;
     }
 
     void Bundle::setTexture(const std::string& name, const std::shared_ptr<graphics::Texture>& texture)
     {
-        textures[name] = texture;
+        textures.insertOrAssign(name, texture);
+        cache.updateIndex(cache.textureIndex, &Bundle::textures, this, name);
     }
 
     void Bundle::releaseTextures()
     {
         textures.clear();
+        cache.rebuildIndex(cache.textureIndex, &Bundle::textures);
     }
 
-    const graphics::Shader* Bundle::getShader(const std::string& name) const
+    const graphics::Shader* Bundle::getShader(const AssetKey& key) const
     {
-        const auto i = shaders.find(name);
-
-        if (i != shaders.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = shaders.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setShader(const std::string& name, std::unique_ptr<graphics::Shader> shader)
     {
-        shaders[name] = std::move(shader);
+        shaders.insertOrAssign(name, std::move(shader));
+        cache.updateIndex(cache.shaderIndex, &Bundle::shaders, this, name);
     }
 
     void Bundle::releaseShaders()
     {
         shaders.clear();
+        cache.rebuildIndex(cache.shaderIndex, &Bundle::shaders);
     }
 
-    const graphics::BlendState* Bundle::getBlendState(const std::string& name) const
+    const graphics::BlendState* Bundle::getBlendState(const AssetKey& key) const
     {
-        const auto i = blendStates.find(name);
-
-        if (i != blendStates.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = blendStates.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setBlendState(const std::string& name, std::unique_ptr<graphics::BlendState> blendState)
     {
-        blendStates[name] = std::move(blendState);
+        blendStates.insertOrAssign(name, std::move(blendState));
+        cache.updateIndex(cache.blendStateIndex, &Bundle::blendStates, this, name);
     }
 
     void Bundle::releaseBlendStates()
     {
         blendStates.clear();
+        cache.rebuildIndex(cache.blendStateIndex, &Bundle::blendStates);
     }
 
-    const graphics::DepthStencilState* Bundle::getDepthStencilState(const std::string& name) const
+    const graphics::DepthStencilState* Bundle::getDepthStencilState(const AssetKey& key) const
     {
-        const auto i = depthStencilStates.find(name);
-
-        if (i != depthStencilStates.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = depthStencilStates.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setDepthStencilState(const std::string& name, std::unique_ptr<graphics::DepthStencilState> depthStencilState)
     {
-        depthStencilStates[name] = std::move(depthStencilState);
+        depthStencilStates.insertOrAssign(name, std::move(depthStencilState));
+        cache.updateIndex(cache.depthStencilStateIndex, &Bundle::depthStencilStates, this, name);
     }
 
     void Bundle::releaseDepthStencilStates()
     {
         depthStencilStates.clear();
+        cache.rebuildIndex(cache.depthStencilStateIndex, &Bundle::depthStencilStates);
     }
 
     void Bundle::preloadSpriteData(const std::string& filename, bool mipmaps,
@@ -144,7 +497,7 @@ namespace ouzel::assets
         auto extension = std::string(storage::Path(filename).getExtension());
         std::transform(extension.begin(), extension.end(), extension.begin(),
                        [](char c) noexcept { return static_cast<char>(std::tolower(c)); });
-        const std::vector<std::string> imageExtensions{"jpg", "jpeg", "png", "bmp", "tga"};
+        const std::vector<std::string> imageExtensions{"jpg", "jpeg", "png", "bmp", "tga", "ktx", "dds"};
 
         if (std::find(imageExtensions.begin(), imageExtensions.end(), extension) != imageExtensions.end())
         {
@@ -181,170 +534,151 @@ namespace ouzel::assets
 
                 newSpriteData.animations[""] = std::move(animation);
 
-                spriteData[filename] = newSpriteData;
+                spriteData.insertOrAssign(filename, newSpriteData);
+                cache.updateIndex(cache.spriteDataIndex, &Bundle::spriteData, this, filename);
             }
         }
         else
             loadAsset(Loader::Type::sprite, filename, filename, mipmaps);
     }
 
-    const scene::SpriteData* Bundle::getSpriteData(const std::string& name) const
+    const scene::SpriteData* Bundle::getSpriteData(const AssetKey& key) const
     {
-        const auto i = spriteData.find(name);
-
-        if (i != spriteData.end())
-            return &i->second;
-
-        return nullptr;
+        return spriteData.find(key);
     }
 
     void Bundle::setSpriteData(const std::string& name, const scene::SpriteData& newSpriteData)
     {
-        spriteData[name] = newSpriteData;
+        spriteData.insertOrAssign(name, newSpriteData);
+        cache.updateIndex(cache.spriteDataIndex, &Bundle::spriteData, this, name);
     }
 
     void Bundle::releaseSpriteData()
     {
         spriteData.clear();
+        cache.rebuildIndex(cache.spriteDataIndex, &Bundle::spriteData);
     }
 
-    const scene::ParticleSystemData* Bundle::getParticleSystemData(const std::string& name) const
+    const scene::ParticleSystemData* Bundle::getParticleSystemData(const AssetKey& key) const
     {
-        const auto i = particleSystemData.find(name);
-
-        if (i != particleSystemData.end())
-            return &i->second;
-
-        return nullptr;
+        return particleSystemData.find(key);
     }
 
     void Bundle::setParticleSystemData(const std::string& name, const scene::ParticleSystemData& newParticleSystemData)
     {
-        particleSystemData[name] = newParticleSystemData;
+        particleSystemData.insertOrAssign(name, newParticleSystemData);
+        cache.updateIndex(cache.particleSystemDataIndex, &Bundle::particleSystemData, this, name);
     }
 
     void Bundle::releaseParticleSystemData()
     {
         particleSystemData.clear();
+        cache.rebuildIndex(cache.particleSystemDataIndex, &Bundle::particleSystemData);
     }
 
-    const gui::Font* Bundle::getFont(const std::string& name) const
+    const gui::Font* Bundle::getFont(const AssetKey& key) const
     {
-        const auto i = fonts.find(name);
-
-        if (i != fonts.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = fonts.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setFont(const std::string& name, std::unique_ptr<gui::Font> font)
     {
-        fonts[name] = std::move(font);
+        fonts.insertOrAssign(name, std::move(font));
+        cache.updateIndex(cache.fontIndex, &Bundle::fonts, this, name);
     }
 
     void Bundle::releaseFonts()
     {
         fonts.clear();
+        cache.rebuildIndex(cache.fontIndex, &Bundle::fonts);
     }
 
-    const audio::Cue* Bundle::getCue(const std::string& name) const
+    const audio::Cue* Bundle::getCue(const AssetKey& key) const
     {
-        const auto i = cues.find(name);
-
-        if (i != cues.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = cues.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setCue(const std::string& name, std::unique_ptr<audio::Cue> cue)
     {
-        cues[name] = std::move(cue);
+        cues.insertOrAssign(name, std::move(cue));
+        cache.updateIndex(cache.cueIndex, &Bundle::cues, this, name);
     }
 
     void Bundle::releaseCues()
     {
         cues.clear();
+        cache.rebuildIndex(cache.cueIndex, &Bundle::cues);
     }
 
-    const audio::Sound* Bundle::getSound(const std::string& name) const
+    const audio::Sound* Bundle::getSound(const AssetKey& key) const
     {
-        const auto i = sounds.find(name);
-
-        if (i != sounds.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = sounds.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setSound(const std::string& name, std::unique_ptr<audio::Sound> sound)
     {
-        sounds[name] = std::move(sound);
+        sounds.insertOrAssign(name, std::move(sound));
+        cache.updateIndex(cache.soundIndex, &Bundle::sounds, this, name);
     }
 
     void Bundle::releaseSounds()
     {
         sounds.clear();
+        cache.rebuildIndex(cache.soundIndex, &Bundle::sounds);
     }
 
-    const graphics::Material* Bundle::getMaterial(const std::string& name) const
+    const graphics::Material* Bundle::getMaterial(const AssetKey& key) const
     {
-        const auto i = materials.find(name);
-
-        if (i != materials.end())
-            return i->second.get();
-
-        return nullptr;
+        const auto i = materials.find(key);
+        return i ? i->get() : nullptr;
     }
 
     void Bundle::setMaterial(const std::string& name, std::unique_ptr<graphics::Material> material)
     {
-        materials[name] = std::move(material);
+        materials.insertOrAssign(name, std::move(material));
+        cache.updateIndex(cache.materialIndex, &Bundle::materials, this, name);
     }
 
     void Bundle::releaseMaterials()
     {
         materials.clear();
+        cache.rebuildIndex(cache.materialIndex, &Bundle::materials);
     }
 
-    const scene::SkinnedMeshData* Bundle::getSkinnedMeshData(const std::string& name) const
+    const scene::SkinnedMeshData* Bundle::getSkinnedMeshData(const AssetKey& key) const
     {
-        const auto i = skinnedMeshData.find(name);
-
-        if (i != skinnedMeshData.end())
-            return &i->second;
-
-        return nullptr;
+        return skinnedMeshData.find(key);
     }
 
     void Bundle::setSkinnedMeshData(const std::string& name, scene::SkinnedMeshData&& newSkinnedMeshData)
     {
-        skinnedMeshData[name] = std::move(newSkinnedMeshData);
+        skinnedMeshData.insertOrAssign(name, std::move(newSkinnedMeshData));
+        cache.updateIndex(cache.skinnedMeshDataIndex, &Bundle::skinnedMeshData, this, name);
     }
 
     void Bundle::releaseSkinnedMeshData()
     {
         skinnedMeshData.clear();
+        cache.rebuildIndex(cache.skinnedMeshDataIndex, &Bundle::skinnedMeshData);
     }
 
-    const scene::StaticMeshData* Bundle::getStaticMeshData(const std::string& name) const
+    const scene::StaticMeshData* Bundle::getStaticMeshData(const AssetKey& key) const
     {
-        const auto i = staticMeshData.find(name);
-
-        if (i != staticMeshData.end())
-            return &i->second;
-
-        return nullptr;
+        return staticMeshData.find(key);
     }
 
     void Bundle::setStaticMeshData(const std::string& name, scene::StaticMeshData&& newStaticMeshData)
     {
-        staticMeshData[name] = std::move(newStaticMeshData);
+        staticMeshData.insertOrAssign(name, std::move(newStaticMeshData));
+        cache.updateIndex(cache.staticMeshDataIndex, &Bundle::staticMeshData, this, name);
     }
 
     void Bundle::releaseStaticMeshData()
     {
         staticMeshData.clear();
+        cache.rebuildIndex(cache.staticMeshDataIndex, &Bundle::staticMeshData);
     }
 }
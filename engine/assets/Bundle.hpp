@@ -3,14 +3,19 @@
 #ifndef OUZEL_ASSETS_BUNDLE_HPP
 #define OUZEL_ASSETS_BUNDLE_HPP
 
-#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+#include "AssetMap.hpp"
 #include "Loader.hpp"
+#include "PackedBundle.hpp"
 #include "../audio/Cue.hpp"
 #include "../audio/Sound.hpp"
+#include "../events/EventHandler.hpp"
 #include "../graphics/BlendState.hpp"
 #include "../graphics/DepthStencilState.hpp"
+#include "../graphics/Image.hpp"
 #include "../graphics/Material.hpp"
 #include "../graphics/Shader.hpp"
 #include "../graphics/Texture.hpp"
@@ -20,6 +25,7 @@
 #include "../scene/SpriteRenderer.hpp"
 #include "../scene/ParticleSystem.hpp"
 #include "../storage/FileSystem.hpp"
+#include "../storage/FileWatcher.hpp"
 
 namespace ouzel::assets
 {
@@ -31,11 +37,17 @@ namespace ouzel::assets
         Asset(Loader::Type initType,
               const std::string& initName,
               const std::string& initFilename,
-              bool initMipmaps = true):
+              bool initMipmaps = true,
+              bool initStream = false,
+              bool initPremultiplyAlpha = false,
+              bool initDistanceField = false):
             type(initType),
             name(initName),
             filename(initFilename),
-            mipmaps(initMipmaps)
+            mipmaps(initMipmaps),
+            stream(initStream),
+            premultiplyAlpha(initPremultiplyAlpha),
+            distanceField(initDistanceField)
         {
         }
 
@@ -43,6 +55,9 @@ namespace ouzel::assets
         std::string name;
         std::string filename;
         bool mipmaps;
+        bool stream; // sounds are decoded from the file while playing
+        bool premultiplyAlpha; // color channels of images are multiplied by alpha, to be drawn with blendScreen
+        bool distanceField; // glyphs of TrueType fonts are rasterized as signed distance fields
     };
 
     class Bundle final
@@ -59,77 +74,123 @@ namespace ouzel::assets
         Bundle& operator=(Bundle&&) = delete;
 
         void loadAsset(Loader::Type loaderType, const std::string& name,
-                       const std::string& filename, bool mipmaps = true);
+                       const std::string& filename, bool mipmaps = true,
+                       bool premultiplyAlpha = false, bool distanceField = false);
         void loadAssets(const std::string& filename);
+        // images are decoded in parallel, a few at a time, and their textures are created in the order of the assets
         void loadAssets(const std::vector<Asset>& assets);
+        void loadPackedAssets(const std::string& filename);
+        void loadPackedAssets(const std::string& filename, const std::vector<std::string>& names);
+        void loadStreamingSound(const std::string& name, const std::string& filename);
 
-        std::shared_ptr<graphics::Texture> getTexture(const std::string& name) const;
+        // modified files are decoded on the watcher thread and swapped in at the start of the next frame
+        // only images (updating the textures in place), sprites and particle systems are reloaded
+        void setHotReload(bool enable);
+        auto isHotReloadEnabled() const noexcept { return fileWatcher != nullptr; }
+
+        std::shared_ptr<graphics::Texture> getTexture(const AssetKey& key) const;
         void setTexture(const std::string& name, const std::shared_ptr<graphics::Texture>& texture);
         void releaseTextures();
 
-        const graphics::Shader* getShader(const std::string& shaderName) const;
+        const graphics::Shader* getShader(const AssetKey& key) const;
         void setShader(const std::string& name, std::unique_ptr<graphics::Shader> shader);
         void releaseShaders();
 
-        const graphics::BlendState* getBlendState(const std::string& name) const;
+        const graphics::BlendState* getBlendState(const AssetKey& key) const;
         void setBlendState(const std::string& name, std::unique_ptr<graphics::BlendState> blendState);
         void releaseBlendStates();
 
-        const graphics::DepthStencilState* getDepthStencilState(const std::string& name) const;
+        const graphics::DepthStencilState* getDepthStencilState(const AssetKey& key) const;
         void setDepthStencilState(const std::string& name, std::unique_ptr<graphics::DepthStencilState> depthStencilState);
         void releaseDepthStencilStates();
 
         void preloadSpriteData(const std::string& filename, bool mipmaps = true,
                                std::uint32_t spritesX = 1, std::uint32_t spritesY = 1,
                                const Vector2F& pivot = Vector2F{0.5F, 0.5F});
-        const scene::SpriteData* getSpriteData(const std::string& name) const;
+        const scene::SpriteData* getSpriteData(const AssetKey& key) const;
         void setSpriteData(const std::string& name, const scene::SpriteData& newSpriteData);
         void releaseSpriteData();
 
-        const scene::ParticleSystemData* getParticleSystemData(const std::string& name) const;
+        const scene::ParticleSystemData* getParticleSystemData(const AssetKey& key) const;
         void setParticleSystemData(const std::string& name, const scene::ParticleSystemData& newParticleSystemData);
         void releaseParticleSystemData();
 
-        const gui::Font* getFont(const std::string& name) const;
+        const gui::Font* getFont(const AssetKey& key) const;
         void setFont(const std::string& name, std::unique_ptr<gui::Font> font);
         void releaseFonts();
 
-        const audio::Cue* getCue(const std::string& name) const;
+        const audio::Cue* getCue(const AssetKey& key) const;
         void setCue(const std::string& name, std::unique_ptr<audio::Cue> cue);
         void releaseCues();
 
-        const audio::Sound* getSound(const std::string& name) const;
+        const audio::Sound* getSound(const AssetKey& key) const;
         void setSound(const std::string& name, std::unique_ptr<audio::Sound> sound);
         void releaseSounds();
 
-        const graphics::Material* getMaterial(const std::string& name) const;
+        const graphics::Material* getMaterial(const AssetKey& key) const;
         void setMaterial(const std::string& name, std::unique_ptr<graphics::Material> material);
         void releaseMaterials();
 
-        const scene::SkinnedMeshData* getSkinnedMeshData(const std::string& name) const;
+        const scene::SkinnedMeshData* getSkinnedMeshData(const AssetKey& key) const;
         void setSkinnedMeshData(const std::string& name, scene::SkinnedMeshData&& newSkinnedMeshData);
         void releaseSkinnedMeshData();
 
-        const scene::StaticMeshData* getStaticMeshData(const std::string& name) const;
+        const scene::StaticMeshData* getStaticMeshData(const AssetKey& key) const;
         void setStaticMeshData(const std::string& name, scene::StaticMeshData&& newStaticMeshData);
         void releaseStaticMeshData();
 
     private:
+        struct Source final
+        {
+            Loader::Type type;
+            std::string name;
+            std::string filename;
+            bool mipmaps;
+            bool premultiplyAlpha;
+            bool distanceField;
+            storage::Path path; // empty if the file is not on the disk
+        };
+
+        struct Reload final
+        {
+            Source source;
+            storage::FileView data;
+            graphics::Image image; // only for images
+        };
+
+        void loadAssetData(Loader::Type loaderType, const std::string& name,
+                           const storage::FileView& data, bool mipmaps,
+                           bool premultiplyAlpha, bool distanceField);
+        void loadPackedAsset(const packed::Reader& reader, const packed::Entry& entry);
+        void addSource(Loader::Type loaderType, const std::string& name,
+                       const std::string& filename, bool mipmaps, bool premultiplyAlpha,
+                       bool distanceField);
+
+        void watchSource(Source& source);
+        void reloadFile(const storage::Path& path);
+        void applyReloads();
+
         Cache& cache;
         storage::FileSystem& fileSystem;
 
-        std::map<std::string, std::shared_ptr<graphics::Texture>> textures;
-        std::map<std::string, std::unique_ptr<graphics::Shader>> shaders;
-        std::map<std::string, scene::ParticleSystemData> particleSystemData;
-        std::map<std::string, std::unique_ptr<graphics::BlendState>> blendStates;
-        std::map<std::string, std::unique_ptr<graphics::DepthStencilState>> depthStencilStates;
-        std::map<std::string, scene::SpriteData> spriteData;
-        std::map<std::string, std::unique_ptr<gui::Font>> fonts;
-        std::map<std::string, std::unique_ptr<audio::Cue>> cues;
-        std::map<std::string, std::unique_ptr<audio::Sound>> sounds;
-        std::map<std::string, std::unique_ptr<graphics::Material>> materials;
-        std::map<std::string, scene::SkinnedMeshData> skinnedMeshData;
-        std::map<std::string, scene::StaticMeshData> staticMeshData;
+        AssetMap<std::shared_ptr<graphics::Texture>> textures;
+        AssetMap<std::unique_ptr<graphics::Shader>> shaders;
+        AssetMap<scene::ParticleSystemData> particleSystemData;
+        AssetMap<std::unique_ptr<graphics::BlendState>> blendStates;
+        AssetMap<std::unique_ptr<graphics::DepthStencilState>> depthStencilStates;
+        AssetMap<scene::SpriteData> spriteData;
+        AssetMap<std::unique_ptr<gui::Font>> fonts;
+        AssetMap<std::unique_ptr<audio::Cue>> cues;
+        AssetMap<std::unique_ptr<audio::Sound>> sounds;
+        AssetMap<std::unique_ptr<graphics::Material>> materials;
+        AssetMap<scene::SkinnedMeshData> skinnedMeshData;
+        AssetMap<scene::StaticMeshData> staticMeshData;
+
+        std::mutex reloadMutex;
+        std::vector<Source> sources; // files that the assets were loaded from
+        std::vector<Reload> reloads;
+        EventHandler updateHandler;
+        std::unique_ptr<storage::FileWatcher> fileWatcher;
     };
 }
 
@@ -40,14 +40,20 @@ namespace ouzel::assets
     {
         const auto i = std::find(bundles.begin(), bundles.end(), bundle);
         if (i == bundles.end())
+        {
             bundles.push_back(bundle);
+            rebuildIndices();
+        }
     }
 
     void Cache::removeBundle(const Bundle* bundle)
     {
         const auto i = std::find(bundles.begin(), bundles.end(), bundle);
         if (i != bundles.end())
+        {
             bundles.erase(i);
+            rebuildIndices();
+        }
     }
 
     void Cache::addLoader(std::unique_ptr<Loader> loader)
@@ -66,111 +72,91 @@ namespace ouzel::assets
             loaders.erase(i);
     }
 
-    std::shared_ptr<graphics::Texture> Cache::getTexture(const std::string& name) const
+    void Cache::rebuildIndices()
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto texture = bundle->getTexture(name))
-                return texture;
-
-        return nullptr;
+        rebuildIndex(textureIndex, &Bundle::textures);
+        rebuildIndex(shaderIndex, &Bundle::shaders);
+        rebuildIndex(blendStateIndex, &Bundle::blendStates);
+        rebuildIndex(depthStencilStateIndex, &Bundle::depthStencilStates);
+        rebuildIndex(spriteDataIndex, &Bundle::spriteData);
+        rebuildIndex(particleSystemDataIndex, &Bundle::particleSystemData);
+        rebuildIndex(fontIndex, &Bundle::fonts);
+        rebuildIndex(cueIndex, &Bundle::cues);
+        rebuildIndex(soundIndex, &Bundle::sounds);
+        rebuildIndex(materialIndex, &Bundle::materials);
+        rebuildIndex(skinnedMeshDataIndex, &Bundle::skinnedMeshData);
+        rebuildIndex(staticMeshDataIndex, &Bundle::staticMeshData);
     }
 
-    const graphics::Shader* Cache::getShader(const std::string& name) const
+    std::shared_ptr<graphics::Texture> Cache::getTexture(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto shader = bundle->getShader(name))
-                return shader;
-
-        return nullptr;
+        const auto texture = textureIndex.find(key);
+        return texture ? *texture->asset : nullptr;
     }
 
-    const graphics::BlendState* Cache::getBlendState(const std::string& name) const
+    const graphics::Shader* Cache::getShader(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto blendState = bundle->getBlendState(name))
-                return blendState;
-
-        return nullptr;
+        const auto shader = shaderIndex.find(key);
+        return shader ? shader->asset : nullptr;
     }
 
-    const graphics::DepthStencilState* Cache::getDepthStencilState(const std::string& name) const
+    const graphics::BlendState* Cache::getBlendState(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto depthStencilState = bundle->getDepthStencilState(name))
-                return depthStencilState;
-
-        return nullptr;
+        const auto blendState = blendStateIndex.find(key);
+        return blendState ? blendState->asset : nullptr;
     }
 
-    const scene::SpriteData* Cache::getSpriteData(const std::string& name) const
+    const graphics::DepthStencilState* Cache::getDepthStencilState(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto spriteData = bundle->getSpriteData(name))
-                return spriteData;
-
-        return nullptr;
+        const auto depthStencilState = depthStencilStateIndex.find(key);
+        return depthStencilState ? depthStencilState->asset : nullptr;
     }
 
-    const scene::ParticleSystemData* Cache::getParticleSystemData(const std::string& name) const
+    const scene::SpriteData* Cache::getSpriteData(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto particleSystemData = bundle->getParticleSystemData(name))
-                return particleSystemData;
-
-        return nullptr;
+        const auto spriteData = spriteDataIndex.find(key);
+        return spriteData ? spriteData->asset : nullptr;
     }
 
-    const gui::Font* Cache::getFont(const std::string& name) const
+    const scene::ParticleSystemData* Cache::getParticleSystemData(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto font = bundle->getFont(name))
-                return font;
-
-        return nullptr;
+        const auto particleSystemData = particleSystemDataIndex.find(key);
+        return particleSystemData ? particleSystemData->asset : nullptr;
     }
 
-    const audio::Cue* Cache::getCue(const std::string& name) const
+    const gui::Font* Cache::getFont(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto cue = bundle->getCue(name))
-                return cue;
-
-        return nullptr;
+        const auto font = fontIndex.find(key);
+        return font ? font->asset : nullptr;
     }
 
-    const audio::Sound* Cache::getSound(const std::string& name) const
+    const audio::Cue* Cache::getCue(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto sound = bundle->getSound(name))
-                return sound;
-
-        return nullptr;
+        const auto cue = cueIndex.find(key);
+        return cue ? cue->asset : nullptr;
     }
 
-    const graphics::Material* Cache::getMaterial(const std::string& name) const
+    const audio::Sound* Cache::getSound(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto material = bundle->getMaterial(name))
-                return material;
-
-        return nullptr;
+        const auto sound = soundIndex.find(key);
+        return sound ? sound->asset : nullptr;
     }
 
-    const scene::SkinnedMeshData* Cache::getSkinnedMeshData(const std::string& name) const
+    const graphics::Material* Cache::getMaterial(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto meshData = bundle->getSkinnedMeshData(name))
-                return meshData;
-
-        return nullptr;
+        const auto material = materialIndex.find(key);
+        return material ? material->asset : nullptr;
     }
 
-    const scene::StaticMeshData* Cache::getStaticMeshData(const std::string& name) const
+    const scene::SkinnedMeshData* Cache::getSkinnedMeshData(const AssetKey& key) const
     {
-        for (const Bundle* bundle : bundles)
-            if (const auto meshData = bundle->getStaticMeshData(name))
-                return meshData;
+        const auto skinnedMeshData = skinnedMeshDataIndex.find(key);
+        return skinnedMeshData ? skinnedMeshData->asset : nullptr;
+    }
 
-        return nullptr;
+    const scene::StaticMeshData* Cache::getStaticMeshData(const AssetKey& key) const
+    {
+        const auto staticMeshData = staticMeshDataIndex.find(key);
+        return staticMeshData ? staticMeshData->asset : nullptr;
     }
 }
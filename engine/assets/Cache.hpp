@@ -3,8 +3,10 @@
 #ifndef OUZEL_ASSETS_CACHE_HPP
 #define OUZEL_ASSETS_CACHE_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include "AssetMap.hpp"
 #include "Bundle.hpp"
 
 namespace ouzel::assets
@@ -27,18 +29,21 @@ namespace ouzel::assets
         auto& getBundles() const noexcept { return bundles; }
         auto& getLoaders() const noexcept { return loaders; }
 
-        std::shared_ptr<graphics::Texture> getTexture(const std::string& name) const;
-        const graphics::Shader* getShader(const std::string& name) const;
-        const graphics::BlendState* getBlendState(const std::string& name) const;
-        const graphics::DepthStencilState* getDepthStencilState(const std::string& name) const;
-        const scene::SpriteData* getSpriteData(const std::string& name) const;
-        const scene::ParticleSystemData* getParticleSystemData(const std::string& name) const;
-        const gui::Font* getFont(const std::string& name) const;
-        const audio::Cue* getCue(const std::string& name) const;
-        const audio::Sound* getSound(const std::string& name) const;
-        const graphics::Material* getMaterial(const std::string& name) const;
-        const scene::SkinnedMeshData* getSkinnedMeshData(const std::string& name) const;
-        const scene::StaticMeshData* getStaticMeshData(const std::string& name) const;
+        std::shared_ptr<graphics::Texture> getTexture(const AssetKey& key) const;
+        const graphics::Shader* getShader(const AssetKey& key) const;
+        const graphics::BlendState* getBlendState(const AssetKey& key) const;
+        const graphics::DepthStencilState* getDepthStencilState(const AssetKey& key) const;
+        const scene::SpriteData* getSpriteData(const AssetKey& key) const;
+        const scene::ParticleSystemData* getParticleSystemData(const AssetKey& key) const;
+        const gui::Font* getFont(const AssetKey& key) const;
+        const audio::Cue* getCue(const AssetKey& key) const;
+        const audio::Sound* getSound(const AssetKey& key) const;
+        const graphics::Material* getMaterial(const AssetKey& key) const;
+        const scene::SkinnedMeshData* getSkinnedMeshData(const AssetKey& key) const;
+        const scene::StaticMeshData* getStaticMeshData(const AssetKey& key) const;
+
+        // incremented every time a bundle reloads sprite or particle system data
+        auto getReloadCount() const noexcept { return reloadCount; }
 
     private:
         void addBundle(const Bundle* bundle);
@@ -47,8 +52,92 @@ namespace ouzel::assets
         void addLoader(std::unique_ptr<Loader> loader);
         void removeLoader(const Loader* loader);
 
+        template <class T>
+        struct IndexEntry final
+        {
+            const Bundle* bundle;
+            T asset;
+        };
+
+        template <class T>
+        static const T* getAssetPointer(const T& asset) noexcept
+        {
+            return &asset;
+        }
+
+        template <class T>
+        static const std::shared_ptr<T>* getAssetPointer(const std::shared_ptr<T>& asset) noexcept
+        {
+            return asset ? &asset : nullptr;
+        }
+
+        template <class T>
+        static const T* getAssetPointer(const std::unique_ptr<T>& asset) noexcept
+        {
+            return asset.get();
+        }
+
+        // true if the first bundle was added before the second one
+        bool isBefore(const Bundle* first, const Bundle* second) const noexcept
+        {
+            for (const Bundle* bundle : bundles)
+            {
+                if (bundle == second) return false;
+                if (bundle == first) return true;
+            }
+
+            return false;
+        }
+
+        // called by the bundles when they set an asset, it replaces the one of the same or a later bundle
+        template <class T, class U>
+        void updateIndex(AssetMap<IndexEntry<T>>& index, AssetMap<U> Bundle::* assets,
+                         const Bundle* bundle, const AssetKey& key)
+        {
+            const auto asset = (bundle->*assets).find(key);
+            if (const auto pointer = asset ? getAssetPointer(*asset) : nullptr)
+            {
+                const auto entry = index.find(key);
+                if (!entry || !isBefore(entry->bundle, bundle))
+                    index.insertOrAssign(key, IndexEntry<T>{bundle, pointer});
+            }
+            else // an empty asset can uncover the one of a later bundle
+                rebuildIndex(index, assets);
+        }
+
+        // called by the bundles when they release the assets of a type
+        template <class T, class U>
+        void rebuildIndex(AssetMap<IndexEntry<T>>& index, AssetMap<U> Bundle::* assets)
+        {
+            index.clear();
+
+            for (const Bundle* bundle : bundles)
+                for (const auto& entry : bundle->*assets)
+                    if (const auto pointer = getAssetPointer(entry.value))
+                        if (!index.find(entry.name))
+                            index.insertOrAssign(entry.name, IndexEntry<T>{bundle, pointer});
+        }
+
+        void rebuildIndices();
+
         std::vector<const Bundle*> bundles;
         std::vector<std::unique_ptr<Loader>> loaders;
+        std::uint32_t reloadCount = 0;
+
+        // the first bundle that has an asset with the name, kept up to date by the bundles,
+        // so the lookups only read it and can be done from any thread while no bundle is being changed
+        AssetMap<IndexEntry<const std::shared_ptr<graphics::Texture>*>> textureIndex;
+        AssetMap<IndexEntry<const graphics::Shader*>> shaderIndex;
+        AssetMap<IndexEntry<const graphics::BlendState*>> blendStateIndex;
+        AssetMap<IndexEntry<const graphics::DepthStencilState*>> depthStencilStateIndex;
+        AssetMap<IndexEntry<const scene::SpriteData*>> spriteDataIndex;
+        AssetMap<IndexEntry<const scene::ParticleSystemData*>> particleSystemDataIndex;
+        AssetMap<IndexEntry<const gui::Font*>> fontIndex;
+        AssetMap<IndexEntry<const audio::Cue*>> cueIndex;
+        AssetMap<IndexEntry<const audio::Sound*>> soundIndex;
+        AssetMap<IndexEntry<const graphics::Material*>> materialIndex;
+        AssetMap<IndexEntry<const scene::SkinnedMeshData*>> skinnedMeshDataIndex;
+        AssetMap<IndexEntry<const scene::StaticMeshData*>> staticMeshDataIndex;
     };
 }
 
@@ -4,7 +4,7 @@
 #include "ColladaLoader.hpp"
 #include "Bundle.hpp"
 #include "../scene/SkinnedMeshRenderer.hpp"
-#include "../formats/Xml.hpp"
+#include "../formats/XmlDocument.hpp"
 
 namespace ouzel::assets
 {
@@ -15,15 +15,14 @@ namespace ouzel::assets
 
     bool ColladaLoader::loadAsset(Bundle& bundle,
                                   const std::string& name,
-                                  const std::vector<std::byte>& data,
+                                  const storage::FileView& data,
+                                  bool,
+                                  bool,
                                   bool)
     {
-        const auto colladaData = xml::parse(data);
+        const xml::Document colladaData(reinterpret_cast<const char*>(data.data()), data.size());
 
-        if (colladaData.getChildren().empty())
-            throw std::runtime_error("Invalid Collada file");
-
-        const auto rootNode = colladaData.getChildren().front();
+        const auto& rootNode = colladaData.getRoot();
 
         if (rootNode.getValue() != "COLLADA")
             throw std::runtime_error("Invalid Collada file");
@@ -1,11 +1,12 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
 #include <stack>
+#include <string_view>
 #include "CueLoader.hpp"
 #include "Bundle.hpp"
 #include "Cache.hpp"
 #include "../audio/Cue.hpp"
-#include "../formats/Json.hpp"
+#include "../formats/JsonDocument.hpp"
 
 namespace ouzel::assets
 {
@@ -16,11 +17,11 @@ namespace ouzel::assets
 
     namespace
     {
-        audio::SourceDefinition parseSourceDefinition(const json::Value& value, Cache& cache)
+        audio::SourceDefinition parseSourceDefinition(const json::Node& value, Cache& cache)
         {
             audio::SourceDefinition sourceDefinition;
 
-            const auto& valueType = value["type"].as<std::string>();
+            const auto valueType = value["type"].as<std::string_view>();
 
             if (valueType == "Parallel")
                 sourceDefinition.type = audio::SourceDefinition::Type::parallel;
@@ -32,7 +33,7 @@ namespace ouzel::assets
             {
                 sourceDefinition.type = audio::SourceDefinition::Type::oscillator;
 
-                auto& oscillatorType = value["oscillatorType"].as<std::string>();
+                const auto oscillatorType = value["oscillatorType"].as<std::string_view>();
 
                 if (oscillatorType == "Sine")
                     sourceDefinition.oscillatorType = audio::Oscillator::Type::sine;
@@ -67,14 +68,14 @@ namespace ouzel::assets
                     sourceDefinition.sound = cache.getSound(value["source"].as<std::string>());
             }
             else
-                throw std::runtime_error("Invalid source type " + valueType);
+                throw std::runtime_error("Invalid source type " + std::string(valueType));
 
             if (value.hasMember("effects"))
-                for (const json::Value& effectValue : value["effects"])
+                for (const json::Node& effectValue : value["effects"])
                 {
                     audio::EffectDefinition effectDefinition;
 
-                    const auto& effectType = effectValue["type"].as<std::string>();
+                    const auto effectType = effectValue["type"].as<std::string_view>();
 
                     if (effectType == "Delay")
                         effectDefinition.type = audio::EffectDefinition::Type::delay;
@@ -91,7 +92,7 @@ namespace ouzel::assets
                     else if (effectType == "HighPass")
                         effectDefinition.type = audio::EffectDefinition::Type::highPass;
                     else
-                        throw std::runtime_error("Invalid effect type " + effectType);
+                        throw std::runtime_error("Invalid effect type " + std::string(effectType));
 
                     if (effectValue.hasMember("delay")) effectDefinition.delay = effectValue["delay"].as<float>();
                     if (effectValue.hasMember("gain")) effectDefinition.gain = effectValue["gain"].as<float>();
@@ -103,7 +104,7 @@ namespace ouzel::assets
                 }
 
             if (value.hasMember("sources"))
-                for (const json::Value& sourceValue : value["sources"])
+                for (const json::Node& sourceValue : value["sources"])
                     sourceDefinition.sourceDefinitions.push_back(parseSourceDefinition(sourceValue, cache));
 
             return sourceDefinition;
@@ -112,11 +113,14 @@ namespace ouzel::assets
 
     bool CueLoader::loadAsset(Bundle& bundle,
                               const std::string& name,
-                              const std::vector<std::byte>& data,
+                              const storage::FileView& data,
+                              bool,
+                              bool,
                               bool)
     {
         audio::SourceDefinition sourceDefinition;
-        const auto d = json::parse(data);
+        const json::Document document(reinterpret_cast<const char*>(data.data()), data.size());
+        const json::Node& d = document.getRoot();
 
         if (d.hasMember("source"))
             sourceDefinition = parseSourceDefinition(d["source"], cache);
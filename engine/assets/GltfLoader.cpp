@@ -3,7 +3,7 @@
 #include "GltfLoader.hpp"
 #include "Bundle.hpp"
 #include "../scene/SkinnedMeshRenderer.hpp"
-#include "../formats/Json.hpp"
+#include "../formats/JsonDocument.hpp"
 
 namespace ouzel::assets
 {
@@ -14,10 +14,13 @@ namespace ouzel::assets
 
     bool GltfLoader::loadAsset(Bundle& bundle,
                                const std::string& name,
-                               const std::vector<std::byte>& data,
-                               bool mipmaps)
+                               const storage::FileView& data,
+                               bool mipmaps,
+                               bool,
+                               bool)
     {
-        const auto d = json::parse(data);
+        const json::Document document(reinterpret_cast<const char*>(data.data()), data.size());
+        const json::Node& d = document.getRoot();
 
         const auto& nodesValue = d["nodes"];
         const auto& meshesValue = d["meshes"];
@@ -13,8 +13,10 @@ namespace ouzel::assets
         explicit GltfLoader(Cache& initCache);
         bool loadAsset(Bundle& bundle,
                        const std::string& name,
-                       const std::vector<std::byte>& data,
-                       bool mipmaps = true) final;
+                       const storage::FileView& data,
+                       bool mipmaps = true,
+                       bool premultiplyAlpha = false,
+                       bool distanceField = false) final;
     };
 }
 
@@ -1,12 +1,27 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#  include <tmmintrin.h>
+#endif
+#if defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <stdexcept>
+#include <thread>
 #include "ImageLoader.hpp"
 #include "Bundle.hpp"
 #include "../core/Engine.hpp"
 #include "../graphics/Image.hpp"
 #include "../graphics/Texture.hpp"
+#include "../thread/Thread.hpp"
+#include "../utils/Utils.hpp"
 
 #if defined(_MSC_VER)
 #  pragma warning( push )
@@ -44,15 +59,426 @@
 
 namespace ouzel::assets
 {
-    ImageLoader::ImageLoader(Cache& initCache):
-        Loader(initCache, Type::image)
+    namespace
     {
+        constexpr std::array<std::uint8_t, 12> ktxIdentifier{
+            0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A // "«KTX 11»\r\n\x1A\n"
+        };
+        constexpr std::size_t ktxHeaderSize = 64;
+
+        constexpr std::uint32_t ddsMagic = 0x20534444U; // "DDS "
+        constexpr std::size_t ddsHeaderSize = 128; // including the magic
+        constexpr std::size_t ddsDx10HeaderSize = 20;
+
+        graphics::PixelFormat getKtxPixelFormat(std::uint32_t internalFormat, std::uint32_t format, std::uint32_t type)
+        {
+            switch (internalFormat)
+            {
+                case 0x83F1: return graphics::PixelFormat::bc1UnsignedNorm; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+                case 0x8C4D: return graphics::PixelFormat::bc1UnsignedNormSRGB; // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+                case 0x83F3: return graphics::PixelFormat::bc3UnsignedNorm; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                case 0x8C4F: return graphics::PixelFormat::bc3UnsignedNormSRGB; // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                case 0x8E8C: return graphics::PixelFormat::bc7UnsignedNorm; // GL_COMPRESSED_RGBA_BPTC_UNORM
+                case 0x8E8D: return graphics::PixelFormat::bc7UnsignedNormSRGB; // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                case 0x9274: return graphics::PixelFormat::etc2Rgb8UnsignedNorm; // GL_COMPRESSED_RGB8_ETC2
+                case 0x9275: return graphics::PixelFormat::etc2Rgb8UnsignedNormSRGB; // GL_COMPRESSED_SRGB8_ETC2
+                case 0x9278: return graphics::PixelFormat::etc2Rgba8UnsignedNorm; // GL_COMPRESSED_RGBA8_ETC2_EAC
+                case 0x9279: return graphics::PixelFormat::etc2Rgba8UnsignedNormSRGB; // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+                case 0x93B0: return graphics::PixelFormat::astc4x4UnsignedNorm; // GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+                case 0x93D0: return graphics::PixelFormat::astc4x4UnsignedNormSRGB; // GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+                case 0x8058: // GL_RGBA8
+                case 0x8C43: // GL_SRGB8_ALPHA8
+                    if (format != 0x1908 || type != 0x1401) // GL_RGBA, GL_UNSIGNED_BYTE
+                        throw std::runtime_error("Unsupported KTX pixel format");
+                    return (internalFormat == 0x8058) ?
+                        graphics::PixelFormat::rgba8UnsignedNorm :
+                        graphics::PixelFormat::rgba8UnsignedNormSRGB;
+                default:
+                    throw std::runtime_error("Unsupported KTX pixel format");
+            }
+        }
+
+        graphics::PixelFormat getDxgiPixelFormat(std::uint32_t dxgiFormat)
+        {
+            switch (dxgiFormat)
+            {
+                case 28: return graphics::PixelFormat::rgba8UnsignedNorm; // DXGI_FORMAT_R8G8B8A8_UNORM
+                case 29: return graphics::PixelFormat::rgba8UnsignedNormSRGB; // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+                case 71: return graphics::PixelFormat::bc1UnsignedNorm; // DXGI_FORMAT_BC1_UNORM
+                case 72: return graphics::PixelFormat::bc1UnsignedNormSRGB; // DXGI_FORMAT_BC1_UNORM_SRGB
+                case 77: return graphics::PixelFormat::bc3UnsignedNorm; // DXGI_FORMAT_BC3_UNORM
+                case 78: return graphics::PixelFormat::bc3UnsignedNormSRGB; // DXGI_FORMAT_BC3_UNORM_SRGB
+                case 98: return graphics::PixelFormat::bc7UnsignedNorm; // DXGI_FORMAT_BC7_UNORM
+                case 99: return graphics::PixelFormat::bc7UnsignedNormSRGB; // DXGI_FORMAT_BC7_UNORM_SRGB
+                default: throw std::runtime_error("Unsupported DDS pixel format");
+            }
+        }
+
+        TextureContainer decodeKtx(const storage::FileView& data)
+        {
+            if (data.size() < ktxHeaderSize)
+                throw std::runtime_error("Invalid KTX file");
+
+            const auto bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+
+            // the writer stores the values in its own byte order together with 0x04030201
+            const bool bigEndian = decodeLittleEndian<std::uint32_t>(bytes + 12) != 0x04030201U;
+            if (bigEndian && decodeBigEndian<std::uint32_t>(bytes + 12) != 0x04030201U)
+                throw std::runtime_error("Invalid KTX endianness");
+
+            const auto decode = [bytes, bigEndian](std::size_t offset) noexcept {
+                return bigEndian ?
+                    decodeBigEndian<std::uint32_t>(bytes + offset) :
+                    decodeLittleEndian<std::uint32_t>(bytes + offset);
+            };
+
+            const auto type = decode(16);
+            const auto format = decode(24);
+            const auto internalFormat = decode(28);
+            const auto width = decode(36);
+            const auto height = decode(40);
+            const auto depth = decode(44);
+            const auto arrayElementCount = decode(48);
+            const auto faceCount = decode(52);
+            const auto levelCount = std::max(decode(56), 1U);
+            const auto keyValueDataSize = decode(60);
+
+            if (!width || !height || depth > 1 || arrayElementCount > 0 || faceCount != 1)
+                throw std::runtime_error("Only 2D KTX textures are supported");
+
+            TextureContainer result;
+            result.pixelFormat = getKtxPixelFormat(internalFormat, format, type);
+            result.size = Size2U(width, height);
+
+            std::size_t offset = ktxHeaderSize + keyValueDataSize;
+            auto levelWidth = width;
+            auto levelHeight = height;
+
+            for (std::uint32_t level = 0; level < levelCount; ++level)
+            {
+                if (offset > data.size() || data.size() - offset < 4)
+                    throw std::runtime_error("Invalid KTX file");
+
+                const std::size_t imageSize = decode(offset);
+                offset += 4;
+
+                if (imageSize != graphics::getLevelSize(result.pixelFormat, levelWidth, levelHeight) ||
+                    data.size() - offset < imageSize)
+                    throw std::runtime_error("Invalid KTX file");
+
+                result.levels.emplace_back(Size2U(levelWidth, levelHeight),
+                                           std::vector<std::uint8_t>(bytes + offset, bytes + offset + imageSize));
+
+                offset += (imageSize + 3) & ~std::size_t(3); // mip padding
+                levelWidth = std::max(levelWidth >> 1, 1U);
+                levelHeight = std::max(levelHeight >> 1, 1U);
+            }
+
+            return result;
+        }
+
+        TextureContainer decodeDds(const storage::FileView& data)
+        {
+            if (data.size() < ddsHeaderSize)
+                throw std::runtime_error("Invalid DDS file");
+
+            const auto bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+
+            constexpr std::uint32_t mipMapCountFlag = 0x20000; // DDSD_MIPMAPCOUNT
+            constexpr std::uint32_t fourCcFlag = 0x4; // DDPF_FOURCC
+            constexpr std::uint32_t rgbFlag = 0x40; // DDPF_RGB
+            constexpr std::uint32_t alphaPixelsFlag = 0x1; // DDPF_ALPHAPIXELS
+            constexpr std::uint32_t cubeMapFlag = 0x200; // DDSCAPS2_CUBEMAP
+            constexpr std::uint32_t volumeFlag = 0x200000; // DDSCAPS2_VOLUME
+
+            const auto flags = decodeLittleEndian<std::uint32_t>(bytes + 8);
+            const auto height = decodeLittleEndian<std::uint32_t>(bytes + 12);
+            const auto width = decodeLittleEndian<std::uint32_t>(bytes + 16);
+            const auto levelCount = (flags & mipMapCountFlag) ?
+                std::max(decodeLittleEndian<std::uint32_t>(bytes + 28), 1U) : 1U;
+            const auto pixelFormatFlags = decodeLittleEndian<std::uint32_t>(bytes + 80);
+            const auto fourCc = decodeLittleEndian<std::uint32_t>(bytes + 84);
+            const auto caps2 = decodeLittleEndian<std::uint32_t>(bytes + 112);
+
+            if (!width || !height || (caps2 & (cubeMapFlag | volumeFlag)))
+                throw std::runtime_error("Only 2D DDS textures are supported");
+
+            TextureContainer result;
+            result.size = Size2U(width, height);
+            std::size_t offset = ddsHeaderSize;
+
+            if (pixelFormatFlags & fourCcFlag)
+            {
+                switch (fourCc)
+                {
+                    case 0x31545844U: // "DXT1"
+                        result.pixelFormat = graphics::PixelFormat::bc1UnsignedNorm;
+                        break;
+                    case 0x35545844U: // "DXT5"
+                        result.pixelFormat = graphics::PixelFormat::bc3UnsignedNorm;
+                        break;
+                    case 0x30315844U: // "DX10"
+                    {
+                        if (data.size() < ddsHeaderSize + ddsDx10HeaderSize)
+                            throw std::runtime_error("Invalid DDS file");
+
+                        const auto resourceDimension = decodeLittleEndian<std::uint32_t>(bytes + ddsHeaderSize + 4);
+                        const auto arraySize = decodeLittleEndian<std::uint32_t>(bytes + ddsHeaderSize + 12);
+
+                        if (resourceDimension != 3 || arraySize > 1) // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+                            throw std::runtime_error("Only 2D DDS textures are supported");
+
+                        result.pixelFormat = getDxgiPixelFormat(decodeLittleEndian<std::uint32_t>(bytes + ddsHeaderSize));
+                        offset += ddsDx10HeaderSize;
+                        break;
+                    }
+                    default:
+                        throw std::runtime_error("Unsupported DDS pixel format");
+                }
+            }
+            else if ((pixelFormatFlags & rgbFlag) && (pixelFormatFlags & alphaPixelsFlag) &&
+                     decodeLittleEndian<std::uint32_t>(bytes + 88) == 32 && // bit count
+                     decodeLittleEndian<std::uint32_t>(bytes + 92) == 0x000000FFU && // red mask
+                     decodeLittleEndian<std::uint32_t>(bytes + 96) == 0x0000FF00U && // green mask
+                     decodeLittleEndian<std::uint32_t>(bytes + 100) == 0x00FF0000U && // blue mask
+                     decodeLittleEndian<std::uint32_t>(bytes + 104) == 0xFF000000U) // alpha mask
+                result.pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
+            else
+                throw std::runtime_error("Unsupported DDS pixel format");
+
+            auto levelWidth = width;
+            auto levelHeight = height;
+
+            for (std::uint32_t level = 0; level < levelCount; ++level)
+            {
+                const auto levelSize = graphics::getLevelSize(result.pixelFormat, levelWidth, levelHeight);
+                if (data.size() - offset < levelSize)
+                    throw std::runtime_error("Invalid DDS file");
+
+                result.levels.emplace_back(Size2U(levelWidth, levelHeight),
+                                           std::vector<std::uint8_t>(bytes + offset, bytes + offset + levelSize));
+
+                offset += levelSize;
+                levelWidth = std::max(levelWidth >> 1, 1U);
+                levelHeight = std::max(levelHeight >> 1, 1U);
+            }
+
+            return result;
+        }
+        // pixels converted at a time, so that the premultiplication reads them back from the cache
+        constexpr std::size_t conversionChunkSize = 4096;
+
+        void convertGreyToRgba(const std::uint8_t* source, std::uint8_t* destination, std::size_t count) noexcept
+        {
+            std::size_t i = 0;
+
+#if defined(__SSE2__)
+            if (core::isSimdAvailable)
+            {
+                const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    const __m128i grey = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+                    const __m128i greyGreyLow = _mm_unpacklo_epi8(grey, grey);
+                    const __m128i greyGreyHigh = _mm_unpackhi_epi8(grey, grey);
+                    const __m128i greyAlphaLow = _mm_unpacklo_epi8(grey, alpha);
+                    const __m128i greyAlphaHigh = _mm_unpackhi_epi8(grey, alpha);
+
+                    auto result = reinterpret_cast<__m128i*>(destination + i * 4);
+                    _mm_storeu_si128(result + 0, _mm_unpacklo_epi16(greyGreyLow, greyAlphaLow));
+                    _mm_storeu_si128(result + 1, _mm_unpackhi_epi16(greyGreyLow, greyAlphaLow));
+                    _mm_storeu_si128(result + 2, _mm_unpacklo_epi16(greyGreyHigh, greyAlphaHigh));
+                    _mm_storeu_si128(result + 3, _mm_unpackhi_epi16(greyGreyHigh, greyAlphaHigh));
+                }
+            }
+#elif defined(__ARM_NEON__)
+            if (core::isSimdAvailable)
+            {
+                const uint8x16_t alpha = vdupq_n_u8(0xFF);
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    const uint8x16_t grey = vld1q_u8(source + i);
+                    vst4q_u8(destination + i * 4, uint8x16x4_t{{grey, grey, grey, alpha}});
+                }
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                destination[i * 4 + 0] = source[i];
+                destination[i * 4 + 1] = source[i];
+                destination[i * 4 + 2] = source[i];
+                destination[i * 4 + 3] = 255;
+            }
+        }
+
+        void convertGreyAlphaToRgba(const std::uint8_t* source, std::uint8_t* destination, std::size_t count) noexcept
+        {
+            std::size_t i = 0;
+
+#if defined(__SSE2__)
+            if (core::isSimdAvailable)
+            {
+                const __m128i greyMask = _mm_set1_epi16(0x00FF);
+
+                for (; i + 8 <= count; i += 8)
+                {
+                    const __m128i greyAlpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+                    const __m128i grey = _mm_and_si128(greyAlpha, greyMask);
+                    const __m128i greyGrey = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+
+                    auto result = reinterpret_cast<__m128i*>(destination + i * 4);
+                    _mm_storeu_si128(result + 0, _mm_unpacklo_epi16(greyGrey, greyAlpha));
+                    _mm_storeu_si128(result + 1, _mm_unpackhi_epi16(greyGrey, greyAlpha));
+                }
+            }
+#elif defined(__ARM_NEON__)
+            if (core::isSimdAvailable)
+            {
+                for (; i + 16 <= count; i += 16)
+                {
+                    const uint8x16x2_t greyAlpha = vld2q_u8(source + i * 2);
+                    vst4q_u8(destination + i * 4, uint8x16x4_t{{greyAlpha.val[0], greyAlpha.val[0], greyAlpha.val[0], greyAlpha.val[1]}});
+                }
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                destination[i * 4 + 0] = source[i * 2 + 0];
+                destination[i * 4 + 1] = source[i * 2 + 0];
+                destination[i * 4 + 2] = source[i * 2 + 0];
+                destination[i * 4 + 3] = source[i * 2 + 1];
+            }
+        }
+
+        void convertRgbToRgba(const std::uint8_t* source, std::uint8_t* destination, std::size_t count) noexcept
+        {
+            std::size_t i = 0;
+
+#if defined(__SSSE3__)
+            if (core::isSimdAvailable)
+            {
+                const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+                const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+
+                // 16 bytes are loaded for 4 pixels, so the last 4 bytes must be inside of the source
+                for (; i + 6 <= count; i += 4)
+                {
+                    const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 3));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4),
+                                     _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+                }
+            }
+#elif defined(__ARM_NEON__)
+            if (core::isSimdAvailable)
+            {
+                const uint8x16_t alpha = vdupq_n_u8(0xFF);
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    const uint8x16x3_t rgb = vld3q_u8(source + i * 3);
+                    vst4q_u8(destination + i * 4, uint8x16x4_t{{rgb.val[0], rgb.val[1], rgb.val[2], alpha}});
+                }
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                destination[i * 4 + 0] = source[i * 3 + 0];
+                destination[i * 4 + 1] = source[i * 3 + 1];
+                destination[i * 4 + 2] = source[i * 3 + 2];
+                destination[i * 4 + 3] = 255;
+            }
+        }
+
+        // destination = source with the color channels multiplied by alpha, rounded the same way as c * a / 255
+        void premultiplyRgba(const std::uint8_t* source, std::uint8_t* destination, std::size_t count) noexcept
+        {
+            std::size_t i = 0;
+
+#if defined(__SSE2__)
+            if (core::isSimdAvailable)
+            {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i half = _mm_set1_epi16(128);
+                // alpha is multiplied by 255, so it stays the same
+                const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, 0xFF, 0, 0, 0, 0xFF);
+
+                const auto multiply = [&half, &alphaMask](__m128i color) noexcept {
+                    __m128i alpha = _mm_shufflelo_epi16(color, _MM_SHUFFLE(3, 3, 3, 3));
+                    alpha = _mm_or_si128(_mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3)), alphaMask);
+                    const __m128i product = _mm_add_epi16(_mm_mullo_epi16(color, alpha), half);
+                    return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+                };
+
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i * 4),
+                                     _mm_packus_epi16(multiply(_mm_unpacklo_epi8(rgba, zero)),
+                                                      multiply(_mm_unpackhi_epi8(rgba, zero))));
+                }
+            }
+#elif defined(__ARM_NEON__)
+            if (core::isSimdAvailable)
+            {
+                const auto multiply = [](uint8x16_t color, uint8x16_t alpha) noexcept {
+                    const uint16x8_t low = vmull_u8(vget_low_u8(color), vget_low_u8(alpha));
+                    const uint16x8_t high = vmull_u8(vget_high_u8(color), vget_high_u8(alpha));
+                    return vcombine_u8(vrshrn_n_u16(vrsraq_n_u16(low, low, 8), 8),
+                                       vrshrn_n_u16(vrsraq_n_u16(high, high, 8), 8));
+                };
+
+                for (; i + 16 <= count; i += 16)
+                {
+                    uint8x16x4_t rgba = vld4q_u8(source + i * 4);
+                    rgba.val[0] = multiply(rgba.val[0], rgba.val[3]);
+                    rgba.val[1] = multiply(rgba.val[1], rgba.val[3]);
+                    rgba.val[2] = multiply(rgba.val[2], rgba.val[3]);
+                    vst4q_u8(destination + i * 4, rgba);
+                }
+            }
+#endif
+
+            for (; i < count; ++i)
+            {
+                const std::uint32_t alpha = source[i * 4 + 3];
+
+                for (std::size_t channel = 0; channel < 3; ++channel)
+                {
+                    const std::uint32_t product = source[i * 4 + channel] * alpha + 128;
+                    destination[i * 4 + channel] = static_cast<std::uint8_t>((product + (product >> 8)) >> 8);
+                }
+
+                destination[i * 4 + 3] = static_cast<std::uint8_t>(alpha);
+            }
+        }
     }
 
-    bool ImageLoader::loadAsset(Bundle& bundle,
-                                const std::string& name,
-                                const std::vector<std::byte>& data,
-                                bool mipmaps)
+    bool isTextureContainer(const storage::FileView& data) noexcept
+    {
+        const auto bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+
+        return (data.size() >= ktxIdentifier.size() && std::equal(ktxIdentifier.begin(), ktxIdentifier.end(), bytes)) ||
+            (data.size() >= 4 && decodeLittleEndian<std::uint32_t>(bytes) == ddsMagic);
+    }
+
+    TextureContainer decodeTextureContainer(const storage::FileView& data)
+    {
+        const auto bytes = reinterpret_cast<const std::uint8_t*>(data.data());
+
+        if (data.size() >= ktxIdentifier.size() && std::equal(ktxIdentifier.begin(), ktxIdentifier.end(), bytes))
+            return decodeKtx(data);
+        else if (data.size() >= 4 && decodeLittleEndian<std::uint32_t>(bytes) == ddsMagic)
+            return decodeDds(data);
+        else
+            throw std::runtime_error("Unsupported texture container");
+    }
+
+    graphics::Image decodeImage(const storage::FileView& data, bool premultiplyAlpha)
     {
         int width;
         int height;
@@ -66,96 +492,136 @@ namespace ouzel::assets
         if (!tempData)
             throw std::runtime_error("Failed to load texture, reason: " + std::string(stbi_failure_reason()));
 
-        graphics::PixelFormat pixelFormat;
-        std::vector<std::uint8_t> imageData;
+        const std::unique_ptr<stbi_uc, void(*)(void*)> pixels(tempData, &stbi_image_free);
+
+        const auto pixelCount = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+
+        // the pixels are expanded straight into the buffer that is moved into the image
+        std::vector<std::uint8_t> imageData(pixelCount * 4);
+        const std::uint8_t* source = pixels.get();
+        std::uint8_t* destination = imageData.data();
 
         switch (comp)
         {
             case STBI_grey:
-            {
-                pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
-
-                imageData.resize(static_cast<std::size_t>(width * height * 4));
-
-                for (int y = 0; y < height; ++y)
-                {
-                    for (int x = 0; x < width; ++x)
-                    {
-                        const auto sourceOffset = static_cast<std::size_t>(y * width + x);
-                        const auto destinationOffset = static_cast<std::size_t>((y * width + x) * 4);
-                        imageData[destinationOffset + 0] = tempData[sourceOffset];
-                        imageData[destinationOffset + 1] = tempData[sourceOffset];
-                        imageData[destinationOffset + 2] = tempData[sourceOffset];
-                        imageData[destinationOffset + 3] = 255;
-                    }
-                }
-                stbi_image_free(tempData);
+                convertGreyToRgba(source, destination, pixelCount);
                 break;
-            }
             case STBI_grey_alpha:
-            {
-                pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
-
-                imageData.resize(static_cast<std::size_t>(width * height * 4));
-
-                for (int y = 0; y < height; ++y)
+                for (std::size_t offset = 0; offset < pixelCount; offset += conversionChunkSize)
                 {
-                    for (int x = 0; x < width; ++x)
-                    {
-                        const auto sourceOffset = static_cast<std::size_t>((y * width + x) * 2);
-                        const auto destinationOffset = static_cast<std::size_t>((y * width + x) * 4);
-                        imageData[destinationOffset + 0] = tempData[sourceOffset + 0];
-                        imageData[destinationOffset + 1] = tempData[sourceOffset + 0];
-                        imageData[destinationOffset + 2] = tempData[sourceOffset + 0];
-                        imageData[destinationOffset + 3] = tempData[sourceOffset + 1];
-                    }
+                    const auto count = std::min(conversionChunkSize, pixelCount - offset);
+                    convertGreyAlphaToRgba(source + offset * 2, destination + offset * 4, count);
+                    if (premultiplyAlpha)
+                        premultiplyRgba(destination + offset * 4, destination + offset * 4, count);
                 }
-                stbi_image_free(tempData);
                 break;
-            }
             case STBI_rgb:
-            {
-                pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
-
-                imageData.resize(static_cast<std::size_t>(width * height * 4));
-
-                for (int y = 0; y < height; ++y)
-                {
-                    for (int x = 0; x < width; ++x)
-                    {
-                        const auto sourceOffset = static_cast<std::size_t>((y * width + x) * 3);
-                        const auto destinationOffset = static_cast<std::size_t>((y * width + x) * 4);
-                        imageData[destinationOffset + 0] = tempData[sourceOffset + 0];
-                        imageData[destinationOffset + 1] = tempData[sourceOffset + 1];
-                        imageData[destinationOffset + 2] = tempData[sourceOffset + 2];
-                        imageData[destinationOffset + 3] = 255;
-                    }
-                }
-                stbi_image_free(tempData);
+                convertRgbToRgba(source, destination, pixelCount);
                 break;
-            }
             case STBI_rgb_alpha:
-            {
-                pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
-                imageData.assign(tempData,
-                                 tempData + static_cast<std::size_t>(width * height) * 4);
-                stbi_image_free(tempData);
+                if (premultiplyAlpha)
+                    premultiplyRgba(source, destination, pixelCount);
+                else
+                    std::copy(source, source + pixelCount * 4, destination);
                 break;
-            }
             default:
-                stbi_image_free(tempData);
                 throw std::runtime_error("Unsupported pixel format");
         }
 
-        graphics::Image image(pixelFormat,
-                              Size2U(static_cast<std::uint32_t>(width),
-                                     static_cast<std::uint32_t>(height)),
-                              imageData);
+        return graphics::Image(graphics::PixelFormat::rgba8UnsignedNorm,
+                               Size2U(static_cast<std::uint32_t>(width),
+                                      static_cast<std::uint32_t>(height)),
+                               std::move(imageData));
+    }
+
+    std::vector<graphics::Image> decodeImages(const std::vector<EncodedImage>& encodedImages)
+    {
+        std::vector<graphics::Image> images(encodedImages.size());
+        std::atomic<std::size_t> nextImage{0};
+
+        // one job per file, the images that fail to decode are left empty
+        const auto decode = [&encodedImages, &images, &nextImage]() noexcept {
+            for (;;)
+            {
+                const auto index = nextImage.fetch_add(1);
+                if (index >= encodedImages.size()) break;
+
+                try
+                {
+                    images[index] = decodeImage(encodedImages[index].data,
+                                                encodedImages[index].premultiplyAlpha);
+                }
+                catch (const std::exception&)
+                {
+                }
+            }
+        };
+
+#if !defined(__EMSCRIPTEN__)
+        // the calling thread decodes the images too
+        const auto cpuCount = std::thread::hardware_concurrency();
+        const auto workerCount = std::min(cpuCount > 1 ? cpuCount - 1 : 0U,
+                                          static_cast<std::uint32_t>(encodedImages.empty() ? 0 : encodedImages.size() - 1));
+
+        std::vector<thread::Thread> workers;
+        workers.reserve(workerCount);
+        for (std::uint32_t i = 0; i < workerCount; ++i)
+            workers.emplace_back([&decode]() {
+                thread::setCurrentThreadName("Image decoder");
+                decode();
+            });
+#endif
+
+        decode();
+
+#if !defined(__EMSCRIPTEN__)
+        for (auto& worker : workers)
+            worker.join();
+#endif
+
+        return images;
+    }
+
+    ImageLoader::ImageLoader(Cache& initCache):
+        Loader(initCache, Type::image)
+    {
+    }
+
+    bool ImageLoader::loadAsset(Bundle& bundle,
+                                const std::string& name,
+                                const storage::FileView& data,
+                                bool mipmaps,
+                                bool premultiplyAlpha,
+                                bool)
+    {
+        if (isTextureContainer(data))
+        {
+            // the containers are uploaded as they are, so their alpha can't be premultiplied
+            if (premultiplyAlpha)
+                throw std::runtime_error("Alpha can not be premultiplied in a texture container");
+
+            auto container = decodeTextureContainer(data);
+
+            // the levels of a container are used as they are, they can't be generated for compressed formats
+            if (!mipmaps) container.levels.resize(1);
+
+            auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                               container.levels,
+                                                               container.size,
+                                                               graphics::Flags::none,
+                                                               container.pixelFormat);
+
+            bundle.setTexture(name, texture);
+
+            return true;
+        }
+
+        auto image = decodeImage(data, premultiplyAlpha);
 
         auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
-                                                           image.getData(),
+                                                           std::move(image).getData(),
                                                            image.getSize(),
-                                                           graphics::Flags::none,
+                                                           premultiplyAlpha ? graphics::Flags::premultipliedAlpha : graphics::Flags::none,
                                                            mipmaps ? 0 : 1,
                                                            image.getPixelFormat());
 
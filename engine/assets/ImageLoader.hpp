@@ -3,18 +3,51 @@
 #ifndef OUZEL_ASSETS_IMAGELOADER_HPP
 #define OUZEL_ASSETS_IMAGELOADER_HPP
 
+#include <cstdint>
+#include <utility>
+#include <vector>
 #include "Loader.hpp"
+#include "../graphics/Image.hpp"
+#include "../graphics/PixelFormat.hpp"
+#include "../math/Size.hpp"
 
 namespace ouzel::assets
 {
+    // decodes the image file without creating a texture, so it can be called from any thread
+    // the color channels of images with alpha can be multiplied by it while they are converted to RGBA
+    graphics::Image decodeImage(const storage::FileView& data, bool premultiplyAlpha = false);
+
+    struct EncodedImage final
+    {
+        storage::FileView data;
+        bool premultiplyAlpha = false;
+    };
+
+    // decodes the images on the calling thread and a pool of worker threads,
+    // the images that fail to decode are left empty
+    std::vector<graphics::Image> decodeImages(const std::vector<EncodedImage>& encodedImages);
+
+    // texture stored in a KTX or DDS container, usually block-compressed and with all of its levels
+    struct TextureContainer final
+    {
+        graphics::PixelFormat pixelFormat = graphics::PixelFormat::rgba8UnsignedNorm;
+        Size2U size;
+        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels;
+    };
+
+    bool isTextureContainer(const storage::FileView& data) noexcept;
+    TextureContainer decodeTextureContainer(const storage::FileView& data);
+
     class ImageLoader final: public Loader
     {
     public:
         explicit ImageLoader(Cache& initCache);
         bool loadAsset(Bundle& bundle,
                        const std::string& name,
-                       const std::vector<std::byte>& data,
-                       bool mipmaps = true) final;
+                       const storage::FileView& data,
+                       bool mipmaps = true,
+                       bool premultiplyAlpha = false,
+                       bool distanceField = false) final;
     };
 }
 
@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <string>
 #include <vector>
+#include "../storage/FileView.hpp"
 
 namespace ouzel::assets
 {
@@ -46,8 +47,10 @@ namespace ouzel::assets
 
         virtual bool loadAsset(Bundle& bundle,
                                const std::string& name,
-                               const std::vector<std::byte>& data,
-                               bool mipmaps = true) = 0;
+                               const storage::FileView& data,
+                               bool mipmaps = true,
+                               bool premultiplyAlpha = false,
+                               bool distanceField = false) = 0;
 
     protected:
         Cache& cache;
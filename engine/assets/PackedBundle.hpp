@@ -0,0 +1,329 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_ASSETS_PACKEDBUNDLE_HPP
+#define OUZEL_ASSETS_PACKEDBUNDLE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Loader.hpp"
+#include "../graphics/PixelFormat.hpp"
+#include "../storage/FileView.hpp"
+#include "../utils/Utils.hpp"
+
+// Packed bundle layout (all values are little endian):
+// header: signature, version, entry count, bucket count (4 bytes each), entry table offset, displacement table offset (8 bytes each)
+// entry table: one 32-byte entry per slot of the perfect hash
+// displacement table: 4-byte displacement for every bucket
+// name table: names of the entries, not null terminated
+// data: contents of the entries, each aligned to 16 bytes
+namespace ouzel::assets::packed
+{
+    constexpr std::uint32_t signature = 0x42505A4FU; // "OZPB"
+    constexpr std::uint32_t version = 1;
+    constexpr std::size_t alignment = 16;
+    constexpr std::size_t headerSize = 32;
+    constexpr std::size_t entrySize = 32;
+
+    // texture: width, height, level count, texture format (4 bytes each)
+    // followed by the levels, every level is half the size of the previous one and aligned to 16 bytes
+    constexpr std::size_t textureHeaderSize = 16;
+
+    // values are stored in the bundles, so they must not change
+    // (the field was reserved and zero in the first bundles, so those are RGBA8)
+    enum class TextureFormat: std::uint32_t
+    {
+        rgba8 = 0,
+        bc1 = 1,
+        bc3 = 2,
+        bc7 = 3,
+        etc2Rgb8 = 4,
+        etc2Rgba8 = 5,
+        astc4x4 = 6
+    };
+
+    enum class Encoding: std::uint8_t
+    {
+        source, // contents of the original file, passed to the loaders
+        texture // decoded texture with all of its levels
+    };
+
+    struct Entry final
+    {
+        std::string_view name;
+        Loader::Type type;
+        Encoding encoding;
+        bool mipmaps;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    // FNV-1a with a seed and a final mix, so that the remainder of the result is evenly distributed
+    constexpr std::uint64_t hash(std::string_view str, std::uint64_t seed) noexcept
+    {
+        std::uint64_t result = 0xCBF29CE484222325U ^ (seed * 0x9E3779B97F4A7C15U);
+        for (const char c : str)
+        {
+            result ^= static_cast<std::uint8_t>(c);
+            result *= 0x100000001B3U;
+        }
+
+        result ^= result >> 33;
+        result *= 0xFF51AFD7ED558CCDU;
+        result ^= result >> 33;
+        return result;
+    }
+
+    inline std::size_t align(std::size_t offset) noexcept
+    {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    inline graphics::PixelFormat getPixelFormat(TextureFormat textureFormat)
+    {
+        switch (textureFormat)
+        {
+            case TextureFormat::rgba8: return graphics::PixelFormat::rgba8UnsignedNorm;
+            case TextureFormat::bc1: return graphics::PixelFormat::bc1UnsignedNorm;
+            case TextureFormat::bc3: return graphics::PixelFormat::bc3UnsignedNorm;
+            case TextureFormat::bc7: return graphics::PixelFormat::bc7UnsignedNorm;
+            case TextureFormat::etc2Rgb8: return graphics::PixelFormat::etc2Rgb8UnsignedNorm;
+            case TextureFormat::etc2Rgba8: return graphics::PixelFormat::etc2Rgba8UnsignedNorm;
+            case TextureFormat::astc4x4: return graphics::PixelFormat::astc4x4UnsignedNorm;
+            default: throw std::runtime_error("Invalid texture format");
+        }
+    }
+
+    // size of the level data without the alignment
+    inline std::size_t getLevelDataSize(TextureFormat textureFormat, std::uint32_t width, std::uint32_t height)
+    {
+        return graphics::getLevelSize(getPixelFormat(textureFormat), width, height);
+    }
+
+    inline std::size_t getLevelSize(TextureFormat textureFormat, std::uint32_t width, std::uint32_t height)
+    {
+        return align(getLevelDataSize(textureFormat, width, height));
+    }
+
+    class Reader final
+    {
+    public:
+        explicit Reader(const storage::FileView& initData):
+            data{initData}
+        {
+            if (data.size() < headerSize)
+                throw std::runtime_error("Invalid packed bundle");
+
+            if (decodeLittleEndian<std::uint32_t>(data.data()) != signature)
+                throw std::runtime_error("Bad signature");
+
+            if (decodeLittleEndian<std::uint32_t>(data.data() + 4) != version)
+                throw std::runtime_error("Unsupported packed bundle version");
+
+            entryCount = decodeLittleEndian<std::uint32_t>(data.data() + 8);
+            bucketCount = decodeLittleEndian<std::uint32_t>(data.data() + 12);
+            entriesOffset = static_cast<std::size_t>(decodeLittleEndian<std::uint64_t>(data.data() + 16));
+            displacementsOffset = static_cast<std::size_t>(decodeLittleEndian<std::uint64_t>(data.data() + 24));
+
+            if (entriesOffset > data.size() ||
+                (data.size() - entriesOffset) / entrySize < entryCount ||
+                displacementsOffset > data.size() ||
+                (data.size() - displacementsOffset) / 4 < bucketCount ||
+                (entryCount > 0 && bucketCount == 0))
+                throw std::runtime_error("Invalid packed bundle");
+        }
+
+        auto getEntryCount() const noexcept { return entryCount; }
+
+        Entry getEntry(std::uint32_t index) const
+        {
+            if (index >= entryCount)
+                throw std::out_of_range("Invalid entry index");
+
+            const auto entry = data.data() + entriesOffset + index * entrySize;
+            const auto offset = static_cast<std::size_t>(decodeLittleEndian<std::uint64_t>(entry));
+            const auto size = static_cast<std::size_t>(decodeLittleEndian<std::uint64_t>(entry + 8));
+            const auto nameOffset = static_cast<std::size_t>(decodeLittleEndian<std::uint64_t>(entry + 16));
+            const std::size_t nameLength = decodeLittleEndian<std::uint16_t>(entry + 24);
+
+            if (offset > data.size() || size > data.size() - offset ||
+                nameOffset > data.size() || nameLength > data.size() - nameOffset)
+                throw std::runtime_error("Invalid packed bundle entry");
+
+            return Entry{
+                std::string_view{reinterpret_cast<const char*>(data.data() + nameOffset), nameLength},
+                static_cast<Loader::Type>(entry[26]),
+                static_cast<Encoding>(entry[27]),
+                (static_cast<std::uint8_t>(entry[28]) & 0x01) != 0,
+                offset,
+                size
+            };
+        }
+
+        // the perfect hash gives the only slot that can contain the name
+        std::optional<Entry> find(std::string_view name) const
+        {
+            if (entryCount == 0) return std::nullopt;
+
+            const auto bucket = static_cast<std::size_t>(hash(name, 0) % bucketCount);
+            const auto displacement = decodeLittleEndian<std::uint32_t>(data.data() + displacementsOffset + bucket * 4);
+            const auto slot = static_cast<std::uint32_t>(hash(name, displacement) % entryCount);
+
+            auto entry = getEntry(slot);
+            if (entry.name != name) return std::nullopt;
+            return entry;
+        }
+
+        storage::FileView getData(const Entry& entry) const
+        {
+            return data.subview(entry.offset, entry.size);
+        }
+
+    private:
+        storage::FileView data;
+        std::uint32_t entryCount = 0;
+        std::uint32_t bucketCount = 0;
+        std::size_t entriesOffset = 0;
+        std::size_t displacementsOffset = 0;
+    };
+
+    class Writer final
+    {
+    public:
+        void addEntry(const std::string& name, Loader::Type type, Encoding encoding,
+                      bool mipmaps, std::vector<std::byte> data)
+        {
+            if (name.size() > 0xFFFF)
+                throw std::runtime_error("Name too long: " + name);
+
+            for (const auto& entry : entries)
+                if (entry.name == name)
+                    throw std::runtime_error("Duplicate entry " + name);
+
+            entries.push_back(WriterEntry{name, type, encoding, mipmaps, std::move(data)});
+        }
+
+        std::vector<std::byte> write() const
+        {
+            const auto entryCount = static_cast<std::uint32_t>(entries.size());
+            const auto bucketCount = std::max(std::uint32_t(1), (entryCount + 3) / 4);
+
+            std::vector<std::vector<std::uint32_t>> buckets(bucketCount);
+            for (std::uint32_t i = 0; i < entryCount; ++i)
+                buckets[hash(entries[i].name, 0) % bucketCount].push_back(i);
+
+            std::vector<std::uint32_t> bucketOrder(bucketCount);
+            for (std::uint32_t i = 0; i < bucketCount; ++i) bucketOrder[i] = i;
+
+            // place the largest buckets first while most of the slots are still free
+            std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](std::uint32_t a, std::uint32_t b) noexcept {
+                return buckets[a].size() > buckets[b].size();
+            });
+
+            std::vector<std::uint32_t> displacements(bucketCount, 0);
+            std::vector<std::uint32_t> slots(entryCount);
+            std::vector<bool> used(entryCount, false);
+            std::vector<std::uint32_t> bucketSlots;
+
+            for (const auto bucket : bucketOrder)
+            {
+                if (buckets[bucket].empty()) break;
+
+                for (std::uint32_t displacement = 1;; ++displacement)
+                {
+                    if (displacement == 0xFFFFFFFFU)
+                        throw std::runtime_error("Failed to build the perfect hash");
+
+                    bucketSlots.clear();
+                    for (const auto index : buckets[bucket])
+                    {
+                        const auto slot = static_cast<std::uint32_t>(hash(entries[index].name, displacement) % entryCount);
+                        if (used[slot] || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+                            break;
+                        bucketSlots.push_back(slot);
+                    }
+
+                    if (bucketSlots.size() == buckets[bucket].size())
+                    {
+                        displacements[bucket] = displacement;
+                        for (std::size_t i = 0; i < bucketSlots.size(); ++i)
+                        {
+                            used[bucketSlots[i]] = true;
+                            slots[buckets[bucket][i]] = bucketSlots[i];
+                        }
+                        break;
+                    }
+                }
+            }
+
+            const std::size_t entriesOffset = headerSize;
+            const std::size_t displacementsOffset = entriesOffset + entryCount * entrySize;
+            std::size_t offset = displacementsOffset + bucketCount * 4;
+
+            std::vector<std::size_t> nameOffsets(entryCount);
+            for (std::uint32_t i = 0; i < entryCount; ++i)
+            {
+                nameOffsets[i] = offset;
+                offset += entries[i].name.size();
+            }
+
+            std::vector<std::size_t> dataOffsets(entryCount);
+            for (std::uint32_t i = 0; i < entryCount; ++i)
+            {
+                offset = align(offset);
+                dataOffsets[i] = offset;
+                offset += entries[i].data.size();
+            }
+
+            std::vector<std::byte> result(offset);
+            auto buffer = reinterpret_cast<std::uint8_t*>(result.data());
+
+            encodeLittleEndian<std::uint32_t>(buffer, signature);
+            encodeLittleEndian<std::uint32_t>(buffer + 4, version);
+            encodeLittleEndian<std::uint32_t>(buffer + 8, entryCount);
+            encodeLittleEndian<std::uint32_t>(buffer + 12, bucketCount);
+            encodeLittleEndian<std::uint64_t>(buffer + 16, entriesOffset);
+            encodeLittleEndian<std::uint64_t>(buffer + 24, displacementsOffset);
+
+            for (std::uint32_t i = 0; i < entryCount; ++i)
+            {
+                const auto& entry = entries[i];
+                const auto entryData = buffer + entriesOffset + slots[i] * entrySize;
+                encodeLittleEndian<std::uint64_t>(entryData, dataOffsets[i]);
+                encodeLittleEndian<std::uint64_t>(entryData + 8, entry.data.size());
+                encodeLittleEndian<std::uint64_t>(entryData + 16, nameOffsets[i]);
+                encodeLittleEndian<std::uint16_t>(entryData + 24, static_cast<std::uint16_t>(entry.name.size()));
+                entryData[26] = static_cast<std::uint8_t>(entry.type);
+                entryData[27] = static_cast<std::uint8_t>(entry.encoding);
+                entryData[28] = entry.mipmaps ? 0x01 : 0x00;
+
+                std::copy(entry.name.begin(), entry.name.end(), buffer + nameOffsets[i]);
+                std::copy(entry.data.begin(), entry.data.end(), result.begin() + static_cast<std::ptrdiff_t>(dataOffsets[i]));
+            }
+
+            for (std::uint32_t i = 0; i < bucketCount; ++i)
+                encodeLittleEndian<std::uint32_t>(buffer + displacementsOffset + i * 4, displacements[i]);
+
+            return result;
+        }
+
+    private:
+        struct WriterEntry final
+        {
+            std::string name;
+            Loader::Type type;
+            Encoding encoding;
+            bool mipmaps;
+            std::vector<std::byte> data;
+        };
+
+        std::vector<WriterEntry> entries;
+    };
+}
+
+#endif // OUZEL_ASSETS_PACKEDBUNDLE_HPP
@@ -4,7 +4,7 @@
 #include "Bundle.hpp"
 #include "Cache.hpp"
 #include "../scene/ParticleSystem.hpp"
-#include "../formats/Json.hpp"
+#include "../formats/JsonDocument.hpp"
 
 namespace ouzel::assets
 {
@@ -15,12 +15,15 @@ namespace ouzel::assets
 
     bool ParticleSystemLoader::loadAsset(Bundle& bundle,
                                          const std::string& name,
-                                         const std::vector<std::byte>& data,
-                                         bool mipmaps)
+                                         const storage::FileView& data,
+                                         bool mipmaps,
+                                         bool premultiplyAlpha,
+                                         bool)
     {
         scene::ParticleSystemData particleSystemData;
 
-        const json::Value d = json::parse(data);
+        const json::Document document(reinterpret_cast<const char*>(data.data()), data.size());
+        const json::Node& d = document.getRoot();
 
         if (!d.hasMember("textureFileName") ||
             !d.hasMember("configName"))
@@ -113,7 +116,7 @@ namespace ouzel::assets
 
             if (!particleSystemData.texture)
             {
-                bundle.loadAsset(Type::image, textureFileName, textureFileName, mipmaps);
+                bundle.loadAsset(Type::image, textureFileName, textureFileName, mipmaps, premultiplyAlpha);
                 particleSystemData.texture = cache.getTexture(textureFileName);
             }
         }
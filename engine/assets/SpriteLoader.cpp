@@ -5,7 +5,7 @@
 #include "Bundle.hpp"
 #include "Cache.hpp"
 #include "../scene/SpriteRenderer.hpp"
-#include "../formats/Json.hpp"
+#include "../formats/JsonDocument.hpp"
 
 namespace ouzel::assets
 {
@@ -16,24 +16,27 @@ namespace ouzel::assets
 
     bool SpriteLoader::loadAsset(Bundle& bundle,
                                  const std::string& name,
-                                 const std::vector<std::byte>& data,
-                                 bool mipmaps)
+                                 const storage::FileView& data,
+                                 bool mipmaps,
+                                 bool premultiplyAlpha,
+                                 bool)
     {
         scene::SpriteData spriteData;
 
-        const json::Value d = json::parse(data);
+        const json::Document document(reinterpret_cast<const char*>(data.data()), data.size());
+        const json::Node& d = document.getRoot();
 
         if (!d.hasMember("meta") ||
             !d.hasMember("frames"))
             return false;
 
-        const json::Value& metaObject = d["meta"];
+        const json::Node& metaObject = d["meta"];
 
         const auto imageFilename = metaObject["image"].as<std::string>();
         spriteData.texture = cache.getTexture(imageFilename);
         if (!spriteData.texture)
         {
-            bundle.loadAsset(Type::image, imageFilename, imageFilename, mipmaps);
+            bundle.loadAsset(Type::image, imageFilename, imageFilename, mipmaps, premultiplyAlpha);
             spriteData.texture = cache.getTexture(imageFilename);
         }
 
@@ -43,34 +46,34 @@ namespace ouzel::assets
         const Size2F textureSize(static_cast<float>(spriteData.texture->getSize().v[0]),
                                        static_cast<float>(spriteData.texture->getSize().v[1]));
 
-        const json::Value& framesArray = d["frames"];
+        const json::Node& framesArray = d["frames"];
 
         scene::SpriteData::Animation animation;
 
         animation.frames.reserve(framesArray.getSize());
 
-        for (const json::Value& frameObject : framesArray)
+        for (const json::Node& frameObject : framesArray)
         {
             const auto filename = frameObject["filename"].as<std::string>();
 
-            const json::Value& frameRectangleObject = frameObject["frame"];
+            const json::Node& frameRectangleObject = frameObject["frame"];
 
             RectF frameRectangle(static_cast<float>(frameRectangleObject["x"].as<std::int32_t>()),
                                  static_cast<float>(frameRectangleObject["y"].as<std::int32_t>()),
                                  static_cast<float>(frameRectangleObject["w"].as<std::int32_t>()),
                                  static_cast<float>(frameRectangleObject["h"].as<std::int32_t>()));
 
-            const json::Value& sourceSizeObject = frameObject["sourceSize"];
+            const json::Node& sourceSizeObject = frameObject["sourceSize"];
 
             Size2F sourceSize(static_cast<float>(sourceSizeObject["w"].as<std::int32_t>()),
                               static_cast<float>(sourceSizeObject["h"].as<std::int32_t>()));
 
-            const json::Value& spriteSourceSizeObject = frameObject["spriteSourceSize"];
+            const json::Node& spriteSourceSizeObject = frameObject["spriteSourceSize"];
 
             Vector2F sourceOffset(static_cast<float>(spriteSourceSizeObject["x"].as<std::int32_t>()),
                                   static_cast<float>(spriteSourceSizeObject["y"].as<std::int32_t>()));
 
-            const json::Value& pivotObject = frameObject["pivot"];
+            const json::Node& pivotObject = frameObject["pivot"];
 
             const Vector2F pivot(pivotObject["x"].as<float>(),
                                  pivotObject["y"].as<float>());
@@ -81,11 +84,11 @@ namespace ouzel::assets
             {
                 std::vector<std::uint16_t> indices;
 
-                const json::Value& trianglesObject = frameObject["triangles"];
+                const json::Node& trianglesObject = frameObject["triangles"];
 
-                for (const json::Value& triangleObject : trianglesObject)
+                for (const json::Node& triangleObject : trianglesObject)
                 {
-                    for (const json::Value& indexObject : triangleObject)
+                    for (const json::Node& indexObject : triangleObject)
                         indices.push_back(static_cast<std::uint16_t>(indexObject.as<std::uint32_t>()));
                 }
 
@@ -94,16 +97,16 @@ namespace ouzel::assets
 
                 std::vector<graphics::Vertex> vertices;
 
-                const json::Value& verticesObject = frameObject["vertices"];
-                const json::Value& verticesUVObject = frameObject["verticesUV"];
+                const json::Node& verticesObject = frameObject["vertices"];
+                const json::Node& verticesUVObject = frameObject["verticesUV"];
 
                 Vector2F finalOffset(-sourceSize.v[0] * pivot.v[0] + sourceOffset.v[0],
                                      -sourceSize.v[1] * pivot.v[1] + (sourceSize.v[1] - frameRectangle.size.v[1] - sourceOffset.v[1]));
 
                 for (std::size_t vertexIndex = 0; vertexIndex < verticesObject.getSize(); ++vertexIndex)
                 {
-                    const json::Value& vertexObject = verticesObject[vertexIndex];
-                    const json::Value& vertexUVObject = verticesUVObject[vertexIndex];
+                    const json::Node& vertexObject = verticesObject[vertexIndex];
+                    const json::Node& vertexUVObject = verticesUVObject[vertexIndex];
 
                     vertices.emplace_back(Vector3F{static_cast<float>(vertexObject[0].as<std::int32_t>()) + finalOffset.v[0],
                                                    -static_cast<float>(vertexObject[1].as<std::int32_t>()) - finalOffset.v[1], 0.0F},
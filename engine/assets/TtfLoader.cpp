@@ -14,13 +14,15 @@ namespace ouzel::assets
 
     bool TtfLoader::loadAsset(Bundle& bundle,
                               const std::string& name,
-                              const std::vector<std::byte>& data,
-                              bool mipmaps)
+                              const storage::FileView& data,
+                              bool mipmaps,
+                              bool,
+                              bool distanceField)
     {
         try
         {
             // TODO: move the loader here
-            auto font = std::make_unique<gui::TTFont>(data, mipmaps);
+            auto font = std::make_unique<gui::TTFont>(std::vector<std::byte>(data.begin(), data.end()), mipmaps, distanceField);
             bundle.setFont(name, std::move(font));
         }
         catch (const std::exception&)
@@ -14,12 +14,15 @@ namespace ouzel::assets
 
     bool VorbisLoader::loadAsset(Bundle& bundle,
                                  const std::string& name,
-                                 const std::vector<std::byte>& data,
+                                 const storage::FileView& data,
+                                 bool,
+                                 bool,
                                  bool)
     {
         try
         {
-            auto sound = std::make_unique<audio::VorbisClip>(*engine->getAudio(), data);
+            auto sound = std::make_unique<audio::VorbisClip>(*engine->getAudio(),
+                                                               std::vector<std::byte>(data.begin(), data.end()));
             bundle.setSound(name, std::move(sound));
         }
         catch (const std::exception&)
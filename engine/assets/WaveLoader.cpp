@@ -21,7 +21,9 @@ namespace ouzel::assets
 
     bool WaveLoader::loadAsset(Bundle& bundle,
                                const std::string& name,
-                               const std::vector<std::byte>& data,
+                               const storage::FileView& data,
+                               bool,
+                               bool,
                                bool)
     {
         try
@@ -9,6 +9,7 @@
 #include "coreaudio/CAAudioDevice.hpp"
 #include "dsound/DSAudioDevice.hpp"
 #include "empty/EmptyAudioDevice.hpp"
+#include "offline/OfflineAudioDevice.hpp"
 #include "openal/OALAudioDevice.hpp"
 #include "opensl/OSLAudioDevice.hpp"
 #include "xaudio2/XA2AudioDevice.hpp"
@@ -43,6 +44,8 @@ namespace ouzel::audio
         }
         else if (driver == "empty")
             return Driver::empty;
+        else if (driver == "offline")
+            return Driver::offline;
         else if (driver == "openal")
             return Driver::openAL;
         else if (driver == "directsound")
@@ -68,6 +71,7 @@ namespace ouzel::audio
         if (availableDrivers.empty())
         {
             availableDrivers.insert(Driver::empty);
+            availableDrivers.insert(Driver::offline);
 
 #if OUZEL_COMPILE_OPENAL
             availableDrivers.insert(Driver::openAL);
@@ -138,6 +142,9 @@ namespace ouzel::audio
                     logger.log(Log::Level::info) << "Using WASAPI audio driver";
                     return std::make_unique<wasapi::AudioDevice>(settings, dataGetter);
 #endif
+                case Driver::offline:
+                    logger.log(Log::Level::info) << "Using offline audio driver";
+                    return std::make_unique<offline::AudioDevice>(settings, dataGetter);
                 default:
                     logger.log(Log::Level::info) << "Not using audio driver";
                     return std::make_unique<empty::AudioDevice>(settings, dataGetter);
@@ -154,6 +161,8 @@ namespace ouzel::audio
         masterMix(*this),
         rootNode(*this) // mixer.getRootObjectId()
     {
+        mixer.getVoiceManager().setMaxVoices(settings.maxVoices);
+        mixer.getPcmCache().setBudget(settings.pcmCacheSize);
         addCommand(std::make_unique<mixer::SetMasterBusCommand>(masterMix.getBusId()));
         device->start();
     }
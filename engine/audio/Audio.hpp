@@ -52,6 +52,18 @@ namespace ouzel::audio
 
         auto& getRootNode() { return rootNode; }
 
+        auto getMaxVoices() const noexcept { return mixer.getVoiceManager().getMaxVoices(); }
+        void setMaxVoices(std::uint32_t newMaxVoices) { mixer.getVoiceManager().setMaxVoices(newMaxVoices); }
+
+        auto getRealVoiceCount() const noexcept { return mixer.getVoiceManager().getRealVoiceCount(); }
+        auto getVirtualVoiceCount() const noexcept { return mixer.getVoiceManager().getVirtualVoiceCount(); }
+
+        auto getPcmCacheSize() const noexcept { return mixer.getPcmCache().getBudget(); }
+        void setPcmCacheSize(std::size_t newPcmCacheSize) { mixer.getPcmCache().setBudget(newPcmCacheSize); }
+
+        auto getPcmCacheHitCount() const noexcept { return mixer.getPcmCache().getHitCount(); }
+        auto getPcmCacheMissCount() const noexcept { return mixer.getPcmCache().getMissCount(); }
+
     private:
         void getSamples(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate, std::vector<float>& samples);
         void eventCallback(const mixer::Mixer::Event& event);
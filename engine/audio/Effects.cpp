@@ -1,10 +1,18 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#if defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include "Effects.hpp"
 #include "Audio.hpp"
+#include "Fft.hpp"
+#include "PcmClip.hpp"
+#include "../core/Engine.hpp"
 #include "../scene/Actor.hpp"
+#include "../math/Constants.hpp"
 #include "../math/MathUtils.hpp"
 #include "smbPitchShift.hpp"
 
@@ -99,6 +107,11 @@ namespace ouzel::audio
                 sample *= gainFactor;
         }
 
+        float getAudibility(const Vector3F&) const noexcept final
+        {
+            return gainFactor;
+        }
+
         void setGain(float newGain)
         {
             gain = newGain;
@@ -149,6 +162,14 @@ namespace ouzel::audio
         {
         }
 
+        // inverse distance clamped attenuation model
+        float getAudibility(const Vector3F& listenerPosition) const noexcept final
+        {
+            const auto distance = std::clamp(position.distance(listenerPosition), minDistance, maxDistance);
+            const auto attenuation = minDistance + rolloffFactor * (distance - minDistance);
+            return (attenuation > 0.0F) ? minDistance / attenuation : 1.0F;
+        }
+
         void setPosition(const Vector3F& newPosition)
         {
             position = newPosition;
@@ -355,35 +376,38 @@ namespace ouzel::audio
                      std::vector<float>& samples) final
         {
             const auto delayFrames = static_cast<std::uint32_t>(delay * sampleRate);
-            const auto bufferFrames = frames + delayFrames;
+            if (delayFrames == 0) return;
 
             buffers.resize(channels);
 
             for (std::uint32_t channel = 0; channel < channels; ++channel)
             {
+                // circular buffer of the last delayFrames output frames
                 std::vector<float>& buffer = buffers[channel];
-                buffer.resize(bufferFrames);
+                if (buffer.size() != delayFrames)
+                    buffer.resize(delayFrames);
 
                 float* outputChannel = &samples[channel * frames];
+                std::uint32_t position = bufferPosition % delayFrames;
 
                 for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame] += outputChannel[frame];
-
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    buffer[frame + delayFrames] += buffer[frame] * decay;
+                {
+                    const float result = outputChannel[frame] + buffer[position] * decay;
+                    buffer[position] = result;
+                    outputChannel[frame] = result;
 
-                for (std::uint32_t frame = 0; frame < frames; ++frame)
-                    outputChannel[frame] = buffer[frame];
-
-                // erase frames from beginning
-                buffer.erase(buffer.begin(), buffer.begin() + frames);
+                    if (++position == delayFrames) position = 0;
+                }
             }
+
+            bufferPosition = (bufferPosition % delayFrames + frames) % delayFrames;
         }
 
     private:
         float delay = 0.1F;
         float decay = 0.5F;
         std::vector<std::vector<float>> buffers;
+        std::uint32_t bufferPosition = 0;
     };
 
     Reverb::Reverb(Audio& initAudio, float initDelay, float initDecay):
@@ -398,9 +422,366 @@ namespace ouzel::audio
     {
     }
 
-    LowPass::LowPass(Audio& initAudio):
+    class ConvolutionReverbProcessor final: public mixer::Processor
+    {
+    public:
+        // the filter contains the spectra of all the partitions of the impulse response for each of its channels
+        ConvolutionReverbProcessor(std::uint32_t initPartitionSize,
+                                   std::uint32_t initPartitionCount,
+                                   std::vector<std::vector<float>> initFilterReal,
+                                   std::vector<std::vector<float>> initFilterImaginary,
+                                   float initMix):
+            partitionSize(initPartitionSize),
+            partitionCount(initPartitionCount),
+            fft(initPartitionSize * 2),
+            filterReal(std::move(initFilterReal)),
+            filterImaginary(std::move(initFilterImaginary)),
+            mix(initMix),
+            accumulatorReal(fft.getBinCount()),
+            accumulatorImaginary(fft.getBinCount()),
+            result(partitionSize * 2)
+        {
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t,
+                     std::vector<float>& samples) final
+        {
+            if (channelStates.size() != channels)
+            {
+                channelStates.resize(channels);
+                for (ChannelState& channelState : channelStates)
+                {
+                    channelState.input.assign(partitionSize * 2, 0.0F);
+                    channelState.output.assign(partitionSize, 0.0F);
+                    channelState.spectraReal.assign(partitionCount * fft.getBinCount(), 0.0F);
+                    channelState.spectraImaginary.assign(partitionCount * fft.getBinCount(), 0.0F);
+                }
+                blockPosition = 0;
+                partitionIndex = 0;
+            }
+
+            const float dry = 1.0F - mix;
+
+            for (std::uint32_t offset = 0; offset < frames;)
+            {
+                const auto blockFrames = std::min(frames - offset, partitionSize - blockPosition);
+
+                // the input is collected to the second half and the output of the previous block is played back
+                for (std::uint32_t channel = 0; channel < channels; ++channel)
+                {
+                    ChannelState& channelState = channelStates[channel];
+                    float* outputChannel = &samples[channel * frames + offset];
+                    float* input = &channelState.input[partitionSize + blockPosition];
+                    const float* output = &channelState.output[blockPosition];
+
+                    for (std::uint32_t frame = 0; frame < blockFrames; ++frame)
+                    {
+                        input[frame] = outputChannel[frame];
+                        outputChannel[frame] = outputChannel[frame] * dry + output[frame] * mix;
+                    }
+                }
+
+                blockPosition += blockFrames;
+                offset += blockFrames;
+
+                if (blockPosition == partitionSize)
+                {
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                        convolve(channelStates[channel], channel % filterReal.size());
+
+                    partitionIndex = (partitionIndex + 1) % partitionCount;
+                    blockPosition = 0;
+                }
+            }
+        }
+
+        void setMix(float newMix)
+        {
+            mix = newMix;
+        }
+
+    private:
+        struct ChannelState final
+        {
+            std::vector<float> input; // the previous and the current block
+            std::vector<float> output;
+            std::vector<float> spectraReal; // frequency domain delay line
+            std::vector<float> spectraImaginary;
+        };
+
+        // uniformly partitioned overlap-save convolution of the current block
+        void convolve(ChannelState& channelState, std::size_t filterChannel)
+        {
+            const std::uint32_t binCount = fft.getBinCount();
+
+            fft.forward(channelState.input.data(),
+                        &channelState.spectraReal[partitionIndex * binCount],
+                        &channelState.spectraImaginary[partitionIndex * binCount]);
+
+            std::fill(accumulatorReal.begin(), accumulatorReal.end(), 0.0F);
+            std::fill(accumulatorImaginary.begin(), accumulatorImaginary.end(), 0.0F);
+
+            // the newest input spectrum is multiplied by the first partition of the filter
+            for (std::uint32_t partition = 0; partition < partitionCount; ++partition)
+            {
+                const auto spectrum = ((partitionIndex + partitionCount - partition) % partitionCount) * binCount;
+
+                multiplyAccumulate(&channelState.spectraReal[spectrum],
+                                   &channelState.spectraImaginary[spectrum],
+                                   &filterReal[filterChannel][partition * binCount],
+                                   &filterImaginary[filterChannel][partition * binCount],
+                                   binCount);
+            }
+
+            fft.inverse(accumulatorReal.data(), accumulatorImaginary.data(), result.data());
+
+            // the first half is polluted by the circular convolution
+            std::copy(result.begin() + partitionSize, result.end(), channelState.output.begin());
+            std::copy(channelState.input.begin() + partitionSize, channelState.input.end(), channelState.input.begin());
+        }
+
+        void multiplyAccumulate(const float* real, const float* imaginary,
+                                const float* otherReal, const float* otherImaginary,
+                                std::uint32_t count) noexcept
+        {
+            std::uint32_t i = 0;
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                for (; i + 4 <= count; i += 4)
+                {
+                    const __m128 a = _mm_loadu_ps(&real[i]);
+                    const __m128 b = _mm_loadu_ps(&imaginary[i]);
+                    const __m128 c = _mm_loadu_ps(&otherReal[i]);
+                    const __m128 d = _mm_loadu_ps(&otherImaginary[i]);
+
+                    const __m128 resultReal = _mm_sub_ps(_mm_mul_ps(a, c), _mm_mul_ps(b, d));
+                    const __m128 resultImaginary = _mm_add_ps(_mm_mul_ps(a, d), _mm_mul_ps(b, c));
+
+                    _mm_storeu_ps(&accumulatorReal[i], _mm_add_ps(_mm_loadu_ps(&accumulatorReal[i]), resultReal));
+                    _mm_storeu_ps(&accumulatorImaginary[i], _mm_add_ps(_mm_loadu_ps(&accumulatorImaginary[i]), resultImaginary));
+                }
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                accumulatorReal[i] += real[i] * otherReal[i] - imaginary[i] * otherImaginary[i];
+                accumulatorImaginary[i] += real[i] * otherImaginary[i] + imaginary[i] * otherReal[i];
+            }
+        }
+
+        std::uint32_t partitionSize;
+        std::uint32_t partitionCount;
+        Fft fft;
+        std::vector<std::vector<float>> filterReal;
+        std::vector<std::vector<float>> filterImaginary;
+        float mix = 0.5F;
+
+        std::vector<ChannelState> channelStates;
+        std::uint32_t blockPosition = 0;
+        std::uint32_t partitionIndex = 0;
+
+        std::vector<float> accumulatorReal;
+        std::vector<float> accumulatorImaginary;
+        std::vector<float> result;
+    };
+
+    namespace
+    {
+        std::unique_ptr<mixer::Processor> createConvolutionReverbProcessor(const Audio& audio,
+                                                                           const Sound& impulseResponse,
+                                                                           float mix)
+        {
+            if (impulseResponse.getFormat() != Sound::Format::pcm)
+                throw std::runtime_error("Impulse response must be a PCM sound");
+
+            const auto& pcmClip = static_cast<const PcmClip&>(impulseResponse);
+            const auto channels = pcmClip.getChannels();
+            const auto& samples = pcmClip.getSamples();
+            const auto sourceFrames = static_cast<std::uint32_t>(samples.size() / channels);
+
+            if (sourceFrames == 0)
+                throw std::runtime_error("Impulse response is empty");
+
+            const auto device = audio.getDevice();
+
+            // one partition per device buffer, so that a buffer costs one forward and one inverse FFT per channel
+            std::uint32_t partitionSize = 64;
+            while (partitionSize < device->getBufferSize()) partitionSize *= 2;
+
+            // resample the impulse response to the sample rate of the device
+            const auto ratio = static_cast<double>(pcmClip.getSampleRate()) / device->getSampleRate();
+            const auto frames = static_cast<std::uint32_t>(std::ceil(sourceFrames / ratio));
+            const auto partitionCount = (frames + partitionSize - 1) / partitionSize;
+
+            Fft fft(partitionSize * 2);
+            const auto binCount = fft.getBinCount();
+
+            std::vector<std::vector<float>> filterReal(channels, std::vector<float>(partitionCount * binCount));
+            std::vector<std::vector<float>> filterImaginary(channels, std::vector<float>(partitionCount * binCount));
+            std::vector<float> block(partitionSize * 2);
+
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            {
+                const float* sourceChannel = &samples[channel * sourceFrames];
+
+                for (std::uint32_t partition = 0; partition < partitionCount; ++partition)
+                {
+                    // each partition is zero padded to the double size
+                    std::fill(block.begin(), block.end(), 0.0F);
+
+                    for (std::uint32_t frame = 0; frame < partitionSize; ++frame)
+                    {
+                        const auto position = (partition * partitionSize + frame) * ratio;
+                        const auto index = static_cast<std::uint32_t>(position);
+                        if (index >= sourceFrames) break;
+
+                        const auto next = std::min(index + 1, sourceFrames - 1);
+                        const auto fraction = static_cast<float>(position - index);
+                        block[frame] = sourceChannel[index] + (sourceChannel[next] - sourceChannel[index]) * fraction;
+                    }
+
+                    fft.forward(block.data(),
+                                &filterReal[channel][partition * binCount],
+                                &filterImaginary[channel][partition * binCount]);
+                }
+            }
+
+            return std::make_unique<ConvolutionReverbProcessor>(partitionSize, partitionCount,
+                                                                std::move(filterReal),
+                                                                std::move(filterImaginary),
+                                                                mix);
+        }
+    }
+
+    ConvolutionReverb::ConvolutionReverb(Audio& initAudio, const Sound& impulseResponse, float initMix):
         Effect(initAudio,
-               initAudio.initProcessor(std::unique_ptr<mixer::Processor>()))
+               initAudio.initProcessor(createConvolutionReverbProcessor(initAudio, impulseResponse, initMix))),
+        mix(initMix)
+    {
+    }
+
+    ConvolutionReverb::~ConvolutionReverb()
+    {
+    }
+
+    void ConvolutionReverb::setMix(float newMix)
+    {
+        mix = newMix;
+
+        audio.updateProcessor(processorId, [newMix](mixer::Object* node) {
+            auto convolutionReverbProcessor = static_cast<ConvolutionReverbProcessor*>(node);
+            convolutionReverbProcessor->setMix(newMix);
+        });
+    }
+
+    // second order filter, the coefficients are from the Audio EQ Cookbook by Robert Bristow-Johnson
+    class BiquadProcessor final: public mixer::Processor
+    {
+    public:
+        enum class Type
+        {
+            lowPass,
+            highPass
+        };
+
+        BiquadProcessor(Type initType, float initCutoffFrequency, float initResonance):
+            type(initType), cutoffFrequency(initCutoffFrequency), resonance(initResonance)
+        {
+        }
+
+        void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
+                     std::vector<float>& samples) final
+        {
+            if (sampleRate != coefficientSampleRate)
+                updateCoefficients(sampleRate);
+
+            states.resize(channels);
+
+            for (std::uint32_t channel = 0; channel < channels; ++channel)
+            {
+                State& state = states[channel];
+                float* outputChannel = &samples[channel * frames];
+
+                // transposed direct form II
+                for (std::uint32_t frame = 0; frame < frames; ++frame)
+                {
+                    const float input = outputChannel[frame];
+                    const float output = b0 * input + state.z1;
+                    state.z1 = b1 * input - a1 * output + state.z2;
+                    state.z2 = b2 * input - a2 * output;
+                    outputChannel[frame] = output;
+                }
+            }
+        }
+
+        void setCutoffFrequency(float newCutoffFrequency)
+        {
+            cutoffFrequency = newCutoffFrequency;
+            coefficientSampleRate = 0;
+        }
+
+        void setResonance(float newResonance)
+        {
+            resonance = newResonance;
+            coefficientSampleRate = 0;
+        }
+
+    private:
+        void updateCoefficients(std::uint32_t sampleRate)
+        {
+            coefficientSampleRate = sampleRate;
+
+            const auto frequency = std::clamp(cutoffFrequency, 1.0F, static_cast<float>(sampleRate) * 0.49F);
+            const auto omega = tau<float> * frequency / static_cast<float>(sampleRate);
+            const auto cosine = std::cos(omega);
+            const auto alpha = std::sin(omega) / (2.0F * std::max(resonance, 0.01F));
+            const auto a0 = 1.0F + alpha;
+
+            switch (type)
+            {
+                case Type::lowPass:
+                    b0 = (1.0F - cosine) / 2.0F / a0;
+                    b1 = (1.0F - cosine) / a0;
+                    b2 = b0;
+                    break;
+                case Type::highPass:
+                    b0 = (1.0F + cosine) / 2.0F / a0;
+                    b1 = -(1.0F + cosine) / a0;
+                    b2 = b0;
+                    break;
+            }
+
+            a1 = -2.0F * cosine / a0;
+            a2 = (1.0F - alpha) / a0;
+        }
+
+        struct State final
+        {
+            float z1 = 0.0F;
+            float z2 = 0.0F;
+        };
+
+        Type type;
+        float cutoffFrequency;
+        float resonance;
+
+        std::uint32_t coefficientSampleRate = 0;
+        float b0 = 1.0F;
+        float b1 = 0.0F;
+        float b2 = 0.0F;
+        float a1 = 0.0F;
+        float a2 = 0.0F;
+        std::vector<State> states;
+    };
+
+    LowPass::LowPass(Audio& initAudio, float initCutoffFrequency, float initResonance):
+        Effect(initAudio,
+               initAudio.initProcessor(std::make_unique<BiquadProcessor>(BiquadProcessor::Type::lowPass,
+                                                                         initCutoffFrequency,
+                                                                         initResonance))),
+        cutoffFrequency(initCutoffFrequency),
+        resonance(initResonance)
     {
     }
 
@@ -408,13 +789,57 @@ namespace ouzel::audio
     {
     }
 
-    HighPass::HighPass(Audio& initAudio):
+    void LowPass::setCutoffFrequency(float newCutoffFrequency)
+    {
+        cutoffFrequency = newCutoffFrequency;
+
+        audio.updateProcessor(processorId, [newCutoffFrequency](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setCutoffFrequency(newCutoffFrequency);
+        });
+    }
+
+    void LowPass::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+
+        audio.updateProcessor(processorId, [newResonance](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setResonance(newResonance);
+        });
+    }
+
+    HighPass::HighPass(Audio& initAudio, float initCutoffFrequency, float initResonance):
         Effect(initAudio,
-               initAudio.initProcessor(std::unique_ptr<mixer::Processor>()))
+               initAudio.initProcessor(std::make_unique<BiquadProcessor>(BiquadProcessor::Type::highPass,
+                                                                         initCutoffFrequency,
+                                                                         initResonance))),
+        cutoffFrequency(initCutoffFrequency),
+        resonance(initResonance)
     {
     }
 
     HighPass::~HighPass()
     {
     }
+
+    void HighPass::setCutoffFrequency(float newCutoffFrequency)
+    {
+        cutoffFrequency = newCutoffFrequency;
+
+        audio.updateProcessor(processorId, [newCutoffFrequency](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setCutoffFrequency(newCutoffFrequency);
+        });
+    }
+
+    void HighPass::setResonance(float newResonance)
+    {
+        resonance = newResonance;
+
+        audio.updateProcessor(processorId, [newResonance](mixer::Object* node) {
+            auto biquadProcessor = static_cast<BiquadProcessor*>(node);
+            biquadProcessor->setResonance(newResonance);
+        });
+    }
 }
@@ -150,28 +150,71 @@ namespace ouzel::audio
         float decay = 0.5F;
     };
 
+    class Sound;
+
+    // Convolves the signal with an impulse response (a PCM sound, e.g. a WAV file loaded through the cache)
+    // The wet signal is delayed by one partition (the device buffer size rounded up to a power of two)
+    class ConvolutionReverb final: public Effect
+    {
+    public:
+        ConvolutionReverb(Audio& initAudio, const Sound& impulseResponse, float initMix = 0.5F);
+        ~ConvolutionReverb() override;
+
+        ConvolutionReverb(const ConvolutionReverb&) = delete;
+        ConvolutionReverb& operator=(const ConvolutionReverb&) = delete;
+        ConvolutionReverb(ConvolutionReverb&&) = delete;
+        ConvolutionReverb& operator=(ConvolutionReverb&&) = delete;
+
+        // 0 is dry, 1 is wet
+        auto getMix() const noexcept { return mix; }
+        void setMix(float newMix);
+
+    private:
+        float mix = 0.5F;
+    };
+
     class LowPass final: public Effect
     {
     public:
-        explicit LowPass(Audio& initAudio);
+        explicit LowPass(Audio& initAudio, float initCutoffFrequency = 1000.0F, float initResonance = 0.7071F);
         ~LowPass() override;
 
         LowPass(const LowPass&) = delete;
         LowPass& operator=(const LowPass&) = delete;
         LowPass(LowPass&&) = delete;
         LowPass& operator=(LowPass&&) = delete;
+
+        auto getCutoffFrequency() const noexcept { return cutoffFrequency; }
+        void setCutoffFrequency(float newCutoffFrequency);
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float cutoffFrequency = 1000.0F; // Hz
+        float resonance = 0.7071F; // Q
     };
 
     class HighPass final: public Effect
     {
     public:
-        explicit HighPass(Audio& initAudio);
+        explicit HighPass(Audio& initAudio, float initCutoffFrequency = 100.0F, float initResonance = 0.7071F);
         ~HighPass() override;
 
         HighPass(const HighPass&) = delete;
         HighPass& operator=(const HighPass&) = delete;
         HighPass(HighPass&&) = delete;
         HighPass& operator=(HighPass&&) = delete;
+
+        auto getCutoffFrequency() const noexcept { return cutoffFrequency; }
+        void setCutoffFrequency(float newCutoffFrequency);
+
+        auto getResonance() const noexcept { return resonance; }
+        void setResonance(float newResonance);
+
+    private:
+        float cutoffFrequency = 100.0F; // Hz
+        float resonance = 0.7071F; // Q
     };
 }
 
@@ -0,0 +1,147 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <cmath>
+#include <stdexcept>
+#include "Fft.hpp"
+#include "../math/Constants.hpp"
+#include "../math/MathUtils.hpp"
+
+namespace ouzel::audio
+{
+    Fft::Fft(std::uint32_t initSize):
+        size(initSize)
+    {
+        if (size < 4 || !isPowerOfTwo(size))
+            throw std::runtime_error("Invalid FFT size");
+
+        // a real transform of size n is computed with a complex transform of size n / 2
+        const std::uint32_t half = size / 2;
+
+        std::uint32_t bits = 0;
+        while ((1U << bits) < half) ++bits;
+
+        bitReversal.resize(half);
+        for (std::uint32_t i = 0; i < half; ++i)
+        {
+            std::uint32_t reversed = 0;
+            for (std::uint32_t bit = 0; bit < bits; ++bit)
+                if (i & (1U << bit)) reversed |= 1U << (bits - bit - 1);
+            bitReversal[i] = reversed;
+        }
+
+        cosines.resize(half / 2);
+        sines.resize(half / 2);
+        for (std::uint32_t i = 0; i < half / 2; ++i)
+        {
+            const double angle = tau<double> * i / half;
+            cosines[i] = static_cast<float>(std::cos(angle));
+            sines[i] = static_cast<float>(-std::sin(angle));
+        }
+
+        splitCosines.resize(half + 1);
+        splitSines.resize(half + 1);
+        for (std::uint32_t i = 0; i <= half; ++i)
+        {
+            const double angle = tau<double> * i / size;
+            splitCosines[i] = static_cast<float>(std::cos(angle));
+            splitSines[i] = static_cast<float>(-std::sin(angle));
+        }
+
+        workReal.resize(half);
+        workImaginary.resize(half);
+    }
+
+    void Fft::forward(const float* input, float* real, float* imaginary)
+    {
+        const std::uint32_t half = size / 2;
+
+        // pack the even samples to the real and the odd samples to the imaginary part
+        for (std::uint32_t i = 0; i < half; ++i)
+        {
+            workReal[bitReversal[i]] = input[i * 2];
+            workImaginary[bitReversal[i]] = input[i * 2 + 1];
+        }
+
+        transform(workReal.data(), workImaginary.data());
+
+        for (std::uint32_t k = 0; k <= half; ++k)
+        {
+            const std::uint32_t i = (k == half) ? 0 : k;
+            const std::uint32_t j = (k == 0) ? 0 : half - k;
+
+            // spectra of the even and the odd samples
+            const float evenReal = (workReal[i] + workReal[j]) * 0.5F;
+            const float evenImaginary = (workImaginary[i] - workImaginary[j]) * 0.5F;
+            const float oddReal = (workImaginary[i] + workImaginary[j]) * 0.5F;
+            const float oddImaginary = (workReal[j] - workReal[i]) * 0.5F;
+
+            real[k] = evenReal + oddReal * splitCosines[k] - oddImaginary * splitSines[k];
+            imaginary[k] = evenImaginary + oddReal * splitSines[k] + oddImaginary * splitCosines[k];
+        }
+    }
+
+    void Fft::inverse(const float* real, const float* imaginary, float* output)
+    {
+        const std::uint32_t half = size / 2;
+
+        for (std::uint32_t k = 0; k < half; ++k)
+        {
+            const std::uint32_t j = half - k;
+
+            const float evenReal = (real[k] + real[j]) * 0.5F;
+            const float evenImaginary = (imaginary[k] - imaginary[j]) * 0.5F;
+            const float differenceReal = (real[k] - real[j]) * 0.5F;
+            const float differenceImaginary = (imaginary[k] + imaginary[j]) * 0.5F;
+
+            // multiply by the conjugate twiddle factor
+            const float oddReal = differenceReal * splitCosines[k] + differenceImaginary * splitSines[k];
+            const float oddImaginary = differenceImaginary * splitCosines[k] - differenceReal * splitSines[k];
+
+            // the inverse transform is computed as a forward transform with swapped real and imaginary parts
+            workImaginary[bitReversal[k]] = evenReal - oddImaginary;
+            workReal[bitReversal[k]] = evenImaginary + oddReal;
+        }
+
+        transform(workReal.data(), workImaginary.data());
+
+        const float scale = 1.0F / static_cast<float>(half);
+        for (std::uint32_t i = 0; i < half; ++i)
+        {
+            output[i * 2] = workImaginary[i] * scale;
+            output[i * 2 + 1] = workReal[i] * scale;
+        }
+    }
+
+    void Fft::transform(float* real, float* imaginary) const noexcept
+    {
+        const std::uint32_t half = size / 2;
+
+        for (std::uint32_t length = 2; length <= half; length *= 2)
+        {
+            const std::uint32_t halfLength = length / 2;
+            const std::uint32_t step = half / length;
+
+            for (std::uint32_t start = 0; start < half; start += length)
+            {
+                float* evenReal = real + start;
+                float* evenImaginary = imaginary + start;
+                float* oddReal = real + start + halfLength;
+                float* oddImaginary = imaginary + start + halfLength;
+
+                for (std::uint32_t i = 0; i < halfLength; ++i)
+                {
+                    const float twiddleReal = cosines[i * step];
+                    const float twiddleImaginary = sines[i * step];
+
+                    const float productReal = oddReal[i] * twiddleReal - oddImaginary[i] * twiddleImaginary;
+                    const float productImaginary = oddReal[i] * twiddleImaginary + oddImaginary[i] * twiddleReal;
+
+                    oddReal[i] = evenReal[i] - productReal;
+                    oddImaginary[i] = evenImaginary[i] - productImaginary;
+                    evenReal[i] += productReal;
+                    evenImaginary[i] += productImaginary;
+                }
+            }
+        }
+    }
+}
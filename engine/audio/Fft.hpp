@@ -0,0 +1,39 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_FFT_HPP
+#define OUZEL_AUDIO_FFT_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace ouzel::audio
+{
+    // Radix-2 FFT of real signals, the spectra are stored as separate real and imaginary parts
+    class Fft final
+    {
+    public:
+        explicit Fft(std::uint32_t initSize); // must be a power of two
+
+        auto getSize() const noexcept { return size; }
+        auto getBinCount() const noexcept { return size / 2 + 1; }
+
+        // size samples to getBinCount() bins
+        void forward(const float* input, float* real, float* imaginary);
+        // getBinCount() bins to size samples, normalized
+        void inverse(const float* real, const float* imaginary, float* output);
+
+    private:
+        void transform(float* real, float* imaginary) const noexcept;
+
+        std::uint32_t size;
+        std::vector<std::uint32_t> bitReversal; // of the half size complex transform
+        std::vector<float> cosines; // twiddle factors of the half size complex transform
+        std::vector<float> sines;
+        std::vector<float> splitCosines; // twiddle factors to split the half size transform
+        std::vector<float> splitSines;
+        std::vector<float> workReal;
+        std::vector<float> workImaginary;
+    };
+}
+
+#endif // OUZEL_AUDIO_FFT_HPP
@@ -17,6 +17,10 @@ namespace ouzel::audio
         PcmClip(Audio& initAudio, std::uint32_t channels, std::uint32_t sampleRate,
                 const std::vector<float>& samples);
 
+        std::uint32_t getChannels() const noexcept;
+        std::uint32_t getSampleRate() const noexcept;
+        const std::vector<float>& getSamples() const noexcept;
+
     private:
         PcmData* data;
     };
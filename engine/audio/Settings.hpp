@@ -3,7 +3,9 @@
 #ifndef OUZEL_AUDIO_SETTINGS_HPP
 #define OUZEL_AUDIO_SETTINGS_HPP
 
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include "SampleFormat.hpp"
 
 namespace ouzel::audio
@@ -14,6 +16,8 @@ namespace ouzel::audio
         std::uint32_t bufferSize = 512;
         std::uint32_t sampleRate = 44100;
         std::uint32_t channels = 0;
+        std::uint32_t maxVoices = 32; // number of voices that are decoded, the rest are virtualized
+        std::size_t pcmCacheSize = 8388608; // bytes of decoded samples of short clips kept in memory
         SampleFormat sampleFormat = SampleFormat::float32;
         std::string audioDevice;
     };
@@ -20,6 +20,7 @@ namespace ouzel::audio
         }
 
         void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
 
     private:
         std::uint32_t position = 0;
@@ -91,6 +92,25 @@ namespace ouzel::audio
         }
     }
 
+    void SilenceStream::skip(std::uint32_t frames)
+    {
+        const auto length = static_cast<SilenceData&>(data).getLength();
+
+        if (length > 0.0F)
+        {
+            const auto frameCount = static_cast<std::uint32_t>(length * data.getSampleRate());
+            position += (frames > frameCount - position) ? frameCount - position : frames;
+
+            if ((frameCount - position) == 0)
+            {
+                playing = false; // TODO: fire event
+                reset();
+            }
+        }
+        else
+            position += frames;
+    }
+
     SilenceSound::SilenceSound(Audio& initAudio, float initLength):
         Sound(initAudio,
               initAudio.initData(std::unique_ptr<mixer::Data>(data = new SilenceData(initLength))),
@@ -139,6 +139,13 @@ namespace ouzel::audio
             audio.deleteObject(streamId);
     }
 
+    void Voice::setPriority(float newPriority)
+    {
+        priority = newPriority;
+
+        audio.addCommand(std::make_unique<mixer::SetStreamPriorityCommand>(streamId, newPriority));
+    }
+
     void Voice::play()
     {
         audio.addCommand(std::make_unique<mixer::PlayStreamCommand>(streamId));
@@ -46,6 +46,10 @@ namespace ouzel::audio
         auto& getVelocity() const noexcept { return velocity; }
         void setVelocity(const Vector3F& newVelocity) { velocity = newVelocity; }
 
+        // voices with higher priority are virtualized last when the voice limit is reached
+        auto getPriority() const noexcept { return priority; }
+        void setPriority(float newPriority);
+
         void play();
         void pause();
         void stop();
@@ -61,6 +65,7 @@ namespace ouzel::audio
         const Sound* sound = nullptr;
         Vector3F position;
         Vector3F velocity;
+        float priority = 0.0F;
         bool playing = false;
 
         Mix* output = nullptr;
@@ -1,10 +1,15 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
 #include <stdexcept>
 #include "VorbisClip.hpp"
 #include "Audio.hpp"
 #include "mixer/Data.hpp"
 #include "mixer/Stream.hpp"
+#include "../thread/Thread.hpp"
 #include "../utils/Utils.hpp"
 
 #if defined(_MSC_VER)
@@ -49,29 +54,33 @@ namespace ouzel::audio
     {
     public:
         explicit VorbisStream(VorbisData& vorbisData);
+        ~VorbisStream() override;
 
-        ~VorbisStream() override
-        {
-            if (vorbisStream)
-                stb_vorbis_close(vorbisStream);
-        }
-
-        void reset() final
-        {
-            stb_vorbis_seek_start(vorbisStream);
-        }
+        void reset() final;
 
         void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
 
     private:
+        void getCachedSamples(std::uint32_t frames, std::vector<float>& samples);
+        void record(std::uint32_t frames, const std::vector<float>& samples);
+
         stb_vorbis* vorbisStream = nullptr;
+        std::uint32_t length = 0; // in frames
+        std::uint32_t position = 0;
+        bool seekPending = false;
+
+        std::shared_ptr<const std::vector<float>> cachedSamples;
+        std::vector<float> recordedSamples; // filled during the first uninterrupted play
+        bool recording = false;
     };
 
     class VorbisData final: public mixer::Data
     {
     public:
-        explicit VorbisData(const std::vector<std::byte>& initData):
-            data(initData)
+        VorbisData(const std::vector<std::byte>& initData, mixer::PcmCache& initPcmCache):
+            data(initData),
+            pcmCache(initPcmCache)
         {
             stb_vorbis* vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(data.data()),
                                                               static_cast<int>(data.size()),
@@ -84,11 +93,19 @@ namespace ouzel::audio
 
             channels = static_cast<std::uint32_t>(info.channels);
             sampleRate = info.sample_rate;
+            length = stb_vorbis_stream_length_in_samples(vorbisStream);
 
             stb_vorbis_close(vorbisStream);
         }
 
+        ~VorbisData() override
+        {
+            pcmCache.erase(*this);
+        }
+
         auto& getData() const noexcept { return data; }
+        auto getLength() const noexcept { return length; }
+        auto& getPcmCache() const noexcept { return pcmCache; }
 
         std::unique_ptr<mixer::Stream> createStream() final
         {
@@ -97,21 +114,108 @@ namespace ouzel::audio
 
     private:
         std::vector<std::byte> data;
+        std::uint32_t length = 0; // in frames
+        mixer::PcmCache& pcmCache;
     };
 
     VorbisStream::VorbisStream(VorbisData& vorbisData):
-        Stream(vorbisData)
+        Stream(vorbisData),
+        length(vorbisData.getLength())
     {
+        auto& pcmCache = vorbisData.getPcmCache();
+
+        // short clips are decoded only once and then played from the cache
+        if (length * vorbisData.getChannels() * sizeof(float) <= pcmCache.getMaxEntrySize())
+        {
+            cachedSamples = pcmCache.find(vorbisData);
+            if (cachedSamples) return;
+
+            recordedSamples.resize(length * vorbisData.getChannels());
+            recording = true;
+        }
+
         vorbisStream = stb_vorbis_open_memory(reinterpret_cast<const unsigned char*>(vorbisData.getData().data()),
                                               static_cast<int>(vorbisData.getData().size()),
                                               nullptr, nullptr);
     }
 
+    VorbisStream::~VorbisStream()
+    {
+        if (vorbisStream)
+            stb_vorbis_close(vorbisStream);
+    }
+
+    void VorbisStream::reset()
+    {
+        if (vorbisStream)
+            stb_vorbis_seek_start(vorbisStream);
+
+        position = 0;
+        seekPending = false;
+    }
+
+    void VorbisStream::getCachedSamples(std::uint32_t frames, std::vector<float>& samples)
+    {
+        const auto channels = data.getChannels();
+        const std::uint32_t copyFrames = (frames > length - position) ? length - position : frames;
+
+        for (std::uint32_t channel = 0; channel < channels; ++channel)
+        {
+            const float* sourceChannel = &(*cachedSamples)[channel * length + position];
+            float* outputChannel = &samples[channel * frames];
+
+            std::copy(sourceChannel, sourceChannel + copyFrames, outputChannel);
+            std::fill(outputChannel + copyFrames, outputChannel + frames, 0.0F);
+        }
+
+        position += copyFrames;
+
+        if ((length - position) == 0)
+        {
+            playing = false; // TODO: fire event
+            reset();
+        }
+    }
+
+    void VorbisStream::record(std::uint32_t frames, const std::vector<float>& samples)
+    {
+        const auto channels = data.getChannels();
+        const std::uint32_t recordFrames = (frames > length - position) ? length - position : frames;
+
+        for (std::uint32_t channel = 0; channel < channels; ++channel)
+            std::copy(&samples[channel * frames], &samples[channel * frames] + recordFrames,
+                      &recordedSamples[channel * length + position]);
+
+        if (position + recordFrames == length)
+        {
+            auto& vorbisData = static_cast<VorbisData&>(data);
+            cachedSamples = vorbisData.getPcmCache().insert(vorbisData, std::move(recordedSamples));
+            recording = false;
+
+            // the following plays of this stream use the cache too
+            stb_vorbis_close(vorbisStream);
+            vorbisStream = nullptr;
+        }
+    }
+
     void VorbisStream::getSamples(std::uint32_t frames, std::vector<float>& samples)
     {
         std::uint32_t neededSize = frames * data.getChannels();
         samples.resize(neededSize);
 
+        if (cachedSamples)
+        {
+            getCachedSamples(frames, samples);
+            return;
+        }
+
+        if (!vorbisStream)
+        {
+            std::fill(samples.begin(), samples.end(), 0.0F);
+            playing = false; // TODO: fire event
+            return;
+        }
+
         int resultFrames = 0;
 
         if (neededSize > 0)
@@ -119,6 +223,12 @@ namespace ouzel::audio
             if (vorbisStream->eof)
                 reset();
 
+            if (seekPending)
+            {
+                stb_vorbis_seek(vorbisStream, position);
+                seekPending = false;
+            }
+
             std::vector<float*> channelData(data.getChannels());
 
             switch (data.getChannels())
@@ -152,9 +262,14 @@ namespace ouzel::audio
                                                         static_cast<int>(data.getChannels()),
                                                         channelData.data(),
                                                         static_cast<int>(frames));
+
+            if (recording)
+                record(static_cast<std::uint32_t>(resultFrames), samples);
+
+            position += static_cast<std::uint32_t>(resultFrames);
         }
 
-        if (vorbisStream->eof)
+        if (!vorbisStream || vorbisStream->eof)
         {
             playing = false; // TODO: fire event
             reset();
@@ -165,10 +280,451 @@ namespace ouzel::audio
                 samples[channel * frames + frame] = 0.0F;
     }
 
+    void VorbisStream::skip(std::uint32_t frames)
+    {
+        // a skipped part can not be recorded
+        if (recording)
+        {
+            recording = false;
+            recordedSamples.clear();
+            recordedSamples.shrink_to_fit();
+        }
+
+        // the seek is deferred until the stream becomes real again, so a virtual stream costs nothing to advance
+        position += (frames > length - position) ? length - position : frames;
+        seekPending = !cachedSamples;
+
+        if ((length - position) == 0)
+        {
+            playing = false; // TODO: fire event
+            reset();
+        }
+    }
+
+    namespace
+    {
+        constexpr std::size_t readChunkSize = 16384;
+
+        // maps the Vorbis channel order to the channel order of the mixer
+        constexpr std::uint32_t getChannelIndex(std::uint32_t channels, std::uint32_t channel) noexcept
+        {
+            constexpr std::uint32_t surroundChannels[] = {0, 2, 1, 4, 5, 3};
+            return (channels == 6) ? surroundChannels[channel] : channel;
+        }
+    }
+
+    // Read-ahead buffer of a single stream, filled by the I/O thread and drained by the audio thread
+    class VorbisFileReader final
+    {
+    public:
+        explicit VorbisFileReader(const storage::FileRegion& initRegion):
+            region(initRegion)
+        {
+        }
+
+        // executed on the I/O thread, returns false if there was nothing to read
+        bool fill()
+        {
+            std::unique_lock lock(mutex);
+
+            if (rewindRequested)
+            {
+                position = 0;
+                rewindRequested = false;
+            }
+
+            if (buffer.size() >= VorbisClip::readAheadSize || position >= region.size)
+                return false;
+
+            const auto readPosition = position;
+            const auto readSize = std::min(readChunkSize, region.size - position);
+            lock.unlock();
+
+            // the file is opened here, so that creating the stream on the audio thread does not block
+            if (!file.is_open())
+                file.open(region.path, std::ios::binary);
+
+            std::size_t bytesRead = 0;
+
+            if (file.is_open())
+            {
+                chunk.resize(readSize);
+                file.clear();
+                file.seekg(static_cast<std::streamoff>(region.offset + readPosition), std::ios::beg);
+                file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(readSize));
+                bytesRead = static_cast<std::size_t>(file.gcount());
+            }
+
+            lock.lock();
+
+            // discard the chunk if the stream was rewound while reading
+            if (!rewindRequested && position == readPosition)
+            {
+                buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(bytesRead));
+                position = (bytesRead == readSize) ? position + bytesRead : region.size; // treat open and read errors as the end of file
+            }
+
+            return true;
+        }
+
+        // executed on the audio thread, appends all the buffered data to the result
+        // returns true if the whole file has been delivered
+        bool read(std::vector<std::byte>& result)
+        {
+            std::lock_guard lock(mutex);
+            result.insert(result.end(), buffer.begin(), buffer.end());
+            buffer.clear();
+            return !rewindRequested && position >= region.size;
+        }
+
+        void rewind()
+        {
+            std::lock_guard lock(mutex);
+            buffer.clear();
+            rewindRequested = true;
+        }
+
+    private:
+        storage::FileRegion region;
+        std::ifstream file;
+        std::vector<std::byte> chunk;
+
+        std::mutex mutex;
+        std::vector<std::byte> buffer;
+        std::size_t position = 0;
+        bool rewindRequested = false;
+    };
+
+    // Single thread that fills the readers of all the streamed clips, alive while any of them exists
+    class VorbisFileIo final
+    {
+    public:
+        VorbisFileIo():
+            ioThread(&VorbisFileIo::ioMain, this)
+        {
+        }
+
+        ~VorbisFileIo()
+        {
+            std::unique_lock lock(ioMutex);
+            running = false;
+            lock.unlock();
+            ioCondition.notify_all();
+
+            if (ioThread.isJoinable()) ioThread.join();
+        }
+
+        VorbisFileIo(const VorbisFileIo&) = delete;
+        VorbisFileIo& operator=(const VorbisFileIo&) = delete;
+
+        VorbisFileIo(VorbisFileIo&&) = delete;
+        VorbisFileIo& operator=(VorbisFileIo&&) = delete;
+
+        static std::shared_ptr<VorbisFileIo> get()
+        {
+            static std::mutex instanceMutex;
+            static std::weak_ptr<VorbisFileIo> instance;
+
+            std::lock_guard lock(instanceMutex);
+            auto result = instance.lock();
+            if (!result) instance = result = std::make_shared<VorbisFileIo>();
+            return result;
+        }
+
+        void addReader(const std::shared_ptr<VorbisFileReader>& reader)
+        {
+            std::unique_lock lock(ioMutex);
+            readers.push_back(reader);
+            dataRequested = true;
+            lock.unlock();
+            ioCondition.notify_all();
+        }
+
+        void removeReader(const std::shared_ptr<VorbisFileReader>& reader)
+        {
+            std::lock_guard lock(ioMutex);
+            const auto i = std::find(readers.begin(), readers.end(), reader);
+            if (i != readers.end()) readers.erase(i);
+        }
+
+        // executed on the audio thread when a reader was drained or rewound
+        void requestData()
+        {
+            std::unique_lock lock(ioMutex);
+            dataRequested = true;
+            lock.unlock();
+            ioCondition.notify_all();
+        }
+
+    private:
+        void ioMain()
+        {
+            thread::setCurrentThreadName("Vorbis I/O");
+
+            std::vector<std::shared_ptr<VorbisFileReader>> currentReaders;
+
+            for (;;)
+            {
+                std::unique_lock lock(ioMutex);
+                ioCondition.wait(lock, [this]() noexcept { return !running || dataRequested; });
+                if (!running) break;
+                dataRequested = false;
+                currentReaders = readers;
+                lock.unlock();
+
+                // the readers that are full are filled again after the next request
+                for (const auto& reader : currentReaders)
+                    while (reader->fill())
+                    {
+                    }
+
+                currentReaders.clear();
+            }
+        }
+
+        std::mutex ioMutex;
+        std::condition_variable ioCondition;
+        bool running = true;
+        bool dataRequested = false;
+        std::vector<std::shared_ptr<VorbisFileReader>> readers;
+        thread::Thread ioThread;
+    };
+
+    class VorbisFileData;
+
+    class VorbisFileStream final: public mixer::Stream
+    {
+    public:
+        explicit VorbisFileStream(VorbisFileData& vorbisFileData);
+        ~VorbisFileStream() override;
+
+        void reset() final;
+
+        void getSamples(std::uint32_t frames, std::vector<float>& samples) final;
+        void skip(std::uint32_t frames) final;
+
+    private:
+        std::uint32_t decode(std::uint32_t frames, float* samples);
+        bool pull();
+
+        std::shared_ptr<VorbisFileIo> io;
+        std::shared_ptr<VorbisFileReader> reader;
+        stb_vorbis* vorbisStream = nullptr;
+        std::vector<std::byte> input;
+        std::size_t inputOffset = 0;
+        bool endOfFile = false;
+
+        float** output = nullptr;
+        std::uint32_t outputFrames = 0;
+        std::uint32_t outputOffset = 0;
+
+        std::vector<float> skipBuffer;
+    };
+
+    class VorbisFileData final: public mixer::Data
+    {
+    public:
+        explicit VorbisFileData(const storage::FileRegion& initRegion):
+            region(initRegion),
+            io(VorbisFileIo::get())
+        {
+            std::ifstream file(region.path, std::ios::binary);
+            if (!file)
+                throw std::runtime_error("Failed to open file " + std::string(region.path));
+
+            file.seekg(static_cast<std::streamoff>(region.offset), std::ios::beg);
+
+            // read until the headers are complete
+            std::vector<std::byte> header;
+            for (;;)
+            {
+                const auto readSize = std::min(readChunkSize, region.size - header.size());
+                if (readSize == 0)
+                    throw std::runtime_error("Failed to load Vorbis stream");
+
+                const auto headerSize = header.size();
+                header.resize(headerSize + readSize);
+                file.read(reinterpret_cast<char*>(header.data() + headerSize), static_cast<std::streamsize>(readSize));
+                header.resize(headerSize + static_cast<std::size_t>(file.gcount()));
+
+                int used = 0;
+                int error = 0;
+                stb_vorbis* vorbisStream = stb_vorbis_open_pushdata(reinterpret_cast<const unsigned char*>(header.data()),
+                                                                    static_cast<int>(header.size()),
+                                                                    &used, &error, nullptr);
+                if (vorbisStream)
+                {
+                    stb_vorbis_info info = stb_vorbis_get_info(vorbisStream);
+
+                    channels = static_cast<std::uint32_t>(info.channels);
+                    sampleRate = info.sample_rate;
+
+                    stb_vorbis_close(vorbisStream);
+                    break;
+                }
+                else if (error != VORBIS_need_more_data || !file)
+                    throw std::runtime_error("Failed to load Vorbis stream");
+            }
+        }
+
+        auto& getRegion() const noexcept { return region; }
+        auto& getIo() const noexcept { return io; }
+
+        std::unique_ptr<mixer::Stream> createStream() final
+        {
+            return std::make_unique<VorbisFileStream>(*this);
+        }
+
+    private:
+        storage::FileRegion region;
+        std::shared_ptr<VorbisFileIo> io;
+    };
+
+    VorbisFileStream::VorbisFileStream(VorbisFileData& vorbisFileData):
+        Stream(vorbisFileData),
+        io(vorbisFileData.getIo()),
+        reader(std::make_shared<VorbisFileReader>(vorbisFileData.getRegion()))
+    {
+        io->addReader(reader);
+    }
+
+    VorbisFileStream::~VorbisFileStream()
+    {
+        io->removeReader(reader);
+
+        if (vorbisStream)
+            stb_vorbis_close(vorbisStream);
+    }
+
+    void VorbisFileStream::reset()
+    {
+        // pushdata decoders can not seek, so the decoding is restarted from the beginning of the file
+        if (vorbisStream)
+        {
+            stb_vorbis_close(vorbisStream);
+            vorbisStream = nullptr;
+        }
+
+        input.clear();
+        inputOffset = 0;
+        endOfFile = false;
+        output = nullptr;
+        outputFrames = 0;
+        outputOffset = 0;
+
+        reader->rewind();
+        io->requestData();
+    }
+
+    bool VorbisFileStream::pull()
+    {
+        input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(inputOffset));
+        inputOffset = 0;
+
+        const auto inputSize = input.size();
+        endOfFile = reader->read(input);
+        io->requestData();
+
+        return input.size() > inputSize;
+    }
+
+    std::uint32_t VorbisFileStream::decode(std::uint32_t frames, float* samples)
+    {
+        const auto channels = data.getChannels();
+        std::uint32_t result = 0;
+
+        while (result < frames)
+        {
+            if (outputOffset < outputFrames)
+            {
+                const auto copyFrames = std::min(frames - result, outputFrames - outputOffset);
+
+                if (samples)
+                    for (std::uint32_t channel = 0; channel < channels; ++channel)
+                        std::copy(output[channel] + outputOffset,
+                                  output[channel] + outputOffset + copyFrames,
+                                  samples + getChannelIndex(channels, channel) * frames + result);
+
+                outputOffset += copyFrames;
+                result += copyFrames;
+                continue;
+            }
+
+            const auto inputData = reinterpret_cast<const unsigned char*>(input.data() + inputOffset);
+            const auto inputSize = static_cast<int>(input.size() - inputOffset);
+            int used = 0;
+
+            if (!vorbisStream)
+            {
+                int error = 0;
+                vorbisStream = stb_vorbis_open_pushdata(inputData, inputSize, &used, &error, nullptr);
+
+                if (!vorbisStream && error != VORBIS_need_more_data)
+                {
+                    endOfFile = true;
+                    break;
+                }
+            }
+            else
+            {
+                int frameChannels = 0;
+                int frameSamples = 0;
+                used = stb_vorbis_decode_frame_pushdata(vorbisStream, inputData, inputSize,
+                                                        &frameChannels, &output, &frameSamples);
+
+                outputFrames = static_cast<std::uint32_t>(frameSamples);
+                outputOffset = 0;
+            }
+
+            if (used == 0 && !pull())
+                break; // either the end of file or the I/O thread has not caught up yet
+
+            inputOffset += static_cast<std::size_t>(used);
+        }
+
+        return result;
+    }
+
+    void VorbisFileStream::getSamples(std::uint32_t frames, std::vector<float>& samples)
+    {
+        samples.resize(frames * data.getChannels());
+
+        const auto resultFrames = decode(frames, samples.data());
+
+        for (std::uint32_t channel = 0; channel < data.getChannels(); ++channel)
+            for (auto frame = resultFrames; frame < frames; ++frame)
+                samples[channel * frames + frame] = 0.0F;
+
+        if (resultFrames < frames && endOfFile)
+        {
+            playing = false; // TODO: fire event
+            reset();
+        }
+    }
+
+    void VorbisFileStream::skip(std::uint32_t frames)
+    {
+        // pushdata decoders can not seek, so the skipped frames are decoded and discarded
+        if (decode(frames, nullptr) < frames && endOfFile)
+        {
+            playing = false; // TODO: fire event
+            reset();
+        }
+    }
+
     VorbisClip::VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData):
         Sound(initAudio,
-              initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initData))),
-              Sound::Format::vorbis)
+              initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisData(initData, initAudio.getMixer().getPcmCache()))),
+              Sound::Format::vorbis),
+        memoryUsage(initData.size())
+    {
+    }
+
+    VorbisClip::VorbisClip(Audio& initAudio, const storage::FileRegion& region):
+        Sound(initAudio,
+              initAudio.initData(std::unique_ptr<mixer::Data>(data = new VorbisFileData(region))),
+              Sound::Format::vorbis),
+        streaming(true)
     {
     }
 }
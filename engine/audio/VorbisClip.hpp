@@ -6,18 +6,34 @@
 #include <cstdint>
 #include <vector>
 #include "Sound.hpp"
+#include "../storage/FileRegion.hpp"
 
 namespace ouzel::audio
 {
-    class VorbisData;
+    namespace mixer
+    {
+        class Data;
+    }
 
     class VorbisClip final: public Sound
     {
     public:
+        // maximum number of compressed bytes buffered ahead for each playing stream
+        static constexpr std::size_t readAheadSize = 65536;
+
         VorbisClip(Audio& initAudio, const std::vector<std::byte>& initData);
+        // streams and decodes the data from the file while playing
+        VorbisClip(Audio& initAudio, const storage::FileRegion& region);
+
+        auto isStreaming() const noexcept { return streaming; }
+
+        // number of compressed bytes kept resident in memory
+        auto getMemoryUsage() const noexcept { return memoryUsage; }
 
     private:
-        VorbisData* data;
+        mixer::Data* data;
+        bool streaming = false;
+        std::size_t memoryUsage = 0;
     };
 }
 
@@ -10,11 +10,13 @@ namespace ouzel::audio::mixer
 {
     class Processor;
     class Stream;
+    class VoiceManager;
 
     class Bus final: public Object
     {
         friend Processor;
         friend Stream;
+        friend VoiceManager;
     public:
         Bus() noexcept {}
         ~Bus() override;
@@ -35,6 +35,7 @@ namespace ouzel::audio::mixer
             initStream,
             playStream,
             stopStream,
+            setStreamPriority,
             setStreamOutput,
             initData,
             initProcessor,
@@ -233,6 +234,20 @@ namespace ouzel::audio::mixer
         const bool reset;
     };
 
+    class SetStreamPriorityCommand final: public Command
+    {
+    public:
+        constexpr SetStreamPriorityCommand(ObjectId initStreamId,
+                                           float initPriority) noexcept:
+            Command(Command::Type::setStreamPriority),
+            streamId(initStreamId),
+            priority(initPriority)
+        {}
+
+        const ObjectId streamId;
+        const float priority;
+    };
+
     class SetStreamOutputCommand final: public Command
     {
     public:
@@ -164,6 +164,14 @@ namespace ouzel::audio::mixer
                         stream->stop(stopStreamCommand->reset);
                         break;
                     }
+                    case Command::Type::setStreamPriority:
+                    {
+                        auto setStreamPriorityCommand = static_cast<const SetStreamPriorityCommand*>(command.get());
+
+                        auto stream = static_cast<Stream*>(objects[setStreamPriorityCommand->streamId - 1].get());
+                        stream->setPriority(setStreamPriorityCommand->priority);
+                        break;
+                    }
                     case Command::Type::setStreamOutput:
                     {
                         auto setStreamOutputCommand = static_cast<const SetStreamOutputCommand*>(command.get());
@@ -218,6 +226,7 @@ namespace ouzel::audio::mixer
             Vector3F listenerPosition;
             QuaternionF listenerRotation;
 
+            voiceManager.update(*masterBus, listenerPosition);
             masterBus->getSamples(frames, channelCount, sampleRate, listenerPosition, listenerRotation, samples);
         }
 
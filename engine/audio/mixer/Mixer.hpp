@@ -13,7 +13,9 @@
 #include <vector>
 #include "Commands.hpp"
 #include "Object.hpp"
+#include "PcmCache.hpp"
 #include "Processor.hpp"
+#include "VoiceManager.hpp"
 #include "../../thread/Thread.hpp"
 
 namespace ouzel::audio::mixer
@@ -108,6 +110,12 @@ namespace ouzel::audio::mixer
             return rootObjectId;
         }
 
+        auto& getVoiceManager() noexcept { return voiceManager; }
+        auto& getVoiceManager() const noexcept { return voiceManager; }
+
+        auto& getPcmCache() noexcept { return pcmCache; }
+        auto& getPcmCache() const noexcept { return pcmCache; }
+
     private:
         void mixerMain();
 
@@ -118,11 +126,13 @@ namespace ouzel::audio::mixer
         ObjectId lastObjectId = 0;
         std::set<ObjectId> deletedObjectIds;
 
+        PcmCache pcmCache; // must outlive the objects, because the data erases its entries on destruction
         std::vector<std::unique_ptr<Object>> objects;
         std::size_t rootObjectId = 0;
         RootObject* rootObject = nullptr;
 
         Bus* masterBus = nullptr;
+        VoiceManager voiceManager;
 
         class Buffer final
         {
@@ -0,0 +1,61 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include "PcmCache.hpp"
+
+namespace ouzel::audio::mixer
+{
+    std::shared_ptr<const std::vector<float>> PcmCache::find(const Data& data)
+    {
+        const auto i = entries.find(&data);
+
+        if (i == entries.end())
+        {
+            ++missCount;
+            return nullptr;
+        }
+
+        ++hitCount;
+        lru.splice(lru.begin(), lru, i->second.lruIterator);
+        return i->second.samples;
+    }
+
+    std::shared_ptr<const std::vector<float>> PcmCache::insert(const Data& data, std::vector<float> samples)
+    {
+        erase(data);
+
+        const auto entrySize = samples.size() * sizeof(float);
+        auto entrySamples = std::make_shared<const std::vector<float>>(std::move(samples));
+
+        if (entrySize > maxEntrySize || entrySize > budget)
+            return entrySamples;
+
+        evict(budget - entrySize);
+
+        lru.push_front(&data);
+        entries[&data] = Entry{entrySamples, lru.begin()};
+        size += entrySize;
+
+        return entrySamples;
+    }
+
+    void PcmCache::erase(const Data& data)
+    {
+        const auto i = entries.find(&data);
+
+        if (i != entries.end())
+        {
+            size -= i->second.samples->size() * sizeof(float);
+            lru.erase(i->second.lruIterator);
+            entries.erase(i);
+        }
+    }
+
+    void PcmCache::evict(std::size_t maxSize)
+    {
+        while (size > maxSize && !lru.empty())
+        {
+            erase(*lru.back());
+            ++evictionCount;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_PCMCACHE_HPP
+#define OUZEL_AUDIO_MIXER_PCMCACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ouzel::audio::mixer
+{
+    class Data;
+
+    // Keeps the decoded samples of short clips, so that they are not decoded again on every play
+    // The entries are accessed only on the audio thread, the limits and statistics can be accessed from any thread
+    class PcmCache final
+    {
+    public:
+        explicit PcmCache(std::size_t initBudget = 8388608,
+                          std::size_t initMaxEntrySize = 1048576) noexcept:
+            budget(initBudget),
+            maxEntrySize(initMaxEntrySize)
+        {
+        }
+
+        PcmCache(const PcmCache&) = delete;
+        PcmCache& operator=(const PcmCache&) = delete;
+
+        PcmCache(PcmCache&&) = delete;
+        PcmCache& operator=(PcmCache&&) = delete;
+
+        // in bytes, a smaller budget is applied on the next insertion
+        auto getBudget() const noexcept { return budget.load(); }
+        void setBudget(std::size_t newBudget) noexcept { budget = newBudget; }
+
+        // in bytes, larger clips are not cached
+        auto getMaxEntrySize() const noexcept { return maxEntrySize.load(); }
+        void setMaxEntrySize(std::size_t newMaxEntrySize) noexcept { maxEntrySize = newMaxEntrySize; }
+
+        auto getSize() const noexcept { return size.load(); }
+        auto getHitCount() const noexcept { return hitCount.load(); }
+        auto getMissCount() const noexcept { return missCount.load(); }
+        auto getEvictionCount() const noexcept { return evictionCount.load(); }
+
+        // returns nullptr on a miss
+        std::shared_ptr<const std::vector<float>> find(const Data& data);
+        std::shared_ptr<const std::vector<float>> insert(const Data& data, std::vector<float> samples);
+        void erase(const Data& data);
+
+    private:
+        void evict(std::size_t maxSize);
+
+        struct Entry final
+        {
+            // streams that are playing the samples keep them alive after the eviction
+            std::shared_ptr<const std::vector<float>> samples;
+            std::list<const Data*>::iterator lruIterator;
+        };
+
+        std::atomic<std::size_t> budget;
+        std::atomic<std::size_t> maxEntrySize;
+        std::atomic<std::size_t> size{0};
+        std::atomic<std::uint64_t> hitCount{0};
+        std::atomic<std::uint64_t> missCount{0};
+        std::atomic<std::uint64_t> evictionCount{0};
+
+        std::unordered_map<const Data*, Entry> entries;
+        std::list<const Data*> lru; // the most recently used entry is at the front
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_PCMCACHE_HPP
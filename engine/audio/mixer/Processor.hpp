@@ -27,6 +27,9 @@ namespace ouzel::audio::mixer
         virtual void process(std::uint32_t frames, std::uint32_t channels, std::uint32_t sampleRate,
                              std::vector<float>& samples) = 0;
 
+        // linear gain that this processor applies to a signal heard at the listener position
+        virtual float getAudibility(const Vector3F&) const noexcept { return 1.0F; }
+
         auto isEnabled() const noexcept { return enabled; }
         void setEnabled(bool newEnabled) { enabled = newEnabled; }
 
@@ -11,10 +11,12 @@ namespace ouzel::audio::mixer
 {
     class Bus;
     class Data;
+    class VoiceManager;
 
     class Stream: public Object
     {
         friend Bus;
+        friend VoiceManager;
     public:
         explicit Stream(Data& initData) noexcept:
             data(initData)
@@ -50,14 +52,24 @@ namespace ouzel::audio::mixer
             if (shouldReset) reset();
         }
 
+        auto getPriority() const noexcept { return priority; }
+        void setPriority(float newPriority) { priority = newPriority; }
+
+        auto isVirtual() const noexcept { return virtualized; }
+
         virtual void reset() = 0;
 
         virtual void getSamples(std::uint32_t frames, std::vector<float>& samples) = 0;
 
+        // advances the play position of a virtual stream without generating samples
+        virtual void skip(std::uint32_t frames) = 0;
+
     protected:
         Data& data;
         Bus* output = nullptr;
         bool playing = false;
+        float priority = 0.0F;
+        bool virtualized = false;
     };
 }
 
@@ -0,0 +1,59 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include "VoiceManager.hpp"
+#include "Bus.hpp"
+#include "Processor.hpp"
+#include "Stream.hpp"
+
+namespace ouzel::audio::mixer
+{
+    void VoiceManager::update(Bus& masterBus, const Vector3F& listenerPosition)
+    {
+        candidates.clear();
+        collectVoices(masterBus, 1.0F, listenerPosition);
+
+        const auto currentMaxVoices = static_cast<std::size_t>(maxVoices.load());
+        const auto currentMinAudibility = minAudibility.load();
+
+        const auto compare = [](const Candidate& a, const Candidate& b) noexcept {
+            return (a.priority != b.priority) ? a.priority > b.priority : a.audibility > b.audibility;
+        };
+
+        // only the partition matters, the order inside of each group is irrelevant
+        if (candidates.size() > currentMaxVoices)
+            std::nth_element(candidates.begin(),
+                             candidates.begin() + static_cast<std::ptrdiff_t>(currentMaxVoices),
+                             candidates.end(), compare);
+
+        std::uint32_t realVoices = 0;
+        std::uint32_t virtualVoices = 0;
+
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            const auto& candidate = candidates[i];
+            const bool real = i < currentMaxVoices && candidate.audibility >= currentMinAudibility;
+            candidate.stream->virtualized = !real;
+
+            if (real) ++realVoices;
+            else ++virtualVoices;
+        }
+
+        realVoiceCount = realVoices;
+        virtualVoiceCount = virtualVoices;
+    }
+
+    void VoiceManager::collectVoices(Bus& bus, float audibility, const Vector3F& listenerPosition)
+    {
+        for (const Processor* processor : bus.processors)
+            if (processor->isEnabled())
+                audibility *= processor->getAudibility(listenerPosition);
+
+        for (Stream* stream : bus.inputStreams)
+            if (stream->isPlaying())
+                candidates.push_back({stream, stream->getPriority(), audibility});
+
+        for (Bus* inputBus : bus.inputBuses)
+            collectVoices(*inputBus, audibility, listenerPosition);
+    }
+}
@@ -0,0 +1,65 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
+#define OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "../../math/Vector.hpp"
+
+namespace ouzel::audio::mixer
+{
+    class Bus;
+    class Stream;
+
+    // Keeps only the most audible streams decoding, the rest are virtualized
+    // (their play position advances, but no samples are generated)
+    class VoiceManager final
+    {
+    public:
+        explicit VoiceManager(std::uint32_t initMaxVoices = 32,
+                              float initMinAudibility = 0.001F) noexcept:
+            maxVoices(initMaxVoices),
+            minAudibility(initMinAudibility)
+        {
+        }
+
+        VoiceManager(const VoiceManager&) = delete;
+        VoiceManager& operator=(const VoiceManager&) = delete;
+
+        VoiceManager(VoiceManager&&) = delete;
+        VoiceManager& operator=(VoiceManager&&) = delete;
+
+        auto getMaxVoices() const noexcept { return maxVoices.load(); }
+        void setMaxVoices(std::uint32_t newMaxVoices) noexcept { maxVoices = newMaxVoices; }
+
+        auto getMinAudibility() const noexcept { return minAudibility.load(); }
+        void setMinAudibility(float newMinAudibility) noexcept { minAudibility = newMinAudibility; }
+
+        auto getRealVoiceCount() const noexcept { return realVoiceCount.load(); }
+        auto getVirtualVoiceCount() const noexcept { return virtualVoiceCount.load(); }
+
+        // executed on the audio thread before the master bus is mixed
+        void update(Bus& masterBus, const Vector3F& listenerPosition);
+
+    private:
+        void collectVoices(Bus& bus, float audibility, const Vector3F& listenerPosition);
+
+        struct Candidate final
+        {
+            Stream* stream;
+            float priority;
+            float audibility;
+        };
+
+        std::atomic<std::uint32_t> maxVoices;
+        std::atomic<float> minAudibility;
+        std::atomic<std::uint32_t> realVoiceCount{0};
+        std::atomic<std::uint32_t> virtualVoiceCount{0};
+
+        std::vector<Candidate> candidates;
+    };
+}
+
+#endif // OUZEL_AUDIO_MIXER_VOICEMANAGER_HPP
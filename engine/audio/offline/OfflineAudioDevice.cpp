@@ -0,0 +1,120 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "OfflineAudioDevice.hpp"
+
+namespace ouzel::audio::offline
+{
+    namespace
+    {
+        constexpr std::uint16_t WAVE_FORMAT_PCM = 1;
+        constexpr std::uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+
+        constexpr std::size_t headerSize = 44; // RIFF header, format chunk and data chunk header
+
+        void encode(std::uint8_t* buffer, std::uint32_t value) noexcept
+        {
+            buffer[0] = static_cast<std::uint8_t>(value);
+            buffer[1] = static_cast<std::uint8_t>(value >> 8);
+            buffer[2] = static_cast<std::uint8_t>(value >> 16);
+            buffer[3] = static_cast<std::uint8_t>(value >> 24);
+        }
+
+        void encode(std::uint8_t* buffer, std::uint16_t value) noexcept
+        {
+            buffer[0] = static_cast<std::uint8_t>(value);
+            buffer[1] = static_cast<std::uint8_t>(value >> 8);
+        }
+    }
+
+    AudioDevice::AudioDevice(const Settings& settings,
+                             const std::function<void(std::uint32_t frames,
+                                                      std::uint32_t channels,
+                                                      std::uint32_t sampleRate,
+                                                      std::vector<float>& samples)>& initDataGetter):
+        audio::AudioDevice(Driver::offline, settings, initDataGetter),
+        file(settings.audioDevice.empty() ? "output.wav" : settings.audioDevice,
+             std::ios::binary | std::ios::trunc)
+    {
+        if (!file)
+            throw std::runtime_error("Failed to open output file");
+
+        sampleFormat = settings.sampleFormat;
+        writeHeader();
+    }
+
+    void AudioDevice::start()
+    {
+        running = true;
+    }
+
+    void AudioDevice::stop()
+    {
+        running = false;
+    }
+
+    void AudioDevice::render(std::uint64_t frames)
+    {
+        if (!running)
+            throw std::runtime_error("Audio device is not running");
+
+        const auto startTime = std::chrono::steady_clock::now();
+
+        while (frames > 0)
+        {
+            const auto bufferFrames = static_cast<std::uint32_t>(std::min(frames, static_cast<std::uint64_t>(bufferSize)));
+            getData(bufferFrames, data);
+
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file)
+                throw std::runtime_error("Failed to write to output file");
+
+            renderedFrames += bufferFrames;
+            frames -= bufferFrames;
+        }
+
+        // keep the file valid after every render
+        writeHeader();
+
+        renderDuration += std::chrono::steady_clock::now() - startTime;
+    }
+
+    double AudioDevice::getRealTimeFactor() const noexcept
+    {
+        const auto seconds = std::chrono::duration<double>(renderDuration).count();
+        return (seconds > 0.0) ? static_cast<double>(renderedFrames) / sampleRate / seconds : 0.0;
+    }
+
+    void AudioDevice::writeHeader()
+    {
+        const auto bytesPerSample = static_cast<std::uint16_t>((sampleFormat == SampleFormat::float32) ? sizeof(float) : sizeof(std::int16_t));
+        const auto blockAlign = static_cast<std::uint16_t>(bytesPerSample * channels);
+        const auto dataSize = static_cast<std::uint32_t>(std::min(renderedFrames * blockAlign,
+                                                                  static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max() - headerSize)));
+
+        std::uint8_t header[headerSize] = {
+            'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E',
+            'f', 'm', 't', ' ', 16, 0, 0, 0
+        };
+
+        encode(header + 4, static_cast<std::uint32_t>(headerSize - 8 + dataSize));
+        encode(header + 20, (sampleFormat == SampleFormat::float32) ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+        encode(header + 22, static_cast<std::uint16_t>(channels));
+        encode(header + 24, sampleRate);
+        encode(header + 28, sampleRate * blockAlign);
+        encode(header + 32, blockAlign);
+        encode(header + 34, static_cast<std::uint16_t>(bytesPerSample * 8));
+        header[36] = 'd'; header[37] = 'a'; header[38] = 't'; header[39] = 'a';
+        encode(header + 40, dataSize);
+
+        const auto position = file.tellp();
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        if (position > 0) file.seekp(position);
+
+        if (!file)
+            throw std::runtime_error("Failed to write to output file");
+    }
+}
@@ -0,0 +1,47 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
+#define OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include "../AudioDevice.hpp"
+
+namespace ouzel::audio::offline
+{
+    // Mixes on demand as fast as possible and writes the result to a WAV file (the audio device setting)
+    class AudioDevice final: public audio::AudioDevice
+    {
+    public:
+        AudioDevice(const Settings& settings,
+                    const std::function<void(std::uint32_t frames,
+                                             std::uint32_t channels,
+                                             std::uint32_t sampleRate,
+                                             std::vector<float>& samples)>& initDataGetter);
+
+        void start() final;
+        void stop() final;
+
+        // mixes the frames on the calling thread and appends them to the file
+        void render(std::uint64_t frames);
+
+        auto getRenderedFrames() const noexcept { return renderedFrames; }
+        auto getRenderDuration() const noexcept { return renderDuration; }
+
+        // duration of the rendered audio divided by the time it took to render it
+        double getRealTimeFactor() const noexcept;
+
+    private:
+        void writeHeader();
+
+        std::ofstream file;
+        std::vector<std::uint8_t> data;
+        std::uint64_t renderedFrames = 0;
+        std::chrono::steady_clock::duration renderDuration{};
+        bool running = false;
+    };
+}
+
+#endif // OUZEL_AUDIO_OFFLINEAUDIODEVICE_HPP
@@ -18,23 +18,31 @@
 #    include "opengl/ColorVSGLES2.h"
 #    include "opengl/TexturePSGLES2.h"
 #    include "opengl/TextureVSGLES2.h"
+#    include "opengl/DistanceFieldPSGLES2.h"
 #    include "opengl/ColorPSGLES3.h"
 #    include "opengl/ColorVSGLES3.h"
 #    include "opengl/TexturePSGLES3.h"
 #    include "opengl/TextureVSGLES3.h"
+#    include "opengl/DistanceFieldPSGLES3.h"
+#    include "opengl/InstancedTextureVSGLES3.h"
 #  else
 #    include "opengl/ColorPSGL2.h"
 #    include "opengl/ColorVSGL2.h"
 #    include "opengl/TexturePSGL2.h"
 #    include "opengl/TextureVSGL2.h"
+#    include "opengl/DistanceFieldPSGL2.h"
 #    include "opengl/ColorPSGL3.h"
 #    include "opengl/ColorVSGL3.h"
 #    include "opengl/TexturePSGL3.h"
 #    include "opengl/TextureVSGL3.h"
+#    include "opengl/DistanceFieldPSGL3.h"
+#    include "opengl/InstancedTextureVSGL3.h"
 #    include "opengl/ColorPSGL4.h"
 #    include "opengl/ColorVSGL4.h"
 #    include "opengl/TexturePSGL4.h"
 #    include "opengl/TextureVSGL4.h"
+#    include "opengl/DistanceFieldPSGL4.h"
+#    include "opengl/InstancedTextureVSGL4.h"
 #  endif
 #endif
 
@@ -175,6 +183,12 @@ namespace ouzel::core
 
             settings.audioSettings.audioDevice = userEngineSection.getValue("audioDevice", defaultEngineSection.getValue("audioDevice"));
 
+            const auto& maxVoicesValue = userEngineSection.getValue("maxVoices", defaultEngineSection.getValue("maxVoices"));
+            if (!maxVoicesValue.empty()) settings.audioSettings.maxVoices = static_cast<std::uint32_t>(std::stoul(maxVoicesValue));
+
+            const auto& pcmCacheSizeValue = userEngineSection.getValue("pcmCacheSize", defaultEngineSection.getValue("pcmCacheSize"));
+            if (!pcmCacheSizeValue.empty()) settings.audioSettings.pcmCacheSize = static_cast<std::size_t>(std::stoull(pcmCacheSizeValue));
+
             return settings;
         }
     }
@@ -347,6 +361,180 @@ namespace ouzel::core
 
                 assetBundle.setShader(shaderTexture, std::move(textureShader));
 
+                std::unique_ptr<graphics::Shader> distanceFieldShader;
+
+                switch (graphics->getDevice()->getAPIMajorVersion())
+                {
+#  if OUZEL_OPENGLES
+                    case 2:
+                        distanceFieldShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                 std::vector<std::uint8_t>(std::begin(DistanceFieldPSGLES2_glsl),
+                                                                                                           std::end(DistanceFieldPSGLES2_glsl)),
+                                                                                 std::vector<std::uint8_t>(std::begin(TextureVSGLES2_glsl),
+                                                                                                           std::end(TextureVSGLES2_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::position,
+                                                                                     graphics::Vertex::Attribute::Usage::color,
+                                                                                     graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"color", graphics::DataType::float32Vector4}
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                 });
+                        break;
+                    case 3:
+                        distanceFieldShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                 std::vector<std::uint8_t>(std::begin(DistanceFieldPSGLES3_glsl),
+                                                                                                           std::end(DistanceFieldPSGLES3_glsl)),
+                                                                                 std::vector<std::uint8_t>(std::begin(TextureVSGLES3_glsl),
+                                                                                                           std::end(TextureVSGLES3_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::position,
+                                                                                     graphics::Vertex::Attribute::Usage::color,
+                                                                                     graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"color", graphics::DataType::float32Vector4}
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                 });
+                        break;
+#  else
+                    case 2:
+                        distanceFieldShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                 std::vector<std::uint8_t>(std::begin(DistanceFieldPSGL2_glsl),
+                                                                                                           std::end(DistanceFieldPSGL2_glsl)),
+                                                                                 std::vector<std::uint8_t>(std::begin(TextureVSGL2_glsl),
+                                                                                                           std::end(TextureVSGL2_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::position,
+                                                                                     graphics::Vertex::Attribute::Usage::color,
+                                                                                     graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"color", graphics::DataType::float32Vector4}
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                 });
+                        break;
+                    case 3:
+                        distanceFieldShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                 std::vector<std::uint8_t>(std::begin(DistanceFieldPSGL3_glsl),
+                                                                                                           std::end(DistanceFieldPSGL3_glsl)),
+                                                                                 std::vector<std::uint8_t>(std::begin(TextureVSGL3_glsl),
+                                                                                                           std::end(TextureVSGL3_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::position,
+                                                                                     graphics::Vertex::Attribute::Usage::color,
+                                                                                     graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"color", graphics::DataType::float32Vector4}
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                 });
+                        break;
+                    case 4:
+                        distanceFieldShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                 std::vector<std::uint8_t>(std::begin(DistanceFieldPSGL4_glsl),
+                                                                                                           std::end(DistanceFieldPSGL4_glsl)),
+                                                                                 std::vector<std::uint8_t>(std::begin(TextureVSGL4_glsl),
+                                                                                                           std::end(TextureVSGL4_glsl)),
+                                                                                 std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                     graphics::Vertex::Attribute::Usage::position,
+                                                                                     graphics::Vertex::Attribute::Usage::color,
+                                                                                     graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"color", graphics::DataType::float32Vector4}
+                                                                                 },
+                                                                                 std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                     {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                 });
+                        break;
+#  endif
+                    default:
+                        throw std::runtime_error("Unsupported OpenGL version");
+                }
+
+                assetBundle.setShader(shaderDistanceField, std::move(distanceFieldShader));
+
+                // instanced quads need OpenGL (ES) 3, older versions draw the expanded vertices
+                if (graphics->getDevice()->isInstancingSupported())
+                {
+                    std::unique_ptr<graphics::Shader> instancedTextureShader;
+
+                    switch (graphics->getDevice()->getAPIMajorVersion())
+                    {
+#  if OUZEL_OPENGLES
+                        case 3:
+                            instancedTextureShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                        std::vector<std::uint8_t>(std::begin(TexturePSGLES3_glsl),
+                                                                                                                  std::end(TexturePSGLES3_glsl)),
+                                                                                        std::vector<std::uint8_t>(std::begin(InstancedTextureVSGLES3_glsl),
+                                                                                                                  std::end(InstancedTextureVSGLES3_glsl)),
+                                                                                        std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                            graphics::Vertex::Attribute::Usage::position,
+                                                                                            graphics::Vertex::Attribute::Usage::color,
+                                                                                            graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"color", graphics::DataType::float32Vector4}
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                        });
+                            break;
+#  else
+                        case 3:
+                            instancedTextureShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                        std::vector<std::uint8_t>(std::begin(TexturePSGL3_glsl),
+                                                                                                                  std::end(TexturePSGL3_glsl)),
+                                                                                        std::vector<std::uint8_t>(std::begin(InstancedTextureVSGL3_glsl),
+                                                                                                                  std::end(InstancedTextureVSGL3_glsl)),
+                                                                                        std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                            graphics::Vertex::Attribute::Usage::position,
+                                                                                            graphics::Vertex::Attribute::Usage::color,
+                                                                                            graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"color", graphics::DataType::float32Vector4}
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                        });
+                            break;
+                        case 4:
+                            instancedTextureShader = std::make_unique<graphics::Shader>(*graphics,
+                                                                                        std::vector<std::uint8_t>(std::begin(TexturePSGL4_glsl),
+                                                                                                                  std::end(TexturePSGL4_glsl)),
+                                                                                        std::vector<std::uint8_t>(std::begin(InstancedTextureVSGL4_glsl),
+                                                                                                                  std::end(InstancedTextureVSGL4_glsl)),
+                                                                                        std::set<graphics::Vertex::Attribute::Usage>{
+                                                                                            graphics::Vertex::Attribute::Usage::position,
+                                                                                            graphics::Vertex::Attribute::Usage::color,
+                                                                                            graphics::Vertex::Attribute::Usage::textureCoordinates0
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"color", graphics::DataType::float32Vector4}
+                                                                                        },
+                                                                                        std::vector<std::pair<std::string, graphics::DataType>>{
+                                                                                            {"modelViewProj", graphics::DataType::float32Matrix4}
+                                                                                        });
+                            break;
+#  endif
+                        default:
+                            throw std::runtime_error("Unsupported OpenGL version");
+                    }
+
+                    assetBundle.setShader(shaderInstancedTexture, std::move(instancedTextureShader));
+                }
+
                 auto colorShader = std::make_unique<graphics::Shader>(*graphics);
 
                 switch (graphics->getDevice()->getAPIMajorVersion())
@@ -156,6 +156,8 @@ namespace ouzel
 {
     const std::string shaderTexture = "shaderTexture";
     const std::string shaderColor = "shaderColor";
+    const std::string shaderDistanceField = "shaderDistanceField";
+    const std::string shaderInstancedTexture = "shaderInstancedTexture";
 
     const std::string blendNoBlend = "blendNoBlend";
     const std::string blendAdd = "blendAdd";
@@ -0,0 +1,347 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FORMATS_DEFLATE_HPP
+#define OUZEL_FORMATS_DEFLATE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ouzel::deflate
+{
+    class DecompressError final: public std::runtime_error
+    {
+    public:
+        explicit DecompressError(const std::string& str): std::runtime_error(str) {}
+        explicit DecompressError(const char* str): std::runtime_error(str) {}
+    };
+
+    inline namespace detail
+    {
+        constexpr std::uint32_t maxBits = 15;
+        constexpr std::uint32_t fastBits = 9;
+
+        // canonical Huffman code with a lookup table for the short codes
+        class Huffman final
+        {
+        public:
+            void build(const std::uint8_t* lengths, std::uint32_t count)
+            {
+                std::fill(std::begin(counts), std::end(counts), std::uint16_t(0));
+                for (std::uint32_t symbol = 0; symbol < count; ++symbol)
+                    ++counts[lengths[symbol]];
+                counts[0] = 0;
+
+                // incomplete codes are allowed, invalid codes are detected while decoding
+                std::int32_t left = 1;
+                for (std::uint32_t length = 1; length <= maxBits; ++length)
+                {
+                    left = left * 2 - counts[length];
+                    if (left < 0)
+                        throw DecompressError("Over-subscribed Huffman code");
+                }
+
+                std::uint16_t offsets[maxBits + 1];
+                offsets[1] = 0;
+                for (std::uint32_t length = 1; length < maxBits; ++length)
+                    offsets[length + 1] = static_cast<std::uint16_t>(offsets[length] + counts[length]);
+
+                for (std::uint32_t symbol = 0; symbol < count; ++symbol)
+                    if (lengths[symbol] != 0)
+                        symbols[offsets[lengths[symbol]]++] = static_cast<std::uint16_t>(symbol);
+
+                std::fill(std::begin(fast), std::end(fast), std::uint16_t(0));
+
+                std::uint32_t code = 0;
+                std::uint32_t index = 0;
+                for (std::uint32_t length = 1; length <= fastBits; ++length)
+                {
+                    for (std::uint32_t i = 0; i < counts[length]; ++i, ++code, ++index)
+                    {
+                        // the codes are stored starting from the most significant bit
+                        std::uint32_t reversed = 0;
+                        for (std::uint32_t bit = 0; bit < length; ++bit)
+                            if (code & (1U << bit)) reversed |= 1U << (length - bit - 1);
+
+                        for (std::uint32_t entry = reversed; entry < (1U << fastBits); entry += 1U << length)
+                            fast[entry] = static_cast<std::uint16_t>((symbols[index] << 4) | length);
+                    }
+
+                    code <<= 1;
+                }
+            }
+
+            std::uint16_t counts[maxBits + 1];
+            std::uint16_t symbols[288];
+            std::uint16_t fast[1U << fastBits]; // symbol << 4 | length, zero for longer codes
+        };
+
+        class Decoder final
+        {
+        public:
+            Decoder(const std::byte* initData, std::size_t initSize) noexcept:
+                data(initData), size(initSize)
+            {
+            }
+
+            void decompress(std::vector<std::byte>& output)
+            {
+                Huffman literals;
+                Huffman distances;
+
+                for (;;)
+                {
+                    const auto last = getBits(1);
+                    const auto type = getBits(2);
+
+                    switch (type)
+                    {
+                        case 0: // stored
+                            copyStored(output);
+                            break;
+                        case 1: // fixed Huffman codes
+                            buildFixed(literals, distances);
+                            decodeBlock(literals, distances, output);
+                            break;
+                        case 2: // dynamic Huffman codes
+                            buildDynamic(literals, distances);
+                            decodeBlock(literals, distances, output);
+                            break;
+                        default:
+                            throw DecompressError("Invalid block type");
+                    }
+
+                    if (last) break;
+                }
+            }
+
+        private:
+            std::uint32_t getBits(std::uint32_t count)
+            {
+                while (bitCount < count)
+                {
+                    if (position >= size)
+                        throw DecompressError("Unexpected end of data");
+
+                    bitBuffer |= static_cast<std::uint32_t>(data[position++]) << bitCount;
+                    bitCount += 8;
+                }
+
+                const std::uint32_t result = bitBuffer & ((1U << count) - 1U);
+                bitBuffer >>= count;
+                bitCount -= count;
+                return result;
+            }
+
+            std::uint32_t decode(const Huffman& huffman)
+            {
+                while (bitCount <= 16 && position < size)
+                {
+                    bitBuffer |= static_cast<std::uint32_t>(data[position++]) << bitCount;
+                    bitCount += 8;
+                }
+
+                if (bitCount >= fastBits)
+                {
+                    const std::uint32_t entry = huffman.fast[bitBuffer & ((1U << fastBits) - 1U)];
+                    if (entry)
+                    {
+                        const std::uint32_t length = entry & 0x0F;
+                        bitBuffer >>= length;
+                        bitCount -= length;
+                        return entry >> 4;
+                    }
+                }
+
+                // the long codes are decoded one bit at a time
+                std::int32_t code = 0;
+                std::int32_t first = 0;
+                std::int32_t index = 0;
+                for (std::uint32_t length = 1; length <= maxBits; ++length)
+                {
+                    code |= static_cast<std::int32_t>(getBits(1));
+                    const std::int32_t count = huffman.counts[length];
+                    if (code - count < first)
+                        return huffman.symbols[index + (code - first)];
+                    index += count;
+                    first = (first + count) << 1;
+                    code <<= 1;
+                }
+
+                throw DecompressError("Invalid Huffman code");
+            }
+
+            void copyStored(std::vector<std::byte>& output)
+            {
+                getBits(bitCount % 8); // skip to the byte boundary
+
+                const auto length = getBits(16);
+                const auto complement = getBits(16);
+                if (length != (~complement & 0xFFFFU))
+                    throw DecompressError("Invalid stored block length");
+
+                std::uint32_t remaining = length;
+                while (remaining > 0 && bitCount >= 8)
+                {
+                    output.push_back(static_cast<std::byte>(getBits(8)));
+                    --remaining;
+                }
+
+                if (size - position < remaining)
+                    throw DecompressError("Unexpected end of data");
+
+                output.insert(output.end(), data + position, data + position + remaining);
+                position += remaining;
+            }
+
+            static void buildFixed(Huffman& literals, Huffman& distances)
+            {
+                std::uint8_t lengths[288];
+                std::fill(lengths, lengths + 144, std::uint8_t(8));
+                std::fill(lengths + 144, lengths + 256, std::uint8_t(9));
+                std::fill(lengths + 256, lengths + 280, std::uint8_t(7));
+                std::fill(lengths + 280, lengths + 288, std::uint8_t(8));
+                literals.build(lengths, 288);
+
+                std::fill(lengths, lengths + 30, std::uint8_t(5));
+                distances.build(lengths, 30);
+            }
+
+            void buildDynamic(Huffman& literals, Huffman& distances)
+            {
+                const auto literalCount = getBits(5) + 257;
+                const auto distanceCount = getBits(5) + 1;
+                const auto codeLengthCount = getBits(4) + 4;
+
+                if (literalCount > 286 || distanceCount > 30)
+                    throw DecompressError("Invalid code counts");
+
+                static constexpr std::uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+                std::uint8_t lengths[286 + 30] = {};
+                for (std::uint32_t i = 0; i < codeLengthCount; ++i)
+                    lengths[order[i]] = static_cast<std::uint8_t>(getBits(3));
+
+                Huffman codeLengths;
+                codeLengths.build(lengths, 19);
+
+                std::fill(std::begin(lengths), std::end(lengths), std::uint8_t(0));
+
+                for (std::uint32_t index = 0; index < literalCount + distanceCount;)
+                {
+                    const auto symbol = decode(codeLengths);
+
+                    if (symbol < 16)
+                        lengths[index++] = static_cast<std::uint8_t>(symbol);
+                    else
+                    {
+                        std::uint8_t length = 0;
+                        std::uint32_t repeat = 0;
+
+                        if (symbol == 16)
+                        {
+                            if (index == 0)
+                                throw DecompressError("Repeat without a previous length");
+                            length = lengths[index - 1];
+                            repeat = 3 + getBits(2);
+                        }
+                        else if (symbol == 17)
+                            repeat = 3 + getBits(3);
+                        else
+                            repeat = 11 + getBits(7);
+
+                        if (index + repeat > literalCount + distanceCount)
+                            throw DecompressError("Too many code lengths");
+
+                        while (repeat--) lengths[index++] = length;
+                    }
+                }
+
+                if (lengths[256] == 0)
+                    throw DecompressError("Missing end of block code");
+
+                literals.build(lengths, literalCount);
+                distances.build(lengths + literalCount, distanceCount);
+            }
+
+            void decodeBlock(const Huffman& literals, const Huffman& distances,
+                             std::vector<std::byte>& output)
+            {
+                static constexpr std::uint16_t lengthBases[29] = {
+                    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+                };
+                static constexpr std::uint8_t lengthExtraBits[29] = {
+                    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+                };
+                static constexpr std::uint16_t distanceBases[30] = {
+                    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+                };
+                static constexpr std::uint8_t distanceExtraBits[30] = {
+                    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+                };
+
+                for (;;)
+                {
+                    const auto symbol = decode(literals);
+
+                    if (symbol < 256)
+                        output.push_back(static_cast<std::byte>(symbol));
+                    else if (symbol == 256)
+                        break;
+                    else
+                    {
+                        const auto lengthSymbol = symbol - 257;
+                        if (lengthSymbol >= 29)
+                            throw DecompressError("Invalid length symbol");
+
+                        const auto length = lengthBases[lengthSymbol] + getBits(lengthExtraBits[lengthSymbol]);
+
+                        const auto distanceSymbol = decode(distances);
+                        if (distanceSymbol >= 30)
+                            throw DecompressError("Invalid distance symbol");
+
+                        const auto distance = distanceBases[distanceSymbol] + getBits(distanceExtraBits[distanceSymbol]);
+                        if (distance > output.size())
+                            throw DecompressError("Distance too far back");
+
+                        // the source and the destination can overlap
+                        const auto offset = output.size();
+                        output.resize(offset + length);
+                        for (std::size_t i = offset; i < offset + length; ++i)
+                            output[i] = output[i - distance];
+                    }
+                }
+            }
+
+            const std::byte* data;
+            std::size_t size;
+            std::size_t position = 0;
+            std::uint32_t bitBuffer = 0;
+            std::uint32_t bitCount = 0;
+        };
+    }
+
+    // decompresses raw deflate data (without a zlib or gzip header)
+    inline std::vector<std::byte> decompress(const std::byte* data, std::size_t size,
+                                             std::size_t expectedSize = 0)
+    {
+        std::vector<std::byte> result;
+        result.reserve(expectedSize);
+
+        Decoder decoder(data, size);
+        decoder.decompress(result);
+
+        return result;
+    }
+}
+
+#endif // OUZEL_FORMATS_DEFLATE_HPP
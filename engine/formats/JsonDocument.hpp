@@ -0,0 +1,783 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FORMATS_JSONDOCUMENT_HPP
+#define OUZEL_FORMATS_JSONDOCUMENT_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+#include "Json.hpp"
+
+namespace ouzel::json
+{
+    inline namespace detail
+    {
+        constexpr std::size_t maxDepth = 512;
+
+#if defined(__SSE2__)
+        inline std::uint32_t countTrailingZeros(std::uint32_t mask) noexcept
+        {
+#  if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long result;
+            _BitScanForward(&result, mask);
+            return static_cast<std::uint32_t>(result);
+#  else
+            return static_cast<std::uint32_t>(__builtin_ctz(mask));
+#  endif
+        }
+#endif
+
+        inline bool isWhitespace(char c) noexcept
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        inline const char* skipWhitespaces(const char* iterator, const char* end) noexcept
+        {
+#if defined(__SSE2__)
+            const auto space = _mm_set1_epi8(' ');
+            const auto tab = _mm_set1_epi8('\t');
+            const auto carriageReturn = _mm_set1_epi8('\r');
+            const auto lineFeed = _mm_set1_epi8('\n');
+
+            while (end - iterator >= 16)
+            {
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iterator));
+                const auto whitespaces = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                                                   _mm_cmpeq_epi8(chunk, tab)),
+                                                      _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn),
+                                                                   _mm_cmpeq_epi8(chunk, lineFeed)));
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(whitespaces)) ^ 0xFFFFU;
+                if (mask) return iterator + countTrailingZeros(mask);
+                iterator += 16;
+            }
+#endif
+            while (iterator != end && isWhitespace(*iterator)) ++iterator;
+            return iterator;
+        }
+
+        inline bool isStringSpecial(char c) noexcept
+        {
+            return c == '"' || c == '\\' || static_cast<std::uint8_t>(c) <= 0x1F;
+        }
+
+        // finds the closing quote, an escape sequence or a control character
+        inline const char* findStringSpecial(const char* iterator, const char* end) noexcept
+        {
+#if defined(__SSE2__)
+            const auto quote = _mm_set1_epi8('"');
+            const auto backslash = _mm_set1_epi8('\\');
+            const auto control = _mm_set1_epi8(0x1F);
+
+            while (end - iterator >= 16)
+            {
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iterator));
+                const auto special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                               _mm_cmpeq_epi8(chunk, backslash)),
+                                                  _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+                const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(special));
+                if (mask) return iterator + countTrailingZeros(mask);
+                iterator += 16;
+            }
+#endif
+            while (iterator != end && !isStringSpecial(*iterator)) ++iterator;
+            return iterator;
+        }
+
+        inline void encodeUtf8(char32_t c, std::string& result)
+        {
+            if (c <= 0x7F)
+                result.push_back(static_cast<char>(c));
+            else if (c <= 0x7FF)
+            {
+                result.push_back(static_cast<char>(0xC0 | ((c >> 6) & 0x1F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else if (c <= 0xFFFF)
+            {
+                result.push_back(static_cast<char>(0xE0 | ((c >> 12) & 0x0F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+            else
+            {
+                result.push_back(static_cast<char>(0xF0 | ((c >> 18) & 0x07)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+                result.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+            }
+        }
+
+        template <class Handler>
+        class Reader final
+        {
+        public:
+            Reader(std::string_view data, Handler& initHandler) noexcept:
+                iterator{data.data()},
+                end{data.data() + data.size()},
+                handler{initHandler}
+            {
+            }
+
+            void read()
+            {
+                if (end - iterator >= 3 &&
+                    static_cast<std::uint8_t>(iterator[0]) == utf8ByteOrderMark[0] &&
+                    static_cast<std::uint8_t>(iterator[1]) == utf8ByteOrderMark[1] &&
+                    static_cast<std::uint8_t>(iterator[2]) == utf8ByteOrderMark[2])
+                    iterator += 3;
+
+                parseValue(0);
+
+                if (skipWhitespaces(iterator, end) != end)
+                    throw ParseError("Unexpected data");
+            }
+
+        private:
+            void parseValue(std::size_t depth)
+            {
+                iterator = skipWhitespaces(iterator, end);
+
+                if (iterator == end)
+                    throw ParseError("Unexpected end of data");
+
+                switch (*iterator)
+                {
+                    case '{':
+                        if (depth == maxDepth) throw ParseError("Too deep nesting");
+                        parseObject(depth + 1);
+                        break;
+                    case '[':
+                        if (depth == maxDepth) throw ParseError("Too deep nesting");
+                        parseArray(depth + 1);
+                        break;
+                    case '"':
+                        handler.string(parseString());
+                        break;
+                    case 't':
+                        parseLiteral("true");
+                        handler.boolean(true);
+                        break;
+                    case 'f':
+                        parseLiteral("false");
+                        handler.boolean(false);
+                        break;
+                    case 'n':
+                        parseLiteral("null");
+                        handler.null();
+                        break;
+                    default:
+                        if (*iterator == '-' || (*iterator >= '0' && *iterator <= '9'))
+                            parseNumber();
+                        else
+                            throw ParseError("Unexpected identifier");
+                }
+            }
+
+            void parseObject(std::size_t depth)
+            {
+                ++iterator; // skip the opening brace
+                handler.startObject();
+
+                iterator = skipWhitespaces(iterator, end);
+                if (iterator != end && *iterator == '}')
+                {
+                    ++iterator;
+                    handler.endObject();
+                    return;
+                }
+
+                for (;;)
+                {
+                    iterator = skipWhitespaces(iterator, end);
+                    handler.key(parseString());
+
+                    iterator = skipWhitespaces(iterator, end);
+                    if (iterator == end || *iterator++ != ':')
+                        throw ParseError("Invalid object");
+
+                    parseValue(depth);
+
+                    iterator = skipWhitespaces(iterator, end);
+                    if (iterator == end)
+                        throw ParseError("Invalid object");
+
+                    const auto c = *iterator++;
+                    if (c == '}') break;
+                    if (c != ',') throw ParseError("Invalid object");
+                }
+
+                handler.endObject();
+            }
+
+            void parseArray(std::size_t depth)
+            {
+                ++iterator; // skip the opening bracket
+                handler.startArray();
+
+                iterator = skipWhitespaces(iterator, end);
+                if (iterator != end && *iterator == ']')
+                {
+                    ++iterator;
+                    handler.endArray();
+                    return;
+                }
+
+                for (;;)
+                {
+                    parseValue(depth);
+
+                    iterator = skipWhitespaces(iterator, end);
+                    if (iterator == end)
+                        throw ParseError("Invalid array");
+
+                    const auto c = *iterator++;
+                    if (c == ']') break;
+                    if (c != ',') throw ParseError("Invalid array");
+                }
+
+                handler.endArray();
+            }
+
+            // strings without escape sequences are returned as views of the data
+            std::string_view parseString()
+            {
+                if (iterator == end || *iterator != '"')
+                    throw ParseError("Invalid string");
+
+                const char* start = ++iterator;
+                iterator = findStringSpecial(iterator, end);
+
+                if (iterator != end && *iterator == '"')
+                    return std::string_view{start, static_cast<std::size_t>(iterator++ - start)};
+
+                buffer.assign(start, iterator);
+
+                for (;;)
+                {
+                    if (iterator == end)
+                        throw ParseError("Unterminated string literal");
+
+                    const auto c = *iterator++;
+
+                    if (c == '"')
+                        return buffer;
+                    else if (c == '\\')
+                        parseEscapeSequence();
+                    else if (static_cast<std::uint8_t>(c) <= 0x1F) // control char
+                        throw ParseError("Unterminated string literal");
+                    else
+                        buffer.push_back(c);
+
+                    const auto next = findStringSpecial(iterator, end);
+                    buffer.append(iterator, next);
+                    iterator = next;
+                }
+            }
+
+            void parseEscapeSequence()
+            {
+                if (iterator == end)
+                    throw ParseError("Unterminated string literal");
+
+                switch (*iterator++)
+                {
+                    case '"': buffer.push_back('"'); break;
+                    case '\\': buffer.push_back('\\'); break;
+                    case '/': buffer.push_back('/'); break;
+                    case 'b': buffer.push_back('\b'); break;
+                    case 'f': buffer.push_back('\f'); break;
+                    case 'n': buffer.push_back('\n'); break;
+                    case 'r': buffer.push_back('\r'); break;
+                    case 't': buffer.push_back('\t'); break;
+                    case 'u':
+                    {
+                        char32_t c = parseCodeUnit();
+
+                        // characters outside of the BMP are encoded as surrogate pairs
+                        if (c >= 0xD800 && c <= 0xDBFF &&
+                            end - iterator >= 6 && iterator[0] == '\\' && iterator[1] == 'u')
+                        {
+                            iterator += 2;
+                            const char32_t low = parseCodeUnit();
+                            if (low < 0xDC00 || low > 0xDFFF)
+                                throw ParseError("Invalid surrogate pair");
+                            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                        }
+
+                        encodeUtf8(c, buffer);
+                        break;
+                    }
+                    default:
+                        throw ParseError("Unrecognized escape character");
+                }
+            }
+
+            char32_t parseCodeUnit()
+            {
+                if (end - iterator < 4)
+                    throw ParseError("Unexpected end of data");
+
+                char32_t result = 0;
+                for (std::uint32_t i = 0; i < 4; ++i, ++iterator)
+                {
+                    const auto c = *iterator;
+                    std::uint8_t code = 0;
+
+                    if (c >= '0' && c <= '9')
+                        code = static_cast<std::uint8_t>(c - '0');
+                    else if (c >= 'a' && c <= 'f')
+                        code = static_cast<std::uint8_t>(c - 'a' + 10);
+                    else if (c >= 'A' && c <= 'F')
+                        code = static_cast<std::uint8_t>(c - 'A' + 10);
+                    else
+                        throw ParseError("Invalid character code");
+
+                    result = (result << 4) | code;
+                }
+
+                return result;
+            }
+
+            void parseNumber()
+            {
+                const char* start = iterator;
+                const bool negative = *iterator == '-';
+                if (negative) ++iterator;
+
+                if (iterator == end || *iterator < '0' || *iterator > '9')
+                    throw ParseError("Invalid number");
+
+                // up to 19 digits fit in the mantissa, longer numbers are converted by the standard library
+                std::uint64_t mantissa = 0;
+                std::uint32_t digits = 0;
+                std::int32_t exponent = 0;
+                bool floatingPoint = false;
+
+                for (; iterator != end && *iterator >= '0' && *iterator <= '9'; ++iterator)
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*iterator - '0');
+                        if (mantissa) ++digits;
+                    }
+                    else
+                        ++exponent;
+
+                if (iterator != end && *iterator == '.')
+                {
+                    floatingPoint = true;
+
+                    if (++iterator == end || *iterator < '0' || *iterator > '9')
+                        throw ParseError("Invalid number");
+
+                    for (; iterator != end && *iterator >= '0' && *iterator <= '9'; ++iterator)
+                        if (digits < 19)
+                        {
+                            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*iterator - '0');
+                            if (mantissa) ++digits;
+                            --exponent;
+                        }
+                }
+
+                if (iterator != end && (*iterator == 'e' || *iterator == 'E'))
+                {
+                    floatingPoint = true;
+
+                    if (++iterator == end)
+                        throw ParseError("Invalid exponent");
+
+                    const bool negativeExponent = *iterator == '-';
+                    if (*iterator == '+' || *iterator == '-') ++iterator;
+
+                    if (iterator == end || *iterator < '0' || *iterator > '9')
+                        throw ParseError("Invalid exponent");
+
+                    std::int32_t explicitExponent = 0;
+                    for (; iterator != end && *iterator >= '0' && *iterator <= '9'; ++iterator)
+                        if (explicitExponent < 100000)
+                            explicitExponent = explicitExponent * 10 + (*iterator - '0');
+
+                    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+                }
+
+                if (!floatingPoint && exponent == 0 &&
+                    mantissa <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+                {
+                    const auto value = static_cast<std::int64_t>(mantissa);
+                    handler.integer(negative ? -value : value);
+                    return;
+                }
+
+                // the mantissa and the power of ten are exact, so the result is correctly rounded
+                constexpr double powersOfTen[] = {
+                    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+                };
+
+                double value;
+                if (mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+                {
+                    value = static_cast<double>(mantissa);
+                    value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+                    if (negative) value = -value;
+                }
+                else
+                    value = std::stod(std::string(start, iterator));
+
+                handler.floatingPoint(value);
+            }
+
+            void parseLiteral(std::string_view literal)
+            {
+                if (static_cast<std::size_t>(end - iterator) < literal.size() ||
+                    std::string_view{iterator, literal.size()} != literal)
+                    throw ParseError("Unexpected identifier");
+
+                iterator += literal.size();
+            }
+
+            const char* iterator;
+            const char* end;
+            Handler& handler;
+            std::string buffer; // for strings with escape sequences
+        };
+    }
+
+    // Event based parser, the handler is called for every value:
+    // null(), boolean(bool), integer(std::int64_t), floatingPoint(double), string(std::string_view),
+    // startObject(), key(std::string_view), endObject(), startArray(), endArray()
+    // the string views point to the data or, if the string has escape sequences, to a temporary buffer
+    // that is valid only during the call
+    template <class Handler>
+    void read(std::string_view data, Handler& handler)
+    {
+        Reader<Handler> reader(data, handler);
+        reader.read();
+    }
+
+    class Member;
+
+    // Read-only value of a Document, strings point to the parsed data or to the arena of the document
+    class Node final
+    {
+        friend class Document;
+    public:
+        using Type = Value::Type;
+
+        Node() noexcept = default;
+
+        auto getType() const noexcept { return type; }
+
+        bool isNull() const noexcept
+        {
+            return type == Type::null;
+        }
+
+        template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+        T as() const
+        {
+            if (type == Type::floatingPoint) return static_cast<T>(doubleValue);
+            if (type == Type::integer) return static_cast<T>(intValue);
+            throw TypeError("Wrong type");
+        }
+
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type* = nullptr>
+        T as() const
+        {
+            if (type == Type::integer) return static_cast<T>(intValue);
+            if (type == Type::floatingPoint) return static_cast<T>(doubleValue);
+            throw TypeError("Wrong type");
+        }
+
+        template <typename T, typename std::enable_if<std::is_same<T, bool>::value>::type* = nullptr>
+        T as() const
+        {
+            if (type == Type::boolean) return boolValue;
+            if (type == Type::integer) return intValue != 0;
+            if (type == Type::floatingPoint) return doubleValue != 0.0;
+            throw TypeError("Wrong type");
+        }
+
+        template <typename T, typename std::enable_if<std::is_same<T, std::string_view>::value>::type* = nullptr>
+        T as() const
+        {
+            if (type != Type::string) throw TypeError("Wrong type");
+            return std::string_view{stringValue, size};
+        }
+
+        template <typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+        T as() const
+        {
+            if (type != Type::string) throw TypeError("Wrong type");
+            return std::string{stringValue, size};
+        }
+
+        std::size_t getSize() const
+        {
+            if (type != Type::array && type != Type::object) throw TypeError("Wrong type");
+            return size;
+        }
+
+        const Node* begin() const
+        {
+            if (type != Type::array) throw TypeError("Wrong type");
+            return elements;
+        }
+
+        const Node* end() const
+        {
+            if (type != Type::array) throw TypeError("Wrong type");
+            return elements + size;
+        }
+
+        const Member* beginMembers() const
+        {
+            if (type != Type::object) throw TypeError("Wrong type");
+            return members;
+        }
+
+        const Member* endMembers() const;
+
+        // members are searched linearly, objects in asset files are small
+        const Node* findMember(std::string_view name) const;
+
+        bool hasMember(std::string_view name) const
+        {
+            return findMember(name) != nullptr;
+        }
+
+        const Node& operator[](std::string_view name) const
+        {
+            if (const auto node = findMember(name)) return *node;
+            throw RangeError("Member does not exist");
+        }
+
+        const Node& operator[](std::size_t index) const
+        {
+            if (type != Type::array) throw TypeError("Wrong type");
+            if (index >= size) throw RangeError("Index out of range");
+            return elements[index];
+        }
+
+    private:
+        Type type = Type::null;
+        std::size_t size = 0;
+        union
+        {
+            bool boolValue = false;
+            std::int64_t intValue;
+            double doubleValue;
+            const char* stringValue;
+            const Node* elements;
+            const Member* members;
+        };
+    };
+
+    class Member final
+    {
+    public:
+        std::string_view name;
+        Node value;
+    };
+
+    inline const Member* Node::endMembers() const
+    {
+        if (type != Type::object) throw TypeError("Wrong type");
+        return members + size;
+    }
+
+    inline const Node* Node::findMember(std::string_view name) const
+    {
+        if (type != Type::object) throw TypeError("Wrong type");
+
+        for (auto member = members; member != members + size; ++member)
+            if (member->name == name)
+                return &member->value;
+
+        return nullptr;
+    }
+
+    // DOM that is allocated in large blocks and refers to the parsed data instead of copying the strings,
+    // so the data must outlive the document
+    class Document final
+    {
+    public:
+        explicit Document(std::string_view initData)
+        {
+            // local class has the same access to Node as the constructor
+            class Builder final
+            {
+            public:
+                Builder(Document& initDocument, std::string_view initData) noexcept:
+                    document{initDocument}, data{initData}
+                {
+                }
+
+                void null() { addValue(Node{}); }
+
+                void boolean(bool value)
+                {
+                    Node node;
+                    node.type = Node::Type::boolean;
+                    node.boolValue = value;
+                    addValue(node);
+                }
+
+                void integer(std::int64_t value)
+                {
+                    Node node;
+                    node.type = Node::Type::integer;
+                    node.intValue = value;
+                    addValue(node);
+                }
+
+                void floatingPoint(double value)
+                {
+                    Node node;
+                    node.type = Node::Type::floatingPoint;
+                    node.doubleValue = value;
+                    addValue(node);
+                }
+
+                void string(std::string_view value)
+                {
+                    Node node;
+                    node.type = Node::Type::string;
+                    node.stringValue = store(value).data();
+                    node.size = value.size();
+                    addValue(node);
+                }
+
+                void key(std::string_view name) { currentKey = store(name); }
+
+                void startObject() { containers.push_back(Container{currentKey, values.size()}); }
+                void startArray() { containers.push_back(Container{currentKey, values.size()}); }
+
+                void endObject()
+                {
+                    const auto container = containers.back();
+                    containers.pop_back();
+
+                    const auto count = values.size() - container.start;
+                    const auto members = document.allocate<Member>(count);
+                    std::copy(values.begin() + static_cast<std::ptrdiff_t>(container.start), values.end(), members);
+                    values.resize(container.start);
+
+                    Node node;
+                    node.type = Node::Type::object;
+                    node.members = members;
+                    node.size = count;
+                    currentKey = container.key;
+                    addValue(node);
+                }
+
+                void endArray()
+                {
+                    const auto container = containers.back();
+                    containers.pop_back();
+
+                    const auto count = values.size() - container.start;
+                    const auto elements = document.allocate<Node>(count);
+                    for (std::size_t i = 0; i < count; ++i)
+                        elements[i] = values[container.start + i].value;
+                    values.resize(container.start);
+
+                    Node node;
+                    node.type = Node::Type::array;
+                    node.elements = elements;
+                    node.size = count;
+                    currentKey = container.key;
+                    addValue(node);
+                }
+
+            private:
+                // escaped strings are in the temporary buffer of the reader
+                std::string_view store(std::string_view value)
+                {
+                    if (value.data() >= data.data() && value.data() + value.size() <= data.data() + data.size())
+                        return value;
+
+                    const auto copy = document.allocate<char>(value.size());
+                    std::copy(value.begin(), value.end(), copy);
+                    return std::string_view{copy, value.size()};
+                }
+
+                void addValue(const Node& node)
+                {
+                    if (containers.empty())
+                        document.root = node;
+                    else
+                        values.push_back(Member{currentKey, node});
+                }
+
+                struct Container final
+                {
+                    std::string_view key;
+                    std::size_t start;
+                };
+
+                Document& document;
+                std::string_view data;
+                std::string_view currentKey;
+                std::vector<Container> containers;
+                std::vector<Member> values; // members or elements of the open containers
+            };
+
+            Builder builder(*this, initData);
+            read(initData, builder);
+        }
+
+        Document(const char* data, std::size_t size):
+            Document{std::string_view{data, size}}
+        {
+        }
+
+        const Node& getRoot() const noexcept { return root; }
+
+        auto getMemoryUsage() const noexcept { return allocatedSize; }
+
+    private:
+        template <class T>
+        T* allocate(std::size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>);
+
+            if (count == 0) return nullptr;
+
+            const auto size = sizeof(T) * count;
+            auto offset = (blockOffset + alignof(T) - 1) & ~(alignof(T) - 1);
+
+            if (blocks.empty() || offset + size > blockSize)
+            {
+                blockSize = std::max(size, std::clamp(blockSize * 2, std::size_t(4096), std::size_t(1048576)));
+                blocks.push_back(std::make_unique<std::byte[]>(blockSize));
+                allocatedSize += blockSize;
+                offset = 0;
+            }
+
+            blockOffset = offset + size;
+            auto result = reinterpret_cast<T*>(blocks.back().get() + offset);
+            std::uninitialized_default_construct_n(result, count);
+            return result;
+        }
+
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        std::size_t blockSize = 0;
+        std::size_t blockOffset = 0;
+        std::size_t allocatedSize = 0;
+        Node root;
+    };
+}
+
+#endif // OUZEL_FORMATS_JSONDOCUMENT_HPP
@@ -3,12 +3,17 @@
 #ifndef OUZEL_FORMATS_OBF_HPP
 #define OUZEL_FORMATS_OBF_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 #include "../utils/Utils.hpp"
 
@@ -313,105 +318,60 @@ namespace ouzel::obf
 
         std::uint32_t encode(std::vector<std::uint8_t>& buffer) const
         {
-            std::uint32_t size = 0;
+            const auto offset = buffer.size();
+            buffer.reserve(offset + getEncodedSize());
+            write(buffer);
 
-            std::uint32_t ret = 0;
+            return static_cast<std::uint32_t>(buffer.size() - offset);
+        }
+
+        std::vector<std::uint8_t> encode() const
+        {
+            std::vector<std::uint8_t> result;
+            encode(result);
+            return result;
+        }
 
+        // exact size of the encoded value, can be used to reserve the buffer when encoding multiple values
+        std::size_t getEncodedSize() const
+        {
             switch (type)
             {
                 case Type::integer:
-                {
-                    if (intValue > std::numeric_limits<std::uint32_t>::max())
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::int64));
-                        size += 1;
-                        ret = writeInt64(buffer, intValue);
-                    }
-                    else if (intValue > std::numeric_limits<std::uint16_t>::max())
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::int32));
-                        size += 1;
-                        ret = writeInt32(buffer, static_cast<std::uint32_t>(intValue));
-                    }
-                    else if (intValue > std::numeric_limits<std::uint8_t>::max())
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::int16));
-                        size += 1;
-                        ret = writeInt16(buffer, static_cast<std::uint16_t>(intValue));
-                    }
-                    else
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::int8));
-                        size += 1;
-                        ret = writeInt8(buffer, static_cast<std::uint8_t>(intValue));
-                    }
-                    break;
-                }
+                    return 1 + getIntSize(intValue);
                 case Type::floatingPoint:
-                {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::floatingPoint));
-                    size += 1;
-                    ret = writeFloat(buffer, static_cast<float>(doubleValue));
-                    break;
-                }
+                    return 1 + sizeof(float);
                 case Type::doublePrecision:
-                {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::doublePrecision));
-                    size += 1;
-                    ret = writeDouble(buffer, doubleValue);
-                    break;
-                }
+                    return 1 + sizeof(double);
                 case Type::string:
-                {
-                    if (stringValue.length() > std::numeric_limits<std::uint16_t>::max())
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::longString));
-                        size += 1;
-                        ret = writeLongString(buffer, stringValue);
-                    }
-                    else
-                    {
-                        buffer.push_back(static_cast<std::uint8_t>(Marker::string));
-                        size += 1;
-                        ret = writeString(buffer, stringValue);
-                    }
-                    break;
-                }
+                    return 1 + (stringValue.length() > std::numeric_limits<std::uint16_t>::max() ?
+                                sizeof(std::uint32_t) : sizeof(std::uint16_t)) + stringValue.length();
                 case Type::byteArray:
-                {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::byteArray));
-                    size += 1;
-                    ret = writeByteArray(buffer, byteArrayValue);
-                    break;
-                }
+                    return 1 + sizeof(std::uint32_t) + byteArrayValue.size();
                 case Type::object:
                 {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::object));
-                    size += 1;
-                    ret = writeObject(buffer, objectValue);
-                    break;
+                    std::size_t size = 1 + sizeof(std::uint32_t);
+                    for (const auto& i : objectValue)
+                        size += sizeof(std::uint32_t) + i.second.getEncodedSize();
+                    return size;
                 }
                 case Type::array:
                 {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::array));
-                    size += 1;
-                    ret = writeArray(buffer, arrayValue);
-                    break;
+                    std::size_t size = 1 + sizeof(std::uint32_t);
+                    for (const auto& i : arrayValue)
+                        size += i.getEncodedSize();
+                    return size;
                 }
                 case Type::dictionary:
                 {
-                    buffer.push_back(static_cast<std::uint8_t>(Marker::dictionary));
-                    size += 1;
-                    ret = writeDictionary(buffer, dictionaryValue);
-                    break;
+                    std::size_t size = 1 + sizeof(std::uint32_t);
+                    for (const auto& i : dictionaryValue)
+                        size += sizeof(std::uint16_t) + i.first.length() + i.second.getEncodedSize();
+                    return size;
                 }
                 default:
                     throw std::runtime_error("Unsupported type");
             }
-
-            size += ret;
-
-            return size;
         }
 
         bool operator!()
@@ -866,206 +826,593 @@ namespace ouzel::obf
         }
 
         // writing
-        static std::uint32_t writeInt8(std::vector<std::uint8_t>& buffer, std::uint8_t value)
+        static std::size_t getIntSize(std::uint64_t value) noexcept
         {
-            buffer.push_back(value);
+            return (value > std::numeric_limits<std::uint32_t>::max()) ? sizeof(std::uint64_t) :
+                (value > std::numeric_limits<std::uint16_t>::max()) ? sizeof(std::uint32_t) :
+                (value > std::numeric_limits<std::uint8_t>::max()) ? sizeof(std::uint16_t) :
+                sizeof(std::uint8_t);
+        }
 
-            return sizeof(value);
+        // the capacity is reserved by encode, so appending does not reallocate
+        static std::uint8_t* append(std::vector<std::uint8_t>& buffer, std::size_t count)
+        {
+            const auto offset = buffer.size();
+            buffer.resize(offset + count);
+            return buffer.data() + offset;
         }
 
-        static std::uint32_t writeInt16(std::vector<std::uint8_t>& buffer, std::uint16_t value)
+        template <typename T>
+        static void writeInt(std::vector<std::uint8_t>& buffer, T value)
         {
-            std::uint8_t data[sizeof(value)];
+            encodeBigEndian<T>(append(buffer, sizeof(value)), value);
+        }
 
-            encodeBigEndian<std::uint16_t>(data, value);
+        static void writeHeader(std::vector<std::uint8_t>& buffer, Marker marker)
+        {
+            *append(buffer, 1) = static_cast<std::uint8_t>(marker);
+        }
 
-            buffer.insert(buffer.end(), std::begin(data), std::end(data));
+        template <typename T>
+        static void writeHeader(std::vector<std::uint8_t>& buffer, Marker marker, T value)
+        {
+            const auto output = append(buffer, 1 + sizeof(value));
+            *output = static_cast<std::uint8_t>(marker);
+            encodeBigEndian<T>(output + 1, value);
+        }
 
-            return sizeof(value);
+        static void writeBytes(std::vector<std::uint8_t>& buffer, const void* data, std::size_t count)
+        {
+            if (count) std::memcpy(append(buffer, count), data, count);
         }
 
-        static std::uint32_t writeInt32(std::vector<std::uint8_t>& buffer, std::uint32_t value)
+        void write(std::vector<std::uint8_t>& buffer) const
         {
-            std::uint8_t data[sizeof(value)];
+            switch (type)
+            {
+                case Type::integer:
+                {
+                    switch (getIntSize(intValue))
+                    {
+                        case sizeof(std::uint64_t):
+                            writeHeader<std::uint64_t>(buffer, Marker::int64, intValue);
+                            break;
+                        case sizeof(std::uint32_t):
+                            writeHeader<std::uint32_t>(buffer, Marker::int32, static_cast<std::uint32_t>(intValue));
+                            break;
+                        case sizeof(std::uint16_t):
+                            writeHeader<std::uint16_t>(buffer, Marker::int16, static_cast<std::uint16_t>(intValue));
+                            break;
+                        default:
+                            writeHeader<std::uint8_t>(buffer, Marker::int8, static_cast<std::uint8_t>(intValue));
+                            break;
+                    }
+                    break;
+                }
+                case Type::floatingPoint:
+                {
+                    const auto floatValue = static_cast<float>(doubleValue);
+                    writeHeader(buffer, Marker::floatingPoint);
+                    writeBytes(buffer, &floatValue, sizeof(floatValue));
+                    break;
+                }
+                case Type::doublePrecision:
+                    writeHeader(buffer, Marker::doublePrecision);
+                    writeBytes(buffer, &doubleValue, sizeof(doubleValue));
+                    break;
+                case Type::string:
+                {
+                    if (stringValue.length() > std::numeric_limits<std::uint16_t>::max())
+                        writeHeader<std::uint32_t>(buffer, Marker::longString,
+                                                   static_cast<std::uint32_t>(stringValue.length()));
+                    else
+                        writeHeader<std::uint16_t>(buffer, Marker::string,
+                                                   static_cast<std::uint16_t>(stringValue.length()));
 
-            encodeBigEndian<std::uint32_t>(data, value);
+                    writeBytes(buffer, stringValue.data(), stringValue.length());
+                    break;
+                }
+                case Type::byteArray:
+                    writeHeader<std::uint32_t>(buffer, Marker::byteArray,
+                                               static_cast<std::uint32_t>(byteArrayValue.size()));
+                    writeBytes(buffer, byteArrayValue.data(), byteArrayValue.size());
+                    break;
+                case Type::object:
+                {
+                    writeHeader<std::uint32_t>(buffer, Marker::object,
+                                               static_cast<std::uint32_t>(objectValue.size()));
 
-            buffer.insert(buffer.end(), std::begin(data), std::end(data));
+                    for (const auto& i : objectValue)
+                    {
+                        writeInt<std::uint32_t>(buffer, i.first);
+                        i.second.write(buffer);
+                    }
+                    break;
+                }
+                case Type::array:
+                {
+                    writeHeader<std::uint32_t>(buffer, Marker::array,
+                                               static_cast<std::uint32_t>(arrayValue.size()));
+
+                    for (const auto& i : arrayValue)
+                        i.write(buffer);
+                    break;
+                }
+                case Type::dictionary:
+                {
+                    writeHeader<std::uint32_t>(buffer, Marker::dictionary,
+                                               static_cast<std::uint32_t>(dictionaryValue.size()));
 
-            return sizeof(value);
+                    for (const auto& i : dictionaryValue)
+                    {
+                        writeInt<std::uint16_t>(buffer, static_cast<std::uint16_t>(i.first.length()));
+                        writeBytes(buffer, i.first.data(), i.first.length());
+                        i.second.write(buffer);
+                    }
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Unsupported type");
+            }
         }
 
-        static std::uint32_t writeInt64(std::vector<std::uint8_t>& buffer, std::uint64_t value)
+        Type type = Type::object;
+        union
         {
-            std::uint8_t data[sizeof(value)];
+            std::uint64_t intValue = 0;
+            double doubleValue;
+        };
+        std::string stringValue;
+        ByteArray byteArrayValue;
+        Object objectValue;
+        Array arrayValue;
+        Dictionary dictionaryValue;
+    };
 
-            encodeBigEndian<std::uint64_t>(data, value);
+    // Lazily decoded value that points to the encoded data, the data must outlive the view
+    class View final
+    {
+    public:
+        using Type = Value::Type;
+        using Marker = Value::Marker;
 
-            buffer.insert(buffer.end(), std::begin(data), std::end(data));
+        class ByteArray final
+        {
+        public:
+            ByteArray(const std::uint8_t* initData, std::size_t initSize) noexcept:
+                pointer{initData}, length{initSize}
+            {
+            }
 
-            return sizeof(value);
-        }
+            auto data() const noexcept { return pointer; }
+            auto size() const noexcept { return length; }
+
+            auto begin() const noexcept { return pointer; }
+            auto end() const noexcept { return pointer + length; }
 
-        static std::uint32_t writeFloat(std::vector<std::uint8_t>& buffer, float value)
+        private:
+            const std::uint8_t* pointer;
+            std::size_t length;
+        };
+
+        class Iterator final
         {
-            buffer.insert(buffer.end(),
-                          reinterpret_cast<const std::uint8_t*>(&value),
-                          reinterpret_cast<const std::uint8_t*>(&value) + sizeof(value));
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = View;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const View*;
+            using reference = View;
 
-            return sizeof(float);
-        }
+            Iterator(const std::uint8_t* initPosition, const std::uint8_t* initEnd, std::uint32_t initRemaining) noexcept:
+                position{initPosition}, bufferEnd{initEnd}, remaining{initRemaining}
+            {
+            }
+
+            View operator*() const { return View{position, bufferEnd}; }
 
-        static std::uint32_t writeDouble(std::vector<std::uint8_t>& buffer, double value)
+            Iterator& operator++()
+            {
+                position += View{position, bufferEnd}.getEncodedSize();
+                --remaining;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const noexcept { return remaining == other.remaining; }
+            bool operator!=(const Iterator& other) const noexcept { return remaining != other.remaining; }
+
+        private:
+            const std::uint8_t* position;
+            const std::uint8_t* bufferEnd;
+            std::uint32_t remaining;
+        };
+
+        View(const std::uint8_t* initData, std::size_t initSize):
+            View{initData, initData + initSize}
         {
-            buffer.insert(buffer.end(),
-                          reinterpret_cast<const std::uint8_t*>(&value),
-                          reinterpret_cast<const std::uint8_t*>(&value) + sizeof(value));
+        }
 
-            return sizeof(double);
+        explicit View(const std::vector<std::uint8_t>& data):
+            View{data.data(), data.data() + data.size()}
+        {
         }
 
-        static std::uint32_t writeString(std::vector<std::uint8_t>& buffer,
-                                         const std::string& value)
+        Type getType() const
         {
-            std::uint8_t lengthData[sizeof(std::uint16_t)];
+            switch (getMarker())
+            {
+                case Marker::int8:
+                case Marker::int16:
+                case Marker::int32:
+                case Marker::int64:
+                    return Type::integer;
+                case Marker::floatingPoint:
+                    return Type::floatingPoint;
+                case Marker::doublePrecision:
+                    return Type::doublePrecision;
+                case Marker::string:
+                case Marker::longString:
+                    return Type::string;
+                case Marker::byteArray:
+                    return Type::byteArray;
+                case Marker::object:
+                    return Type::object;
+                case Marker::array:
+                    return Type::array;
+                case Marker::dictionary:
+                    return Type::dictionary;
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
+        }
 
-            encodeBigEndian<std::uint16_t>(lengthData, static_cast<std::uint16_t>(value.length()));
+        template <typename T, typename std::enable_if<std::is_integral<T>::value>::type* = nullptr>
+        T as() const
+        {
+            switch (getMarker())
+            {
+                case Marker::int8: return static_cast<T>(readInt<std::uint8_t>(1));
+                case Marker::int16: return static_cast<T>(readInt<std::uint16_t>(1));
+                case Marker::int32: return static_cast<T>(readInt<std::uint32_t>(1));
+                case Marker::int64: return static_cast<T>(readInt<std::uint64_t>(1));
+                default: throw std::runtime_error("Wrong type");
+            }
+        }
 
-            buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
+        template <typename T, typename std::enable_if<std::is_floating_point<T>::value>::type* = nullptr>
+        T as() const
+        {
+            switch (getMarker())
+            {
+                case Marker::floatingPoint: return static_cast<T>(readValue<float>(1));
+                case Marker::doublePrecision: return static_cast<T>(readValue<double>(1));
+                default: throw std::runtime_error("Wrong type");
+            }
+        }
 
-            std::uint32_t size = sizeof(lengthData);
+        template <typename T, typename std::enable_if<std::is_same<T, std::string_view>::value>::type* = nullptr>
+        T as() const
+        {
+            const auto bytes = getBytes(Type::string);
+            return std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+        }
 
-            buffer.insert(buffer.end(),
-                          reinterpret_cast<const std::uint8_t*>(value.data()),
-                          reinterpret_cast<const std::uint8_t*>(value.data()) + value.length());
-            size += static_cast<std::uint32_t>(value.length());
+        template <typename T, typename std::enable_if<std::is_same<T, std::string>::value>::type* = nullptr>
+        T as() const
+        {
+            const auto bytes = getBytes(Type::string);
+            return std::string{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+        }
 
-            return size;
+        template <typename T, typename std::enable_if<std::is_same<T, ByteArray>::value>::type* = nullptr>
+        T as() const
+        {
+            return getBytes(Type::byteArray);
         }
 
-        static std::uint32_t writeLongString(std::vector<std::uint8_t>& buffer,
-                                             const std::string& value)
+        // number of elements of an object, an array or a dictionary
+        std::uint32_t getSize() const
         {
-            std::uint8_t lengthData[sizeof(std::uint32_t)];
+            const auto marker = getMarker();
+            if (marker != Marker::object && marker != Marker::array && marker != Marker::dictionary)
+                throw std::runtime_error("Wrong type");
 
-            encodeBigEndian<std::uint32_t>(lengthData, static_cast<std::uint32_t>(value.length()));
+            return readInt<std::uint32_t>(1);
+        }
 
-            buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
+        Iterator begin() const
+        {
+            if (getMarker() != Marker::array)
+                throw std::runtime_error("Wrong type");
 
-            std::uint32_t size = sizeof(lengthData);
+            return Iterator{buffer + 1 + sizeof(std::uint32_t), bufferEnd, readInt<std::uint32_t>(1)};
+        }
 
-            buffer.insert(buffer.end(),
-                          reinterpret_cast<const std::uint8_t*>(value.data()),
-                          reinterpret_cast<const std::uint8_t*>(value.data()) + value.length());
-            size += static_cast<std::uint32_t>(value.length());
+        Iterator end() const
+        {
+            if (getMarker() != Marker::array)
+                throw std::runtime_error("Wrong type");
 
-            return size;
+            return Iterator{nullptr, nullptr, 0};
         }
 
-        static std::uint32_t writeByteArray(std::vector<std::uint8_t>& buffer,
-                                            const ByteArray& value)
+        // elements are found by skipping over the preceding ones without decoding them
+        const std::uint8_t* findElement(std::uint32_t key) const
         {
-            std::uint8_t lengthData[sizeof(std::uint32_t)];
+            const auto marker = getMarker();
+            const auto count = getSize();
+            auto position = buffer + 1 + sizeof(std::uint32_t);
 
-            encodeBigEndian<std::uint32_t>(lengthData, static_cast<std::uint32_t>(value.size()));
+            if (marker == Marker::array)
+            {
+                if (key >= count) return nullptr;
 
-            buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
+                for (std::uint32_t i = 0; i < key; ++i)
+                    position += View{position, bufferEnd}.getEncodedSize();
 
-            std::uint32_t size = sizeof(lengthData);
+                return position;
+            }
+            else if (marker == Marker::object)
+            {
+                for (std::uint32_t i = 0; i < count; ++i)
+                {
+                    require(position, sizeof(std::uint32_t));
+                    const auto elementKey = decodeBigEndian<std::uint32_t>(position);
+                    position += sizeof(std::uint32_t);
 
-            buffer.insert(buffer.end(), value.begin(), value.end());
-            size += static_cast<std::uint32_t>(value.size());
+                    if (elementKey == key) return position;
+                    position += View{position, bufferEnd}.getEncodedSize();
+                }
 
-            return size;
+                return nullptr;
+            }
+            else
+                throw std::runtime_error("Wrong type");
         }
 
-        static std::uint32_t writeObject(std::vector<std::uint8_t>& buffer,
-                                         const Object& value)
+        const std::uint8_t* findElement(std::string_view key) const
         {
-            std::uint8_t lengthData[sizeof(std::uint32_t)];
+            if (getMarker() != Marker::dictionary)
+                throw std::runtime_error("Wrong type");
 
-            encodeBigEndian<std::uint32_t>(lengthData, static_cast<std::uint32_t>(value.size()));
+            const auto count = getSize();
+            auto position = buffer + 1 + sizeof(std::uint32_t);
 
-            buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
-
-            std::uint32_t size = sizeof(lengthData);
-
-            for (const auto& i : value)
+            for (std::uint32_t i = 0; i < count; ++i)
             {
-                std::uint8_t keyData[sizeof(std::uint32_t)];
+                require(position, sizeof(std::uint16_t));
+                const auto length = decodeBigEndian<std::uint16_t>(position);
+                position += sizeof(std::uint16_t);
 
-                encodeBigEndian<std::uint32_t>(keyData, i.first);
+                require(position, length);
+                const std::string_view elementKey{reinterpret_cast<const char*>(position), length};
+                position += length;
 
-                buffer.insert(buffer.end(), std::begin(keyData), std::end(keyData));
+                if (elementKey == key) return position;
+                position += View{position, bufferEnd}.getEncodedSize();
+            }
 
-                size += sizeof(keyData);
+            return nullptr;
+        }
 
-                size += i.second.encode(buffer);
-            }
+        bool hasElement(std::uint32_t key) const { return findElement(key) != nullptr; }
+        bool hasElement(std::string_view key) const { return findElement(key) != nullptr; }
 
-            return size;
+        View operator[](std::uint32_t key) const
+        {
+            if (const auto element = findElement(key)) return View{element, bufferEnd};
+            throw std::runtime_error("Element not found");
         }
 
-        static std::uint32_t writeArray(std::vector<std::uint8_t>& buffer,
-                                        const Array& value)
+        View operator[](std::string_view key) const
         {
-            std::uint8_t lengthData[sizeof(std::uint32_t)];
+            if (const auto element = findElement(key)) return View{element, bufferEnd};
+            throw std::runtime_error("Element not found");
+        }
 
-            encodeBigEndian<std::uint32_t>(lengthData, static_cast<std::uint32_t>(value.size()));
+        std::size_t getEncodedSize() const
+        {
+            switch (getMarker())
+            {
+                case Marker::int8: return require(1 + sizeof(std::uint8_t));
+                case Marker::int16: return require(1 + sizeof(std::uint16_t));
+                case Marker::int32: return require(1 + sizeof(std::uint32_t));
+                case Marker::int64: return require(1 + sizeof(std::uint64_t));
+                case Marker::floatingPoint: return require(1 + sizeof(float));
+                case Marker::doublePrecision: return require(1 + sizeof(double));
+                case Marker::string:
+                    return require(1 + sizeof(std::uint16_t) + readInt<std::uint16_t>(1));
+                case Marker::longString:
+                case Marker::byteArray:
+                    return require(1 + sizeof(std::uint32_t) + std::size_t(readInt<std::uint32_t>(1)));
+                case Marker::object:
+                case Marker::array:
+                {
+                    const bool object = getMarker() == Marker::object;
+                    const auto count = readInt<std::uint32_t>(1);
+                    auto position = buffer + 1 + sizeof(std::uint32_t);
 
-            buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        if (object)
+                        {
+                            require(position, sizeof(std::uint32_t));
+                            position += sizeof(std::uint32_t);
+                        }
+                        position += View{position, bufferEnd}.getEncodedSize();
+                    }
 
-            std::uint32_t size = sizeof(lengthData);
+                    return static_cast<std::size_t>(position - buffer);
+                }
+                case Marker::dictionary:
+                {
+                    const auto count = readInt<std::uint32_t>(1);
+                    auto position = buffer + 1 + sizeof(std::uint32_t);
 
-            for (const auto& i : value)
-                size += i.encode(buffer);
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        require(position, sizeof(std::uint16_t));
+                        const auto length = decodeBigEndian<std::uint16_t>(position);
+                        position += sizeof(std::uint16_t);
 
-            return size;
+                        require(position, length);
+                        position += length;
+                        position += View{position, bufferEnd}.getEncodedSize();
+                    }
+
+                    return static_cast<std::size_t>(position - buffer);
+                }
+                default:
+                    throw std::runtime_error("Unsupported marker");
+            }
         }
 
-        static std::uint32_t writeDictionary(std::vector<std::uint8_t>& buffer,
-                                             const Dictionary& value)
+        // copies the value and all its elements
+        Value decode() const
         {
-            std::uint8_t sizeData[sizeof(std::uint32_t)];
+            const std::uint8_t* end;
+            return decode(end);
+        }
 
-            encodeBigEndian<std::uint32_t>(sizeData, static_cast<std::uint32_t>(value.size()));
+    private:
+        // the elements are decoded in a single pass, the end of each one is where the next one starts
+        Value decode(const std::uint8_t*& end) const
+        {
+            switch (getType())
+            {
+                case Type::integer:
+                    end = buffer + getEncodedSize();
+                    return Value{as<std::uint64_t>()};
+                case Type::floatingPoint:
+                    end = buffer + getEncodedSize();
+                    return Value{as<float>()};
+                case Type::doublePrecision:
+                    end = buffer + getEncodedSize();
+                    return Value{as<double>()};
+                case Type::string:
+                    end = buffer + getEncodedSize();
+                    return Value{as<std::string>()};
+                case Type::byteArray:
+                {
+                    end = buffer + getEncodedSize();
+                    const auto bytes = as<ByteArray>();
+                    return Value{Value::ByteArray(bytes.begin(), bytes.end())};
+                }
+                case Type::object:
+                {
+                    Value result{Type::object};
+                    auto& object = result.as<Value::Object>();
+                    const auto count = getSize();
+                    auto position = buffer + 1 + sizeof(std::uint32_t);
 
-            buffer.insert(buffer.end(), std::begin(sizeData), std::end(sizeData));
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        require(position, sizeof(std::uint32_t));
+                        const auto key = decodeBigEndian<std::uint32_t>(position);
+                        position += sizeof(std::uint32_t);
 
-            std::uint32_t size = sizeof(sizeData);
+                        object[key] = View{position, bufferEnd}.decode(position);
+                    }
 
-            for (const auto& i : value)
-            {
-                std::uint8_t lengthData[sizeof(std::uint16_t)];
+                    end = position;
+                    return result;
+                }
+                case Type::array:
+                {
+                    Value result{Type::array};
+                    auto& array = result.as<Value::Array>();
+                    const auto count = getSize();
+                    auto position = buffer + 1 + sizeof(std::uint32_t);
+                    array.reserve(count);
 
-                encodeBigEndian<std::uint16_t>(lengthData, static_cast<std::uint16_t>(i.first.length()));
+                    for (std::uint32_t i = 0; i < count; ++i)
+                        array.push_back(View{position, bufferEnd}.decode(position));
 
-                buffer.insert(buffer.end(), std::begin(lengthData), std::end(lengthData));
+                    end = position;
+                    return result;
+                }
+                case Type::dictionary:
+                {
+                    Value result{Type::dictionary};
+                    auto& dictionary = result.as<Value::Dictionary>();
+                    const auto count = getSize();
+                    auto position = buffer + 1 + sizeof(std::uint32_t);
+
+                    for (std::uint32_t i = 0; i < count; ++i)
+                    {
+                        require(position, sizeof(std::uint16_t));
+                        const auto length = decodeBigEndian<std::uint16_t>(position);
+                        position += sizeof(std::uint16_t);
 
-                size += sizeof(lengthData);
+                        require(position, length);
+                        std::string key(reinterpret_cast<const char*>(position), length);
+                        position += length;
 
-                buffer.insert(buffer.end(),
-                              reinterpret_cast<const std::uint8_t*>(i.first.data()),
-                              reinterpret_cast<const std::uint8_t*>(i.first.data()) + i.first.length());
-                size += static_cast<std::uint32_t>(i.first.length());
+                        dictionary[key] = View{position, bufferEnd}.decode(position);
+                    }
 
-                size += i.second.encode(buffer);
+                    end = position;
+                    return result;
+                }
+                default:
+                    throw std::runtime_error("Unsupported type");
             }
+        }
+
+        View(const std::uint8_t* initData, const std::uint8_t* initEnd):
+            buffer{initData}, bufferEnd{initEnd}
+        {
+            require(buffer, 1);
+        }
 
+        Marker getMarker() const noexcept
+        {
+            return static_cast<Marker>(*buffer);
+        }
+
+        void require(const std::uint8_t* position, std::size_t size) const
+        {
+            if (position > bufferEnd || static_cast<std::size_t>(bufferEnd - position) < size)
+                throw std::runtime_error("Not enough data");
+        }
+
+        std::size_t require(std::size_t size) const
+        {
+            require(buffer, size);
             return size;
         }
 
-        Type type = Type::object;
-        union
+        template <typename T>
+        T readInt(std::size_t offset) const
         {
-            std::uint64_t intValue = 0;
-            double doubleValue;
-        };
-        std::string stringValue;
-        ByteArray byteArrayValue;
-        Object objectValue;
-        Array arrayValue;
-        Dictionary dictionaryValue;
+            require(buffer + offset, sizeof(T));
+            return decodeBigEndian<T>(buffer + offset);
+        }
+
+        template <typename T>
+        T readValue(std::size_t offset) const
+        {
+            require(buffer + offset, sizeof(T));
+            T result;
+            std::memcpy(&result, buffer + offset, sizeof(T));
+            return result;
+        }
+
+        ByteArray getBytes(Type expectedType) const
+        {
+            if (getType() != expectedType)
+                throw std::runtime_error("Wrong type");
+
+            const bool shortLength = getMarker() == Marker::string;
+            const std::size_t length = shortLength ? readInt<std::uint16_t>(1) : readInt<std::uint32_t>(1);
+            const std::size_t offset = 1 + (shortLength ? sizeof(std::uint16_t) : sizeof(std::uint32_t));
+
+            require(buffer + offset, length);
+            return ByteArray{buffer + offset, length};
+        }
+
+        const std::uint8_t* buffer;
+        const std::uint8_t* bufferEnd;
     };
 }
 
@@ -0,0 +1,630 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_FORMATS_XMLDOCUMENT_HPP
+#define OUZEL_FORMATS_XMLDOCUMENT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+#include "Xml.hpp"
+
+namespace ouzel::xml
+{
+    class Attribute final
+    {
+    public:
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // Pull parser, the caller asks for the next event and the views stay valid until the next call
+    // (names always point to the data, values point to the data or, if they have entities, to a buffer)
+    class Reader final
+    {
+    public:
+        enum class Event
+        {
+            startTag,
+            endTag,
+            text,
+            characterData,
+            comment,
+            processingInstruction,
+            endOfData
+        };
+
+        explicit Reader(std::string_view data, bool initPreserveWhitespaces = false) noexcept:
+            iterator{data.data()},
+            end{data.data() + data.size()},
+            preserveWhitespaces{initPreserveWhitespaces}
+        {
+            if (end - iterator >= 3 &&
+                static_cast<std::uint8_t>(iterator[0]) == utf8ByteOrderMark[0] &&
+                static_cast<std::uint8_t>(iterator[1]) == utf8ByteOrderMark[1] &&
+                static_cast<std::uint8_t>(iterator[2]) == utf8ByteOrderMark[2])
+                iterator += 3;
+        }
+
+        Event next()
+        {
+            value = {};
+            attributes.clear();
+            buffer.clear();
+
+            if (closePending)
+            {
+                closePending = false;
+                name = openTags.back();
+                openTags.pop_back();
+                return Event::endTag;
+            }
+
+            name = {};
+
+            if (!preserveWhitespaces) skipWhitespaces();
+
+            if (iterator == end)
+            {
+                if (!openTags.empty())
+                    throw ParseError("Unexpected end of data");
+
+                if (!rootTagFound)
+                    throw ParseError("No root tag found");
+
+                return Event::endOfData;
+            }
+
+            if (*iterator != '<')
+            {
+                value = parseText();
+                return Event::text;
+            }
+
+            if (end - iterator < 2)
+                throw ParseError("Unexpected end of data");
+
+            switch (iterator[1])
+            {
+                case '!': return parseDeclaration();
+                case '?': return parseProcessingInstruction();
+                case '/': return parseEndTag();
+                default: return parseStartTag();
+            }
+        }
+
+        auto getDepth() const noexcept { return openTags.size(); }
+        std::string_view getName() const noexcept { return name; }
+        std::string_view getValue() const noexcept { return value; }
+        const std::vector<Attribute>& getAttributes() const noexcept { return attributes; }
+
+    private:
+        static constexpr bool isWhitespace(char c) noexcept
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        // multibyte UTF-8 sequences are accepted in names without further validation
+        static constexpr bool isNameStartChar(char c) noexcept
+        {
+            return (c >= 'a' && c <= 'z') ||
+                (c >= 'A' && c <= 'Z') ||
+                c == ':' || c == '_' ||
+                static_cast<std::uint8_t>(c) >= 0x80;
+        }
+
+        static constexpr bool isNameChar(char c) noexcept
+        {
+            return isNameStartChar(c) ||
+                c == '-' || c == '.' ||
+                (c >= '0' && c <= '9');
+        }
+
+        bool startsWith(std::string_view prefix) const noexcept
+        {
+            return static_cast<std::size_t>(end - iterator) >= prefix.size() &&
+                std::string_view{iterator, prefix.size()} == prefix;
+        }
+
+        void skipWhitespaces() noexcept
+        {
+            while (iterator != end && isWhitespace(*iterator)) ++iterator;
+        }
+
+        void expect(char c, const char* error)
+        {
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            if (*iterator != c)
+                throw ParseError(error);
+
+            ++iterator;
+        }
+
+        std::string_view parseName()
+        {
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            if (!isNameStartChar(*iterator))
+                throw ParseError("Invalid name start");
+
+            const char* start = iterator;
+            while (iterator != end && isNameChar(*iterator)) ++iterator;
+
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            return std::string_view{start, static_cast<std::size_t>(iterator - start)};
+        }
+
+        void parseEntity()
+        {
+            const char* start = ++iterator; // skip the ampersand
+            while (iterator != end && *iterator != ';') ++iterator;
+
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            const std::string_view entity{start, static_cast<std::size_t>(iterator++ - start)};
+
+            if (entity == "quot") buffer.push_back('"');
+            else if (entity == "amp") buffer.push_back('&');
+            else if (entity == "apos") buffer.push_back('\'');
+            else if (entity == "lt") buffer.push_back('<');
+            else if (entity == "gt") buffer.push_back('>');
+            else if (entity.size() >= 2 && entity[0] == '#')
+            {
+                const bool hex = entity[1] == 'x';
+                if (hex && entity.size() == 2)
+                    throw ParseError("Invalid entity");
+
+                char32_t c = 0;
+                for (auto i = entity.begin() + (hex ? 2 : 1); i != entity.end(); ++i)
+                {
+                    std::uint32_t code = 0;
+
+                    if (*i >= '0' && *i <= '9')
+                        code = static_cast<std::uint32_t>(*i - '0');
+                    else if (hex && *i >= 'a' && *i <= 'f')
+                        code = static_cast<std::uint32_t>(*i - 'a' + 10);
+                    else if (hex && *i >= 'A' && *i <= 'F')
+                        code = static_cast<std::uint32_t>(*i - 'A' + 10);
+                    else
+                        throw ParseError("Invalid character code");
+
+                    c = hex ? (c << 4) | code : c * 10 + code;
+                    if (c > 0x10FFFF)
+                        throw ParseError("Invalid character code");
+                }
+
+                buffer += utf8::fromUtf32(c);
+            }
+            else
+                throw ParseError("Invalid entity");
+        }
+
+        // returns the offset in the buffer if the value had to be decoded
+        std::size_t parseString(std::string_view& result)
+        {
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            const auto quotes = *iterator;
+            if (quotes != '"' && quotes != '\'')
+                throw ParseError("Expected quotes");
+
+            const char* start = ++iterator;
+            while (iterator != end && *iterator != quotes && *iterator != '&') ++iterator;
+
+            if (iterator == end)
+                throw ParseError("Unexpected end of data");
+
+            if (*iterator == quotes)
+            {
+                result = std::string_view{start, static_cast<std::size_t>(iterator++ - start)};
+                return std::string::npos;
+            }
+
+            const auto offset = buffer.size();
+            buffer.append(start, iterator);
+
+            for (;;)
+            {
+                if (iterator == end)
+                    throw ParseError("Unexpected end of data");
+
+                if (*iterator == quotes)
+                {
+                    ++iterator;
+                    break;
+                }
+                else if (*iterator == '&')
+                    parseEntity();
+                else
+                    buffer.push_back(*iterator++);
+            }
+
+            result = std::string_view{nullptr, buffer.size() - offset};
+            return offset;
+        }
+
+        void parseAttributes(char terminator)
+        {
+            // decoded values are resolved when the buffer does not grow anymore
+            decodedOffsets.clear();
+
+            for (;;)
+            {
+                skipWhitespaces();
+
+                if (iterator == end)
+                    throw ParseError("Unexpected end of data");
+
+                if (*iterator == terminator || *iterator == '>' || *iterator == '/')
+                    break;
+
+                Attribute attribute;
+                attribute.name = parseName();
+
+                skipWhitespaces();
+                expect('=', "Expected an equal sign");
+                skipWhitespaces();
+
+                decodedOffsets.push_back(parseString(attribute.value));
+                attributes.push_back(attribute);
+            }
+
+            for (std::size_t i = 0; i < attributes.size(); ++i)
+                if (decodedOffsets[i] != std::string::npos)
+                    attributes[i].value = std::string_view{buffer.data() + decodedOffsets[i], attributes[i].value.size()};
+        }
+
+        std::string_view parseText()
+        {
+            const char* start = iterator;
+            while (iterator != end && *iterator != '<' && *iterator != '&') ++iterator;
+
+            if (iterator == end || *iterator == '<')
+                return std::string_view{start, static_cast<std::size_t>(iterator - start)};
+
+            buffer.assign(start, iterator);
+
+            while (iterator != end && *iterator != '<')
+                if (*iterator == '&')
+                    parseEntity();
+                else
+                    buffer.push_back(*iterator++);
+
+            return buffer;
+        }
+
+        Event parseDeclaration()
+        {
+            if (startsWith("<!--"))
+            {
+                iterator += 4;
+                const std::string_view rest{iterator, static_cast<std::size_t>(end - iterator)};
+                const auto position = rest.find("--");
+
+                if (position == std::string_view::npos)
+                    throw ParseError("Unexpected end of data");
+
+                if (position + 2 == rest.size())
+                    throw ParseError("Unexpected end of data");
+
+                if (rest[position + 2] != '>')
+                    throw ParseError("Unexpected double-hyphen inside comment");
+
+                value = rest.substr(0, position);
+                iterator += position + 3;
+                return Event::comment;
+            }
+            else if (startsWith("<![CDATA["))
+            {
+                iterator += 9;
+                const std::string_view rest{iterator, static_cast<std::size_t>(end - iterator)};
+                const auto position = rest.find("]]>");
+
+                if (position == std::string_view::npos)
+                    throw ParseError("Unexpected end of data");
+
+                value = rest.substr(0, position);
+                iterator += position + 3;
+                return Event::characterData;
+            }
+            else if (startsWith("<!-"))
+                throw ParseError("Expected a comment");
+            else if (startsWith("<!["))
+                throw ParseError("Expected CDATA");
+            else
+                throw ParseError("Type declarations are not supported");
+        }
+
+        Event parseProcessingInstruction()
+        {
+            iterator += 2; // skip the <?
+            name = parseName();
+            parseAttributes('?');
+
+            expect('?', "Expected a question mark");
+            expect('>', "Expected a right angle bracket");
+            return Event::processingInstruction;
+        }
+
+        Event parseStartTag()
+        {
+            ++iterator; // skip the left angle bracket
+
+            if (openTags.empty())
+            {
+                if (rootTagFound)
+                    throw ParseError("Multiple root tags found");
+                rootTagFound = true;
+            }
+
+            name = parseName();
+            parseAttributes('>');
+
+            if (*iterator == '/')
+            {
+                ++iterator;
+                closePending = true;
+            }
+
+            expect('>', "Expected a right angle bracket");
+            openTags.push_back(name);
+            return Event::startTag;
+        }
+
+        Event parseEndTag()
+        {
+            iterator += 2; // skip the </
+            name = parseName();
+
+            if (openTags.empty() || name != openTags.back())
+                throw ParseError("Tag not closed properly");
+
+            openTags.pop_back();
+
+            skipWhitespaces();
+            expect('>', "Expected a right angle bracket");
+            return Event::endTag;
+        }
+
+        const char* iterator;
+        const char* end;
+        bool preserveWhitespaces;
+        bool rootTagFound = false;
+        bool closePending = false; // set for empty-element tags
+        std::string_view name;
+        std::string_view value;
+        std::vector<Attribute> attributes;
+        std::vector<std::size_t> decodedOffsets;
+        std::vector<std::string_view> openTags;
+        std::string buffer; // for values with entities
+    };
+
+    // Read-only node of a Document, the value is the name for tags and processing instructions
+    class DocumentNode final
+    {
+        friend class Document;
+    public:
+        using Type = Node::Type;
+
+        auto getType() const noexcept { return type; }
+        auto getValue() const noexcept { return value; }
+
+        const DocumentNode* begin() const noexcept { return children; }
+        const DocumentNode* end() const noexcept { return children + childCount; }
+        auto getChildCount() const noexcept { return childCount; }
+
+        const Attribute* beginAttributes() const noexcept { return attributes; }
+        const Attribute* endAttributes() const noexcept { return attributes + attributeCount; }
+        auto getAttributeCount() const noexcept { return attributeCount; }
+
+        const DocumentNode* findChild(std::string_view name) const noexcept
+        {
+            for (const auto& child : *this)
+                if (child.type == Type::tag && child.value == name)
+                    return &child;
+
+            return nullptr;
+        }
+
+        bool hasAttribute(std::string_view name) const noexcept
+        {
+            return findAttribute(name) != nullptr;
+        }
+
+        std::string_view operator[](std::string_view name) const
+        {
+            if (const auto attribute = findAttribute(name)) return attribute->value;
+            throw RangeError("Invalid attribute");
+        }
+
+    private:
+        const Attribute* findAttribute(std::string_view name) const noexcept
+        {
+            for (auto attribute = attributes; attribute != attributes + attributeCount; ++attribute)
+                if (attribute->name == name)
+                    return attribute;
+
+            return nullptr;
+        }
+
+        Type type = Type::text;
+        std::uint32_t attributeCount = 0;
+        std::uint32_t childCount = 0;
+        std::string_view value;
+        const Attribute* attributes = nullptr;
+        const DocumentNode* children = nullptr;
+    };
+
+    // DOM that is allocated in large blocks and refers to the parsed data instead of copying the strings,
+    // so the data must outlive the document
+    class Document final
+    {
+    public:
+        explicit Document(std::string_view data,
+                          bool preserveWhitespaces = false,
+                          bool preserveComments = false,
+                          bool preserveProcessingInstructions = false)
+        {
+            Reader reader(data, preserveWhitespaces);
+
+            // names are interned, so that every tag and attribute name is stored only once
+            std::unordered_set<std::string_view> names;
+            std::vector<DocumentNode> nodes; // children of the open tags
+            std::vector<std::size_t> starts;
+
+            const auto store = [this, data](std::string_view value) {
+                if (value.data() >= data.data() && value.data() + value.size() <= data.data() + data.size())
+                    return value;
+
+                const auto copy = allocate<char>(value.size());
+                std::copy(value.begin(), value.end(), copy);
+                return std::string_view{copy, value.size()};
+            };
+
+            const auto addTag = [this, &reader, &names, &nodes, &store](Reader::Event event) {
+                const auto& readerAttributes = reader.getAttributes();
+
+                DocumentNode node;
+                node.type = (event == Reader::Event::startTag) ? Node::Type::tag : Node::Type::processingInstruction;
+                node.value = *names.insert(reader.getName()).first;
+                node.attributeCount = static_cast<std::uint32_t>(readerAttributes.size());
+
+                const auto result = allocate<Attribute>(readerAttributes.size());
+                for (std::size_t i = 0; i < readerAttributes.size(); ++i)
+                {
+                    result[i].name = *names.insert(readerAttributes[i].name).first;
+                    result[i].value = store(readerAttributes[i].value);
+                }
+                node.attributes = result;
+
+                nodes.push_back(node);
+            };
+
+            const auto addValue = [&nodes, &store](Node::Type type, std::string_view value) {
+                DocumentNode node;
+                node.type = type;
+                node.value = store(value);
+                nodes.push_back(node);
+            };
+
+            for (;;)
+            {
+                const auto event = reader.next();
+
+                if (event == Reader::Event::endOfData)
+                    break;
+
+                switch (event)
+                {
+                    case Reader::Event::startTag:
+                        addTag(event);
+                        starts.push_back(nodes.size());
+                        break;
+                    case Reader::Event::endTag:
+                    {
+                        const auto start = starts.back();
+                        starts.pop_back();
+
+                        auto& parent = nodes[start - 1];
+                        parent.childCount = static_cast<std::uint32_t>(nodes.size() - start);
+                        parent.children = copyNodes(nodes, start);
+                        nodes.resize(start);
+                        break;
+                    }
+                    case Reader::Event::text:
+                        addValue(Node::Type::text, reader.getValue());
+                        break;
+                    case Reader::Event::characterData:
+                        addValue(Node::Type::characterData, reader.getValue());
+                        break;
+                    case Reader::Event::comment:
+                        if (preserveComments)
+                            addValue(Node::Type::comment, reader.getValue());
+                        break;
+                    case Reader::Event::processingInstruction:
+                        if (preserveProcessingInstructions)
+                            addTag(event);
+                        break;
+                    default:
+                        break;
+                }
+            }
+
+            childCount = nodes.size();
+            children = copyNodes(nodes, 0);
+
+            for (const auto& child : *this)
+                if (child.getType() == Node::Type::tag)
+                    root = &child;
+        }
+
+        Document(const char* data, std::size_t size,
+                 bool preserveWhitespaces = false,
+                 bool preserveComments = false,
+                 bool preserveProcessingInstructions = false):
+            Document{std::string_view{data, size}, preserveWhitespaces, preserveComments, preserveProcessingInstructions}
+        {
+        }
+
+        const DocumentNode* begin() const noexcept { return children; }
+        const DocumentNode* end() const noexcept { return children + childCount; }
+
+        const DocumentNode& getRoot() const noexcept { return *root; }
+
+        auto getMemoryUsage() const noexcept { return allocatedSize; }
+
+    private:
+        template <class T>
+        T* allocate(std::size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<T>);
+
+            if (count == 0) return nullptr;
+
+            const auto size = sizeof(T) * count;
+            auto offset = (blockOffset + alignof(T) - 1) & ~(alignof(T) - 1);
+
+            if (blocks.empty() || offset + size > blockSize)
+            {
+                blockSize = std::max(size, std::clamp(blockSize * 2, std::size_t(4096), std::size_t(1048576)));
+                blocks.push_back(std::make_unique<std::byte[]>(blockSize));
+                allocatedSize += blockSize;
+                offset = 0;
+            }
+
+            blockOffset = offset + size;
+            auto result = reinterpret_cast<T*>(blocks.back().get() + offset);
+            std::uninitialized_default_construct_n(result, count);
+            return result;
+        }
+
+        const DocumentNode* copyNodes(const std::vector<DocumentNode>& nodes, std::size_t start)
+        {
+            const auto result = allocate<DocumentNode>(nodes.size() - start);
+            std::copy(nodes.begin() + static_cast<std::ptrdiff_t>(start), nodes.end(), result);
+            return result;
+        }
+
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        std::size_t blockSize = 0;
+        std::size_t blockOffset = 0;
+        std::size_t allocatedSize = 0;
+        const DocumentNode* children = nullptr;
+        std::size_t childCount = 0;
+        const DocumentNode* root = nullptr;
+    };
+}
+
+#endif // OUZEL_FORMATS_XMLDOCUMENT_HPP
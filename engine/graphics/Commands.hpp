@@ -5,6 +5,7 @@
 
 #include <queue>
 #include <string>
+#include <utility>
 #include "BlendFactor.hpp"
 #include "BlendOperation.hpp"
 #include "BufferType.hpp"
@@ -350,14 +351,16 @@ namespace ouzel::graphics
                               std::uint32_t initIndexSize,
                               ResourceId initVertexBuffer,
                               DrawMode initDrawMode,
-                              std::uint32_t initStartIndex) noexcept:
+                              std::uint32_t initStartIndex,
+                              std::uint32_t initInstanceCount) noexcept:
             Command(Command::Type::draw),
             indexBuffer(initIndexBuffer),
             indexCount(initIndexCount),
             indexSize(initIndexSize),
             vertexBuffer(initVertexBuffer),
             drawMode(initDrawMode),
-            startIndex(initStartIndex)
+            startIndex(initStartIndex),
+            instanceCount(initInstanceCount)
         {
         }
 
@@ -367,6 +370,8 @@ namespace ouzel::graphics
         const ResourceId vertexBuffer;
         const DrawMode drawMode;
         const std::uint32_t startIndex;
+        // if not zero, the vertices are read once per instance and the shader expands them
+        const std::uint32_t instanceCount;
     };
 
     class PushDebugMarkerCommand final: public Command
@@ -517,7 +522,7 @@ namespace ouzel::graphics
     {
     public:
         InitTextureCommand(ResourceId initTexture,
-                           const std::vector<std::pair<Size2U, std::vector<std::uint8_t>>>& initLevels,
+                           std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> initLevels,
                            TextureType initTextureType,
                            Flags initFlags,
                            std::uint32_t initSampleCount,
@@ -526,7 +531,7 @@ namespace ouzel::graphics
                            std::uint32_t initMaxAnisotropy) noexcept(false):
             Command(Command::Type::initTexture),
             texture(initTexture),
-            levels(initLevels),
+            levels(std::move(initLevels)),
             textureType(initTextureType),
             flags(initFlags),
             sampleCount(initSampleCount),
@@ -11,7 +11,8 @@ namespace ouzel::graphics
         dynamic = 0x01,
         bindRenderTarget = 0x02,
         bindShader = 0x04,
-        bindShaderMsaa = 0x08
+        bindShaderMsaa = 0x08,
+        premultipliedAlpha = 0x10 // color channels are multiplied by alpha, mip levels are generated with a box filter
     };
 
     inline constexpr Flags operator&(const Flags a, const Flags b) noexcept
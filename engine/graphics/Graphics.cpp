@@ -231,7 +231,8 @@ namespace ouzel::graphics
                         std::uint32_t indexSize,
                         std::size_t vertexBuffer,
                         DrawMode drawMode,
-                        std::uint32_t startIndex)
+                        std::uint32_t startIndex,
+                        std::uint32_t instanceCount)
     {
         if (!indexBuffer || !vertexBuffer)
             throw std::runtime_error("Invalid mesh buffer passed to render queue");
@@ -241,7 +242,8 @@ namespace ouzel::graphics
                                                  indexSize,
                                                  vertexBuffer,
                                                  drawMode,
-                                                 startIndex));
+                                                 startIndex,
+                                                 instanceCount));
     }
 
     void Graphics::pushDebugMarker(const std::string& name)
@@ -63,7 +63,8 @@ namespace ouzel::graphics
                   std::uint32_t indexSize,
                   std::size_t vertexBuffer,
                   DrawMode drawMode,
-                  std::uint32_t startIndex);
+                  std::uint32_t startIndex,
+                  std::uint32_t instanceCount = 0);
         void pushDebugMarker(const std::string& name);
         void popDebugMarker();
         void setShaderConstants(const std::vector<std::vector<float>>& fragmentShaderConstants,
@@ -4,6 +4,7 @@
 #define OUZEL_GRAPHICS_IMAGEDATA_HPP
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 #include "PixelFormat.hpp"
 #include "../math/Size.hpp"
@@ -22,9 +23,17 @@ namespace ouzel::graphics
         {
         }
 
+        Image(PixelFormat initPixelFormat,
+              const Size2U& initSize,
+              std::vector<std::uint8_t>&& initData) noexcept:
+            pixelFormat(initPixelFormat), size(initSize), data(std::move(initData))
+        {
+        }
+
         auto getPixelFormat() const noexcept { return pixelFormat; }
         auto& getSize() const noexcept { return size; }
-        auto& getData() const noexcept { return data; }
+        auto& getData() const& noexcept { return data; }
+        auto getData() && noexcept { return std::move(data); }
 
     private:
         PixelFormat pixelFormat = PixelFormat::rgba8UnsignedNorm;
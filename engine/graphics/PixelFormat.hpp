@@ -3,6 +3,9 @@
 #ifndef OUZEL_GRAPHICS_PIXELFORMAT_HPP
 #define OUZEL_GRAPHICS_PIXELFORMAT_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 namespace ouzel::graphics
 {
     enum class PixelFormat
@@ -37,6 +40,18 @@ namespace ouzel::graphics
         rgba32UnsignedInt,
         rgba32SignedInt,
         rgba32Float,
+        bc1UnsignedNorm,
+        bc1UnsignedNormSRGB,
+        bc3UnsignedNorm,
+        bc3UnsignedNormSRGB,
+        bc7UnsignedNorm,
+        bc7UnsignedNormSRGB,
+        etc2Rgb8UnsignedNorm,
+        etc2Rgb8UnsignedNormSRGB,
+        etc2Rgba8UnsignedNorm,
+        etc2Rgba8UnsignedNormSRGB,
+        astc4x4UnsignedNorm,
+        astc4x4UnsignedNormSRGB,
         depth,
         depthStencil
     };
@@ -172,6 +187,20 @@ namespace ouzel::graphics
             case PixelFormat::rgba32SignedInt:
             case PixelFormat::rgba32Float:
                 return 4;
+            case PixelFormat::etc2Rgb8UnsignedNorm:
+            case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                return 3;
+            case PixelFormat::bc1UnsignedNorm:
+            case PixelFormat::bc1UnsignedNormSRGB:
+            case PixelFormat::bc3UnsignedNorm:
+            case PixelFormat::bc3UnsignedNormSRGB:
+            case PixelFormat::bc7UnsignedNorm:
+            case PixelFormat::bc7UnsignedNormSRGB:
+            case PixelFormat::etc2Rgba8UnsignedNorm:
+            case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+            case PixelFormat::astc4x4UnsignedNorm:
+            case PixelFormat::astc4x4UnsignedNormSRGB:
+                return 4;
             case PixelFormat::depth:
             case PixelFormat::depthStencil:
                 return 1;
@@ -179,6 +208,72 @@ namespace ouzel::graphics
                 return 0;
         }
     }
+
+    // compressed formats store the pixels in blocks of 4x4 pixels
+    inline bool isCompressed(PixelFormat pixelFormat) noexcept
+    {
+        switch (pixelFormat)
+        {
+            case PixelFormat::bc1UnsignedNorm:
+            case PixelFormat::bc1UnsignedNormSRGB:
+            case PixelFormat::bc3UnsignedNorm:
+            case PixelFormat::bc3UnsignedNormSRGB:
+            case PixelFormat::bc7UnsignedNorm:
+            case PixelFormat::bc7UnsignedNormSRGB:
+            case PixelFormat::etc2Rgb8UnsignedNorm:
+            case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+            case PixelFormat::etc2Rgba8UnsignedNorm:
+            case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+            case PixelFormat::astc4x4UnsignedNorm:
+            case PixelFormat::astc4x4UnsignedNormSRGB:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // size of a 4x4 block of a compressed format in bytes
+    inline std::uint32_t getBlockSize(PixelFormat pixelFormat) noexcept
+    {
+        switch (pixelFormat)
+        {
+            case PixelFormat::bc1UnsignedNorm:
+            case PixelFormat::bc1UnsignedNormSRGB:
+            case PixelFormat::etc2Rgb8UnsignedNorm:
+            case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                return 8;
+            case PixelFormat::bc3UnsignedNorm:
+            case PixelFormat::bc3UnsignedNormSRGB:
+            case PixelFormat::bc7UnsignedNorm:
+            case PixelFormat::bc7UnsignedNormSRGB:
+            case PixelFormat::etc2Rgba8UnsignedNorm:
+            case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+            case PixelFormat::astc4x4UnsignedNorm:
+            case PixelFormat::astc4x4UnsignedNormSRGB:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    // size of a row of pixels (or a row of blocks for compressed formats) in bytes
+    inline std::uint32_t getRowPitch(PixelFormat pixelFormat, std::uint32_t width) noexcept
+    {
+        return isCompressed(pixelFormat) ?
+            (width + 3) / 4 * getBlockSize(pixelFormat) :
+            width * getPixelSize(pixelFormat);
+    }
+
+    // number of rows of pixels (or rows of blocks for compressed formats)
+    inline std::uint32_t getRowCount(PixelFormat pixelFormat, std::uint32_t height) noexcept
+    {
+        return isCompressed(pixelFormat) ? (height + 3) / 4 : height;
+    }
+
+    inline std::size_t getLevelSize(PixelFormat pixelFormat, std::uint32_t width, std::uint32_t height) noexcept
+    {
+        return static_cast<std::size_t>(getRowPitch(pixelFormat, width)) * getRowCount(pixelFormat, height);
+    }
 }
 
 #endif // OUZEL_GRAPHICS_PIXELFORMAT_HPP
@@ -13,6 +13,13 @@ namespace ouzel::graphics
         Vertex::Attribute{Vertex::Attribute::Usage::normal, DataType::float32Vector3}
     };
 
+    // the layout of InstanceVertex, in the same order as the vertex attributes, so that the shaders bind them to the same locations
+    const std::array<Vertex::Attribute, 3> RenderDevice::INSTANCE_ATTRIBUTES{
+        Vertex::Attribute{Vertex::Attribute::Usage::position, DataType::float32Vector2},
+        Vertex::Attribute{Vertex::Attribute::Usage::color, DataType::unsignedByteVector4Norm},
+        Vertex::Attribute{Vertex::Attribute::Usage::textureCoordinates0, DataType::float32Vector2}
+    };
+
     RenderDevice::RenderDevice(Driver initDriver,
                                const Settings& settings,
                                core::Window& initWindow,
@@ -32,6 +39,7 @@ namespace ouzel::graphics
         clampToBorderSupported(false),
         multisamplingSupported(false),
         uintIndicesSupported(false),
+        instancingSupported(false),
         previousFrameTime(std::chrono::steady_clock::now())
     {
     }
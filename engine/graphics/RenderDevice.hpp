@@ -56,6 +56,7 @@ namespace ouzel::graphics
         friend Graphics;
     public:
         static const std::array<Vertex::Attribute, 5> VERTEX_ATTRIBUTES;
+        static const std::array<Vertex::Attribute, 3> INSTANCE_ATTRIBUTES;
 
         struct Event
         {
@@ -103,6 +104,7 @@ namespace ouzel::graphics
         auto isNPOTTexturesSupported() const noexcept { return npotTexturesSupported; }
         auto isAnisotropicFilteringSupported() const noexcept { return anisotropicFilteringSupported; }
         auto isRenderTargetsSupported() const noexcept { return renderTargetsSupported; }
+        auto isInstancingSupported() const noexcept { return instancingSupported; }
 
         auto& getProjectionTransform(bool renderTarget) const noexcept
         {
@@ -185,6 +187,7 @@ namespace ouzel::graphics
         bool clampToBorderSupported:1;
         bool multisamplingSupported:1;
         bool uintIndicesSupported:1;
+        bool instancingSupported:1;
 
         Matrix4F projectionTransform = Matrix4F::identity();
         Matrix4F renderTargetProjectionTransform = Matrix4F::identity();
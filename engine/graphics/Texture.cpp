@@ -1,8 +1,17 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#if defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <utility>
 #include "Texture.hpp"
 #include "Graphics.hpp"
+#include "../core/Engine.hpp"
+#include "../thread/Thread.hpp"
+#include "../utils/Utils.hpp"
 
 namespace ouzel::graphics
 {
@@ -44,353 +53,363 @@ namespace ouzel::graphics
             0.9406006932F, 0.9489649534F, 0.957369566F, 0.9658146501F, 0.9743002057F, 0.9828262329F, 0.9913928509F, 1.0F
         };
 
-        void downsample2x2A8(std::uint32_t width, std::uint32_t height,
-                             const std::vector<float>& original, std::vector<float>& resized)
+        // runs the function for bands of rows on multiple threads if the image is large enough
+        template <class Function>
+        void forEachRowBand(std::uint32_t rowCount, std::uint32_t rowSize, const Function& function)
         {
-            const std::uint32_t dstWidth = width >> 1;
-            const std::uint32_t dstHeight = height >> 1;
-            const std::uint32_t pitch = width * 1;
-            resized.resize(dstWidth * dstHeight * 1);
-            const float* src = original.data();
-            float* dst = resized.data();
+#if !defined(__EMSCRIPTEN__)
+            constexpr std::uint32_t minBandSize = 65536;
+            const std::uint32_t bandCount = std::min({std::thread::hardware_concurrency(),
+                                                      rowCount,
+                                                      static_cast<std::uint32_t>(std::uint64_t{rowCount} * rowSize / minBandSize)});
 
-            if (dstWidth > 0 && dstHeight > 0)
+            if (bandCount > 1)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2)
-                {
-                    const float* pixel = src;
-                    for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                    {
-                        float a = 0.0F;
-                        a += pixel[0];
-                        a += pixel[1];
-                        a += pixel[pitch + 0];
-                        a += pixel[pitch + 1];
-                        dst[0] = a / 4.0F;
-                    }
-                }
+                const std::uint32_t bandRows = (rowCount + bandCount - 1) / bandCount;
+
+                std::vector<thread::Thread> threads;
+                threads.reserve(bandCount - 1);
+
+                for (std::uint32_t firstRow = bandRows; firstRow < rowCount; firstRow += bandRows)
+                    threads.emplace_back(function, firstRow, std::min(firstRow + bandRows, rowCount));
+
+                function(0U, bandRows);
+                return; // the threads are joined when they are destroyed
             }
-            else if (dstHeight > 0)
+#endif
+
+            function(0U, rowCount);
+        }
+
+        // single channel formats (r8 and a8)
+        void downsampleRowR8(const float* top, const float* bottom, float* dst, std::uint32_t dstWidth) noexcept
+        {
+            std::uint32_t x = 0;
+
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += 1)
-                {
-                    const float* pixel = src;
+                const __m128 quarter = _mm_set1_ps(0.25F);
 
-                    float a = 0.0F;
-                    a += pixel[0];
-                    a += pixel[pitch + 0];
-                    dst[0] = a / 2.0F;
+                for (; x + 4 <= dstWidth; x += 4, top += 8, bottom += 8, dst += 4)
+                {
+                    const __m128 top0 = _mm_loadu_ps(top);
+                    const __m128 top1 = _mm_loadu_ps(top + 4);
+                    const __m128 bottom0 = _mm_loadu_ps(bottom);
+                    const __m128 bottom1 = _mm_loadu_ps(bottom + 4);
+
+                    // even and odd pixels of both rows
+                    __m128 r = _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(2, 0, 2, 0));
+                    r = _mm_add_ps(r, _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(3, 1, 3, 1)));
+                    r = _mm_add_ps(r, _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    r = _mm_add_ps(r, _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+                    _mm_storeu_ps(dst, _mm_mul_ps(r, quarter));
                 }
             }
-            else if (dstWidth > 0)
+#endif
+
+            for (; x < dstWidth; ++x, top += 2, bottom += 2, dst += 1)
             {
-                const float* pixel = src;
-                for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                {
-                    float a = 0.0F;
-                    a += pixel[0];
-                    a += pixel[1];
-                    dst[0] = a / 2.0F;
-                }
+                float r = 0.0F;
+                r += top[0];
+                r += top[1];
+                r += bottom[0];
+                r += bottom[1];
+                dst[0] = r / 4.0F;
             }
         }
 
-        void downsample2x2R8(std::uint32_t width, std::uint32_t height,
-                             const std::vector<float>& original, std::vector<float>& resized)
+        void downsamplePairR8(const float* first, const float* second, float* dst) noexcept
         {
-            std::vector<float> normalized(width * height * 1);
+            float r = 0.0F;
+            r += first[0];
+            r += second[0];
+            dst[0] = r / 2.0F;
+        }
 
-            const std::uint32_t dstWidth = width >> 1;
-            const std::uint32_t dstHeight = height >> 1;
-            const std::uint32_t pitch = width * 1;
-            resized.resize(dstWidth * dstHeight * 1);
-            const float* src = original.data();
-            float* dst = resized.data();
+        void downsampleRowRg8(const float* top, const float* bottom, float* dst, std::uint32_t dstWidth) noexcept
+        {
+            std::uint32_t x = 0;
 
-            if (dstWidth > 0 && dstHeight > 0)
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2)
+                const __m128 quarter = _mm_set1_ps(0.25F);
+
+                for (; x + 2 <= dstWidth; x += 2, top += 8, bottom += 8, dst += 4)
                 {
-                    const float* pixel = src;
-                    for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                    {
-                        float r = 0.0F;
-                        r += pixel[0];
-                        r += pixel[1];
-                        r += pixel[pitch + 0];
-                        r += pixel[pitch + 1];
-                        dst[0] = r / 4.0F;
-                    }
+                    const __m128 top0 = _mm_loadu_ps(top);
+                    const __m128 top1 = _mm_loadu_ps(top + 4);
+                    const __m128 bottom0 = _mm_loadu_ps(bottom);
+                    const __m128 bottom1 = _mm_loadu_ps(bottom + 4);
+
+                    // even and odd pixels of both rows
+                    __m128 rg = _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(1, 0, 1, 0));
+                    rg = _mm_add_ps(rg, _mm_shuffle_ps(top0, top1, _MM_SHUFFLE(3, 2, 3, 2)));
+                    rg = _mm_add_ps(rg, _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(1, 0, 1, 0)));
+                    rg = _mm_add_ps(rg, _mm_shuffle_ps(bottom0, bottom1, _MM_SHUFFLE(3, 2, 3, 2)));
+
+                    _mm_storeu_ps(dst, _mm_mul_ps(rg, quarter));
                 }
             }
-            else if (dstHeight > 0)
-            {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += 1)
-                {
-                    const float* pixel = src;
+#endif
 
-                    float r = 0.0F;
-                    r += pixel[0];
-                    r += pixel[pitch + 0];
-                    dst[0] = r / 2.0F;
-                }
-            }
-            else if (dstWidth > 0)
+            for (; x < dstWidth; ++x, top += 4, bottom += 4, dst += 2)
             {
-                const float* pixel = src;
-                for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 2, dst += 1)
-                {
-                    float r = 0.0F;
-                    r += pixel[0];
-                    r += pixel[1];
-                    dst[0] = r / 2.0F;
-                }
+                float r = 0.0F;
+                float g = 0.0F;
+
+                r += top[0];
+                g += top[1];
+
+                r += top[2];
+                g += top[3];
+
+                r += bottom[0];
+                g += bottom[1];
+
+                r += bottom[2];
+                g += bottom[3];
+
+                dst[0] = r / 4.0F;
+                dst[1] = g / 4.0F;
             }
         }
 
-        void downsample2x2Rg8(std::uint32_t width, std::uint32_t height,
-                              const std::vector<float>& original, std::vector<float>& resized)
+        void downsamplePairRg8(const float* first, const float* second, float* dst) noexcept
         {
-            std::vector<float> normalized(width * height * 2);
+            float r = 0.0F;
+            float g = 0.0F;
 
-            const std::uint32_t dstWidth = width >> 1;
-            const std::uint32_t dstHeight = height >> 1;
-            const std::uint32_t pitch = width * 2;
-            resized.resize(dstWidth * dstHeight * 2);
-            const float* src = original.data();
-            float* dst = resized.data();
-
-            if (dstWidth > 0 && dstHeight > 0)
-            {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2)
-                {
-                    const float* pixel = src;
-                    for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 4, dst += 2)
-                    {
-                        float r = 0.0F;
-                        float g = 0.0F;
+            r += first[0];
+            g += first[1];
 
-                        r += pixel[0];
-                        g += pixel[1];
+            r += second[0];
+            g += second[1];
 
-                        r += pixel[2];
-                        g += pixel[3];
+            dst[0] = r / 2.0F;
+            dst[1] = g / 2.0F;
+        }
 
-                        r += pixel[pitch + 0];
-                        g += pixel[pitch + 1];
+        void downsampleRowRgba8(const float* top, const float* bottom, float* dst, std::uint32_t dstWidth) noexcept
+        {
+            std::uint32_t x = 0;
 
-                        r += pixel[pitch + 2];
-                        g += pixel[pitch + 3];
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0F);
+                const __m128 quarter = _mm_set1_ps(0.25F);
 
-                        dst[0] = r / 4.0F;
-                        dst[1] = g / 4.0F;
-                    }
+                for (; x < dstWidth; ++x, top += 8, bottom += 8, dst += 4)
+                {
+                    const __m128 p0 = _mm_loadu_ps(top);
+                    const __m128 p1 = _mm_loadu_ps(top + 4);
+                    const __m128 p2 = _mm_loadu_ps(bottom);
+                    const __m128 p3 = _mm_loadu_ps(bottom + 4);
+
+                    // the color of fully transparent pixels is ignored
+                    const __m128 m0 = _mm_cmpgt_ps(_mm_shuffle_ps(p0, p0, _MM_SHUFFLE(3, 3, 3, 3)), zero);
+                    const __m128 m1 = _mm_cmpgt_ps(_mm_shuffle_ps(p1, p1, _MM_SHUFFLE(3, 3, 3, 3)), zero);
+                    const __m128 m2 = _mm_cmpgt_ps(_mm_shuffle_ps(p2, p2, _MM_SHUFFLE(3, 3, 3, 3)), zero);
+                    const __m128 m3 = _mm_cmpgt_ps(_mm_shuffle_ps(p3, p3, _MM_SHUFFLE(3, 3, 3, 3)), zero);
+
+                    __m128 color = _mm_and_ps(p0, m0);
+                    color = _mm_add_ps(color, _mm_and_ps(p1, m1));
+                    color = _mm_add_ps(color, _mm_and_ps(p2, m2));
+                    color = _mm_add_ps(color, _mm_and_ps(p3, m3));
+
+                    __m128 pixels = _mm_and_ps(one, m0);
+                    pixels = _mm_add_ps(pixels, _mm_and_ps(one, m1));
+                    pixels = _mm_add_ps(pixels, _mm_and_ps(one, m2));
+                    pixels = _mm_add_ps(pixels, _mm_and_ps(one, m3));
+
+                    const __m128 alpha = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(p0, p1), p2), p3), quarter);
+                    const __m128 average = _mm_div_ps(color, pixels);
+
+                    // r, g, b from the average and a from the alpha
+                    const __m128 blueAlpha = _mm_shuffle_ps(average, alpha, _MM_SHUFFLE(3, 3, 2, 2));
+                    const __m128 result = _mm_shuffle_ps(average, blueAlpha, _MM_SHUFFLE(2, 0, 1, 0));
+
+                    _mm_storeu_ps(dst, _mm_and_ps(result, _mm_cmpgt_ps(pixels, zero)));
                 }
             }
-            else if (dstHeight > 0)
+#endif
+
+            for (; x < dstWidth; ++x, top += 8, bottom += 8, dst += 4)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += 2)
+                float pixels = 0.0F;
+                float r = 0.0F;
+                float g = 0.0F;
+                float b = 0.0F;
+                float a = 0.0F;
+
+                if (top[3] > 0.0F)
                 {
-                    const float* pixel = src;
-                    float r = 0.0F;
-                    float g = 0.0F;
+                    r += top[0];
+                    g += top[1];
+                    b += top[2];
+                    pixels += 1.0F;
+                }
+                a += top[3];
 
-                    r += pixel[0];
-                    g += pixel[1];
+                if (top[7] > 0.0F)
+                {
+                    r += top[4];
+                    g += top[5];
+                    b += top[6];
+                    pixels += 1.0F;
+                }
+                a += top[7];
 
-                    r += pixel[pitch + 0];
-                    g += pixel[pitch + 1];
+                if (bottom[3] > 0.0F)
+                {
+                    r += bottom[0];
+                    g += bottom[1];
+                    b += bottom[2];
+                    pixels += 1.0F;
+                }
+                a += bottom[3];
 
-                    dst[0] = r / 2.0F;
-                    dst[1] = g / 2.0F;
+                if (bottom[7] > 0.0F)
+                {
+                    r += bottom[4];
+                    g += bottom[5];
+                    b += bottom[6];
+                    pixels += 1.0F;
+                }
+                a += bottom[7];
+
+                if (pixels > 0.0F)
+                {
+                    dst[0] = r / pixels;
+                    dst[1] = g / pixels;
+                    dst[2] = b / pixels;
+                    dst[3] = a / 4.0F;
+                }
+                else
+                {
+                    dst[0] = 0;
+                    dst[1] = 0;
+                    dst[2] = 0;
+                    dst[3] = 0;
                 }
             }
-            else if (dstWidth > 0)
+        }
+
+        void downsamplePairRgba8(const float* first, const float* second, float* dst) noexcept
+        {
+            float pixels = 0.0F;
+            float r = 0.0F;
+            float g = 0.0F;
+            float b = 0.0F;
+            float a = 0.0F;
+
+            if (first[3] > 0)
             {
-                const float* pixel = src;
-                for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 4, dst += 2)
-                {
-                    float r = 0.0F;
-                    float g = 0.0F;
+                r += first[0];
+                g += first[1];
+                b += first[2];
+                pixels += 1.0F;
+            }
+            a += first[3];
 
-                    r += pixel[0];
-                    g += pixel[1];
+            if (second[3] > 0)
+            {
+                r += second[0];
+                g += second[1];
+                b += second[2];
+                pixels += 1.0F;
+            }
+            a += second[3];
+
+            if (pixels > 0.0F)
+            {
+                dst[0] = r / pixels;
+                dst[1] = g / pixels;
+                dst[2] = b / pixels;
+                dst[3] = a / 2.0F;
+            }
+            else
+            {
+                dst[0] = 0;
+                dst[1] = 0;
+                dst[2] = 0;
+                dst[3] = 0;
+            }
+        }
+
+        // premultiplied colors are averaged together with the transparent pixels, which are black
+        void downsampleRowRgba8Premultiplied(const float* top, const float* bottom, float* dst, std::uint32_t dstWidth) noexcept
+        {
+            std::uint32_t x = 0;
+
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                const __m128 quarter = _mm_set1_ps(0.25F);
 
-                    r += pixel[2];
-                    g += pixel[3];
+                for (; x < dstWidth; ++x, top += 8, bottom += 8, dst += 4)
+                {
+                    __m128 result = _mm_loadu_ps(top);
+                    result = _mm_add_ps(result, _mm_loadu_ps(top + 4));
+                    result = _mm_add_ps(result, _mm_loadu_ps(bottom));
+                    result = _mm_add_ps(result, _mm_loadu_ps(bottom + 4));
 
-                    dst[0] = r / 2.0F;
-                    dst[1] = g / 2.0F;
+                    _mm_storeu_ps(dst, _mm_mul_ps(result, quarter));
                 }
             }
+#endif
+
+            for (; x < dstWidth; ++x, top += 8, bottom += 8, dst += 4)
+                for (std::uint32_t channel = 0; channel < 4; ++channel)
+                    dst[channel] = (top[channel] + top[channel + 4] + bottom[channel] + bottom[channel + 4]) / 4.0F;
         }
 
-        void downsample2x2Rgba8(std::uint32_t width, std::uint32_t height,
-                                const std::vector<float>& original, std::vector<float>& resized)
+        void downsamplePairRgba8Premultiplied(const float* first, const float* second, float* dst) noexcept
+        {
+            for (std::uint32_t channel = 0; channel < 4; ++channel)
+                dst[channel] = (first[channel] + second[channel]) / 2.0F;
+        }
+
+        using DownsampleRow = void(*)(const float* top, const float* bottom, float* dst, std::uint32_t dstWidth) noexcept;
+        using DownsamplePair = void(*)(const float* first, const float* second, float* dst) noexcept;
+
+        void downsample2x2(std::uint32_t width, std::uint32_t height,
+                           std::uint32_t channelCount,
+                           DownsampleRow downsampleRow,
+                           DownsamplePair downsamplePair,
+                           const std::vector<float>& original, std::vector<float>& resized)
         {
             const std::uint32_t dstWidth = width >> 1;
             const std::uint32_t dstHeight = height >> 1;
-            const std::uint32_t pitch = width * 4;
-            resized.resize(dstWidth * dstHeight * 4);
+            const std::uint32_t pitch = width * channelCount;
+            // a single row or column is left when one of the sides is already 1
+            resized.resize(std::max(dstWidth, 1U) * std::max(dstHeight, 1U) * channelCount);
             const float* src = original.data();
             float* dst = resized.data();
 
             if (dstWidth > 0 && dstHeight > 0)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2)
-                {
-                    const float* pixel = src;
-                    for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 8, dst += 4)
+                forEachRowBand(dstHeight, dstWidth, [src, dst, pitch, dstWidth, channelCount, downsampleRow](std::uint32_t firstRow, std::uint32_t lastRow) noexcept {
+                    for (std::uint32_t y = firstRow; y < lastRow; ++y)
                     {
-                        float pixels = 0.0F;
-                        float r = 0.0F;
-                        float g = 0.0F;
-                        float b = 0.0F;
-                        float a = 0.0F;
-
-                        if (pixel[3] > 0.0F)
-                        {
-                            r += pixel[0];
-                            g += pixel[1];
-                            b += pixel[2];
-                            pixels += 1.0F;
-                        }
-                        a += pixel[3];
-
-                        if (pixel[7] > 0.0F)
-                        {
-                            r += pixel[4];
-                            g += pixel[5];
-                            b += pixel[6];
-                            pixels += 1.0F;
-                        }
-                        a += pixel[7];
-
-                        if (pixel[pitch + 3] > 0.0F)
-                        {
-                            r += pixel[pitch + 0];
-                            g += pixel[pitch + 1];
-                            b += pixel[pitch + 2];
-                            pixels += 1.0F;
-                        }
-                        a += pixel[pitch + 3];
-
-                        if (pixel[pitch + 7] > 0.0F)
-                        {
-                            r += pixel[pitch + 4];
-                            g += pixel[pitch + 5];
-                            b += pixel[pitch + 6];
-                            pixels += 1.0F;
-                        }
-                        a += pixel[pitch + 7];
-
-                        if (pixels > 0.0F)
-                        {
-                            dst[0] = r / pixels;
-                            dst[1] = g / pixels;
-                            dst[2] = b / pixels;
-                            dst[3] = a / 4.0F;
-                        }
-                        else
-                        {
-                            dst[0] = 0;
-                            dst[1] = 0;
-                            dst[2] = 0;
-                            dst[3] = 0;
-                        }
+                        const float* top = src + std::size_t{y} * pitch * 2;
+                        downsampleRow(top, top + pitch, dst + std::size_t{y} * dstWidth * channelCount, dstWidth);
                     }
-                }
+                });
             }
             else if (dstHeight > 0)
             {
-                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += 4)
-                {
-                    const float* pixel = src;
-
-                    float pixels = 0.0F;
-                    float r = 0.0F;
-                    float g = 0.0F;
-                    float b = 0.0F;
-                    float a = 0.0F;
-
-                    if (pixel[3] > 0)
-                    {
-                        r += pixel[0];
-                        g += pixel[1];
-                        b += pixel[2];
-                        pixels += 1.0F;
-                    }
-                    a = pixel[3];
-
-                    if (pixel[pitch + 3] > 0)
-                    {
-                        r += pixel[pitch + 0];
-                        g += pixel[pitch + 1];
-                        b += pixel[pitch + 2];
-                        pixels += 1.0F;
-                    }
-                    a += pixel[pitch + 3];
-
-                    if (pixels > 0.0F)
-                    {
-                        dst[0] = r / pixels;
-                        dst[1] = g / pixels;
-                        dst[2] = b / pixels;
-                        dst[3] = a / 2.0F;
-                    }
-                    else
-                    {
-                        dst[0] = 0;
-                        dst[1] = 0;
-                        dst[2] = 0;
-                        dst[3] = 0;
-                    }
-                }
+                for (std::uint32_t y = 0; y < dstHeight; ++y, src += pitch * 2, dst += channelCount)
+                    downsamplePair(src, src + pitch, dst);
             }
             else if (dstWidth > 0)
             {
-                const float* pixel = src;
-                for (std::uint32_t x = 0; x < dstWidth; ++x, pixel += 8, dst += 4)
-                {
-                    float pixels = 0.0F;
-                    float r = 0.0F;
-                    float g = 0.0F;
-                    float b = 0.0F;
-                    float a = 0.0F;
-
-                    if (pixel[3] > 0)
-                    {
-                        r += pixel[0];
-                        g += pixel[1];
-                        b += pixel[2];
-                        pixels += 1.0F;
-                    }
-                    a += pixel[3];
-
-                    if (pixel[7] > 0)
-                    {
-                        r += pixel[4];
-                        g += pixel[5];
-                        b += pixel[6];
-                        pixels += 1.0F;
-                    }
-                    a += pixel[7];
-
-                    if (pixels > 0.0F)
-                    {
-                        dst[0] = r / pixels;
-                        dst[1] = g / pixels;
-                        dst[2] = b / pixels;
-                        dst[3] = a / 2.0F;
-                    }
-                    else
-                    {
-                        dst[0] = 0;
-                        dst[1] = 0;
-                        dst[2] = 0;
-                        dst[3] = 0;
-                    }
-                }
+                for (std::uint32_t x = 0; x < dstWidth; ++x, src += channelCount * 2, dst += channelCount)
+                    downsamplePair(src, src + channelCount, dst);
             }
         }
 
@@ -404,66 +423,89 @@ namespace ouzel::graphics
             return static_cast<std::uint8_t>(std::round(std::pow(value, 1.0F / gamma) * 255.0F));
         }
 
-        void decode(const Size2U& size,
-                    const std::vector<std::uint8_t>& encodedData,
-                    PixelFormat pixelFormat,
-                    std::vector<float>& decodedData)
+        // gammaEncode without std::pow, gives exactly the same results
+        class GammaEncoder final
         {
-            const std::uint32_t channelCount = getChannelCount(pixelFormat);
-            const std::uint32_t pitch = size.width() * channelCount;
-            decodedData.resize(size.width() * size.height() * channelCount);
-            const std::uint8_t* src = encodedData.data();
-            float* dst = decodedData.data();
+        public:
+            GammaEncoder() noexcept
+            {
+                // the smallest value that is encoded to each of the values
+                thresholds[0] = 0.0F;
+                for (std::uint32_t encoded = 1; encoded < 256; ++encoded)
+                {
+                    std::uint32_t low = 0; // bits of 0.0F
+                    std::uint32_t high = oneBits;
+                    while (low < high)
+                    {
+                        const std::uint32_t middle = low + (high - low) / 2;
+                        if (gammaEncode(bitCast<float>(middle)) >= encoded)
+                            high = middle;
+                        else
+                            low = middle + 1;
+                    }
+                    thresholds[encoded] = bitCast<float>(low);
+                }
+                thresholds[256] = 2.0F; // never reached
+
+                for (std::uint32_t bucket = 0; bucket < bucketCount; ++bucket)
+                    bucketStarts[bucket] = gammaEncode(bitCast<float>(minBits + (bucket << bucketShift)));
+            }
 
+            std::uint8_t encode(float value) const noexcept
+            {
+                // everything below the smallest bucket is encoded to 0
+                if (!(value >= bitCast<float>(minBits))) return 0;
+                if (value >= 1.0F) return 255;
+
+                // the buckets are spaced logarithmically and are narrow enough to contain at most one threshold
+                const std::uint32_t encoded = bucketStarts[(bitCast<std::uint32_t>(value) - minBits) >> bucketShift];
+                return static_cast<std::uint8_t>(encoded + (value >= thresholds[encoded + 1] ? 1 : 0));
+            }
+
+        private:
+            static constexpr std::uint32_t oneBits = 0x3F800000U; // 1.0F
+            static constexpr std::uint32_t minBits = 0x33800000U; // 2^-24
+            static constexpr std::uint32_t bucketShift = 15; // 256 buckets for every power of two
+            static constexpr std::uint32_t bucketCount = (oneBits - minBits) >> bucketShift;
+
+            float thresholds[257];
+            std::uint8_t bucketStarts[bucketCount];
+        };
+
+        const GammaEncoder& getGammaEncoder()
+        {
+            static const GammaEncoder gammaEncoder;
+            return gammaEncoder;
+        }
+
+        void decodeRow(const std::uint8_t* src, float* dst, std::uint32_t width, PixelFormat pixelFormat)
+        {
             switch (pixelFormat)
             {
                 case PixelFormat::rgba8UnsignedNorm:
                 case PixelFormat::rgba8UnsignedNormSRGB:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
+                    for (std::uint32_t x = 0; x < width; ++x, src += 4, dst += 4)
                     {
-                        const std::uint8_t* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 4, dst += 4)
-                        {
-                            dst[0] = gammaDecode(pixel[0]); // red
-                            dst[1] = gammaDecode(pixel[1]); // green
-                            dst[2] = gammaDecode(pixel[2]); // blue
-                            dst[3] = pixel[3] / 255.0F; // alpha
-                        }
+                        dst[0] = gammaDecode(src[0]); // red
+                        dst[1] = gammaDecode(src[1]); // green
+                        dst[2] = gammaDecode(src[2]); // blue
+                        dst[3] = src[3] / 255.0F; // alpha
                     }
                     break;
 
                 case PixelFormat::rg8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const std::uint8_t* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 2, dst += 2)
-                        {
-                            dst[0] = gammaDecode(pixel[0]); // red
-                            dst[1] = gammaDecode(pixel[1]); // green
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width * 2; ++x)
+                        dst[x] = gammaDecode(src[x]); // red and green
                     break;
 
                 case PixelFormat::r8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const std::uint8_t* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 4, dst += 1)
-                        {
-                            dst[0] = gammaDecode(pixel[0]); // red
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width; ++x)
+                        dst[x] = gammaDecode(src[x]); // red
                     break;
 
                 case PixelFormat::a8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const std::uint8_t* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 1, dst += 1)
-                        {
-                            dst[0] = pixel[0] / 255.0F; // alpha
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width; ++x)
+                        dst[x] = src[x] / 255.0F; // alpha
                     break;
 
                 default:
@@ -471,66 +513,36 @@ namespace ouzel::graphics
             }
         }
 
-        void encode(const Size2U& size,
-                    const std::vector<float>& decodedData,
-                    PixelFormat pixelFormat,
-                    std::vector<std::uint8_t>& encodedData)
+        void encodeRow(const float* src, std::uint8_t* dst, std::uint32_t width, PixelFormat pixelFormat)
         {
-            const std::uint32_t pixelSize = getPixelSize(pixelFormat);
-            const std::uint32_t pitch = size.width() * pixelSize;
-            encodedData.resize(size.width() * size.height() * pixelSize);
-            const float* src = decodedData.data();
-            std::uint8_t* dst = encodedData.data();
+            const GammaEncoder& gammaEncoder = getGammaEncoder();
 
             switch (pixelFormat)
             {
                 case PixelFormat::rgba8UnsignedNorm:
                 case PixelFormat::rgba8UnsignedNormSRGB:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
+                    for (std::uint32_t x = 0; x < width; ++x, src += 4, dst += 4)
                     {
-                        const float* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 4, dst += 4)
-                        {
-                            dst[0] = gammaEncode(pixel[0]); // red
-                            dst[1] = gammaEncode(pixel[1]); // green
-                            dst[2] = gammaEncode(pixel[2]); // blue
-                            dst[3] = static_cast<std::uint8_t>(std::round(pixel[3] * 255.0F)); // alpha
-                        }
+                        dst[0] = gammaEncoder.encode(src[0]); // red
+                        dst[1] = gammaEncoder.encode(src[1]); // green
+                        dst[2] = gammaEncoder.encode(src[2]); // blue
+                        dst[3] = static_cast<std::uint8_t>(std::round(src[3] * 255.0F)); // alpha
                     }
                     break;
 
                 case PixelFormat::rg8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const float* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 2, dst += 2)
-                        {
-                            dst[0] = gammaEncode(pixel[0]); // red
-                            dst[1] = gammaEncode(pixel[1]); // green
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width * 2; ++x)
+                        dst[x] = gammaEncoder.encode(src[x]); // red and green
                     break;
 
                 case PixelFormat::r8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const float* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 1, dst += 1)
-                        {
-                            dst[0] = gammaEncode(pixel[0]); // red
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width; ++x)
+                        dst[x] = gammaEncoder.encode(src[x]); // red
                     break;
 
                 case PixelFormat::a8UnsignedNorm:
-                    for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch)
-                    {
-                        const float* pixel = src;
-                        for (std::uint32_t x = 0; x < size.width(); ++x, pixel += 1, dst += 1)
-                        {
-                            dst[0] = static_cast<std::uint8_t>(std::round(pixel[0] * 255.0F)); // alpha
-                        }
-                    }
+                    for (std::uint32_t x = 0; x < width; ++x)
+                        dst[x] = static_cast<std::uint8_t>(std::round(src[x] * 255.0F)); // alpha
                     break;
 
                 default:
@@ -538,6 +550,87 @@ namespace ouzel::graphics
             }
         }
 
+        void decode(const Size2U& size,
+                    const std::vector<std::uint8_t>& encodedData,
+                    PixelFormat pixelFormat,
+                    std::vector<float>& decodedData)
+        {
+            const std::uint32_t channelCount = getChannelCount(pixelFormat);
+            const std::uint32_t pitch = size.width() * channelCount;
+            decodedData.resize(size.width() * size.height() * channelCount);
+            const std::uint8_t* src = encodedData.data();
+            float* dst = decodedData.data();
+
+            for (std::uint32_t y = 0; y < size.height(); ++y, src += pitch, dst += pitch)
+                decodeRow(src, dst, size.width(), pixelFormat);
+        }
+
+        void encode(const Size2U& size,
+                    const std::vector<float>& decodedData,
+                    PixelFormat pixelFormat,
+                    std::vector<std::uint8_t>& encodedData)
+        {
+            const std::uint32_t pixelSize = getPixelSize(pixelFormat);
+            const std::uint32_t pitch = size.width() * pixelSize;
+            encodedData.resize(size.width() * size.height() * pixelSize);
+            const float* src = decodedData.data();
+            std::uint8_t* dst = encodedData.data();
+
+            forEachRowBand(size.height(), size.width(), [src, dst, pitch, &size, pixelFormat](std::uint32_t firstRow, std::uint32_t lastRow) {
+                for (std::uint32_t y = firstRow; y < lastRow; ++y)
+                    encodeRow(src + std::size_t{y} * pitch, dst + std::size_t{y} * pitch, size.width(), pixelFormat);
+            });
+        }
+
+        // downsamples the encoded image without decoding all of it first
+        void decodeDownsample2x2(const Size2U& size,
+                                 const std::vector<std::uint8_t>& encodedData,
+                                 PixelFormat pixelFormat,
+                                 DownsampleRow downsampleRow,
+                                 DownsamplePair downsamplePair,
+                                 std::vector<float>& resized)
+        {
+            const std::uint32_t channelCount = getChannelCount(pixelFormat);
+
+            if (size.width() < 2 || size.height() < 2)
+            {
+                std::vector<float> decodedData;
+                decode(size, encodedData, pixelFormat, decodedData);
+                downsample2x2(size.width(), size.height(), channelCount, downsampleRow, downsamplePair, decodedData, resized);
+                return;
+            }
+
+            const std::uint32_t dstWidth = size.width() >> 1;
+            const std::uint32_t dstHeight = size.height() >> 1;
+            const std::uint32_t pitch = size.width() * channelCount;
+            resized.resize(dstWidth * dstHeight * channelCount);
+            const std::uint8_t* src = encodedData.data();
+            float* dst = resized.data();
+
+            forEachRowBand(dstHeight, dstWidth, [src, dst, pitch, dstWidth, channelCount, pixelFormat, downsampleRow](std::uint32_t firstRow, std::uint32_t lastRow) {
+                // both rows are decoded in chunks that fit in the cache
+                constexpr std::uint32_t chunkWidth = 256;
+                float top[chunkWidth * 2 * 4];
+                float bottom[chunkWidth * 2 * 4];
+
+                for (std::uint32_t y = firstRow; y < lastRow; ++y)
+                {
+                    const std::uint8_t* topRow = src + std::size_t{y} * pitch * 2;
+                    float* dstRow = dst + std::size_t{y} * dstWidth * channelCount;
+
+                    for (std::uint32_t x = 0; x < dstWidth; x += chunkWidth)
+                    {
+                        const std::uint32_t width = std::min(chunkWidth, dstWidth - x);
+                        const std::size_t offset = std::size_t{x} * 2 * channelCount;
+
+                        decodeRow(topRow + offset, top, width * 2, pixelFormat);
+                        decodeRow(topRow + pitch + offset, bottom, width * 2, pixelFormat);
+                        downsampleRow(top, bottom, dstRow + std::size_t{x} * channelCount, width);
+                    }
+                }
+            });
+        }
+
         std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> calculateSizes(const Size2U& size,
                                                                                  std::uint32_t mipmaps,
                                                                                  PixelFormat pixelFormat)
@@ -547,9 +640,7 @@ namespace ouzel::graphics
             std::uint32_t newWidth = size.v[0];
             std::uint32_t newHeight = size.v[1];
 
-            const std::uint32_t pixelSize = getPixelSize(pixelFormat);
-            std::uint32_t bufferSize = newWidth * newHeight * pixelSize;
-            levels.emplace_back(size, std::vector<std::uint8_t>(bufferSize));
+            levels.emplace_back(size, std::vector<std::uint8_t>(getLevelSize(pixelFormat, newWidth, newHeight)));
 
             while ((newWidth > 1 || newHeight > 1) &&
                 (mipmaps == 0 || levels.size() < mipmaps))
@@ -561,34 +652,58 @@ namespace ouzel::graphics
                 if (newHeight < 1) newHeight = 1;
 
                 auto mipMapSize = Size2U(newWidth, newHeight);
-                bufferSize = newWidth * newHeight * pixelSize;
 
-                levels.emplace_back(mipMapSize, std::vector<std::uint8_t>(bufferSize));
+                levels.emplace_back(mipMapSize, std::vector<std::uint8_t>(getLevelSize(pixelFormat, newWidth, newHeight)));
             }
 
             return levels;
         }
 
         std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> calculateSizes(const Size2U& size,
-                                                                                 const std::vector<std::uint8_t>& data,
+                                                                                 std::vector<std::uint8_t> data,
                                                                                  std::uint32_t mipmaps,
-                                                                                 PixelFormat pixelFormat)
+                                                                                 PixelFormat pixelFormat,
+                                                                                 bool premultipliedAlpha)
         {
             std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels;
 
             std::uint32_t newWidth = size.v[0];
             std::uint32_t newHeight = size.v[1];
 
-            levels.emplace_back(size, data);
+            DownsampleRow downsampleRow;
+            DownsamplePair downsamplePair;
+
+            switch (pixelFormat)
+            {
+                case PixelFormat::rgba8UnsignedNorm:
+                case PixelFormat::rgba8UnsignedNormSRGB:
+                    downsampleRow = premultipliedAlpha ? downsampleRowRgba8Premultiplied : downsampleRowRgba8;
+                    downsamplePair = premultipliedAlpha ? downsamplePairRgba8Premultiplied : downsamplePairRgba8;
+                    break;
+
+                case PixelFormat::rg8UnsignedNorm:
+                    downsampleRow = downsampleRowRg8;
+                    downsamplePair = downsamplePairRg8;
+                    break;
+
+                case PixelFormat::r8UnsignedNorm:
+                case PixelFormat::a8UnsignedNorm:
+                    downsampleRow = downsampleRowR8;
+                    downsamplePair = downsamplePairR8;
+                    break;
+
+                default:
+                    throw std::runtime_error("Invalid pixel format");
+            }
+
+            const std::uint32_t channelCount = getChannelCount(pixelFormat);
+
+            levels.emplace_back(size, std::move(data));
 
             std::uint32_t previousWidth = newWidth;
             std::uint32_t previousHeight = newHeight;
             std::vector<float> previousData;
-
-            decode(size, data, pixelFormat, previousData);
-
             std::vector<float> newData;
-            std::vector<std::uint8_t> encodedData;
 
             while ((newWidth > 1 || newHeight > 1) &&
                 (mipmaps == 0 || levels.size() < mipmaps))
@@ -601,33 +716,15 @@ namespace ouzel::graphics
 
                 auto mipMapSize = Size2U(newWidth, newHeight);
 
-                switch (pixelFormat)
-                {
-                    case PixelFormat::rgba8UnsignedNorm:
-                    case PixelFormat::rgba8UnsignedNormSRGB:
-                        downsample2x2Rgba8(previousWidth, previousHeight, previousData, newData);
-                        break;
-
-                    case PixelFormat::rg8UnsignedNorm:
-                        downsample2x2Rg8(previousWidth, previousHeight, previousData, newData);
-                        break;
-
-                    case PixelFormat::r8UnsignedNorm:
-                        downsample2x2R8(previousWidth, previousHeight, previousData, newData);
-                        break;
-
-                    case PixelFormat::a8UnsignedNorm:
-                        downsample2x2A8(previousWidth, previousHeight, previousData, newData);
-                        break;
-
-                    default:
-                        throw std::runtime_error("Invalid pixel format");
-                }
+                if (levels.size() == 1)
+                    decodeDownsample2x2(size, levels.front().second, pixelFormat, downsampleRow, downsamplePair, newData);
+                else
+                    downsample2x2(previousWidth, previousHeight, channelCount, downsampleRow, downsamplePair, previousData, newData);
 
-                encode(mipMapSize, newData, pixelFormat, encodedData);
-                levels.emplace_back(mipMapSize, encodedData);
+                levels.emplace_back(mipMapSize, std::vector<std::uint8_t>());
+                encode(mipMapSize, newData, pixelFormat, levels.back().second);
 
-                previousData = newData;
+                std::swap(previousData, newData);
 
                 previousWidth = newWidth;
                 previousHeight = newHeight;
@@ -672,7 +769,7 @@ namespace ouzel::graphics
         std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels = calculateSizes(size, mipmaps, pixelFormat);
 
         initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                    levels,
+                                                                    std::move(levels),
                                                                     TextureType::twoDimensional,
                                                                     flags,
                                                                     sampleCount,
@@ -687,6 +784,21 @@ namespace ouzel::graphics
                      Flags initFlags,
                      std::uint32_t initMipmaps,
                      PixelFormat initPixelFormat):
+        Texture(initGraphics,
+                std::vector<std::uint8_t>(initData),
+                initSize,
+                initFlags,
+                initMipmaps,
+                initPixelFormat)
+    {
+    }
+
+    Texture::Texture(Graphics& initGraphics,
+                     std::vector<std::uint8_t>&& initData,
+                     const Size2U& initSize,
+                     Flags initFlags,
+                     std::uint32_t initMipmaps,
+                     PixelFormat initPixelFormat):
         graphics(&initGraphics),
         resource(*initGraphics.getDevice()),
         size(initSize),
@@ -705,10 +817,11 @@ namespace ouzel::graphics
             (!isPowerOfTwo(size.v[0]) || !isPowerOfTwo(size.v[1])))
             mipmaps = 1;
 
-        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels = calculateSizes(size, initData, mipmaps, pixelFormat);
+        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels = calculateSizes(size, std::move(initData), mipmaps, pixelFormat,
+                                                                                           (flags & Flags::premultipliedAlpha) == Flags::premultipliedAlpha);
 
         initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                     levels,
+                                                                     std::move(levels),
                                                                      TextureType::twoDimensional,
                                                                      flags,
                                                                      sampleCount,
@@ -746,7 +859,7 @@ namespace ouzel::graphics
         }
 
         initGraphics.addCommand(std::make_unique<InitTextureCommand>(resource,
-                                                                     levels,
+                                                                     std::move(levels),
                                                                      TextureType::twoDimensional,
                                                                      flags,
                                                                      sampleCount,
@@ -761,7 +874,8 @@ namespace ouzel::graphics
             (flags & Flags::bindRenderTarget) == Flags::bindRenderTarget)
             throw std::runtime_error("Texture is not dynamic");
 
-        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels = calculateSizes(size, newData, mipmaps, pixelFormat);
+        std::vector<std::pair<Size2U, std::vector<std::uint8_t>>> levels = calculateSizes(size, newData, mipmaps, pixelFormat,
+                                                                                           (flags & Flags::premultipliedAlpha) == Flags::premultipliedAlpha);
 
         if (resource)
             graphics->addCommand(std::make_unique<SetTextureDataCommand>(resource,
@@ -37,6 +37,13 @@ namespace ouzel::graphics
                 Flags initFlags = Flags::none,
                 std::uint32_t initMipmaps = 0,
                 PixelFormat initPixelFormat = PixelFormat::rgba8UnsignedNorm);
+        // the data becomes the first level of the texture without being copied
+        Texture(Graphics& initGraphics,
+                std::vector<std::uint8_t>&& initData,
+                const Size2U& initSize,
+                Flags initFlags = Flags::none,
+                std::uint32_t initMipmaps = 0,
+                PixelFormat initPixelFormat = PixelFormat::rgba8UnsignedNorm);
         Texture(Graphics& initGraphics,
                 const std::vector<std::pair<Size2U, std::vector<std::uint8_t>>>& initLevels,
                 const Size2U& initSize,
@@ -49,6 +49,16 @@ namespace ouzel::graphics
         Vector2F texCoords[2];
         Vector3F normal;
     };
+
+    // a quad drawn by the instanced shaders, they calculate its corners from the centre, the half size and the rotation
+    class InstanceVertex final
+    {
+    public:
+        Vector2F position;
+        Color color;
+        float halfSize = 0.0F; // the half size and the rotation are the first texture coordinates
+        float rotation = 0.0F;
+    };
 }
 
 #endif // OUZEL_GRAPHICS_VERTEX_HPP
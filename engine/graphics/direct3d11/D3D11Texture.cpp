@@ -46,6 +46,19 @@ namespace ouzel::graphics::d3d11
                 case PixelFormat::rgba32UnsignedInt: return DXGI_FORMAT_R32G32B32A32_UINT;
                 case PixelFormat::rgba32SignedInt: return DXGI_FORMAT_R32G32B32A32_SINT;
                 case PixelFormat::rgba32Float: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+                case PixelFormat::bc1UnsignedNorm: return DXGI_FORMAT_BC1_UNORM;
+                case PixelFormat::bc1UnsignedNormSRGB: return DXGI_FORMAT_BC1_UNORM_SRGB;
+                case PixelFormat::bc3UnsignedNorm: return DXGI_FORMAT_BC3_UNORM;
+                case PixelFormat::bc3UnsignedNormSRGB: return DXGI_FORMAT_BC3_UNORM_SRGB;
+                case PixelFormat::bc7UnsignedNorm: return DXGI_FORMAT_BC7_UNORM;
+                case PixelFormat::bc7UnsignedNormSRGB: return DXGI_FORMAT_BC7_UNORM_SRGB;
+                case PixelFormat::etc2Rgb8UnsignedNorm:
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                case PixelFormat::etc2Rgba8UnsignedNorm:
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+                case PixelFormat::astc4x4UnsignedNorm:
+                case PixelFormat::astc4x4UnsignedNormSRGB:
+                    return DXGI_FORMAT_UNKNOWN; // not supported by Direct3D 11
                 case PixelFormat::depth: return DXGI_FORMAT_D32_FLOAT;
                 case PixelFormat::depthStencil: return DXGI_FORMAT_D24_UNORM_S8_UINT;
                 default: throw std::runtime_error("Invalid pixel format");
@@ -103,8 +116,8 @@ namespace ouzel::graphics::d3d11
         flags(initFlags),
         mipmaps(static_cast<std::uint32_t>(levels.size())),
         sampleCount(initSampleCount),
-        pixelFormat(d3d11::getPixelFormat(initPixelFormat)),
-        pixelSize(getPixelSize(initPixelFormat))
+        dataPixelFormat(initPixelFormat),
+        pixelFormat(d3d11::getPixelFormat(initPixelFormat))
     {
         if ((flags & Flags::bindRenderTarget) == Flags::bindRenderTarget &&
             (mipmaps == 0 || mipmaps > 1))
@@ -182,7 +195,7 @@ namespace ouzel::graphics::d3d11
             for (std::size_t level = 0; level < levels.size(); ++level)
             {
                 subresourceData[level].pSysMem = levels[level].second.data();
-                subresourceData[level].SysMemPitch = static_cast<UINT>(levels[level].first.v[0] * pixelSize);
+                subresourceData[level].SysMemPitch = static_cast<UINT>(getRowPitch(dataPixelFormat, levels[level].first.v[0]));
                 subresourceData[level].SysMemSlicePitch = 0;
             }
 
@@ -344,7 +357,9 @@ namespace ouzel::graphics::d3d11
 
                 auto destination = static_cast<std::uint8_t*>(mappedSubresource.pData);
 
-                if (mappedSubresource.RowPitch == levels[level].first.v[0] * pixelSize)
+                const auto rowSize = getRowPitch(dataPixelFormat, levels[level].first.v[0]);
+
+                if (mappedSubresource.RowPitch == rowSize)
                 {
                     std::copy(levels[level].second.begin(),
                                 levels[level].second.end(),
@@ -353,8 +368,7 @@ namespace ouzel::graphics::d3d11
                 else
                 {
                     auto source = levels[level].second.begin();
-                    auto rowSize = static_cast<std::uint32_t>(levels[level].first.v[0]) * pixelSize;
-                    auto rows = static_cast<UINT>(levels[level].first.v[1]);
+                    const auto rows = static_cast<UINT>(getRowCount(dataPixelFormat, levels[level].first.v[1]));
 
                     for (UINT row = 0; row < rows; ++row)
                     {
@@ -362,7 +376,7 @@ namespace ouzel::graphics::d3d11
                                     source + rowSize,
                                     destination);
 
-                        source += levels[level].first.v[0] * pixelSize;
+                        source += rowSize;
                         destination += mappedSubresource.RowPitch;
                     }
                 }
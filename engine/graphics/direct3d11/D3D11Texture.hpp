@@ -92,8 +92,8 @@ namespace ouzel::graphics::d3d11
         Flags flags = Flags::none;
         std::uint32_t mipmaps = 0;
         std::uint32_t sampleCount = 1;
+        PixelFormat dataPixelFormat = PixelFormat::rgba8UnsignedNorm;
         DXGI_FORMAT pixelFormat = DXGI_FORMAT_UNKNOWN;
-        std::uint32_t pixelSize = 0;
         SamplerStateDesc samplerDescriptor;
 
         Pointer<ID3D11Texture2D> texture;
@@ -102,8 +102,8 @@ namespace ouzel::graphics::metal
         MTLSamplerStatePtr samplerState = nil;
         Pointer<MTLTexturePtr> msaaTexture;
 
+        PixelFormat dataPixelFormat = PixelFormat::rgba8UnsignedNorm;
         MTLPixelFormat pixelFormat;
-        std::uint32_t pixelSize = 0;
         bool stencilBuffer = false;
     };
 }
@@ -4,6 +4,7 @@
 
 #if OUZEL_COMPILE_METAL
 
+#include <TargetConditionals.h>
 #include "MetalTexture.hpp"
 #include "MetalError.hpp"
 #include "MetalRenderDevice.hpp"
@@ -47,6 +48,35 @@ namespace ouzel::graphics::metal
                 case PixelFormat::rgba32UnsignedInt: return MTLPixelFormatRGBA32Uint;
                 case PixelFormat::rgba32SignedInt: return MTLPixelFormatRGBA32Sint;
                 case PixelFormat::rgba32Float: return MTLPixelFormatRGBA32Float;
+#if TARGET_OS_IOS || TARGET_OS_TV
+                case PixelFormat::bc1UnsignedNorm:
+                case PixelFormat::bc1UnsignedNormSRGB:
+                case PixelFormat::bc3UnsignedNorm:
+                case PixelFormat::bc3UnsignedNormSRGB:
+                case PixelFormat::bc7UnsignedNorm:
+                case PixelFormat::bc7UnsignedNormSRGB:
+                    return MTLPixelFormatInvalid; // BC formats are only available on macOS
+                case PixelFormat::etc2Rgb8UnsignedNorm: return MTLPixelFormatETC2_RGB8;
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB: return MTLPixelFormatETC2_RGB8_sRGB;
+                case PixelFormat::etc2Rgba8UnsignedNorm: return MTLPixelFormatEAC_RGBA8;
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB: return MTLPixelFormatEAC_RGBA8_sRGB;
+                case PixelFormat::astc4x4UnsignedNorm: return MTLPixelFormatASTC_4x4_LDR;
+                case PixelFormat::astc4x4UnsignedNormSRGB: return MTLPixelFormatASTC_4x4_sRGB;
+#else
+                case PixelFormat::bc1UnsignedNorm: return MTLPixelFormatBC1_RGBA;
+                case PixelFormat::bc1UnsignedNormSRGB: return MTLPixelFormatBC1_RGBA_sRGB;
+                case PixelFormat::bc3UnsignedNorm: return MTLPixelFormatBC3_RGBA;
+                case PixelFormat::bc3UnsignedNormSRGB: return MTLPixelFormatBC3_RGBA_sRGB;
+                case PixelFormat::bc7UnsignedNorm: return MTLPixelFormatBC7_RGBAUnorm;
+                case PixelFormat::bc7UnsignedNormSRGB: return MTLPixelFormatBC7_RGBAUnorm_sRGB;
+                case PixelFormat::etc2Rgb8UnsignedNorm:
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                case PixelFormat::etc2Rgba8UnsignedNorm:
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+                case PixelFormat::astc4x4UnsignedNorm:
+                case PixelFormat::astc4x4UnsignedNormSRGB:
+                    return MTLPixelFormatInvalid; // ETC2 and ASTC formats are only available on iOS and tvOS
+#endif
                 case PixelFormat::depth: return MTLPixelFormatDepth32Float;
                 case PixelFormat::depthStencil: return MTLPixelFormatDepth32Float_Stencil8; // MTLPixelFormatDepth24Unorm_Stencil8 is only available on macOS
                 default: throw std::runtime_error("Invalid pixel format");
@@ -104,8 +134,8 @@ namespace ouzel::graphics::metal
         flags(initFlags),
         mipmaps(static_cast<std::uint32_t>(levels.size())),
         sampleCount(initSampleCount),
+        dataPixelFormat(initPixelFormat),
         pixelFormat(getMetalPixelFormat(initPixelFormat)),
-        pixelSize(getPixelSize(initPixelFormat)),
         stencilBuffer(initPixelFormat == PixelFormat::depthStencil)
     {
         if ((flags & Flags::bindRenderTarget) == Flags::bindRenderTarget &&
@@ -182,7 +212,7 @@ namespace ouzel::graphics::metal
                                                                  static_cast<NSUInteger>(levels[level].first.v[1]))
                                      mipmapLevel:level
                                        withBytes:levels[level].second.data()
-                                     bytesPerRow:static_cast<NSUInteger>(levels[level].first.v[0] * pixelSize)];
+                                     bytesPerRow:static_cast<NSUInteger>(getRowPitch(dataPixelFormat, levels[level].first.v[0]))];
             }
         }
 
@@ -209,7 +239,7 @@ namespace ouzel::graphics::metal
                                                              static_cast<NSUInteger>(levels[level].first.v[1]))
                                  mipmapLevel:level
                                    withBytes:levels[level].second.data()
-                                 bytesPerRow:static_cast<NSUInteger>(levels[level].first.v[0] * pixelSize)];
+                                 bytesPerRow:static_cast<NSUInteger>(getRowPitch(dataPixelFormat, levels[level].first.v[0]))];
         }
     }
 
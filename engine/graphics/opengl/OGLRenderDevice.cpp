@@ -336,6 +336,8 @@ namespace ouzel::graphics::opengl
         glTexParameterfvProc = getter.get<PFNGLTEXPARAMETERFVPROC>("glTexParameterfv", ApiVersion(1, 0));
         glTexImage2DProc = getter.get<PFNGLTEXIMAGE2DPROC>("glTexImage2D", ApiVersion(1, 0));
         glTexSubImage2DProc = getter.get<PFNGLTEXSUBIMAGE2DPROC>("glTexSubImage2D", ApiVersion(1, 0));
+        glCompressedTexImage2DProc = getter.get<PFNGLCOMPRESSEDTEXIMAGE2DPROC>("glCompressedTexImage2D", ApiVersion(2, 0));
+        glCompressedTexSubImage2DProc = getter.get<PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC>("glCompressedTexSubImage2D", ApiVersion(2, 0));
         glViewportProc = getter.get<PFNGLVIEWPORTPROC>("glViewport", ApiVersion(1, 0));
         glClearProc = getter.get<PFNGLCLEARPROC>("glClear", ApiVersion(1, 0));
         glClearColorProc = getter.get<PFNGLCLEARCOLORPROC>("glClearColor", ApiVersion(1, 0));
@@ -431,6 +433,9 @@ namespace ouzel::graphics::opengl
         glDeleteVertexArraysProc = getter.get<PFNGLDELETEVERTEXARRAYSPROC>("glDeleteVertexArrays", ApiVersion(3, 0),
                                                                            {{"glDeleteVertexArraysOES", "GL_OES_vertex_array_object"}});
 
+        glDrawElementsInstancedProc = getter.get<PFNGLDRAWELEMENTSINSTANCEDPROC>("glDrawElementsInstanced", ApiVersion(3, 0));
+        glVertexAttribDivisorProc = getter.get<PFNGLVERTEXATTRIBDIVISORPROC>("glVertexAttribDivisor", ApiVersion(3, 0));
+
         glPushGroupMarkerEXTProc = getter.get<PFNGLPUSHGROUPMARKEREXTPROC>("glPushGroupMarkerEXT", "GL_EXT_debug_marker");
         glPopGroupMarkerEXTProc = getter.get<PFNGLPOPGROUPMARKEREXTPROC>("glPopGroupMarkerEXT", "GL_EXT_debug_marker");
 
@@ -482,6 +487,8 @@ namespace ouzel::graphics::opengl
         glTexParameterfvProc = getter.get<PFNGLTEXPARAMETERFVPROC>("glTexParameterfv", ApiVersion(1, 0));
         glTexImage2DProc = getter.get<PFNGLTEXIMAGE2DPROC>("glTexImage2D", ApiVersion(1, 0));
         glTexSubImage2DProc = getter.get<PFNGLTEXSUBIMAGE2DPROC>("glTexSubImage2D", ApiVersion(1, 1));
+        glCompressedTexImage2DProc = getter.get<PFNGLCOMPRESSEDTEXIMAGE2DPROC>("glCompressedTexImage2D", ApiVersion(1, 3));
+        glCompressedTexSubImage2DProc = getter.get<PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC>("glCompressedTexSubImage2D", ApiVersion(1, 3));
         glViewportProc = getter.get<PFNGLVIEWPORTPROC>("glViewport", ApiVersion(1, 0));
         glClearProc = getter.get<PFNGLCLEARPROC>("glClear", ApiVersion(1, 0));
         glClearColorProc = getter.get<PFNGLCLEARCOLORPROC>("glClearColor", ApiVersion(1, 0));
@@ -610,6 +617,12 @@ namespace ouzel::graphics::opengl
         glDeleteVertexArraysProc = getter.get<PFNGLDELETEVERTEXARRAYSPROC>("glDeleteVertexArrays", ApiVersion(3, 0),
                                                                            {{"glDeleteVertexArrays", "GL_ARB_vertex_array_object"}});
 
+        glDrawElementsInstancedProc = getter.get<PFNGLDRAWELEMENTSINSTANCEDPROC>("glDrawElementsInstanced", ApiVersion(3, 1),
+                                                                                 {{"glDrawElementsInstancedARB", "GL_ARB_draw_instanced"},
+                                                                                  {"glDrawElementsInstancedEXT", "GL_EXT_draw_instanced"}});
+        glVertexAttribDivisorProc = getter.get<PFNGLVERTEXATTRIBDIVISORPROC>("glVertexAttribDivisor", ApiVersion(3, 3),
+                                                                             {{"glVertexAttribDivisorARB", "GL_ARB_instanced_arrays"}});
+
         glCopyImageSubDataProc = getter.get<PFNGLCOPYIMAGESUBDATAPROC>("glCopyImageSubData", ApiVersion(4, 3),
                                                                        {{"glCopyImageSubData", "GL_ARB_copy_image"}, {"glCopyImageSubDataEXT", "GL_EXT_copy_image"}});
 
@@ -617,6 +630,9 @@ namespace ouzel::graphics::opengl
         glPopGroupMarkerEXTProc = getter.get<PFNGLPOPGROUPMARKEREXTPROC>("glPopGroupMarkerEXT", "GL_EXT_debug_marker");
 #endif
 
+        // the instanced shaders need gl_VertexID, which is not available before OpenGL (ES) 3
+        instancingSupported = apiVersion >= ApiVersion(3, 0) && glDrawElementsInstancedProc && glVertexAttribDivisorProc;
+
         if (!multisamplingSupported) sampleCount = 1;
 
         glDisableProc(GL_DITHER);
@@ -1043,21 +1059,40 @@ namespace ouzel::graphics::opengl
 
                         const std::byte* vertexOffset = nullptr;
 
+                        // instanced draws read an InstanceVertex once per instance
+                        const bool instanced = drawCommand->instanceCount != 0;
+                        const auto vertexAttributes = instanced ?
+                            RenderDevice::INSTANCE_ATTRIBUTES.data() : RenderDevice::VERTEX_ATTRIBUTES.data();
+                        const auto vertexAttributeCount = static_cast<GLuint>(instanced ?
+                            RenderDevice::INSTANCE_ATTRIBUTES.size() : RenderDevice::VERTEX_ATTRIBUTES.size());
+                        const auto vertexSize = static_cast<GLsizei>(instanced ? sizeof(InstanceVertex) : sizeof(Vertex));
+                        const GLuint vertexAttribDivisor = instanced ? 1 : 0;
+
                         for (GLuint index = 0; index < RenderDevice::VERTEX_ATTRIBUTES.size(); ++index)
                         {
-                            const auto& vertexAttribute = RenderDevice::VERTEX_ATTRIBUTES[index];
+                            if (index < vertexAttributeCount)
+                            {
+                                const auto& vertexAttribute = vertexAttributes[index];
 
-                            glEnableVertexAttribArrayProc(index);
-                            glVertexAttribPointerProc(index,
-                                                      getArraySize(vertexAttribute.dataType),
-                                                      getVertexType(vertexAttribute.dataType),
-                                                      isNormalized(vertexAttribute.dataType),
-                                                      static_cast<GLsizei>(sizeof(Vertex)),
-                                                      vertexOffset);
+                                glEnableVertexAttribArrayProc(index);
+                                glVertexAttribPointerProc(index,
+                                                          getArraySize(vertexAttribute.dataType),
+                                                          getVertexType(vertexAttribute.dataType),
+                                                          isNormalized(vertexAttribute.dataType),
+                                                          vertexSize,
+                                                          vertexOffset);
 
-                            vertexOffset += getDataTypeSize(vertexAttribute.dataType);
+                                vertexOffset += getDataTypeSize(vertexAttribute.dataType);
+                            }
+                            else // the attributes past the end of the instance are not read
+                                glDisableVertexAttribArrayProc(index);
+
+                            if (stateCache.vertexAttribDivisor != vertexAttribDivisor)
+                                glVertexAttribDivisorProc(index, vertexAttribDivisor);
                         }
 
+                        stateCache.vertexAttribDivisor = vertexAttribDivisor;
+
                         GLenum error;
                         if ((error = glGetErrorProc()) != GL_NO_ERROR)
                             throw std::system_error(makeErrorCode(error), "Failed to update vertex attributes");
@@ -1069,10 +1104,17 @@ namespace ouzel::graphics::opengl
                         const std::byte* indexOffset = nullptr;
                         indexOffset += drawCommand->startIndex * drawCommand->indexSize;
 
-                        glDrawElementsProc(getDrawMode(drawCommand->drawMode),
-                                           static_cast<GLsizei>(drawCommand->indexCount),
-                                           getIndexType(drawCommand->indexSize),
-                                           indexOffset);
+                        if (drawCommand->instanceCount)
+                            glDrawElementsInstancedProc(getDrawMode(drawCommand->drawMode),
+                                                        static_cast<GLsizei>(drawCommand->indexCount),
+                                                        getIndexType(drawCommand->indexSize),
+                                                        indexOffset,
+                                                        static_cast<GLsizei>(drawCommand->instanceCount));
+                        else
+                            glDrawElementsProc(getDrawMode(drawCommand->drawMode),
+                                               static_cast<GLsizei>(drawCommand->indexCount),
+                                               getIndexType(drawCommand->indexSize),
+                                               indexOffset);
 
                         if ((error = glGetErrorProc()) != GL_NO_ERROR)
                             throw std::system_error(makeErrorCode(error), "Failed to draw elements");
@@ -61,6 +61,8 @@ namespace ouzel::graphics::opengl
         PFNGLTEXPARAMETERFVPROC glTexParameterfvProc = nullptr;
         PFNGLTEXIMAGE2DPROC glTexImage2DProc = nullptr;
         PFNGLTEXSUBIMAGE2DPROC glTexSubImage2DProc = nullptr;
+        PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2DProc = nullptr;
+        PFNGLCOMPRESSEDTEXSUBIMAGE2DPROC glCompressedTexSubImage2DProc = nullptr;
         PFNGLVIEWPORTPROC glViewportProc = nullptr;
         PFNGLCLEARPROC glClearProc = nullptr;
         PFNGLCLEARCOLORPROC glClearColorProc = nullptr;
@@ -74,6 +76,7 @@ namespace ouzel::graphics::opengl
         PFNGLCULLFACEPROC glCullFaceProc = nullptr;
         PFNGLSCISSORPROC glScissorProc = nullptr;
         PFNGLDRAWELEMENTSPROC glDrawElementsProc = nullptr;
+        PFNGLDRAWELEMENTSINSTANCEDPROC glDrawElementsInstancedProc = nullptr;
         PFNGLREADPIXELSPROC glReadPixelsProc = nullptr;
 
         PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparateProc = nullptr;
@@ -161,6 +164,7 @@ namespace ouzel::graphics::opengl
         PFNGLENABLEVERTEXATTRIBARRAYPROC glEnableVertexAttribArrayProc = nullptr;
         PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArrayProc = nullptr;
         PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointerProc = nullptr;
+        PFNGLVERTEXATTRIBDIVISORPROC glVertexAttribDivisorProc = nullptr;
 
         PFNGLGETSTRINGIPROC glGetStringiProc = nullptr;
         PFNGLPUSHGROUPMARKEREXTPROC glPushGroupMarkerEXTProc = nullptr;
@@ -625,6 +629,7 @@ namespace ouzel::graphics::opengl
             };
             GLuint programId = 0;
             GLuint frameBufferId = 0;
+            GLuint vertexAttribDivisor = 0;
 
             std::unordered_map<GLenum, GLuint> bufferId{
                 {GL_ELEMENT_ARRAY_BUFFER, 0},
@@ -8,6 +8,44 @@
 #include "OGLError.hpp"
 #include "OGLRenderDevice.hpp"
 
+// the compressed formats are core only in newer versions of the APIs, so not all headers define them
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#  define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#  define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#  define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#  define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#  define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#  define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#  define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ETC2
+#  define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#  define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+#  define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#  define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+#  define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#endif
+
 namespace ouzel::graphics::opengl
 {
     namespace
@@ -49,6 +87,18 @@ namespace ouzel::graphics::opengl
                     case PixelFormat::rgba32UnsignedInt: return GL_RGBA32UI;
                     case PixelFormat::rgba32SignedInt: return GL_RGBA32I;
                     case PixelFormat::rgba32Float: return GL_RGBA32F;
+                    case PixelFormat::bc1UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                    case PixelFormat::bc1UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+                    case PixelFormat::bc3UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                    case PixelFormat::bc3UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                    case PixelFormat::bc7UnsignedNorm: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                    case PixelFormat::bc7UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+                    case PixelFormat::etc2Rgb8UnsignedNorm: return GL_COMPRESSED_RGB8_ETC2;
+                    case PixelFormat::etc2Rgb8UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ETC2;
+                    case PixelFormat::etc2Rgba8UnsignedNorm: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                    case PixelFormat::etc2Rgba8UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+                    case PixelFormat::astc4x4UnsignedNorm: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                    case PixelFormat::astc4x4UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
                     case PixelFormat::depth: return GL_DEPTH_COMPONENT24;
                     case PixelFormat::depthStencil: return GL_DEPTH24_STENCIL8;
                     default: throw Error("Invalid pixel format");
@@ -60,6 +110,10 @@ namespace ouzel::graphics::opengl
                 {
                     case PixelFormat::a8UnsignedNorm: return GL_ALPHA;
                     case PixelFormat::rgba8UnsignedNorm: return GL_RGBA;
+                    case PixelFormat::bc1UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                    case PixelFormat::bc3UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                    case PixelFormat::astc4x4UnsignedNorm: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                    case PixelFormat::astc4x4UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
                     case PixelFormat::depth: return GL_DEPTH_COMPONENT24;
                     case PixelFormat::depthStencil: return GL_DEPTH24_STENCIL8;
                     default: throw Error("Invalid pixel format");
@@ -101,6 +155,18 @@ namespace ouzel::graphics::opengl
                 case PixelFormat::rgba32UnsignedInt: return GL_RGBA32UI;
                 case PixelFormat::rgba32SignedInt: return GL_RGBA32I;
                 case PixelFormat::rgba32Float: return GL_RGBA32F;
+                case PixelFormat::bc1UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+                case PixelFormat::bc1UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+                case PixelFormat::bc3UnsignedNorm: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                case PixelFormat::bc3UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+                case PixelFormat::bc7UnsignedNorm: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+                case PixelFormat::bc7UnsignedNormSRGB: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+                case PixelFormat::etc2Rgb8UnsignedNorm: return GL_COMPRESSED_RGB8_ETC2;
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ETC2;
+                case PixelFormat::etc2Rgba8UnsignedNorm: return GL_COMPRESSED_RGBA8_ETC2_EAC;
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+                case PixelFormat::astc4x4UnsignedNorm: return GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+                case PixelFormat::astc4x4UnsignedNormSRGB: return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
                 case PixelFormat::depth: return GL_DEPTH_COMPONENT24;
                 case PixelFormat::depthStencil: return GL_DEPTH24_STENCIL8;
                 default: throw Error("Invalid pixel format");
@@ -153,6 +219,19 @@ namespace ouzel::graphics::opengl
                     return GL_DEPTH_COMPONENT;
                 case PixelFormat::depthStencil:
                     return GL_DEPTH_STENCIL;
+                case PixelFormat::bc1UnsignedNorm:
+                case PixelFormat::bc1UnsignedNormSRGB:
+                case PixelFormat::bc3UnsignedNorm:
+                case PixelFormat::bc3UnsignedNormSRGB:
+                case PixelFormat::bc7UnsignedNorm:
+                case PixelFormat::bc7UnsignedNormSRGB:
+                case PixelFormat::etc2Rgb8UnsignedNorm:
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                case PixelFormat::etc2Rgba8UnsignedNorm:
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+                case PixelFormat::astc4x4UnsignedNorm:
+                case PixelFormat::astc4x4UnsignedNormSRGB:
+                    return GL_NONE; // compressed data is uploaded with glCompressedTexImage2D
                 default:
                     throw Error("Invalid pixel format");
             }
@@ -200,6 +279,19 @@ namespace ouzel::graphics::opengl
                     return GL_UNSIGNED_INT;
                 case PixelFormat::depthStencil:
                     return GL_UNSIGNED_INT_24_8;
+                case PixelFormat::bc1UnsignedNorm:
+                case PixelFormat::bc1UnsignedNormSRGB:
+                case PixelFormat::bc3UnsignedNorm:
+                case PixelFormat::bc3UnsignedNormSRGB:
+                case PixelFormat::bc7UnsignedNorm:
+                case PixelFormat::bc7UnsignedNormSRGB:
+                case PixelFormat::etc2Rgb8UnsignedNorm:
+                case PixelFormat::etc2Rgb8UnsignedNormSRGB:
+                case PixelFormat::etc2Rgba8UnsignedNorm:
+                case PixelFormat::etc2Rgba8UnsignedNormSRGB:
+                case PixelFormat::astc4x4UnsignedNorm:
+                case PixelFormat::astc4x4UnsignedNormSRGB:
+                    return GL_NONE;
                 default:
                     throw Error("Invalid pixel format");
             }
@@ -270,7 +362,8 @@ namespace ouzel::graphics::opengl
         textureTarget(getTextureTarget(type)),
         internalPixelFormat(getOpenGlInternalPixelFormat(initPixelFormat, renderDevice.getAPIMajorVersion())),
         pixelFormat(getOpenGlPixelFormat(initPixelFormat)),
-        pixelType(getOpenGlPixelType(initPixelFormat))
+        pixelType(getOpenGlPixelType(initPixelFormat)),
+        compressed(isCompressed(initPixelFormat))
     {
         if ((flags & Flags::bindRenderTarget) == Flags::bindRenderTarget &&
             (mipmaps == 0 || mipmaps > 1))
@@ -279,11 +372,22 @@ namespace ouzel::graphics::opengl
         if (internalPixelFormat == GL_NONE)
             throw Error("Invalid pixel format");
 
-        if (pixelFormat == GL_NONE)
-            throw Error("Invalid pixel format");
+        if (compressed)
+        {
+            if ((flags & Flags::bindRenderTarget) == Flags::bindRenderTarget)
+                throw Error("Compressed textures can not be render targets");
 
-        if (pixelType == GL_NONE)
-            throw Error("Invalid pixel format");
+            if (!renderDevice.glCompressedTexImage2DProc)
+                throw Error("Compressed textures are not supported");
+        }
+        else
+        {
+            if (pixelFormat == GL_NONE)
+                throw Error("Invalid pixel format");
+
+            if (pixelType == GL_NONE)
+                throw Error("Invalid pixel format");
+        }
 
         createTexture();
 
@@ -304,7 +408,13 @@ namespace ouzel::graphics::opengl
 
             for (std::size_t level = 0; level < levels.size(); ++level)
             {
-                if (!levels[level].second.empty())
+                if (compressed)
+                    renderDevice.glCompressedTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), internalPixelFormat,
+                                                            static_cast<GLsizei>(levels[level].first.v[0]),
+                                                            static_cast<GLsizei>(levels[level].first.v[1]), 0,
+                                                            static_cast<GLsizei>(levels[level].second.size()),
+                                                            levels[level].second.data());
+                else if (!levels[level].second.empty())
                     renderDevice.glTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(internalPixelFormat),
                                                   static_cast<GLsizei>(levels[level].first.v[0]),
                                                   static_cast<GLsizei>(levels[level].first.v[1]), 0,
@@ -358,7 +468,13 @@ namespace ouzel::graphics::opengl
 
             for (std::size_t level = 0; level < levels.size(); ++level)
             {
-                if (!levels[level].second.empty())
+                if (compressed)
+                    renderDevice.glCompressedTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), internalPixelFormat,
+                                                            static_cast<GLsizei>(levels[level].first.v[0]),
+                                                            static_cast<GLsizei>(levels[level].first.v[1]), 0,
+                                                            static_cast<GLsizei>(levels[level].second.size()),
+                                                            levels[level].second.data());
+                else if (!levels[level].second.empty())
                     renderDevice.glTexImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(internalPixelFormat),
                                                   static_cast<GLsizei>(levels[level].first.v[0]),
                                                   static_cast<GLsizei>(levels[level].first.v[1]), 0,
@@ -393,12 +509,24 @@ namespace ouzel::graphics::opengl
         renderDevice.bindTexture(textureTarget, 0, textureId);
 
         for (std::size_t level = 0; level < levels.size(); ++level)
-            if (!levels[level].second.empty())
+        {
+            if (levels[level].second.empty())
+                continue;
+
+            if (compressed)
+                renderDevice.glCompressedTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                                                           static_cast<GLsizei>(levels[level].first.v[0]),
+                                                           static_cast<GLsizei>(levels[level].first.v[1]),
+                                                           internalPixelFormat,
+                                                           static_cast<GLsizei>(levels[level].second.size()),
+                                                           levels[level].second.data());
+            else
                 renderDevice.glTexSubImage2DProc(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
                                                  static_cast<GLsizei>(levels[level].first.v[0]),
                                                  static_cast<GLsizei>(levels[level].first.v[1]),
                                                  pixelFormat, pixelType,
                                                  levels[level].second.data());
+        }
 
         GLenum error;
 
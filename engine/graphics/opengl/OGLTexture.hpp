@@ -96,6 +96,7 @@ namespace ouzel::graphics::opengl
         GLenum internalPixelFormat = GL_NONE;
         GLenum pixelFormat = GL_NONE;
         GLenum pixelType = GL_NONE;
+        bool compressed = false;
     };
 }
 #endif
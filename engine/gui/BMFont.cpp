@@ -225,6 +225,24 @@ namespace ouzel::gui
                             value = parseString(data, iterator);
                     }
                 }
+                else if (keyword == "distanceField")
+                {
+                    // written by the distance field font generators, e.g. "distanceField fieldType=msdf distanceRange=4"
+                    while (iterator != data.end())
+                    {
+                        if (isNewline(*iterator)) break;
+
+                        skipWhitespaces(data, iterator);
+                        key = parseString(data, iterator);
+
+                        expectToken(data, iterator, '=');
+                        value = parseString(data, iterator);
+
+                        if (key == "fieldType")
+                            distanceField = value == "sdf" || value == "psdf" ||
+                                value == "msdf" || value == "mtsdf";
+                    }
+                }
                 else if (keyword == "char")
                 {
                     char32_t charId = 0;
@@ -342,107 +360,69 @@ namespace ouzel::gui
                         }
                         else
                             value = parseString(data, iterator);
-
-                        kern[std::make_pair(first, second)] = amount;
                     }
+
+                    kern[(static_cast<std::uint64_t>(first) << 32) | second] = amount;
                 }
                 else
                     skipLine(data, iterator);
             }
         }
+
+        // the glyphs are drawn as a plain texture on the render devices that don't have the distance field shader
+        if (distanceField && !engine->getCache().getShader(shaderDistanceField))
+        {
+            logger.log(Log::Level::warning) << "Distance field fonts are not supported by the render device, drawing the glyphs as a texture";
+            distanceField = false;
+        }
     }
 
-    Font::RenderData BMFont::getRenderData(const std::string& text,
-                                           Color color,
-                                           float fontSize,
-                                           const Vector2F& anchor) const
+    bool BMFont::appendLayout(Layout& layout, const std::u32string& text) const
     {
-        Vector2F position;
-
-        const std::u32string utf32Text = utf8::toUtf32(text);
+        const float fontSize = layout.fontSize;
 
-        std::vector<std::uint16_t> indices;
-        std::vector<graphics::Vertex> vertices;
-        indices.reserve(utf32Text.size() * 6);
-        vertices.reserve(utf32Text.size() * 4);
+        layout.texture = fontTexture;
+        layout.lineHeight = lineHeight * fontSize;
 
-        Vector2F textCoords[4];
-
-        std::size_t firstChar = 0;
-
-        for (auto i = utf32Text.begin(); i != utf32Text.end(); ++i)
+        for (const char32_t c : text)
         {
-            auto iter = chars.find(*i);
+            if (layout.pendingKerning)
+                layout.position.v[0] += static_cast<float>(getKerningPair(layout.lastChar, c)) * fontSize;
+
+            const auto iter = chars.find(c);
+            layout.pendingKerning = iter != chars.end();
 
             if (iter != chars.end())
             {
                 const auto& f = iter->second;
 
-                auto startIndex = static_cast<std::uint16_t>(vertices.size());
-                indices.push_back(startIndex + 0);
-                indices.push_back(startIndex + 1);
-                indices.push_back(startIndex + 2);
+                const Vector2F leftTop(f.x / static_cast<float>(width),
+                                       f.y / static_cast<float>(height));
 
-                indices.push_back(startIndex + 1);
-                indices.push_back(startIndex + 3);
-                indices.push_back(startIndex + 2);
+                const Vector2F rightBottom((f.x + f.width) / static_cast<float>(width),
+                                           (f.y + f.height) / static_cast<float>(height));
 
-                Vector2F leftTop(f.x / static_cast<float>(width),
-                                 f.y / static_cast<float>(height));
-
-                Vector2F rightBottom((f.x + f.width) / static_cast<float>(width),
-                                     (f.y + f.height) / static_cast<float>(height));
-
-                textCoords[0] = Vector2F(leftTop.v[0], rightBottom.v[1]);
-                textCoords[1] = Vector2F(rightBottom.v[0], rightBottom.v[1]);
-                textCoords[2] = Vector2F(leftTop.v[0], leftTop.v[1]);
-                textCoords[3] = Vector2F(rightBottom.v[0], leftTop.v[1]);
-
-                vertices.emplace_back(Vector3F{position.v[0] + f.xOffset, -position.v[1] - f.yOffset - f.height, 0.0F},
-                                      color, textCoords[0], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.xOffset + f.width, -position.v[1] - f.yOffset - f.height, 0.0F},
-                                      color, textCoords[1], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.xOffset, -position.v[1] - f.yOffset, 0.0F},
-                                      color, textCoords[2], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.xOffset + f.width, -position.v[1] - f.yOffset, 0.0F},
-                                      color, textCoords[3], Vector3F{0.0F, 0.0F, -1.0F});
-
-                if ((i + 1) != utf32Text.end())
-                    position.v[0] += static_cast<float>(getKerningPair(*i, *(i + 1)));
+                addQuad(layout,
+                        Vector2F(f.xOffset * fontSize, f.yOffset * fontSize),
+                        Size2F(f.width * fontSize, f.height * fontSize),
+                        leftTop, rightBottom);
 
-                position.v[0] += f.xAdvance;
+                layout.position.v[0] += f.xAdvance * fontSize;
             }
 
-            if (*i == '\n' || // line feed
-                (i + 1) == utf32Text.end()) // end of string
-            {
-                const float lineWidth = position.v[0];
-                position.v[0] = 0.0F;
-                position.v[1] += lineHeight;
-
-                for (std::size_t c = firstChar; c < vertices.size(); ++c)
-                    vertices[c].position.v[0] -= lineWidth * anchor.v[0];
-
-                firstChar = vertices.size();
-            }
+            addCharacter(layout, c);
         }
 
-        const float textHeight = position.v[1];
+        finishLayout(layout);
 
-        for (graphics::Vertex& vertex : vertices)
-        {
-            vertex.position.v[1] += textHeight * (1.0F - anchor.v[1]);
-
-            vertex.position.v[0] *= fontSize;
-            vertex.position.v[1] *= fontSize;
-        }
-
-        return std::make_tuple(std::move(indices), std::move(vertices), fontTexture);
+        return true;
     }
 
     std::int16_t BMFont::getKerningPair(char32_t first, char32_t second) const
     {
-        const auto i = kern.find(std::make_pair(first, second));
+        if (kern.empty()) return 0;
+
+        const auto i = kern.find((static_cast<std::uint64_t>(first) << 32) | second);
 
         if (i != kern.end())
             return i->second;
@@ -13,10 +13,7 @@ namespace ouzel::gui
         BMFont() = default;
         explicit BMFont(const std::vector<std::byte>& data);
 
-        RenderData getRenderData(const std::string& text,
-                                 Color color,
-                                 float fontSize,
-                                 const Vector2F& anchor) const final;
+        bool appendLayout(Layout& layout, const std::u32string& text) const final;
 
         float getStringWidth(const std::string& text) const;
 
@@ -43,7 +40,8 @@ namespace ouzel::gui
         std::uint16_t outline = 0;
         std::uint16_t kernCount = 0;
         std::unordered_map<char32_t, CharDescriptor> chars;
-        std::map<std::pair<char32_t, char32_t>, std::int16_t> kern;
+        // the first character in the upper 32 bits and the second one in the lower 32 bits
+        std::unordered_map<std::uint64_t, std::int16_t> kern;
         std::shared_ptr<graphics::Texture> fontTexture;
     };
 }
@@ -0,0 +1,102 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include "Font.hpp"
+#include "../utils/Utf8.hpp"
+
+namespace ouzel::gui
+{
+    Font::RenderData Font::getRenderData(const std::string& text,
+                                         Color color,
+                                         float fontSize,
+                                         const Vector2F& anchor) const
+    {
+        Layout layout;
+        layout.fontSize = fontSize;
+        appendLayout(layout, utf8::toUtf32(text));
+
+        std::vector<graphics::Vertex> vertices;
+        anchorLayout(layout, anchor, vertices);
+
+        for (graphics::Vertex& vertex : vertices)
+            vertex.color = color;
+
+        return std::make_tuple(std::move(layout.indices), std::move(vertices), std::move(layout.texture));
+    }
+
+    void Font::anchorLayout(const Layout& layout,
+                            const Vector2F& anchor,
+                            std::vector<graphics::Vertex>& vertices)
+    {
+        vertices = layout.vertices;
+
+        const float offsetY = layout.height * (1.0F - anchor.v[1]);
+
+        for (std::size_t line = 0; line < layout.lines.size(); ++line)
+        {
+            const float offsetX = -layout.lines[line].second * anchor.v[0];
+            const std::size_t end = line + 1 < layout.lines.size() ? layout.lines[line + 1].first : vertices.size();
+
+            for (std::size_t i = layout.lines[line].first; i < end; ++i)
+            {
+                vertices[i].position.v[0] += offsetX;
+                vertices[i].position.v[1] += offsetY;
+            }
+        }
+    }
+
+    void Font::addQuad(Layout& layout,
+                       const Vector2F& offset,
+                       const Size2F& size,
+                       const Vector2F& leftTop,
+                       const Vector2F& rightBottom)
+    {
+        const auto startIndex = static_cast<std::uint16_t>(layout.vertices.size());
+        layout.indices.push_back(startIndex + 0);
+        layout.indices.push_back(startIndex + 1);
+        layout.indices.push_back(startIndex + 2);
+
+        layout.indices.push_back(startIndex + 1);
+        layout.indices.push_back(startIndex + 3);
+        layout.indices.push_back(startIndex + 2);
+
+        const float left = layout.position.v[0] + offset.v[0];
+        const float top = -layout.position.v[1] - offset.v[1];
+
+        layout.vertices.emplace_back(Vector3F{left, top - size.v[1], 0.0F}, Color::white(),
+                                     Vector2F{leftTop.v[0], rightBottom.v[1]}, Vector3F{0.0F, 0.0F, -1.0F});
+        layout.vertices.emplace_back(Vector3F{left + size.v[0], top - size.v[1], 0.0F}, Color::white(),
+                                     Vector2F{rightBottom.v[0], rightBottom.v[1]}, Vector3F{0.0F, 0.0F, -1.0F});
+        layout.vertices.emplace_back(Vector3F{left, top, 0.0F}, Color::white(),
+                                     Vector2F{leftTop.v[0], leftTop.v[1]}, Vector3F{0.0F, 0.0F, -1.0F});
+        layout.vertices.emplace_back(Vector3F{left + size.v[0], top, 0.0F}, Color::white(),
+                                     Vector2F{rightBottom.v[0], leftTop.v[1]}, Vector3F{0.0F, 0.0F, -1.0F});
+    }
+
+    void Font::addCharacter(Layout& layout, char32_t c)
+    {
+        layout.lastChar = c;
+        ++layout.length;
+
+        if (c == '\n') // line feed
+        {
+            layout.lines.back().second = layout.position.v[0];
+            layout.lines.emplace_back(layout.vertices.size(), 0.0F);
+            layout.position.v[0] = 0.0F;
+            layout.position.v[1] += layout.lineHeight;
+            layout.pendingKerning = false;
+        }
+    }
+
+    void Font::finishLayout(Layout& layout) noexcept
+    {
+        layout.lines.back().second = layout.position.v[0];
+
+        // a trailing line feed doesn't start a new line
+        if (layout.length == 0)
+            layout.height = 0.0F;
+        else if (layout.lastChar == '\n')
+            layout.height = layout.position.v[1];
+        else
+            layout.height = layout.position.v[1] + layout.lineHeight;
+    }
+}
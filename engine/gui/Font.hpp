@@ -10,6 +10,7 @@
 #include <unordered_map>
 #include <vector>
 #include "../math/Color.hpp"
+#include "../math/Size.hpp"
 #include "../graphics/Texture.hpp"
 #include "../graphics/Vertex.hpp"
 
@@ -33,10 +34,52 @@ namespace ouzel::gui
             std::vector<graphics::Vertex>,
             std::shared_ptr<graphics::Texture>>;
 
-        virtual RenderData getRenderData(const std::string& text,
-                                         Color color,
-                                         float fontSize,
-                                         const Vector2F& anchor) const = 0;
+        // glyph quads of a text laid out from the origin, the anchor is applied separately,
+        // so that it can be changed without laying out the text again
+        struct Layout final
+        {
+            float fontSize = 1.0F;
+            std::vector<std::uint16_t> indices;
+            std::vector<graphics::Vertex> vertices;
+            std::shared_ptr<graphics::Texture> texture;
+
+            // first vertex and width of each line, the last one is open for the appended text
+            std::vector<std::pair<std::size_t, float>> lines{{0, 0.0F}};
+            Vector2F position;
+            float lineHeight = 0.0F;
+            float height = 0.0F;
+            std::size_t length = 0;
+            char32_t lastChar = 0;
+            bool pendingKerning = false;
+        };
+
+        RenderData getRenderData(const std::string& text,
+                                 Color color,
+                                 float fontSize,
+                                 const Vector2F& anchor) const;
+
+        // lays out the text after the text that is already in the layout, returns false
+        // without changing the layout if it has to be created from scratch
+        virtual bool appendLayout(Layout& layout, const std::u32string& text) const = 0;
+
+        static void anchorLayout(const Layout& layout,
+                                 const Vector2F& anchor,
+                                 std::vector<graphics::Vertex>& vertices);
+
+        // the glyphs are stored as (multi-channel) signed distance fields
+        // and have to be drawn with the distance field shader
+        auto isDistanceField() const noexcept { return distanceField; }
+
+    protected:
+        static void addQuad(Layout& layout,
+                            const Vector2F& offset,
+                            const Size2F& size,
+                            const Vector2F& leftTop,
+                            const Vector2F& rightBottom);
+        static void addCharacter(Layout& layout, char32_t c);
+        static void finishLayout(Layout& layout) noexcept;
+
+        bool distanceField = false;
     };
 }
 
@@ -1,5 +1,6 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include "TTFont.hpp"
@@ -26,10 +27,18 @@
 
 namespace ouzel::gui
 {
-    TTFont::TTFont(const std::vector<std::byte>& initData, bool initMipmaps):
+    TTFont::TTFont(const std::vector<std::byte>& initData,
+                   bool initMipmaps,
+                   bool initDistanceField):
         data(initData),
         mipmaps(initMipmaps)
     {
+        // distance fields can only be drawn on the render devices that have the shader for them
+        if (initDistanceField && !engine->getCache().getShader(shaderDistanceField))
+            logger.log(Log::Level::warning) << "Distance field fonts are not supported by the render device, rasterizing the glyphs";
+        else
+            distanceField = initDistanceField;
+
         const int offset = stbtt_GetFontOffsetForIndex(reinterpret_cast<const unsigned char*>(data.data()), 0);
 
         if (offset == -1)
@@ -41,199 +50,289 @@ namespace ouzel::gui
             throw std::runtime_error("Failed to load font");
     }
 
-    Font::RenderData TTFont::getRenderData(const std::string& text,
-                                           Color color,
-                                           float fontSize,
-                                           const Vector2F& anchor) const
+    namespace
+    {
+        constexpr std::uint32_t pageSize = 512;
+        constexpr std::size_t maxPageCount = 8;
+        constexpr std::uint32_t spacing = 2U;
+
+        // distance fields are rasterized at this size and spread over this many pixels around the outline
+        constexpr float distanceFieldSize = 48.0F;
+        constexpr int distanceFieldSpread = 6;
+        constexpr unsigned char distanceFieldEdge = 128;
+    }
+
+    bool TTFont::appendLayout(Layout& layout, const std::u32string& text) const
     {
         if (!font)
             throw std::runtime_error("Font not loaded");
 
-        constexpr std::uint32_t SPACING = 2U;
-
-        struct CharDescriptor final
-        {
-            std::uint16_t x = 0;
-            std::uint16_t y = 0;
-            std::uint16_t width = 0;
-            std::uint16_t height = 0;
-            Vector2F offset;
-            float advance = 0;
-            std::vector<std::uint8_t> bitmap;
-        };
-
-        std::unordered_map<std::uint32_t, CharDescriptor> chars;
-
+        const float fontSize = layout.fontSize;
         const float s = stbtt_ScaleForPixelHeight(font.get(), fontSize);
 
-        const std::u32string utf32Text = utf8::toUtf32(text);
-
-        std::set<char32_t> glyphs;
-        for (const char32_t i : utf32Text)
-            glyphs.insert(i);
-
-        std::uint16_t width = 0;
-        std::uint16_t height = 0;
+        // the characters that the font doesn't have are skipped
+        std::vector<char32_t> codepoints;
+        codepoints.reserve(text.size());
+        for (const char32_t c : text)
+            if (std::find(codepoints.begin(), codepoints.end(), c) == codepoints.end() &&
+                stbtt_FindGlyphIndex(font.get(), static_cast<int>(c)))
+                codepoints.push_back(c);
 
         int ascent;
         int descent;
         int lineGap;
         stbtt_GetFontVMetrics(font.get(), &ascent, &descent, &lineGap);
 
-        for (const char32_t c : glyphs)
-        {
-            int w;
-            int h;
-            int xoff;
-            int yoff;
+        // the distance field glyphs are scaled from the reference size
+        const float rasterSize = distanceField ? distanceFieldSize : fontSize;
+        const float scale = fontSize / rasterSize;
 
-            if (const int index = stbtt_FindGlyphIndex(font.get(), static_cast<int>(c)))
-            {
-                int advance;
-                int leftBearing;
-                stbtt_GetGlyphHMetrics(font.get(), index, &advance, &leftBearing);
+        const Page& page = getPage(codepoints, rasterSize, layout.texture.get());
 
-                CharDescriptor charDesc;
+        // the whole text is drawn with one texture
+        if (layout.texture && layout.texture != page.texture)
+            return false;
 
-                if (unsigned char* bitmap = stbtt_GetGlyphBitmapSubpixel(font.get(), s, s, 0.0F, 0.0F, index, &w, &h, &xoff, &yoff))
-                {
-                    charDesc.width = static_cast<std::uint16_t>(w);
-                    charDesc.height = static_cast<std::uint16_t>(h);
-                    charDesc.offset.v[0] = static_cast<float>(leftBearing * s);
-                    charDesc.offset.v[1] = static_cast<float>(yoff + (ascent - descent) * s);
-                    charDesc.bitmap = std::vector<std::uint8_t>(bitmap, bitmap + h * w);
-                    charDesc.x = width;
+        const auto& chars = page.glyphs;
+        const auto width = static_cast<float>(page.width);
+        const auto height = static_cast<float>(page.height);
 
-                    width += static_cast<std::uint16_t>(w);
-                    height = height > static_cast<std::uint16_t>(h) ? height : static_cast<std::uint16_t>(h);
+        layout.texture = page.texture;
+        layout.lineHeight = fontSize + lineGap;
 
-                    stbtt_FreeBitmap(bitmap, nullptr);
-                }
+        for (const char32_t c : text)
+        {
+            if (layout.pendingKerning)
+            {
+                const int kernAdvance = stbtt_GetCodepointKernAdvance(font.get(),
+                                                                      static_cast<int>(layout.lastChar),
+                                                                      static_cast<int>(c));
+                layout.position.v[0] += static_cast<float>(kernAdvance) * s;
+            }
+
+            const auto iter = chars.find(c);
+            layout.pendingKerning = iter != chars.end();
 
-                charDesc.advance = static_cast<float>(advance * s);
+            if (iter != chars.end())
+            {
+                const auto& f = iter->second;
 
-                if (!chars.empty())
-                    width += SPACING;
+                const Vector2F leftTop(f.x / width, f.y / height);
+                const Vector2F rightBottom((f.x + f.width) / width, (f.y + f.height) / height);
 
-                chars[c] = charDesc;
+                addQuad(layout,
+                        f.offset * scale,
+                        Size2F(f.width * scale, f.height * scale),
+                        leftTop, rightBottom);
+
+                layout.position.v[0] += f.advance * scale;
             }
+
+            addCharacter(layout, c);
         }
 
-        std::vector<std::uint8_t> textureData(width * height * 4);
+        finishLayout(layout);
 
-        for (std::uint16_t posX = 0; posX < width; ++posX)
-        {
-            for (std::uint16_t posY = 0; posY < height; ++posY)
+        return true;
+    }
+
+    TTFont::Page& TTFont::getPage(const std::vector<char32_t>& codepoints,
+                                  float fontSize,
+                                  const graphics::Texture* preferredTexture) const
+    {
+        // pages of the font size, the page of the preferred texture and then the most recently used first
+        std::vector<Page*> candidates;
+        for (const auto& page : pages)
+            if (page->fontSize == fontSize)
+                candidates.push_back(page.get());
+
+        std::sort(candidates.begin(), candidates.end(), [preferredTexture](const Page* a, const Page* b) noexcept {
+            const bool aPreferred = preferredTexture && a->texture.get() == preferredTexture;
+            const bool bPreferred = preferredTexture && b->texture.get() == preferredTexture;
+            if (aPreferred != bPreferred) return aPreferred;
+            return a->lastUse > b->lastUse;
+        });
+
+        std::unordered_map<char32_t, RasterizedGlyph> rasterizedGlyphs;
+        const auto rasterize = [this, fontSize, &rasterizedGlyphs](char32_t c) -> const RasterizedGlyph& {
+            auto i = rasterizedGlyphs.find(c);
+            if (i == rasterizedGlyphs.end())
+                i = rasterizedGlyphs.emplace(c, rasterizeGlyph(c, fontSize)).first;
+            return i->second;
+        };
+
+        // all glyphs of a string must be on the same page, because it is drawn with one texture
+        const auto addGlyphs = [this, &codepoints, &rasterize](Page& page) {
+            for (const char32_t c : codepoints)
+                if (page.glyphs.find(c) == page.glyphs.end() &&
+                    !addGlyph(page, c, rasterize(c)))
+                    return false;
+
+            return true;
+        };
+
+        Page* result = nullptr;
+
+        for (Page* page : candidates)
+            if (addGlyphs(*page))
             {
-                textureData[(posY * width + posX) * 4 + 0] = 255;
-                textureData[(posY * width + posX) * 4 + 1] = 255;
-                textureData[(posY * width + posX) * 4 + 2] = 255;
-                textureData[(posY * width + posX) * 4 + 3] = 0;
+                result = page;
+                break;
             }
-        }
 
-        for (const auto& c : chars)
+        if (!result)
         {
-            const auto& charDesc = c.second;
+            auto newPage = std::make_unique<Page>();
+            newPage->fontSize = fontSize;
 
-            for (std::uint16_t posX = 0; posX < charDesc.width; ++posX)
+            // the page grows until the whole string fits on it
+            for (std::uint32_t size = pageSize;; size *= 2)
             {
-                for (std::uint16_t posY = 0; posY < charDesc.height; ++posY)
+                newPage->width = size;
+                newPage->height = size;
+                newPage->shelfX = spacing;
+                newPage->shelfY = spacing;
+                newPage->shelfHeight = 0;
+                newPage->glyphs.clear();
+
+                // white pixels, the glyphs are stored in the alpha channel,
+                // distance fields are stored in all channels, so the empty space is black
+                newPage->data.resize(static_cast<std::size_t>(size) * size * 4);
+                for (std::size_t i = 0; i < newPage->data.size(); i += 4)
                 {
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 0] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 1] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 2] = 255;
-                    textureData[(posY * width + posX + charDesc.x) * 4 + 3] = charDesc.bitmap[posY * charDesc.width + posX];
+                    const std::uint8_t background = distanceField ? 0 : 255;
+                    newPage->data[i + 0] = background;
+                    newPage->data[i + 1] = background;
+                    newPage->data[i + 2] = background;
+                    newPage->data[i + 3] = 0;
                 }
+
+                if (addGlyphs(*newPage)) break;
             }
+
+            result = newPage.get();
+            pages.push_back(std::move(newPage));
         }
 
-        RenderData result;
+        // only the pages that got new glyphs are uploaded again
+        if (!result->texture)
+            result->texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
+                                                                  result->data,
+                                                                  Size2U(result->width, result->height),
+                                                                  graphics::Flags::dynamic,
+                                                                  mipmaps ? 0 : 1);
+        else if (result->dirty)
+            result->texture->setData(result->data);
+
+        result->dirty = false;
+        result->lastUse = ++useCount;
+
+        // the texts that still use a released page keep its texture
+        if (pages.size() > maxPageCount)
+        {
+            const auto leastRecentlyUsed = std::min_element(pages.begin(), pages.end(),
+                                                            [](const auto& a, const auto& b) noexcept {
+                return a->lastUse < b->lastUse;
+            });
+            pages.erase(leastRecentlyUsed);
+        }
 
-        auto texture = std::make_shared<graphics::Texture>(*engine->getGraphics(),
-                                                           textureData,
-                                                           Size2U(width, height),
-                                                           graphics::Flags::none,
-                                                           mipmaps ? 0 : 1);
+        return *result;
+    }
 
-        Vector2F position;
+    TTFont::RasterizedGlyph TTFont::rasterizeGlyph(char32_t codepoint, float fontSize) const
+    {
+        const float s = stbtt_ScaleForPixelHeight(font.get(), fontSize);
+        const int index = stbtt_FindGlyphIndex(font.get(), static_cast<int>(codepoint));
 
-        std::vector<std::uint16_t> indices;
-        std::vector<graphics::Vertex> vertices;
-        indices.reserve(utf32Text.size() * 6);
-        vertices.reserve(utf32Text.size() * 4);
+        int ascent;
+        int descent;
+        int lineGap;
+        stbtt_GetFontVMetrics(font.get(), &ascent, &descent, &lineGap);
 
-        Vector2F textCoords[4];
+        int advance;
+        int leftBearing;
+        stbtt_GetGlyphHMetrics(font.get(), index, &advance, &leftBearing);
 
-        std::size_t firstChar = 0;
+        RasterizedGlyph result;
 
-        for (auto i = utf32Text.begin(); i != utf32Text.end(); ++i)
-        {
-            auto iter = chars.find(*i);
+        int w;
+        int h;
+        int xoff;
+        int yoff;
 
-            if (iter != chars.end())
+        if (distanceField)
+        {
+            if (unsigned char* bitmap = stbtt_GetGlyphSDF(font.get(), s, index,
+                                                          distanceFieldSpread,
+                                                          distanceFieldEdge,
+                                                          static_cast<float>(distanceFieldEdge) / distanceFieldSpread,
+                                                          &w, &h, &xoff, &yoff))
             {
-                const auto& f = iter->second;
+                // the padding of the distance field is included in the offsets
+                result.glyph.width = static_cast<std::uint16_t>(w);
+                result.glyph.height = static_cast<std::uint16_t>(h);
+                result.glyph.offset.v[0] = static_cast<float>(xoff);
+                result.glyph.offset.v[1] = static_cast<float>(yoff + (ascent - descent) * s);
+                result.bitmap = std::vector<std::uint8_t>(bitmap, bitmap + h * w);
+
+                stbtt_FreeSDF(bitmap, nullptr);
+            }
+        }
+        else if (unsigned char* bitmap = stbtt_GetGlyphBitmapSubpixel(font.get(), s, s, 0.0F, 0.0F, index, &w, &h, &xoff, &yoff))
+        {
+            result.glyph.width = static_cast<std::uint16_t>(w);
+            result.glyph.height = static_cast<std::uint16_t>(h);
+            result.glyph.offset.v[0] = static_cast<float>(leftBearing * s);
+            result.glyph.offset.v[1] = static_cast<float>(yoff + (ascent - descent) * s);
+            result.bitmap = std::vector<std::uint8_t>(bitmap, bitmap + h * w);
 
-                auto startIndex = static_cast<std::uint16_t>(vertices.size());
-                indices.push_back(startIndex + 0);
-                indices.push_back(startIndex + 1);
-                indices.push_back(startIndex + 2);
+            stbtt_FreeBitmap(bitmap, nullptr);
+        }
 
-                indices.push_back(startIndex + 1);
-                indices.push_back(startIndex + 3);
-                indices.push_back(startIndex + 2);
+        result.glyph.advance = static_cast<float>(advance * s);
 
-                Vector2F leftTop(f.x / static_cast<float>(width),
-                                 f.y / static_cast<float>(height));
+        return result;
+    }
 
-                Vector2F rightBottom((f.x + f.width) / static_cast<float>(width),
-                                     (f.y + f.height) / static_cast<float>(height));
+    bool TTFont::addGlyph(Page& page, char32_t codepoint, const RasterizedGlyph& rasterizedGlyph) const
+    {
+        Glyph glyph = rasterizedGlyph.glyph;
 
-                textCoords[0] = Vector2F(leftTop.v[0], rightBottom.v[1]);
-                textCoords[1] = Vector2F(rightBottom.v[0], rightBottom.v[1]);
-                textCoords[2] = Vector2F(leftTop.v[0], leftTop.v[1]);
-                textCoords[3] = Vector2F(rightBottom.v[0], leftTop.v[1]);
+        // shelf packing, a new shelf is started below the tallest glyph of the current one
+        if (glyph.width && glyph.height)
+        {
+            if (page.shelfX + glyph.width + spacing > page.width)
+            {
+                page.shelfX = spacing;
+                page.shelfY += page.shelfHeight + spacing;
+                page.shelfHeight = 0;
+            }
 
-                vertices.emplace_back(Vector3F{position.v[0] + f.offset.v[0], -position.v[1] - f.offset.v[1] - f.height, 0.0F},
-                                      color, textCoords[0], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.offset.v[0] + f.width, -position.v[1] - f.offset.v[1] - f.height, 0.0F},
-                                      color, textCoords[1], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.offset.v[0], -position.v[1] - f.offset.v[1], 0.0F},
-                                      color, textCoords[2], Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{position.v[0] + f.offset.v[0] + f.width, -position.v[1] - f.offset.v[1], 0.0F},
-                                      color, textCoords[3], Vector3F{0.0F, 0.0F, -1.0F});
+            if (page.shelfX + glyph.width + spacing > page.width ||
+                page.shelfY + glyph.height + spacing > page.height)
+                return false;
 
-                if ((i + 1) != utf32Text.end())
-                {
-                    const int kernAdvance = stbtt_GetCodepointKernAdvance(font.get(),
-                                                                          static_cast<int>(*i),
-                                                                          static_cast<int>(*(i + 1)));
-                    position.v[0] += static_cast<float>(kernAdvance) * s;
-                }
+            glyph.x = static_cast<std::uint16_t>(page.shelfX);
+            glyph.y = static_cast<std::uint16_t>(page.shelfY);
 
-                position.v[0] += f.advance;
-            }
+            page.shelfX += glyph.width + spacing;
+            page.shelfHeight = std::max(page.shelfHeight, static_cast<std::uint32_t>(glyph.height));
 
-            if (*i == static_cast<std::uint32_t>('\n') || // line feed
-                (i + 1) == utf32Text.end()) // end of string
-            {
-                const float lineWidth = position.v[0];
-                position.v[0] = 0.0F;
-                position.v[1] += fontSize + lineGap;
+            const std::size_t firstChannel = distanceField ? 0 : 3;
 
-                for (std::size_t c = firstChar; c < vertices.size(); ++c)
-                    vertices[c].position.v[0] -= lineWidth * anchor.v[0];
+            for (std::uint32_t y = 0; y < glyph.height; ++y)
+                for (std::uint32_t x = 0; x < glyph.width; ++x)
+                {
+                    const auto pixel = ((static_cast<std::size_t>(glyph.y) + y) * page.width + glyph.x + x) * 4;
+                    for (std::size_t channel = firstChannel; channel < 4; ++channel)
+                        page.data[pixel + channel] = rasterizedGlyph.bitmap[y * glyph.width + x];
+                }
 
-                firstChar = vertices.size();
-            }
+            page.dirty = true;
         }
 
-        const float textHeight = position.v[1];
-
-        for (graphics::Vertex& vertex : vertices)
-            vertex.position.v[1] += textHeight * (1.0F - anchor.v[1]);
-
-        return std::make_tuple(std::move(indices), std::move(vertices), std::move(texture));
+        page.glyphs[codepoint] = glyph;
+        return true;
     }
 }
@@ -3,6 +3,10 @@
 #ifndef OUZEL_GUI_TTFONT_HPP
 #define OUZEL_GUI_TTFONT_HPP
 
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "../gui/Font.hpp"
 
 struct stbtt_fontinfo;
@@ -13,19 +17,62 @@ namespace ouzel::gui
     {
     public:
         TTFont() = default;
-        TTFont(const std::vector<std::byte>& newData, bool newMipmaps = true);
+        TTFont(const std::vector<std::byte>& newData,
+               bool newMipmaps = true,
+               bool newDistanceField = false);
 
-        RenderData getRenderData(const std::string& text,
-                                 Color color,
-                                 float fontSize,
-                                 const Vector2F& anchor) const final;
+        bool appendLayout(Layout& layout, const std::u32string& text) const final;
 
         float getStringWidth(const std::string& text);
 
     private:
+        struct Glyph final
+        {
+            std::uint16_t x = 0;
+            std::uint16_t y = 0;
+            std::uint16_t width = 0;
+            std::uint16_t height = 0;
+            Vector2F offset;
+            float advance = 0.0F;
+        };
+
+        struct RasterizedGlyph final
+        {
+            Glyph glyph;
+            std::vector<std::uint8_t> bitmap;
+        };
+
+        // texture page of the glyph atlas of a font size, glyphs are only ever added to a page,
+        // so the texture coordinates of the text that was laid out on it stay valid,
+        // distance field glyphs are rasterized once at a reference size and serve all font sizes
+        struct Page final
+        {
+            float fontSize = 0.0F;
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+            std::vector<std::uint8_t> data;
+            std::shared_ptr<graphics::Texture> texture;
+            std::unordered_map<char32_t, Glyph> glyphs;
+            std::uint32_t shelfX = 0;
+            std::uint32_t shelfY = 0;
+            std::uint32_t shelfHeight = 0;
+            std::uint64_t lastUse = 0;
+            bool dirty = false;
+        };
+
+        Page& getPage(const std::vector<char32_t>& codepoints,
+                      float fontSize,
+                      const graphics::Texture* preferredTexture = nullptr) const;
+        RasterizedGlyph rasterizeGlyph(char32_t codepoint, float fontSize) const;
+        bool addGlyph(Page& page, char32_t codepoint, const RasterizedGlyph& rasterizedGlyph) const;
+
         std::unique_ptr<stbtt_fontinfo> font;
         std::vector<std::byte> data;
         bool mipmaps = true;
+
+        // least recently used pages are released when there are more than maxPageCount of them
+        mutable std::vector<std::unique_ptr<Page>> pages;
+        mutable std::uint64_t useCount = 0;
     };
 }
 
@@ -34,6 +34,9 @@ LOCAL_SRC_FILES := ../assets/BmfLoader.cpp \
     ../assets/WaveLoader.cpp \
     ../audio/mixer/Bus.cpp \
     ../audio/mixer/Mixer.cpp \
+    ../audio/mixer/PcmCache.cpp \
+    ../audio/mixer/VoiceManager.cpp \
+    ../audio/offline/OfflineAudioDevice.cpp \
     ../audio/opensl/OSLAudioDevice.cpp \
     ../audio/Audio.cpp \
     ../audio/AudioDevice.cpp \
@@ -41,6 +44,7 @@ LOCAL_SRC_FILES := ../assets/BmfLoader.cpp \
     ../audio/Cue.cpp \
     ../audio/Effect.cpp \
     ../audio/Effects.cpp \
+    ../audio/Fft.cpp \
     ../audio/Listener.cpp \
     ../audio/Mix.cpp \
     ../audio/Node.cpp \
@@ -77,6 +81,7 @@ LOCAL_SRC_FILES := ../assets/BmfLoader.cpp \
     ../graphics/Shader.cpp \
     ../graphics/Texture.cpp \
     ../gui/BMFont.cpp \
+    ../gui/Font.cpp \
     ../gui/TTFont.cpp \
     ../gui/Widget.cpp \
     ../gui/Widgets.cpp \
@@ -106,6 +111,7 @@ LOCAL_SRC_FILES := ../assets/BmfLoader.cpp \
     ../scene/Component.cpp \
     ../scene/Layer.cpp \
     ../scene/Light.cpp \
+    ../scene/ParticleManager.cpp \
     ../scene/ParticleSystem.cpp \
     ../scene/Scene.cpp \
     ../scene/SceneManager.cpp \
@@ -115,6 +121,7 @@ LOCAL_SRC_FILES := ../assets/BmfLoader.cpp \
     ../scene/StaticMeshRenderer.cpp \
     ../scene/TextRenderer.cpp \
     ../storage/FileSystem.cpp \
+    ../storage/FileWatcher.cpp \
     ../utils/Log.cpp \
     ../utils/Utils.cpp
 
@@ -1,128 +1,181 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
 #include <stdexcept>
 #include <string>
-#include <string_view>
 #include "Localization.hpp"
+#include "../utils/Utils.hpp"
 
 namespace ouzel
 {
-    Language::Language(const std::vector<std::byte>& data)
+    namespace
     {
-        if (data.size() < 5 * sizeof(std::uint32_t))
+        constexpr std::uint32_t magicBig = 0xDE120495U;
+        constexpr std::uint32_t magicLittle = 0x950412DEU;
+        constexpr std::size_t headerSize = 7 * sizeof(std::uint32_t);
+
+        // the hashpjw function used by gettext, stops at the first null character like the C string version
+        std::uint32_t hashString(std::string_view str) noexcept
+        {
+            std::uint32_t result = 0;
+
+            for (const char c : str)
+            {
+                if (c == '\0') break;
+
+                result = (result << 4) + static_cast<std::uint8_t>(c);
+                if (const std::uint32_t high = result & 0xF0000000U)
+                {
+                    result ^= high >> 24;
+                    result ^= high;
+                }
+            }
+
+            return result;
+        }
+    }
+
+    Language::Language(const std::vector<std::byte>& initData):
+        Language{storage::FileView{initData}}
+    {
+    }
+
+    Language::Language(storage::FileView initData):
+        data{std::move(initData)}
+    {
+        if (data.size() < headerSize)
             throw std::runtime_error("Not enough data");
 
-        const auto magic = static_cast<std::uint32_t>(data[0]) |
-            (static_cast<std::uint32_t>(data[1]) << 8) |
-            (static_cast<std::uint32_t>(data[2]) << 16) |
-            (static_cast<std::uint32_t>(data[3]) << 24);
-
-        const auto decodeUInt32 = [magic]() -> std::function<std::uint32_t(const std::byte*)> {
-            constexpr std::uint32_t magicBig = 0xDE120495U;
-            constexpr std::uint32_t magicLittle = 0x950412DEU;
-
-            if (magic == magicBig)
-                return [](const std::byte* bytes) noexcept {
-                    return static_cast<std::uint32_t>(bytes[3]) |
-                        (static_cast<std::uint32_t>(bytes[2]) << 8) |
-                        (static_cast<std::uint32_t>(bytes[1]) << 16) |
-                        (static_cast<std::uint32_t>(bytes[0]) << 24);
-                };
-            else if (magic == magicLittle)
-                return [](const std::byte* bytes) noexcept {
-                    return static_cast<std::uint32_t>(bytes[0]) |
-                        (static_cast<std::uint32_t>(bytes[1]) << 8) |
-                        (static_cast<std::uint32_t>(bytes[2]) << 16) |
-                        (static_cast<std::uint32_t>(bytes[3]) << 24);
-                };
-            else
-                throw std::runtime_error("Wrong magic " + std::to_string(magic));
-        }();
-
-        const std::uint32_t revisionOffset = sizeof(magic);
-        const std::uint32_t revision = decodeUInt32(data.data() + revisionOffset);
-
-        if (revision != 0)
-            throw std::runtime_error("Unsupported revision " + std::to_string(revision));
+        const auto magic = decodeLittleEndian<std::uint32_t>(data.data());
 
-        const std::uint32_t stringCountOffset = revisionOffset + sizeof(revision);
-        const std::uint32_t stringCount = decodeUInt32(data.data() + stringCountOffset);
+        if (magic == magicBig)
+            bigEndian = true;
+        else if (magic != magicLittle)
+            throw std::runtime_error("Wrong magic " + std::to_string(magic));
 
-        struct TranslationInfo final
-        {
-            std::uint32_t stringLength = 0;
-            std::uint32_t stringOffset = 0;
+        const std::uint32_t revision = decodeUInt32(4);
 
-            std::uint32_t translationLength = 0;
-            std::uint32_t translationOffset = 0;
-        };
-        std::vector<TranslationInfo> translations(stringCount);
+        // only the major revision (upper 16 bits) affects the layout
+        if ((revision >> 16) != 0)
+            throw std::runtime_error("Unsupported revision " + std::to_string(revision));
 
-        const std::uint32_t stringsOffsetOffset = stringCountOffset + sizeof(stringCount);
-        const std::uint32_t stringsOffset = decodeUInt32(data.data() + stringsOffsetOffset);
+        stringCount = decodeUInt32(8);
+        stringsOffset = decodeUInt32(12);
+        translationsOffset = decodeUInt32(16);
+        hashTableSize = decodeUInt32(20);
+        hashTableOffset = decodeUInt32(24);
 
-        const std::uint32_t translationsOffsetOffset = stringsOffsetOffset + sizeof(stringsOffset);
-        const std::uint32_t translationsOffset = decodeUInt32(data.data() + translationsOffsetOffset);
+        const auto checkRange = [this](std::size_t offset, std::size_t size) {
+            if (offset > data.size() || size > data.size() - offset)
+                throw std::runtime_error("Not enough data");
+        };
 
-        if (data.size() < stringsOffset + 2 * sizeof(std::uint32_t) * stringCount)
-            throw std::runtime_error("Not enough data");
+        const std::size_t tableSize = 2 * sizeof(std::uint32_t) * std::size_t(stringCount);
+        checkRange(stringsOffset, tableSize);
+        checkRange(translationsOffset, tableSize);
 
-        std::uint32_t stringOffset = stringsOffset;
+        // strings are null-terminated
         for (std::uint32_t i = 0; i < stringCount; ++i)
         {
-            translations[i].stringLength = decodeUInt32(data.data() + stringOffset);
-            stringOffset += sizeof(translations[i].stringLength);
+            const std::size_t stringOffset = stringsOffset + i * 2 * sizeof(std::uint32_t);
+            checkRange(decodeUInt32(stringOffset + sizeof(std::uint32_t)), std::size_t(decodeUInt32(stringOffset)) + 1);
 
-            translations[i].stringOffset = decodeUInt32(data.data() + stringOffset);
-            stringOffset += sizeof(translations[i].stringOffset);
+            const std::size_t translationOffset = translationsOffset + i * 2 * sizeof(std::uint32_t);
+            checkRange(decodeUInt32(translationOffset + sizeof(std::uint32_t)), std::size_t(decodeUInt32(translationOffset)) + 1);
         }
 
-        if (data.size() < translationsOffset + 2 * sizeof(std::uint32_t) * stringCount)
-            throw std::runtime_error("Not enough data");
-
-        std::uint32_t translationOffset = translationsOffset;
-        for (std::uint32_t i = 0; i < stringCount; ++i)
+        // the double hashing step needs at least three slots
+        if (hashTableSize > 2)
+            checkRange(hashTableOffset, sizeof(std::uint32_t) * std::size_t(hashTableSize));
+        else
         {
-            translations[i].translationLength = decodeUInt32(data.data() + translationOffset);
-            translationOffset += sizeof(translations[i].translationLength);
-
-            translations[i].translationOffset = decodeUInt32(data.data() + translationOffset);
-            translationOffset += sizeof(translations[i].translationOffset);
+            hashTableSize = 0;
+
+            sortedStrings.resize(stringCount);
+            for (std::uint32_t i = 0; i < stringCount; ++i)
+                sortedStrings[i] = i;
+
+            // msgfmt writes the strings sorted, so usually there is nothing to do
+            const auto compare = [this](std::uint32_t a, std::uint32_t b) noexcept {
+                return getOriginal(a) < getOriginal(b);
+            };
+            if (!std::is_sorted(sortedStrings.begin(), sortedStrings.end(), compare))
+                std::sort(sortedStrings.begin(), sortedStrings.end(), compare);
         }
+    }
 
-        for (std::uint32_t i = 0; i < stringCount; ++i)
+    std::string_view Language::getString(std::string_view str) const noexcept
+    {
+        if (hashTableSize)
         {
-            if (data.size() < translations[i].stringOffset + translations[i].stringLength ||
-                data.size() < translations[i].translationOffset + translations[i].translationLength)
-                throw std::runtime_error("Not enough data");
+            const auto hash = hashString(str);
+            auto index = hash % hashTableSize;
+            const auto increment = 1 + (hash % (hashTableSize - 2));
+
+            for (std::uint32_t probe = 0; probe < hashTableSize; ++probe)
+            {
+                const auto entry = decodeUInt32(hashTableOffset + index * sizeof(std::uint32_t));
+                if (entry == 0) break; // empty slot
+
+                // entries above the string count are system dependent strings of revision 1 catalogs
+                if (entry <= stringCount && getOriginal(entry - 1) == str)
+                    return getTranslation(entry - 1);
 
-            const std::string str(reinterpret_cast<const char*>(data.data() + translations[i].stringOffset),
-                                  translations[i].stringLength);
-            const std::string_view translation(reinterpret_cast<const char*>(data.data() + translations[i].translationOffset),
-                                               translations[i].translationLength);
+                index = (index >= hashTableSize - increment) ? index - (hashTableSize - increment) : index + increment;
+            }
+        }
+        else
+        {
+            const auto i = std::lower_bound(sortedStrings.begin(), sortedStrings.end(), str,
+                                            [this](std::uint32_t index, std::string_view value) noexcept {
+                                                return getOriginal(index) < value;
+                                            });
 
-            strings[str] = translation;
+            if (i != sortedStrings.end() && getOriginal(*i) == str)
+                return getTranslation(*i);
         }
+
+        return str;
     }
 
-    std::string Language::getString(const std::string& str) const
+    std::uint32_t Language::decodeUInt32(std::size_t offset) const noexcept
     {
-        const auto i = strings.find(str);
+        return bigEndian ?
+            decodeBigEndian<std::uint32_t>(data.data() + offset) :
+            decodeLittleEndian<std::uint32_t>(data.data() + offset);
+    }
 
-        if (i != strings.end())
-            return i->second;
-        else
-            return str;
+    std::string_view Language::getOriginal(std::uint32_t index) const noexcept
+    {
+        return getStringAt(stringsOffset, index);
+    }
+
+    std::string_view Language::getTranslation(std::uint32_t index) const noexcept
+    {
+        return getStringAt(translationsOffset, index);
+    }
+
+    std::string_view Language::getStringAt(std::uint32_t tableOffset, std::uint32_t index) const noexcept
+    {
+        const std::size_t entryOffset = tableOffset + index * 2 * sizeof(std::uint32_t);
+        const auto length = decodeUInt32(entryOffset);
+        const auto offset = decodeUInt32(entryOffset + sizeof(std::uint32_t));
+        return std::string_view{reinterpret_cast<const char*>(data.data() + offset), length};
     }
 
     void Localization::addLanguage(const std::string& name, const std::vector<std::byte>& data)
+    {
+        addLanguage(name, storage::FileView{data});
+    }
+
+    void Localization::addLanguage(const std::string& name, storage::FileView data)
     {
         const auto i = languages.find(name);
 
         if (i != languages.end())
-            i->second = Language(data);
+            i->second = Language(std::move(data));
         else
-            languages.insert(std::make_pair(name, Language(data)));
+            languages.insert(std::make_pair(name, Language(std::move(data))));
     }
 
     void Localization::removeLanguage(const std::string& name)
@@ -148,7 +201,7 @@ namespace ouzel
             currentLanguage = languages.end();
     }
 
-    std::string Localization::getString(const std::string& str) const
+    std::string_view Localization::getString(std::string_view str) const noexcept
     {
         if (currentLanguage != languages.end())
             return currentLanguage->second.getString(str);
@@ -3,32 +3,53 @@
 #ifndef OUZEL_LOCALIZATION_LOCALIZATION_HPP
 #define OUZEL_LOCALIZATION_LOCALIZATION_HPP
 
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "../storage/FileView.hpp"
 
 namespace ouzel
 {
+    // gettext catalog (.mo file), strings are looked up in the data without copying them
     class Language final
     {
     public:
         Language() = default;
-        explicit Language(const std::vector<std::byte>& data);
+        explicit Language(const std::vector<std::byte>& initData);
+        explicit Language(storage::FileView initData);
 
-        std::string getString(const std::string& str) const;
+        // returns the string itself if there is no translation for it
+        std::string_view getString(std::string_view str) const noexcept;
 
     private:
-        std::map<std::string, std::string> strings;
+        std::uint32_t decodeUInt32(std::size_t offset) const noexcept;
+        std::string_view getOriginal(std::uint32_t index) const noexcept;
+        std::string_view getTranslation(std::uint32_t index) const noexcept;
+        std::string_view getStringAt(std::uint32_t tableOffset, std::uint32_t index) const noexcept;
+
+        storage::FileView data;
+        bool bigEndian = false;
+        std::uint32_t stringCount = 0;
+        std::uint32_t stringsOffset = 0;
+        std::uint32_t translationsOffset = 0;
+        std::uint32_t hashTableSize = 0;
+        std::uint32_t hashTableOffset = 0;
+        std::vector<std::uint32_t> sortedStrings; // used if the file has no hash table
     };
 
     class Localization final
     {
     public:
         void addLanguage(const std::string& name, const std::vector<std::byte>& data);
+        void addLanguage(const std::string& name, storage::FileView data);
         void removeLanguage(const std::string& name);
         void setLanguage(const std::string& name);
-        std::string getString(const std::string& str) const;
+
+        // the result points to the catalog or, if there is no translation, to str
+        std::string_view getString(std::string_view str) const noexcept;
 
     private:
         std::map<std::string, Language> languages;
@@ -0,0 +1,200 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <algorithm>
+#include <random>
+#include "ParticleManager.hpp"
+#include "ParticleSystem.hpp"
+#include "../core/Engine.hpp"
+#include "../utils/Utils.hpp"
+
+namespace ouzel::scene
+{
+    ParticleManager::ParticleManager()
+    {
+        updateHandler.updateHandler = [this](const UpdateEvent& event) {
+            update(event.delta);
+            return false;
+        };
+    }
+
+    ParticleManager::~ParticleManager()
+    {
+        std::unique_lock lock(jobMutex);
+        running = false;
+        lock.unlock();
+        jobCondition.notify_all();
+
+        for (auto& worker : workers)
+            if (worker.isJoinable()) worker.join();
+
+        for (ParticleSystem* system : systems)
+            system->manager = nullptr;
+
+        for (ParticleSystem* system : finishedSystems)
+            system->manager = nullptr;
+    }
+
+    void ParticleManager::addSystem(ParticleSystem& system)
+    {
+        removeSystem(system);
+
+        if (deterministic)
+        {
+            std::seed_seq seedSequence{seed, sequence++};
+            system.randomEngine.seed(seedSequence);
+        }
+        else
+            system.randomEngine.seed(randomEngine());
+
+        if (systems.empty())
+            engine->getEventDispatcher().addEventHandler(updateHandler);
+
+        systems.push_back(&system);
+        system.manager = this;
+    }
+
+    void ParticleManager::removeSystem(ParticleSystem& system) noexcept
+    {
+        if (system.manager != this) return;
+
+        auto i = std::find(systems.begin(), systems.end(), &system);
+        if (i != systems.end()) systems.erase(i);
+
+        i = std::find(finishedSystems.begin(), finishedSystems.end(), &system);
+        if (i != finishedSystems.end()) finishedSystems.erase(i);
+
+        system.manager = nullptr;
+    }
+
+    void ParticleManager::setDeterministic(bool newDeterministic, std::uint32_t newSeed) noexcept
+    {
+        deterministic = newDeterministic;
+        seed = newSeed;
+        sequence = 0;
+    }
+
+    void ParticleManager::update(float delta)
+    {
+        // everything that depends on the actors is read on the update thread
+        for (ParticleSystem* system : systems)
+            system->prepareUpdate();
+
+        stepDelta = delta;
+        nextSystem = 0;
+
+        if (systems.size() > 1 && !workersStarted)
+            startWorkers();
+
+        if (systems.size() > 1 && !workers.empty())
+        {
+            std::unique_lock lock(jobMutex);
+            ++generation;
+            busyWorkers = workers.size();
+            lock.unlock();
+            jobCondition.notify_all();
+
+            simulateSystems();
+
+            lock.lock();
+            doneCondition.wait(lock, [this]() noexcept { return busyWorkers == 0; });
+        }
+        else
+            simulateSystems();
+
+        if (exception)
+        {
+            const auto currentException = exception;
+            exception = nullptr;
+            std::rethrow_exception(currentException);
+        }
+
+        for (auto i = systems.begin(); i != systems.end();)
+        {
+            if (!(*i)->active)
+            {
+                finishedSystems.push_back(*i);
+                i = systems.erase(i);
+            }
+            else
+                ++i;
+        }
+
+        if (systems.empty())
+            updateHandler.remove();
+
+        // the event handlers can remove, destroy or resume any of the systems
+        while (!finishedSystems.empty())
+        {
+            ParticleSystem* system = finishedSystems.front();
+            finishedSystems.erase(finishedSystems.begin());
+            system->manager = nullptr;
+
+            auto finishEvent = std::make_unique<AnimationEvent>();
+            finishEvent->type = Event::Type::animationFinish;
+            finishEvent->component = system;
+            engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
+        }
+    }
+
+    void ParticleManager::startWorkers()
+    {
+        workersStarted = true;
+
+#if !defined(__EMSCRIPTEN__)
+        // the update thread simulates the systems too
+        const auto cpuCount = std::thread::hardware_concurrency();
+        const auto workerCount = cpuCount > 1 ? cpuCount - 1 : 0U;
+
+        workers.reserve(workerCount);
+        for (std::uint32_t i = 0; i < workerCount; ++i)
+            workers.emplace_back(&ParticleManager::workerMain, this);
+#endif
+    }
+
+    void ParticleManager::workerMain()
+    {
+        thread::setCurrentThreadName("Particles");
+
+        std::uint64_t currentGeneration = 0;
+
+        for (;;)
+        {
+            std::unique_lock lock(jobMutex);
+            jobCondition.wait(lock, [this, currentGeneration]() noexcept {
+                return !running || generation != currentGeneration;
+            });
+            if (!running) break;
+            currentGeneration = generation;
+            lock.unlock();
+
+            simulateSystems();
+
+            lock.lock();
+            if (--busyWorkers == 0)
+            {
+                lock.unlock();
+                doneCondition.notify_all();
+            }
+        }
+    }
+
+    void ParticleManager::simulateSystems() noexcept
+    {
+        // one job per system, the systems don't share any state
+        for (;;)
+        {
+            const auto index = nextSystem.fetch_add(1);
+            if (index >= systems.size()) break;
+
+            try
+            {
+                systems[index]->simulate(stepDelta);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(jobMutex);
+                if (!exception) exception = std::current_exception();
+            }
+        }
+    }
+}
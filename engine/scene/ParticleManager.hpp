@@ -0,0 +1,72 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_SCENE_PARTICLEMANAGER_HPP
+#define OUZEL_SCENE_PARTICLEMANAGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <vector>
+#include "../events/EventHandler.hpp"
+#include "../thread/Thread.hpp"
+
+namespace ouzel::scene
+{
+    class ParticleSystem;
+
+    // Steps all active particle systems on the update thread and a pool of worker threads
+    // and builds their vertex data before the scenes are drawn
+    class ParticleManager final
+    {
+    public:
+        ParticleManager();
+        ~ParticleManager();
+
+        ParticleManager(const ParticleManager&) = delete;
+        ParticleManager& operator=(const ParticleManager&) = delete;
+
+        ParticleManager(ParticleManager&&) = delete;
+        ParticleManager& operator=(ParticleManager&&) = delete;
+
+        void addSystem(ParticleSystem& system);
+        void removeSystem(ParticleSystem& system) noexcept;
+
+        // in the deterministic mode the random engines of the systems are seeded from the seed
+        // in the order the systems are started, so a replay with the same update deltas emits the same particles
+        auto isDeterministic() const noexcept { return deterministic; }
+        void setDeterministic(bool newDeterministic, std::uint32_t newSeed = 0) noexcept;
+
+        auto getSystemCount() const noexcept { return systems.size(); }
+
+    private:
+        void update(float delta);
+        void startWorkers();
+        void workerMain();
+        void simulateSystems() noexcept;
+
+        std::vector<ParticleSystem*> systems;
+        std::vector<ParticleSystem*> finishedSystems;
+        EventHandler updateHandler;
+
+        bool deterministic = false;
+        std::uint32_t seed = 0;
+        std::uint32_t sequence = 0;
+
+        std::vector<thread::Thread> workers;
+        bool workersStarted = false;
+
+        std::mutex jobMutex;
+        std::condition_variable jobCondition;
+        std::condition_variable doneCondition;
+        bool running = true;
+        std::uint64_t generation = 0;
+        std::size_t busyWorkers = 0;
+        std::atomic<std::size_t> nextSystem{0};
+        float stepDelta = 0.0F;
+        std::exception_ptr exception;
+    };
+}
+
+#endif // OUZEL_SCENE_PARTICLEMANAGER_HPP
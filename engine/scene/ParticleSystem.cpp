@@ -1,9 +1,14 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#if defined(__SSE__)
+#  include <xmmintrin.h>
+#endif
 #include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <stdexcept>
 #include "ParticleSystem.hpp"
+#include "ParticleManager.hpp"
 #include "SceneManager.hpp"
 #include "Actor.hpp"
 #include "Camera.hpp"
@@ -19,18 +24,81 @@ namespace ouzel::scene
     namespace
     {
         constexpr float updateStep = 1.0F / 60.0F;
+
+        // values += deltas * step
+        void integrate(float* values, const float* deltas, float step, std::uint32_t count) noexcept
+        {
+            std::uint32_t i = 0;
+
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                const __m128 stepVector = _mm_set1_ps(step);
+
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(&values[i], _mm_add_ps(_mm_loadu_ps(&values[i]),
+                                                         _mm_mul_ps(_mm_loadu_ps(&deltas[i]), stepVector)));
+            }
+#endif
+
+            for (; i < count; ++i)
+                values[i] += deltas[i] * step;
+        }
+
+        // values = max(values + deltas * step, 0)
+        void integratePositive(float* values, const float* deltas, float step, std::uint32_t count) noexcept
+        {
+            std::uint32_t i = 0;
+
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                const __m128 stepVector = _mm_set1_ps(step);
+                const __m128 zero = _mm_setzero_ps();
+
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(&values[i], _mm_max_ps(_mm_add_ps(_mm_loadu_ps(&values[i]),
+                                                                    _mm_mul_ps(_mm_loadu_ps(&deltas[i]), stepVector)),
+                                                         zero));
+            }
+#endif
+
+            for (; i < count; ++i)
+                values[i] = std::max(0.0F, values[i] + deltas[i] * step);
+        }
+
+        void decrement(float* values, float amount, std::uint32_t count) noexcept
+        {
+            std::uint32_t i = 0;
+
+#if defined(__SSE__)
+            if (core::isSimdAvailable)
+            {
+                const __m128 amountVector = _mm_set1_ps(amount);
+
+                for (; i + 4 <= count; i += 4)
+                    _mm_storeu_ps(&values[i], _mm_sub_ps(_mm_loadu_ps(&values[i]), amountVector));
+            }
+#endif
+
+            for (; i < count; ++i)
+                values[i] -= amount;
+        }
     }
 
     ParticleSystem::ParticleSystem():
-        shader(engine->getCache().getShader(shaderTexture)),
         blendState(engine->getCache().getBlendState(blendAlpha))
     {
-        whitePixelTexture = engine->getCache().getTexture(textureWhitePixel);
+        // the instanced shader is only registered if the render device supports instancing
+        if (const auto instancedShader = engine->getCache().getShader(shaderInstancedTexture))
+        {
+            shader = instancedShader;
+            instanced = true;
+        }
+        else
+            shader = engine->getCache().getShader(shaderTexture);
 
-        updateHandler.updateHandler = [this](const UpdateEvent& event) {
-            update(event.delta);
-            return false;
-        };
+        whitePixelTexture = engine->getCache().getTexture(textureWhitePixel);
     }
 
     ParticleSystem::ParticleSystem(const ParticleSystemData& initParticleSystemData):
@@ -39,6 +107,17 @@ namespace ouzel::scene
         init(initParticleSystemData);
     }
 
+    ParticleSystem::ParticleSystem(const std::string& filename):
+        ParticleSystem()
+    {
+        init(filename);
+    }
+
+    ParticleSystem::~ParticleSystem()
+    {
+        if (manager) manager->removeSystem(*this);
+    }
+
     void ParticleSystem::draw(const Matrix4F& transformMatrix,
                               float opacity,
                               const Matrix4F& renderViewProjection,
@@ -49,12 +128,29 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
+        if (!sourceName.empty() && reloadCount != engine->getCache().getReloadCount())
+        {
+            reloadCount = engine->getCache().getReloadCount();
+
+            if (const auto data = engine->getCache().getParticleSystemData(sourceName))
+            {
+                const auto name = std::move(sourceName);
+                reset();
+                init(*data);
+                sourceName = name;
+            }
+        }
+
         if (particleCount)
         {
-            if (needsMeshUpdate)
+            if (needsMeshUpload)
             {
-                updateParticleMesh();
-                needsMeshUpdate = false;
+                // only the live particles are uploaded, the rest of the buffer is not drawn
+                if (instanced)
+                    vertexBuffer->setData(instances.data(), static_cast<std::uint32_t>(particleCount * sizeof(graphics::InstanceVertex)));
+                else
+                    vertexBuffer->setData(vertices.data(), static_cast<std::uint32_t>(particleCount * 4 * sizeof(graphics::Vertex)));
+                needsMeshUpload = false;
             }
 
             const Matrix4F transform =
@@ -80,16 +176,45 @@ namespace ouzel::scene
             engine->getGraphics()->setShaderConstants(pixelShaderConstants,
                                                       vertexShaderConstants);
             engine->getGraphics()->setTextures({wireframe ? whitePixelTexture->getResource() : texture->getResource()});
-            engine->getGraphics()->draw(indexBuffer->getResource(),
-                                        particleCount * 6,
-                                        sizeof(std::uint16_t),
-                                        vertexBuffer->getResource(),
-                                        graphics::DrawMode::triangleList,
-                                        0);
+
+            if (instanced)
+                engine->getGraphics()->draw(indexBuffer->getResource(),
+                                            6,
+                                            sizeof(std::uint16_t),
+                                            vertexBuffer->getResource(),
+                                            graphics::DrawMode::triangleList,
+                                            0,
+                                            particleCount);
+            else
+                engine->getGraphics()->draw(indexBuffer->getResource(),
+                                            particleCount * 6,
+                                            sizeof(std::uint16_t),
+                                            vertexBuffer->getResource(),
+                                            graphics::DrawMode::triangleList,
+                                            0);
+        }
+    }
+
+    void ParticleSystem::prepareUpdate()
+    {
+        hasActor = actor != nullptr;
+
+        if (actor)
+        {
+            emitterPosition = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
+                Vector2F(actor->convertLocalToWorld(Vector3F())) :
+                (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+                Vector2F(actor->convertLocalToWorld(Vector3F()) - actor->getPosition()) :
+                (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
+                Vector2F() :
+                throw std::runtime_error("Invalid position type");
+
+            actorPosition = Vector2F(actor->getPosition());
+            inverseTransform = actor->getInverseTransform();
         }
     }
 
-    void ParticleSystem::update(float delta)
+    void ParticleSystem::simulate(float delta)
     {
         timeSinceUpdate += delta;
 
@@ -125,85 +250,50 @@ namespace ouzel::scene
             }
             else if (active && !particleCount)
             {
+                // the particle manager sends the finish event
                 active = false;
-                updateHandler.remove();
-
-                auto finishEvent = std::make_unique<AnimationEvent>();
-                finishEvent->type = Event::Type::animationFinish;
-                finishEvent->component = this;
-                engine->getEventDispatcher().dispatchEvent(std::move(finishEvent));
-
                 return;
             }
 
             if (active)
             {
-                for (std::uint32_t counter = particleCount; counter > 0; --counter)
+                const auto particles = getParticles();
+
+                decrement(particles.life, updateStep, particleCount);
+
+                if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
+                    updateGravity(particles, particleCount, updateStep);
+                else
                 {
-                    const std::size_t i = counter - 1;
+                    const float flip = particleSystemData.yCoordFlipped ? 1.0F : 0.0F;
 
-                    particles[i].life -= updateStep;
+                    integrate(particles.angle, particles.degreesPerSecond, updateStep, particleCount);
+                    integrate(particles.radius, particles.deltaRadius, updateStep, particleCount);
 
-                    if (particles[i].life >= 0.0F)
-                    {
-                        if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
-                        {
-                            Vector2F tmp;
-                            Vector2F radial;
-                            Vector2F tangential;
-
-                            // radial acceleration
-                            if (particles[i].position.v[0] == 0.0F || particles[i].position.v[1] == 0.0F)
-                                radial = particles[i].position.normalized();
-
-                            tangential = radial;
-                            radial *= particles[i].radialAcceleration;
-
-                            // tangential acceleration
-                            std::swap(tangential.v[0], tangential.v[1]);
-                            tangential.v[0] *= - particles[i].tangentialAcceleration;
-                            tangential.v[1] *= particles[i].tangentialAcceleration;
-
-                            // (gravity + radial + tangential) * updateStep
-                            tmp.v[0] = radial.v[0] + tangential.v[0] + particleSystemData.gravity.v[0];
-                            tmp.v[1] = radial.v[1] + tangential.v[1] + particleSystemData.gravity.v[1];
-                            tmp *= updateStep;
-
-                            particles[i].direction.v[0] += tmp.v[0];
-                            particles[i].direction.v[1] += tmp.v[1];
-                            tmp.v[0] = particles[i].direction.v[0] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                            tmp.v[1] = particles[i].direction.v[1] * updateStep * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                            particles[i].position.v[0] += tmp.v[0];
-                            particles[i].position.v[1] += tmp.v[1];
-                        }
-                        else
-                        {
-                            particles[i].angle += particles[i].degreesPerSecond * updateStep;
-                            particles[i].radius += particles[i].deltaRadius * updateStep;
-                            particles[i].position.v[0] = -std::cos(particles[i].angle) * particles[i].radius;
-                            particles[i].position.v[1] = -std::sin(particles[i].angle) * particles[i].radius * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
-                        }
-
-                        // color r,g,b,a
-                        particles[i].colorRed += particles[i].deltaColorRed * updateStep;
-                        particles[i].colorGreen += particles[i].deltaColorGreen * updateStep;
-                        particles[i].colorBlue += particles[i].deltaColorBlue * updateStep;
-                        particles[i].colorAlpha += particles[i].deltaColorAlpha * updateStep;
-
-                        // size
-                        particles[i].size += (particles[i].deltaSize * updateStep);
-                        particles[i].size = std::max(0.0F, particles[i].size);
-
-                        // angle
-                        particles[i].rotation += particles[i].deltaRotation * updateStep;
-                    }
-                    else
+                    for (std::uint32_t i = 0; i < particleCount; ++i)
                     {
-                        particles[i] = particles[particleCount - 1];
-                        --particleCount;
+                        particles.positionX[i] = -std::cos(particles.angle[i]) * particles.radius[i];
+                        particles.positionY[i] = -std::sin(particles.angle[i]) * particles.radius[i] * flip;
                     }
                 }
 
+                // color r,g,b,a
+                integrate(particles.colorRed, particles.deltaColorRed, updateStep, particleCount);
+                integrate(particles.colorGreen, particles.deltaColorGreen, updateStep, particleCount);
+                integrate(particles.colorBlue, particles.deltaColorBlue, updateStep, particleCount);
+                integrate(particles.colorAlpha, particles.deltaColorAlpha, updateStep, particleCount);
+
+                // size
+                integratePositive(particles.size, particles.deltaSize, updateStep, particleCount);
+
+                // angle
+                integrate(particles.rotation, particles.deltaRotation, updateStep, particleCount);
+
+                // dead particles are replaced by the last ones
+                for (std::uint32_t counter = particleCount; counter > 0; --counter)
+                    if (particles.life[counter - 1] < 0.0F)
+                        removeParticle(counter - 1);
+
                 needsMeshUpdate = true;
                 needsBoundingBoxUpdate = true;
             }
@@ -217,13 +307,13 @@ namespace ouzel::scene
             if (particleSystemData.positionType == ParticleSystemData::PositionType::free ||
                 particleSystemData.positionType == ParticleSystemData::PositionType::parent)
             {
-                if (actor)
+                if (hasActor)
                 {
-                    const auto& inverseTransform = actor->getInverseTransform();
+                    const auto particles = getParticles();
 
                     for (std::uint32_t i = 0; i < particleCount; ++i)
                     {
-                        auto position = Vector3F(particles[i].position);
+                        Vector3F position{particles.positionX[i], particles.positionY[i], 0.0F};
                         inverseTransform.transformPoint(position);
                         boundingBox.insertPoint(position);
                     }
@@ -231,14 +321,24 @@ namespace ouzel::scene
             }
             else if (particleSystemData.positionType == ParticleSystemData::PositionType::grouped)
             {
+                const auto particles = getParticles();
+
                 for (std::uint32_t i = 0; i < particleCount; ++i)
-                    boundingBox.insertPoint(Vector3F(particles[i].position));
+                    boundingBox.insertPoint(Vector3F{particles.positionX[i], particles.positionY[i], 0.0F});
             }
         }
+
+        if (needsMeshUpdate && particleCount)
+        {
+            updateParticleMesh();
+            needsMeshUpdate = false;
+            needsMeshUpload = true;
+        }
     }
 
     void ParticleSystem::init(const ParticleSystemData& newParticleSystemData)
     {
+        sourceName.clear();
         particleSystemData = newParticleSystemData;
 
         texture = particleSystemData.texture;
@@ -250,6 +350,19 @@ namespace ouzel::scene
         resume();
     }
 
+    void ParticleSystem::init(const std::string& filename)
+    {
+        const auto data = engine->getCache().getParticleSystemData(filename);
+
+        if (!data)
+            throw std::runtime_error("Particle system data " + filename + " not found");
+
+        init(*data);
+
+        sourceName = filename;
+        reloadCount = engine->getCache().getReloadCount();
+    }
+
     void ParticleSystem::resume()
     {
         if (!running)
@@ -260,7 +373,7 @@ namespace ouzel::scene
             if (!active)
             {
                 active = true;
-                engine->getEventDispatcher().addEventHandler(updateHandler);
+                engine->getSceneManager().getParticleManager().addSystem(*this);
             }
 
             if (particleCount == 0)
@@ -289,26 +402,38 @@ namespace ouzel::scene
 
     void ParticleSystem::createParticleMesh()
     {
-        indices.reserve(particleSystemData.maxParticles * 6);
-        vertices.reserve(particleSystemData.maxParticles * 4);
-
-        for (std::uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+        if (instanced)
         {
-            indices.push_back(i * 4 + 0);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 2);
-            indices.push_back(i * 4 + 1);
-            indices.push_back(i * 4 + 3);
-            indices.push_back(i * 4 + 2);
-
-            vertices.emplace_back(Vector3F{-1.0F, -1.0F, 0.0F}, Color::white(),
-                                  Vector2F{0.0F, 1.0F}, Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{1.0F, -1.0F, 0.0F}, Color::white(),
-                                  Vector2F{1.0F, 1.0F}, Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{-1.0F, 1.0F, 0.0F}, Color::white(),
-                                  Vector2F{0.0F, 0.0F}, Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{1.0F, 1.0F, 0.0F}, Color::white(),
-                                  Vector2F{1.0F, 0.0F}, Vector3F{0.0F, 0.0F, -1.0F});
+            // one instance per particle, the shader expands it to a quad
+            indices = {0, 1, 2, 1, 3, 2};
+            instances.resize(particleSystemData.maxParticles);
+        }
+        else
+        {
+            // the mesh is created again when the system is initialized again
+            indices.clear();
+            vertices.clear();
+            indices.reserve(particleSystemData.maxParticles * 6);
+            vertices.reserve(particleSystemData.maxParticles * 4);
+
+            for (std::uint16_t i = 0; i < particleSystemData.maxParticles; ++i)
+            {
+                indices.push_back(i * 4 + 0);
+                indices.push_back(i * 4 + 1);
+                indices.push_back(i * 4 + 2);
+                indices.push_back(i * 4 + 1);
+                indices.push_back(i * 4 + 3);
+                indices.push_back(i * 4 + 2);
+
+                vertices.emplace_back(Vector3F{-1.0F, -1.0F, 0.0F}, Color::white(),
+                                      Vector2F{0.0F, 1.0F}, Vector3F{0.0F, 0.0F, -1.0F});
+                vertices.emplace_back(Vector3F{1.0F, -1.0F, 0.0F}, Color::white(),
+                                      Vector2F{1.0F, 1.0F}, Vector3F{0.0F, 0.0F, -1.0F});
+                vertices.emplace_back(Vector3F{-1.0F, 1.0F, 0.0F}, Color::white(),
+                                      Vector2F{0.0F, 0.0F}, Vector3F{0.0F, 0.0F, -1.0F});
+                vertices.emplace_back(Vector3F{1.0F, 1.0F, 0.0F}, Color::white(),
+                                      Vector2F{1.0F, 0.0F}, Vector3F{0.0F, 0.0F, -1.0F});
+            }
         }
 
         indexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
@@ -317,63 +442,263 @@ namespace ouzel::scene
                                                          indices.data(),
                                                          static_cast<std::uint32_t>(getVectorSize(indices)));
 
-        vertexBuffer = std::make_unique<graphics::Buffer>(*engine->getGraphics(),
-                                                          graphics::BufferType::vertex,
-                                                          graphics::Flags::dynamic,
-                                                          vertices.data(),
-                                                          static_cast<std::uint32_t>(getVectorSize(vertices)));
+        vertexBuffer = instanced ?
+            std::make_unique<graphics::Buffer>(*engine->getGraphics(),
+                                               graphics::BufferType::vertex,
+                                               graphics::Flags::dynamic,
+                                               instances.data(),
+                                               static_cast<std::uint32_t>(getVectorSize(instances))) :
+            std::make_unique<graphics::Buffer>(*engine->getGraphics(),
+                                               graphics::BufferType::vertex,
+                                               graphics::Flags::dynamic,
+                                               vertices.data(),
+                                               static_cast<std::uint32_t>(getVectorSize(vertices)));
+
+        // padded, so that every array starts at a 16 byte boundary relative to the first one
+        particleCapacity = (particleSystemData.maxParticles + 3) & ~3U;
+        particleData.assign(particleCapacity * attributeCount, 0.0F);
+        rotationCosines.resize(particleCapacity);
+        rotationSines.resize(particleCapacity);
+    }
 
-        particles.resize(particleSystemData.maxParticles);
+    ParticleSystem::Particles ParticleSystem::getParticles() noexcept
+    {
+        float* data = particleData.data();
+        const auto next = [&data, this]() noexcept {
+            float* result = data;
+            data += particleCapacity;
+            return result;
+        };
+
+        Particles result;
+        result.life = next();
+        result.positionX = next();
+        result.positionY = next();
+        result.colorRed = next();
+        result.colorGreen = next();
+        result.colorBlue = next();
+        result.colorAlpha = next();
+        result.deltaColorRed = next();
+        result.deltaColorGreen = next();
+        result.deltaColorBlue = next();
+        result.deltaColorAlpha = next();
+        result.angle = next();
+        result.size = next();
+        result.deltaSize = next();
+        result.rotation = next();
+        result.deltaRotation = next();
+        result.radialAcceleration = next();
+        result.tangentialAcceleration = next();
+        result.directionX = next();
+        result.directionY = next();
+        result.radius = next();
+        result.degreesPerSecond = next();
+        result.deltaRadius = next();
+        return result;
     }
 
-    void ParticleSystem::updateParticleMesh()
+    void ParticleSystem::removeParticle(std::uint32_t index) noexcept
     {
-        if (actor)
+        const auto last = --particleCount;
+
+        if (index != last)
+            for (std::size_t attribute = 0; attribute < attributeCount; ++attribute)
+                particleData[attribute * particleCapacity + index] = particleData[attribute * particleCapacity + last];
+    }
+
+    void ParticleSystem::updateGravity(const Particles& particles, std::uint32_t count, float step) noexcept
+    {
+        const float gravityX = particleSystemData.gravity.v[0];
+        const float gravityY = particleSystemData.gravity.v[1];
+        const float positionStep = step * (particleSystemData.yCoordFlipped ? 1.0F : 0.0F);
+
+        std::uint32_t i = 0;
+
+#if defined(__SSE__)
+        if (core::isSimdAvailable)
         {
-            for (std::uint32_t counter = particleCount; counter > 0; --counter)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0F);
+            const __m128 minLength = _mm_set1_ps(std::numeric_limits<float>::min());
+            const __m128 gravityXVector = _mm_set1_ps(gravityX);
+            const __m128 gravityYVector = _mm_set1_ps(gravityY);
+            const __m128 stepVector = _mm_set1_ps(step);
+            const __m128 positionStepVector = _mm_set1_ps(positionStep);
+
+            for (; i + 4 <= count; i += 4)
             {
-                const std::size_t i = counter - 1;
+                const __m128 positionX = _mm_loadu_ps(&particles.positionX[i]);
+                const __m128 positionY = _mm_loadu_ps(&particles.positionY[i]);
+
+                // same as Vector2F::normalized
+                const __m128 squared = _mm_add_ps(_mm_mul_ps(positionX, positionX), _mm_mul_ps(positionY, positionY));
+                const __m128 length = _mm_sqrt_ps(squared);
+                const __m128 multiplier = _mm_div_ps(one, length);
+                const __m128 keep = _mm_or_ps(_mm_cmpeq_ps(squared, one), _mm_cmple_ps(length, minLength));
+                const __m128 normalizedX = _mm_or_ps(_mm_and_ps(keep, positionX), _mm_andnot_ps(keep, _mm_mul_ps(positionX, multiplier)));
+                const __m128 normalizedY = _mm_or_ps(_mm_and_ps(keep, positionY), _mm_andnot_ps(keep, _mm_mul_ps(positionY, multiplier)));
+
+                // radial acceleration
+                const __m128 radialMask = _mm_or_ps(_mm_cmpeq_ps(positionX, zero), _mm_cmpeq_ps(positionY, zero));
+                const __m128 directionX = _mm_and_ps(radialMask, normalizedX);
+                const __m128 directionY = _mm_and_ps(radialMask, normalizedY);
+
+                const __m128 radialAcceleration = _mm_loadu_ps(&particles.radialAcceleration[i]);
+                const __m128 tangentialAcceleration = _mm_loadu_ps(&particles.tangentialAcceleration[i]);
+
+                // tangential acceleration
+                const __m128 tangentialX = _mm_mul_ps(directionY, _mm_sub_ps(zero, tangentialAcceleration));
+                const __m128 tangentialY = _mm_mul_ps(directionX, tangentialAcceleration);
+
+                // (gravity + radial + tangential) * step
+                const __m128 accelerationX = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, radialAcceleration), tangentialX), gravityXVector), stepVector);
+                const __m128 accelerationY = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionY, radialAcceleration), tangentialY), gravityYVector), stepVector);
+
+                const __m128 velocityX = _mm_add_ps(_mm_loadu_ps(&particles.directionX[i]), accelerationX);
+                const __m128 velocityY = _mm_add_ps(_mm_loadu_ps(&particles.directionY[i]), accelerationY);
+                _mm_storeu_ps(&particles.directionX[i], velocityX);
+                _mm_storeu_ps(&particles.directionY[i], velocityY);
+
+                _mm_storeu_ps(&particles.positionX[i], _mm_add_ps(positionX, _mm_mul_ps(velocityX, positionStepVector)));
+                _mm_storeu_ps(&particles.positionY[i], _mm_add_ps(positionY, _mm_mul_ps(velocityY, positionStepVector)));
+            }
+        }
+#endif
 
-                const Vector2F position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
-                    particles[i].position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
-                    Vector2F(actor->getPosition()) + particles[i].position :
-                    (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
-                    Vector2F() :
-                    throw std::runtime_error("Invalid position type");
+        for (; i < count; ++i)
+        {
+            Vector2F radial;
 
-                const float halfSize = particles[i].size / 2.0F;
-                Vector2F v1(-halfSize, -halfSize);
-                Vector2F v2(halfSize, halfSize);
+            // radial acceleration
+            if (particles.positionX[i] == 0.0F || particles.positionY[i] == 0.0F)
+                radial = Vector2F{particles.positionX[i], particles.positionY[i]}.normalized();
 
-                const float r = -degToRad(particles[i].rotation);
-                const float cr = std::cos(r);
-                const float sr = std::sin(r);
+            // tangential acceleration
+            const float tangentialX = radial.v[1] * -particles.tangentialAcceleration[i];
+            const float tangentialY = radial.v[0] * particles.tangentialAcceleration[i];
 
-                const Vector2F a(v1.v[0] * cr - v1.v[1] * sr, v1.v[0] * sr + v1.v[1] * cr);
-                const Vector2F b(v2.v[0] * cr - v1.v[1] * sr, v2.v[0] * sr + v1.v[1] * cr);
-                const Vector2F c(v2.v[0] * cr - v2.v[1] * sr, v2.v[0] * sr + v2.v[1] * cr);
-                const Vector2F d(v1.v[0] * cr - v2.v[1] * sr, v1.v[0] * sr + v2.v[1] * cr);
+            // (gravity + radial + tangential) * step
+            particles.directionX[i] += (radial.v[0] * particles.radialAcceleration[i] + tangentialX + gravityX) * step;
+            particles.directionY[i] += (radial.v[1] * particles.radialAcceleration[i] + tangentialY + gravityY) * step;
 
-                const Color color(static_cast<std::uint8_t>(particles[i].colorRed * 255),
-                                  static_cast<std::uint8_t>(particles[i].colorGreen * 255),
-                                  static_cast<std::uint8_t>(particles[i].colorBlue * 255),
-                                  static_cast<std::uint8_t>(particles[i].colorAlpha * 255));
+            particles.positionX[i] += particles.directionX[i] * positionStep;
+            particles.positionY[i] += particles.directionY[i] * positionStep;
+        }
+    }
 
-                vertices[i * 4 + 0].position = Vector3F(a + position);
-                vertices[i * 4 + 0].color = color;
+    void ParticleSystem::updateParticleMesh()
+    {
+        if (hasActor)
+        {
+            // grouped particles are drawn relative to the actor, so their positions are ignored
+            const bool grouped = particleSystemData.positionType == ParticleSystemData::PositionType::grouped;
+            const Vector2F offset = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
+                Vector2F() :
+                (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
+                actorPosition :
+                grouped ?
+                Vector2F() :
+                throw std::runtime_error("Invalid position type");
+
+            const auto particles = getParticles();
 
-                vertices[i * 4 + 1].position = Vector3F(b + position);
-                vertices[i * 4 + 1].color = color;
+            if (instanced)
+            {
+                // the centre, the half size and the rotation of the quad, the shader calculates the corners
+                for (std::uint32_t i = 0; i < particleCount; ++i)
+                {
+                    auto& instance = instances[i];
+                    instance.position = grouped ? Vector2F() : Vector2F{offset.v[0] + particles.positionX[i],
+                                                                        offset.v[1] + particles.positionY[i]};
+                    instance.color = Color(static_cast<std::uint8_t>(particles.colorRed[i] * 255),
+                                         static_cast<std::uint8_t>(particles.colorGreen[i] * 255),
+                                         static_cast<std::uint8_t>(particles.colorBlue[i] * 255),
+                                         static_cast<std::uint8_t>(particles.colorAlpha[i] * 255));
+                    instance.halfSize = particles.size[i] / 2.0F;
+                    instance.rotation = -degToRad(particles.rotation[i]);
+                }
 
-                vertices[i * 4 + 2].position = Vector3F(d + position);
-                vertices[i * 4 + 2].color = color;
+                return;
+            }
 
-                vertices[i * 4 + 3].position = Vector3F(c + position);
-                vertices[i * 4 + 3].color = color;
+            for (std::uint32_t i = 0; i < particleCount; ++i)
+            {
+                const float r = -degToRad(particles.rotation[i]);
+                rotationCosines[i] = std::cos(r);
+                rotationSines[i] = std::sin(r);
             }
 
-            vertexBuffer->setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
+            // corners of the quads are calculated for four particles at once and then written to the vertices
+            alignas(16) float cornerX[4][4];
+            alignas(16) float cornerY[4][4];
+
+            for (std::uint32_t first = 0; first < particleCount; first += 4)
+            {
+                const auto batchSize = std::min(particleCount - first, 4U);
+
+#if defined(__SSE__)
+                if (core::isSimdAvailable && batchSize == 4)
+                {
+                    const __m128 halfSize = _mm_mul_ps(_mm_loadu_ps(&particles.size[first]), _mm_set1_ps(0.5F));
+                    const __m128 hc = _mm_mul_ps(halfSize, _mm_loadu_ps(&rotationCosines[first]));
+                    const __m128 hs = _mm_mul_ps(halfSize, _mm_loadu_ps(&rotationSines[first]));
+
+                    const __m128 positionX = grouped ? _mm_setzero_ps() : _mm_add_ps(_mm_set1_ps(offset.v[0]), _mm_loadu_ps(&particles.positionX[first]));
+                    const __m128 positionY = grouped ? _mm_setzero_ps() : _mm_add_ps(_mm_set1_ps(offset.v[1]), _mm_loadu_ps(&particles.positionY[first]));
+
+                    const __m128 negativeHc = _mm_sub_ps(_mm_setzero_ps(), hc);
+                    const __m128 negativeHs = _mm_sub_ps(_mm_setzero_ps(), hs);
+
+                    // a, b, d, c in the order of the vertices
+                    _mm_store_ps(cornerX[0], _mm_add_ps(_mm_add_ps(negativeHc, hs), positionX));
+                    _mm_store_ps(cornerY[0], _mm_add_ps(_mm_sub_ps(negativeHs, hc), positionY));
+                    _mm_store_ps(cornerX[1], _mm_add_ps(_mm_add_ps(hc, hs), positionX));
+                    _mm_store_ps(cornerY[1], _mm_add_ps(_mm_sub_ps(hs, hc), positionY));
+                    _mm_store_ps(cornerX[2], _mm_add_ps(_mm_sub_ps(negativeHc, hs), positionX));
+                    _mm_store_ps(cornerY[2], _mm_add_ps(_mm_add_ps(negativeHs, hc), positionY));
+                    _mm_store_ps(cornerX[3], _mm_add_ps(_mm_sub_ps(hc, hs), positionX));
+                    _mm_store_ps(cornerY[3], _mm_add_ps(_mm_add_ps(hs, hc), positionY));
+                }
+                else
+#endif
+                {
+                    for (std::uint32_t j = 0; j < batchSize; ++j)
+                    {
+                        const auto i = first + j;
+                        const float halfSize = particles.size[i] / 2.0F;
+                        const float hc = halfSize * rotationCosines[i];
+                        const float hs = halfSize * rotationSines[i];
+                        const float positionX = grouped ? 0.0F : offset.v[0] + particles.positionX[i];
+                        const float positionY = grouped ? 0.0F : offset.v[1] + particles.positionY[i];
+
+                        cornerX[0][j] = (-hc + hs) + positionX;
+                        cornerY[0][j] = (-hs - hc) + positionY;
+                        cornerX[1][j] = (hc + hs) + positionX;
+                        cornerY[1][j] = (hs - hc) + positionY;
+                        cornerX[2][j] = (-hc - hs) + positionX;
+                        cornerY[2][j] = (-hs + hc) + positionY;
+                        cornerX[3][j] = (hc - hs) + positionX;
+                        cornerY[3][j] = (hs + hc) + positionY;
+                    }
+                }
+
+                for (std::uint32_t j = 0; j < batchSize; ++j)
+                {
+                    const auto i = first + j;
+
+                    const Color color(static_cast<std::uint8_t>(particles.colorRed[i] * 255),
+                                      static_cast<std::uint8_t>(particles.colorGreen[i] * 255),
+                                      static_cast<std::uint8_t>(particles.colorBlue[i] * 255),
+                                      static_cast<std::uint8_t>(particles.colorAlpha[i] * 255));
+
+                    for (std::uint32_t corner = 0; corner < 4; ++corner)
+                    {
+                        auto& vertex = vertices[i * 4 + corner];
+                        vertex.position = Vector3F{cornerX[corner][j], cornerY[corner][j], 0.0F};
+                        vertex.color = color;
+                    }
+                }
+            }
         }
     }
 
@@ -382,52 +707,48 @@ namespace ouzel::scene
         if (particleCount + count > particleSystemData.maxParticles)
             count = particleSystemData.maxParticles - particleCount;
 
-        if (count && actor)
+        if (count && hasActor)
         {
-            const Vector2F position = (particleSystemData.positionType == ParticleSystemData::PositionType::free) ?
-                Vector2F(actor->convertLocalToWorld(Vector3F())) :
-                (particleSystemData.positionType == ParticleSystemData::PositionType::parent) ?
-                Vector2F(actor->convertLocalToWorld(Vector3F()) - actor->getPosition()) :
-                (particleSystemData.positionType == ParticleSystemData::PositionType::grouped) ?
-                Vector2F() :
-                throw std::runtime_error("Invalid position type");
+            const auto particles = getParticles();
 
             for (std::uint32_t i = particleCount; i < particleCount + count; ++i)
             {
                 if (particleSystemData.emitterType == ParticleSystemData::EmitterType::gravity)
                 {
-                    particles[i].life = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                    particles.life[i] = std::max(particleSystemData.particleLifespan + particleSystemData.particleLifespanVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
 
-                    particles[i].position = particleSystemData.sourcePosition + position + Vector2F(particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine),
-                                                                                                    particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                    const auto particlePosition = particleSystemData.sourcePosition + emitterPosition + Vector2F(particleSystemData.sourcePositionVariance.v[0] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine),
+                                                                                                          particleSystemData.sourcePositionVariance.v[1] * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                    particles.positionX[i] = particlePosition.v[0];
+                    particles.positionY[i] = particlePosition.v[1];
 
-                    particles[i].size = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
+                    particles.size[i] = std::max(particleSystemData.startParticleSize + particleSystemData.startParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
 
                     const float finishSize = std::max(particleSystemData.finishParticleSize + particleSystemData.finishParticleSizeVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F);
-                    particles[i].deltaSize = (finishSize - particles[i].size) / particles[i].life;
+                    particles.deltaSize[i] = (finishSize - particles.size[i]) / particles.life[i];
 
-                    particles[i].colorRed = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                    particles[i].colorGreen = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                    particles[i].colorBlue = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
-                    particles[i].colorAlpha = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    particles.colorRed[i] = std::clamp(particleSystemData.startColorRed + particleSystemData.startColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    particles.colorGreen[i] = std::clamp(particleSystemData.startColorGreen + particleSystemData.startColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    particles.colorBlue[i] = std::clamp(particleSystemData.startColorBlue + particleSystemData.startColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
+                    particles.colorAlpha[i] = std::clamp(particleSystemData.startColorAlpha + particleSystemData.startColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
 
                     const float finishColorRed = std::clamp(particleSystemData.finishColorRed + particleSystemData.finishColorRedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                     const float finishColorGreen = std::clamp(particleSystemData.finishColorGreen + particleSystemData.finishColorGreenVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                     const float finishColorBlue = std::clamp(particleSystemData.finishColorBlue + particleSystemData.finishColorBlueVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
                     const float finishColorAlpha = std::clamp(particleSystemData.finishColorAlpha + particleSystemData.finishColorAlphaVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine), 0.0F, 1.0F);
 
-                    particles[i].deltaColorRed = (finishColorRed - particles[i].colorRed) / particles[i].life;
-                    particles[i].deltaColorGreen = (finishColorGreen - particles[i].colorGreen) / particles[i].life;
-                    particles[i].deltaColorBlue = (finishColorBlue - particles[i].colorBlue) / particles[i].life;
-                    particles[i].deltaColorAlpha = (finishColorAlpha - particles[i].colorAlpha) / particles[i].life;
+                    particles.deltaColorRed[i] = (finishColorRed - particles.colorRed[i]) / particles.life[i];
+                    particles.deltaColorGreen[i] = (finishColorGreen - particles.colorGreen[i]) / particles.life[i];
+                    particles.deltaColorBlue[i] = (finishColorBlue - particles.colorBlue[i]) / particles.life[i];
+                    particles.deltaColorAlpha[i] = (finishColorAlpha - particles.colorAlpha[i]) / particles.life[i];
 
-                    particles[i].rotation = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                    particles.rotation[i] = particleSystemData.startRotation + particleSystemData.startRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
 
                     const float finishRotation = particleSystemData.finishRotation + particleSystemData.finishRotationVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                    particles[i].deltaRotation = (finishRotation - particles[i].rotation) / particles[i].life;
+                    particles.deltaRotation[i] = (finishRotation - particles.rotation[i]) / particles.life[i];
 
-                    particles[i].radialAcceleration = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                    particles[i].tangentialAcceleration = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                    particles.radialAcceleration[i] = particleSystemData.radialAcceleration + particleSystemData.radialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                    particles.tangentialAcceleration[i] = particleSystemData.tangentialAcceleration + particleSystemData.tangentialAcceleration * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
 
                     if (particleSystemData.rotationIsDir)
                     {
@@ -435,8 +756,9 @@ namespace ouzel::scene
                         const Vector2F v(std::cos(a), std::sin(a));
                         const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
                         const auto dir = v * s;
-                        particles[i].direction = dir;
-                        particles[i].rotation = -radToDeg(dir.getAngle());
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
+                        particles.rotation[i] = -radToDeg(dir.getAngle());
                     }
                     else
                     {
@@ -444,17 +766,18 @@ namespace ouzel::scene
                         const Vector2F v(std::cos(a), std::sin(a));
                         const float s = particleSystemData.speed + particleSystemData.speedVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
                         const auto dir = v * s;
-                        particles[i].direction = dir;
+                        particles.directionX[i] = dir.v[0];
+                        particles.directionY[i] = dir.v[1];
                     }
                 }
                 else
                 {
-                    particles[i].radius = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                    particles[i].angle = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
-                    particles[i].degreesPerSecond = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                    particles.radius[i] = particleSystemData.maxRadius + particleSystemData.maxRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
+                    particles.angle[i] = degToRad(particleSystemData.angle + particleSystemData.angleVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
+                    particles.degreesPerSecond[i] = degToRad(particleSystemData.rotatePerSecond + particleSystemData.rotatePerSecondVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine));
 
                     const float endRadius = particleSystemData.minRadius + particleSystemData.minRadiusVariance * std::uniform_real_distribution<float>{-1.0F, 1.0F}(randomEngine);
-                    particles[i].deltaRadius = (endRadius - particles[i].radius) / particles[i].life;
+                    particles.deltaRadius[i] = (endRadius - particles.radius[i]) / particles.life[i];
                 }
             }
 
@@ -3,13 +3,13 @@
 #ifndef OUZEL_SCENE_PARTICLESYSTEM_HPP
 #define OUZEL_SCENE_PARTICLESYSTEM_HPP
 
+#include <random>
 #include <string>
 #include <vector>
 #include <functional>
 #include "Component.hpp"
 #include "../math/Color.hpp"
 #include "../math/Vector.hpp"
-#include "../events/EventHandler.hpp"
 #include "../graphics/Vertex.hpp"
 #include "../graphics/BlendState.hpp"
 #include "../graphics/Buffer.hpp"
@@ -113,11 +113,16 @@ namespace ouzel::scene
         std::shared_ptr<graphics::Texture> texture;
     };
 
+    class ParticleManager;
+
     class ParticleSystem: public Component
     {
+        friend ParticleManager;
     public:
         ParticleSystem();
         explicit ParticleSystem(const ParticleSystemData& initParticleSystemData);
+        explicit ParticleSystem(const std::string& filename);
+        ~ParticleSystem() override;
 
         void draw(const Matrix4F& transformMatrix,
                   float opacity,
@@ -125,6 +130,7 @@ namespace ouzel::scene
                   bool wireframe) override;
 
         void init(const ParticleSystemData& newParticleSystemData);
+        void init(const std::string& filename);
 
         void resume();
         void stop();
@@ -144,7 +150,10 @@ namespace ouzel::scene
         }
 
     private:
-        void update(float delta);
+        // called by the particle manager on the update thread before the systems are simulated
+        void prepareUpdate();
+        // called by the particle manager on any thread, must not touch the actor, the engine or the graphics
+        void simulate(float delta);
 
         void createParticleMesh();
         void updateParticleMesh();
@@ -158,47 +167,67 @@ namespace ouzel::scene
         std::shared_ptr<graphics::Texture> texture;
         std::shared_ptr<graphics::Texture> whitePixelTexture;
 
-        struct Particle final
+        // pointers to the attribute arrays, particles are stored as a structure of arrays,
+        // so that every attribute can be updated for multiple particles at once
+        struct Particles final
         {
-            float life = 0.0F;
+            float* life;
 
-            Vector2F position;
+            float* positionX;
+            float* positionY;
 
-            float colorRed = 0.0F;
-            float colorGreen = 0.0F;
-            float colorBlue = 0.0F;
-            float colorAlpha = 0.0F;
+            float* colorRed;
+            float* colorGreen;
+            float* colorBlue;
+            float* colorAlpha;
 
-            float deltaColorRed = 0.0F;
-            float deltaColorGreen = 0.0F;
-            float deltaColorBlue = 0.0F;
-            float deltaColorAlpha = 0.0F;
+            float* deltaColorRed;
+            float* deltaColorGreen;
+            float* deltaColorBlue;
+            float* deltaColorAlpha;
 
-            float angle = 0.0F;
-            float speed = 0.0F;
+            float* angle;
 
-            float size = 0.0F;
-            float deltaSize = 0.0F;
+            float* size;
+            float* deltaSize;
 
-            float rotation = 0.0F;
-            float deltaRotation = 0.0F;
+            float* rotation;
+            float* deltaRotation;
 
-            float radialAcceleration = 0.0F;
-            float tangentialAcceleration = 0.0F;
+            float* radialAcceleration;
+            float* tangentialAcceleration;
 
-            Vector2F direction;
-            float radius = 0.0F;
-            float degreesPerSecond = 0.0F;
-            float deltaRadius = 0.0F;
+            float* directionX;
+            float* directionY;
+            float* radius;
+            float* degreesPerSecond;
+            float* deltaRadius;
         };
 
-        std::vector<Particle> particles;
+        static constexpr std::size_t attributeCount = sizeof(Particles) / sizeof(float*);
+
+        Particles getParticles() noexcept;
+        void removeParticle(std::uint32_t index) noexcept;
+        void updateGravity(const Particles& particles, std::uint32_t count, float step) noexcept;
+
+        std::vector<float> particleData;
+        std::uint32_t particleCapacity = 0;
 
         std::unique_ptr<graphics::Buffer> indexBuffer;
         std::unique_ptr<graphics::Buffer> vertexBuffer;
 
         std::vector<std::uint16_t> indices;
         std::vector<graphics::Vertex> vertices;
+        std::vector<graphics::InstanceVertex> instances;
+        std::vector<float> rotationCosines;
+        std::vector<float> rotationSines;
+
+        // the instances are drawn instead of the vertices, one per particle instead of the corners of its quad
+        bool instanced = false;
+
+        // the particle system data that the system was created from by name, loaded again when it is hot reloaded
+        std::string sourceName;
+        std::uint32_t reloadCount = 0;
 
         std::uint32_t particleCount = 0;
 
@@ -210,8 +239,16 @@ namespace ouzel::scene
         bool finished = false;
 
         bool needsMeshUpdate = false;
+        bool needsMeshUpload = false;
+
+        // actor data captured by prepareUpdate
+        bool hasActor = false;
+        Vector2F emitterPosition;
+        Vector2F actorPosition;
+        Matrix4F inverseTransform;
 
-        EventHandler updateHandler;
+        ParticleManager* manager = nullptr;
+        std::mt19937 randomEngine;
     };
 }
 
@@ -9,6 +9,7 @@
 #include <queue>
 #include <set>
 #include <vector>
+#include "ParticleManager.hpp"
 
 namespace ouzel::scene
 {
@@ -40,9 +41,13 @@ namespace ouzel::scene
 
         auto getScene() const noexcept { return scenes.empty() ? nullptr : scenes.back(); }
 
+        auto& getParticleManager() noexcept { return particleManager; }
+        auto& getParticleManager() const noexcept { return particleManager; }
+
     private:
         std::vector<Scene*> scenes;
         std::vector<std::unique_ptr<Scene>> ownedScenes;
+        ParticleManager particleManager;
     };
 }
 
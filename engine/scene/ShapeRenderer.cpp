@@ -1,5 +1,7 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include "ShapeRenderer.hpp"
@@ -22,6 +24,52 @@ namespace ouzel::scene
     {
     }
 
+    namespace
+    {
+        // the largest distance in pixels between an adaptive circle and its segments
+        constexpr float maxCircleError = 0.25F;
+        // the length in pixels of a segment of an adaptive curve
+        constexpr float curveSegmentLength = 8.0F;
+        constexpr std::uint32_t minAdaptiveSegments = 8;
+        constexpr std::uint32_t maxAdaptiveSegments = 256;
+
+        // length of a unit of the local space on the screen in pixels
+        float getPixelScale(const Matrix4F& modelViewProj, const Size2U& size) noexcept
+        {
+            const float halfWidth = static_cast<float>(size.v[0]) / 2.0F;
+            const float halfHeight = static_cast<float>(size.v[1]) / 2.0F;
+
+            const float scaleX = std::hypot(modelViewProj.m[0] * halfWidth, modelViewProj.m[1] * halfHeight);
+            const float scaleY = std::hypot(modelViewProj.m[4] * halfWidth, modelViewProj.m[5] * halfHeight);
+
+            return std::max(scaleX, scaleY);
+        }
+
+        std::array<Vector2F, 4> getLineCorners(const Vector2F& start, const Vector2F& finish, float halfThickness)
+        {
+            Vector2F tangent = finish - start;
+            tangent.normalize();
+            const Vector2F normal(-tangent.v[1], tangent.v[0]);
+
+            return {
+                start - tangent * halfThickness - normal * halfThickness,
+                finish + tangent * halfThickness - normal * halfThickness,
+                start - tangent * halfThickness + normal * halfThickness,
+                finish + tangent * halfThickness + normal * halfThickness
+            };
+        }
+
+        std::vector<std::uint32_t> pascalsTriangleRow(std::uint32_t row)
+        {
+            std::vector<std::uint32_t> ret;
+            ret.push_back(1);
+            for (std::uint32_t i = 0; i < row; ++i)
+                ret.push_back(ret[i] * (row - i) / (i + 1));
+
+            return ret;
+        }
+    }
+
     void ShapeRenderer::draw(const Matrix4F& transformMatrix,
                              float opacity,
                              const Matrix4F& renderViewProjection,
@@ -32,43 +80,68 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
+        const auto modelViewProj = renderViewProjection * transformMatrix;
+
+        if (adaptive)
+        {
+            const float pixelScale = getPixelScale(modelViewProj, engine->getGraphics()->getSize());
+
+            for (Shape& shape : shapes)
+                if (!shape.segments)
+                {
+                    const auto segmentCount = getSegmentCount(shape, pixelScale);
+
+                    if (shape.tessellatedSegments != segmentCount)
+                    {
+                        shape.tessellatedSegments = segmentCount;
+                        dirty = true;
+                    }
+                }
+        }
+
         if (dirty)
         {
+            tessellate();
+
             if (!indices.empty()) indexBuffer.setData(indices.data(), static_cast<std::uint32_t>(getVectorSize(indices)));
             if (!vertices.empty()) vertexBuffer.setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
             dirty = false;
         }
 
-        const auto modelViewProj = renderViewProjection * transformMatrix;
+        if (drawCommands.empty()) return;
+
         const float colorVector[] = {1.0F, 1.0F, 1.0F, opacity};
 
+        std::vector<std::vector<float>> fragmentShaderConstants(1);
+        fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
+
+        std::vector<std::vector<float>> vertexShaderConstants(1);
+        vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
+
+        engine->getGraphics()->setPipelineState(blendState->getResource(),
+                                                shader->getResource(),
+                                                graphics::CullMode::none,
+                                                wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
+        engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
+                                                  vertexShaderConstants);
+
         for (const DrawCommand& drawCommand : drawCommands)
-        {
-            std::vector<std::vector<float>> fragmentShaderConstants(1);
-            fragmentShaderConstants[0] = {std::begin(colorVector), std::end(colorVector)};
-
-            std::vector<std::vector<float>> vertexShaderConstants(1);
-            vertexShaderConstants[0] = {std::begin(modelViewProj.m), std::end(modelViewProj.m)};
-
-            engine->getGraphics()->setPipelineState(blendState->getResource(),
-                                                    shader->getResource(),
-                                                    graphics::CullMode::none,
-                                                    wireframe ? graphics::FillMode::wireframe : graphics::FillMode::solid);
-            engine->getGraphics()->setShaderConstants(fragmentShaderConstants,
-                                                      vertexShaderConstants);
             engine->getGraphics()->draw(indexBuffer.getResource(),
                                         drawCommand.indexCount,
                                         sizeof(std::uint16_t),
                                         vertexBuffer.getResource(),
                                         drawCommand.mode,
                                         drawCommand.startIndex);
-        }
     }
 
     void ShapeRenderer::clear()
     {
         boundingBox.reset();
 
+        shapes.clear();
+        points.clear();
+        adaptive = false;
+
         drawCommands.clear();
         indices.clear();
         vertices.clear();
@@ -80,63 +153,22 @@ namespace ouzel::scene
     {
         assert(thickness >= 0.0F);
 
-        DrawCommand command;
-        command.startIndex = static_cast<std::uint32_t>(indices.size());
-
-        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
+        Shape shape;
+        shape.type = Shape::Type::line;
+        shape.color = color;
+        shape.thickness = thickness;
+        addShape(shape, {start, finish});
 
         if (thickness == 0.0F)
         {
-            command.mode = graphics::DrawMode::lineList;
-
-            vertices.emplace_back(Vector3F(start), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F(finish), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-            command.indexCount = 2;
-
-            indices.push_back(startVertex + 0);
-            indices.push_back(startVertex + 1);
-
             boundingBox.insertPoint(Vector3F(start));
             boundingBox.insertPoint(Vector3F(finish));
         }
         else
         {
-            command.mode = graphics::DrawMode::triangleList;
-
-            Vector2F tangent = finish - start;
-            tangent.normalize();
-            const Vector2F normal(-tangent.v[1], tangent.v[0]);
-
-            const float halfThickness = thickness / 2.0F;
-
-            vertices.emplace_back(Vector3F{start - tangent * halfThickness - normal * halfThickness},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{finish + tangent * halfThickness - normal * halfThickness},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{start - tangent * halfThickness + normal * halfThickness},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{finish + tangent * halfThickness + normal * halfThickness},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-            command.indexCount = 6;
-
-            indices.push_back(startVertex + 0);
-            indices.push_back(startVertex + 1);
-            indices.push_back(startVertex + 2);
-            indices.push_back(startVertex + 1);
-            indices.push_back(startVertex + 3);
-            indices.push_back(startVertex + 2);
-
-            boundingBox.insertPoint(vertices[startVertex + 0].position);
-            boundingBox.insertPoint(vertices[startVertex + 1].position);
-            boundingBox.insertPoint(vertices[startVertex + 2].position);
-            boundingBox.insertPoint(vertices[startVertex + 3].position);
+            for (const Vector2F& corner : getLineCorners(start, finish, thickness / 2.0F))
+                boundingBox.insertPoint(Vector3F(corner));
         }
-
-        drawCommands.push_back(command);
-
-        dirty = true;
     }
 
     void ShapeRenderer::circle(const Vector2F& position,
@@ -147,391 +179,494 @@ namespace ouzel::scene
                                float thickness)
     {
         assert(radius >= 0.0F);
-        assert(segments >= 3);
+        assert(segments == 0 || segments >= 3);
         assert(thickness >= 0.0F);
 
-        DrawCommand command;
-        command.startIndex = static_cast<std::uint32_t>(indices.size());
-
-        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
+        Shape shape;
+        shape.type = Shape::Type::circle;
+        shape.color = color;
+        shape.fill = fill;
+        shape.thickness = thickness;
+        shape.radius = radius;
+        shape.segments = segments;
+        addShape(shape, {position});
+
+        const float extent = (fill || thickness == 0.0F) ? radius : radius + thickness / 2.0F;
+        boundingBox.insertPoint(Vector3F(position - Vector2F{extent, extent}));
+        boundingBox.insertPoint(Vector3F(position + Vector2F{extent, extent}));
+    }
 
-        if (fill)
-        {
-            command.mode = graphics::DrawMode::triangleStrip;
+    void ShapeRenderer::rectangle(const RectF& rectangle,
+                                  Color color,
+                                  bool fill,
+                                  float thickness)
+    {
+        assert(thickness >= 0.0F);
 
-            vertices.emplace_back(Vector3F(position), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F}); // center
+        Shape shape;
+        shape.type = Shape::Type::rectangle;
+        shape.color = color;
+        shape.fill = fill;
+        shape.thickness = thickness;
+        addShape(shape, {rectangle.bottomLeft(), rectangle.topRight()});
 
-            for (std::uint32_t i = 0; i <= segments; ++i)
-                vertices.emplace_back(Vector3F{position.v[0] + radius * std::cos(i * tau<float> / static_cast<float>(segments)), position.v[1] + radius * std::sin(i * tau<float> / static_cast<float>(segments)), 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+        const float halfThickness = fill ? 0.0F : thickness / 2.0F;
+        boundingBox.insertPoint(Vector3F(rectangle.bottomLeft() - Vector2F(halfThickness, halfThickness)));
+        boundingBox.insertPoint(Vector3F(rectangle.topRight() + Vector2F(halfThickness, halfThickness)));
+    }
 
-            command.indexCount = segments * 2 + 1;
+    void ShapeRenderer::polygon(const std::vector<Vector2F>& edges,
+                                Color color,
+                                bool fill,
+                                float thickness)
+    {
+        assert(edges.size() >= 3);
+        assert(thickness >= 0.0F);
 
-            for (std::uint16_t i = 0; i < segments; ++i)
-            {
-                indices.push_back(startVertex + i + 1);
-                indices.push_back(startVertex); // center
-            }
+        Shape shape;
+        shape.type = Shape::Type::polygon;
+        shape.color = color;
+        shape.fill = fill;
+        shape.thickness = thickness;
+        addShape(shape, edges);
 
-            indices.push_back(startVertex + 1);
+        for (const Vector2F& edge : edges)
+            boundingBox.insertPoint(Vector3F(edge));
+    }
 
-            boundingBox.insertPoint(Vector3F(position - Vector2F{radius, radius}));
-            boundingBox.insertPoint(Vector3F(position + Vector2F{radius, radius}));
-        }
-        else
-        {
-            if (thickness == 0.0F)
-            {
-                command.mode = graphics::DrawMode::lineStrip;
+    void ShapeRenderer::curve(const std::vector<Vector2F>& controlPoints,
+                              Color color,
+                              std::uint32_t segments,
+                              float thickness)
+    {
+        assert(controlPoints.size() >= 2);
+        assert(segments == 0 || segments >= 2);
+        assert(thickness >= 0.0F);
 
-                for (std::uint32_t i = 0; i <= segments; ++i)
-                {
-                    vertices.emplace_back(Vector3F{position.v[0] + radius * std::cos(i * tau<float> / static_cast<float>(segments)), position.v[1] + radius * std::sin(i * tau<float> / static_cast<float>(segments)), 0.0F},
-                                          color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                }
+        Shape shape;
+        shape.type = Shape::Type::curve;
+        shape.color = color;
+        shape.thickness = thickness;
+        shape.segments = segments;
+        addShape(shape, controlPoints);
 
-                command.indexCount = segments + 1;
+        // the curve lies inside the convex hull of its control points
+        for (const Vector2F& controlPoint : controlPoints)
+            boundingBox.insertPoint(Vector3F(controlPoint));
+    }
 
-                for (std::uint16_t i = 0; i < segments; ++i)
-                    indices.push_back(startVertex + i);
+    void ShapeRenderer::addShape(const Shape& shape, const std::vector<Vector2F>& shapePoints)
+    {
+        shapes.push_back(shape);
+        Shape& newShape = shapes.back();
+        newShape.firstPoint = points.size();
+        newShape.pointCount = shapePoints.size();
+        newShape.tessellatedSegments = shape.segments;
+        points.insert(points.end(), shapePoints.begin(), shapePoints.end());
 
-                indices.push_back(startVertex);
+        // the adaptive shapes are tessellated when their size on the screen is known
+        if ((shape.type == Shape::Type::circle || shape.type == Shape::Type::curve) && !shape.segments)
+            adaptive = true;
 
-                boundingBox.insertPoint(Vector3F(position - Vector2F{radius, radius}));
-                boundingBox.insertPoint(Vector3F(position + Vector2F{radius, radius}));
-            }
-            else
-            {
-                command.mode = graphics::DrawMode::triangleStrip;
+        dirty = true;
+    }
 
-                const float halfThickness = thickness / 2.0F;
+    std::uint32_t ShapeRenderer::getSegmentCount(const Shape& shape, float pixelScale) const
+    {
+        float segmentCount = 0.0F;
 
-                for (std::uint32_t i = 0; i <= segments; ++i)
-                {
-                    vertices.emplace_back(Vector3F{position.v[0] + (radius - halfThickness) * std::cos(i * tau<float> / static_cast<float>(segments)), position.v[1] + (radius - halfThickness) * std::sin(i * tau<float> / static_cast<float>(segments)), 0.0F},
-                                          color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+        if (shape.type == Shape::Type::circle)
+        {
+            const float pixelRadius = (shape.radius + shape.thickness / 2.0F) * pixelScale;
 
-                    vertices.emplace_back(Vector3F{position.v[0] + (radius + halfThickness) * std::cos(i * tau<float> / static_cast<float>(segments)), position.v[1] + (radius + halfThickness) * std::sin(i * tau<float> / static_cast<float>(segments)), 0.0F},
-                                          color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                }
+            if (pixelRadius > maxCircleError)
+                segmentCount = pi<float> / std::acos(1.0F - maxCircleError / pixelRadius);
+        }
+        else if (shape.type == Shape::Type::curve)
+        {
+            float length = 0.0F;
+            for (std::size_t i = shape.firstPoint + 1; i < shape.firstPoint + shape.pointCount; ++i)
+                length += Vector2F(points[i] - points[i - 1]).length();
 
-                for (const graphics::Vertex& vertex : vertices)
-                    boundingBox.insertPoint(vertex.position);
+            segmentCount = length * pixelScale / curveSegmentLength;
+        }
 
-                command.indexCount = segments * 6;
+        // powers of two, so that the shapes are not tessellated again on every small change of the scale
+        std::uint32_t result = minAdaptiveSegments;
+        while (static_cast<float>(result) < segmentCount && result < maxAdaptiveSegments)
+            result *= 2;
 
-                for (std::uint16_t i = 0; i < segments; ++i)
-                {
-                    if (i < segments - 1)
-                    {
-                        indices.push_back(startVertex + i * 2 + 0);
-                        indices.push_back(startVertex + i * 2 + 1);
-                        indices.push_back(startVertex + i * 2 + 3);
+        return result;
+    }
 
-                        indices.push_back(startVertex + i * 2 + 3);
-                        indices.push_back(startVertex + i * 2 + 2);
-                        indices.push_back(startVertex + i * 2 + 0);
-                    }
-                    else
-                    {
-                        indices.push_back(startVertex + i * 2 + 0);
-                        indices.push_back(startVertex + i * 2 + 1);
-                        indices.push_back(startVertex + 1);
+    void ShapeRenderer::tessellate()
+    {
+        drawCommands.clear();
+        indices.clear();
+        vertices.clear();
 
-                        indices.push_back(startVertex + 1);
-                        indices.push_back(startVertex + 0);
-                        indices.push_back(startVertex + i * 2 + 0);
-                    }
-                }
+        for (const Shape& shape : shapes)
+        {
+            switch (shape.type)
+            {
+                case Shape::Type::line: tessellateLine(shape); break;
+                case Shape::Type::circle: tessellateCircle(shape); break;
+                case Shape::Type::rectangle: tessellateRectangle(shape); break;
+                case Shape::Type::polygon: tessellatePolygon(shape); break;
+                case Shape::Type::curve: tessellateCurve(shape); break;
             }
         }
-
-        drawCommands.push_back(command);
-
-        dirty = true;
     }
 
-    void ShapeRenderer::rectangle(const RectF& rectangle,
-                                  Color color,
-                                  bool fill,
-                                  float thickness)
+    void ShapeRenderer::addDrawCommand(graphics::DrawMode mode, std::uint32_t startIndex)
     {
-        assert(thickness >= 0.0F);
-
-        DrawCommand command;
-        command.startIndex = static_cast<std::uint32_t>(indices.size());
+        const auto indexCount = static_cast<std::uint32_t>(indices.size()) - startIndex;
+        if (!indexCount) return;
+
+        // all the shapes are lists of lines or triangles, so the neighbours of the same type can be merged
+        if (!drawCommands.empty() &&
+            drawCommands.back().mode == mode &&
+            drawCommands.back().startIndex + drawCommands.back().indexCount == startIndex)
+            drawCommands.back().indexCount += indexCount;
+        else
+            drawCommands.push_back(DrawCommand{mode, indexCount, startIndex});
+    }
 
+    void ShapeRenderer::tessellateLine(const Shape& shape)
+    {
+        const auto startIndex = static_cast<std::uint32_t>(indices.size());
         const auto startVertex = static_cast<std::uint16_t>(vertices.size());
 
-        if (fill)
+        const Vector2F& start = points[shape.firstPoint];
+        const Vector2F& finish = points[shape.firstPoint + 1];
+
+        if (shape.thickness == 0.0F)
         {
-            command.mode = graphics::DrawMode::triangleList;
+            vertices.emplace_back(Vector3F(start), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F(finish), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-            vertices.emplace_back(Vector3F{rectangle.left(), rectangle.bottom(), 0.0F},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{rectangle.right(), rectangle.bottom(), 0.0F},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{rectangle.right(), rectangle.top(), 0.0F},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-            vertices.emplace_back(Vector3F{rectangle.left(), rectangle.top(), 0.0F},
-                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            indices.push_back(startVertex + 0);
+            indices.push_back(startVertex + 1);
 
-            command.indexCount = 6;
+            addDrawCommand(graphics::DrawMode::lineList, startIndex);
+        }
+        else
+        {
+            for (const Vector2F& corner : getLineCorners(start, finish, shape.thickness / 2.0F))
+                vertices.emplace_back(Vector3F(corner), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
             indices.push_back(startVertex + 0);
             indices.push_back(startVertex + 1);
-            indices.push_back(startVertex + 3);
-            indices.push_back(startVertex + 1);
             indices.push_back(startVertex + 2);
+            indices.push_back(startVertex + 1);
             indices.push_back(startVertex + 3);
+            indices.push_back(startVertex + 2);
 
-            boundingBox.insertPoint(Vector3F(rectangle.bottomLeft()));
-            boundingBox.insertPoint(Vector3F(rectangle.topRight()));
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
         }
-        else
-        {
-            if (thickness == 0.0F)
-            {
-                command.mode = graphics::DrawMode::lineStrip;
+    }
 
-                // left bottom
-                vertices.emplace_back(Vector3F(rectangle.left(), rectangle.bottom(), 0.0F),
-                                      color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
+    void ShapeRenderer::tessellateCircle(const Shape& shape)
+    {
+        const auto startIndex = static_cast<std::uint32_t>(indices.size());
+        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
 
-                // right bottom
-                vertices.emplace_back(Vector3F(rectangle.right(), rectangle.bottom(), 0.0F),
-                                      color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
+        const Vector2F& position = points[shape.firstPoint];
+        const float radius = shape.radius;
+        const std::uint32_t segments = shape.tessellatedSegments;
+        const std::vector<Vector2F>& unitCircle = getUnitCircle(segments);
 
-                // right top
-                vertices.emplace_back(Vector3F(rectangle.right(), rectangle.top(), 0.0F),
-                                      color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
+        if (shape.fill)
+        {
+            vertices.emplace_back(Vector3F(position), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F}); // center
 
-                // left top
-                vertices.emplace_back(Vector3F(rectangle.left(), rectangle.top(), 0.0F),
-                                      color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
+            for (const Vector2F& point : unitCircle)
+                vertices.emplace_back(Vector3F(position + point * radius),
+                                      shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                command.indexCount = 5;
+            for (std::uint16_t i = 0; i < segments; ++i)
+            {
+                indices.push_back(startVertex + i + 1);
+                indices.push_back(startVertex); // center
+                indices.push_back(startVertex + i + 2);
+            }
 
-                indices.push_back(startVertex + 0);
-                indices.push_back(startVertex + 1);
-                indices.push_back(startVertex + 2);
-                indices.push_back(startVertex + 3);
-                indices.push_back(startVertex + 0);
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
+        }
+        else if (shape.thickness == 0.0F)
+        {
+            for (const Vector2F& point : unitCircle)
+                vertices.emplace_back(Vector3F(position + point * radius),
+                                      shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                boundingBox.insertPoint(Vector3F(rectangle.bottomLeft()));
-                boundingBox.insertPoint(Vector3F(rectangle.topRight()));
-            }
-            else
+            for (std::uint16_t i = 0; i < segments; ++i)
             {
-                command.mode = graphics::DrawMode::triangleList;
-
-                const float halfThickness = thickness / 2.0F;
-
-                // left bottom
-                vertices.emplace_back(Vector3F{rectangle.left() - halfThickness, rectangle.bottom() - halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{rectangle.left() + halfThickness, rectangle.bottom() + halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-                // right bottom
-                vertices.emplace_back(Vector3F{rectangle.right() + halfThickness, rectangle.bottom() - halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{rectangle.right() - halfThickness, rectangle.bottom() + halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-                // right top
-                vertices.emplace_back(Vector3F{rectangle.right() + halfThickness, rectangle.top() + halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{rectangle.right() - halfThickness, rectangle.top() - halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-                // left top
-                vertices.emplace_back(Vector3F{rectangle.left() - halfThickness, rectangle.top() + halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                vertices.emplace_back(Vector3F{rectangle.left() + halfThickness, rectangle.top() - halfThickness, 0.0F},
-                                      color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-
-                command.indexCount = 24;
-                // bottom
-                indices.push_back(startVertex + 0);
-                indices.push_back(startVertex + 2);
-                indices.push_back(startVertex + 1);
-
-                indices.push_back(startVertex + 2);
-                indices.push_back(startVertex + 3);
-                indices.push_back(startVertex + 1);
-
-                // right
-                indices.push_back(startVertex + 2);
-                indices.push_back(startVertex + 4);
-                indices.push_back(startVertex + 3);
-
-                indices.push_back(startVertex + 4);
-                indices.push_back(startVertex + 5);
-                indices.push_back(startVertex + 3);
-
-                // top
-                indices.push_back(startVertex + 4);
-                indices.push_back(startVertex + 6);
-                indices.push_back(startVertex + 5);
-
-                indices.push_back(startVertex + 6);
-                indices.push_back(startVertex + 7);
-                indices.push_back(startVertex + 5);
-
-                // left
-                indices.push_back(startVertex + 6);
-                indices.push_back(startVertex + 0);
-                indices.push_back(startVertex + 7);
-
-                indices.push_back(startVertex + 0);
-                indices.push_back(startVertex + 1);
-                indices.push_back(startVertex + 7);
-
-                boundingBox.insertPoint(Vector3F(rectangle.bottomLeft() - Vector2F(halfThickness, halfThickness)));
-                boundingBox.insertPoint(Vector3F(rectangle.topRight() + Vector2F(halfThickness, halfThickness)));
+                indices.push_back(startVertex + i);
+                indices.push_back(startVertex + i + 1);
             }
+
+            addDrawCommand(graphics::DrawMode::lineList, startIndex);
         }
+        else
+        {
+            const float halfThickness = shape.thickness / 2.0F;
+
+            for (const Vector2F& point : unitCircle)
+            {
+                vertices.emplace_back(Vector3F(position + point * (radius - halfThickness)),
+                                      shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-        drawCommands.push_back(command);
+                vertices.emplace_back(Vector3F(position + point * (radius + halfThickness)),
+                                      shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            }
 
-        dirty = true;
+            for (std::uint16_t i = 0; i < segments; ++i)
+            {
+                indices.push_back(startVertex + i * 2 + 0);
+                indices.push_back(startVertex + i * 2 + 1);
+                indices.push_back(startVertex + i * 2 + 3);
+
+                indices.push_back(startVertex + i * 2 + 3);
+                indices.push_back(startVertex + i * 2 + 2);
+                indices.push_back(startVertex + i * 2 + 0);
+            }
+
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
+        }
     }
 
-    void ShapeRenderer::polygon(const std::vector<Vector2F>& edges,
-                                Color color,
-                                bool fill,
-                                float thickness)
+    void ShapeRenderer::tessellateRectangle(const Shape& shape)
     {
-        assert(edges.size() >= 3);
-        assert(thickness >= 0.0F);
+        const auto startIndex = static_cast<std::uint32_t>(indices.size());
+        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
 
-        DrawCommand command;
-        command.startIndex = static_cast<std::uint32_t>(indices.size());
+        const float left = points[shape.firstPoint].v[0];
+        const float bottom = points[shape.firstPoint].v[1];
+        const float right = points[shape.firstPoint + 1].v[0];
+        const float top = points[shape.firstPoint + 1].v[1];
+        const Color color = shape.color;
 
-        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
+        if (shape.fill)
+        {
+            vertices.emplace_back(Vector3F{left, bottom, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{right, bottom, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{right, top, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{left, top, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+
+            indices.push_back(startVertex + 0);
+            indices.push_back(startVertex + 1);
+            indices.push_back(startVertex + 3);
+            indices.push_back(startVertex + 1);
+            indices.push_back(startVertex + 2);
+            indices.push_back(startVertex + 3);
 
-        if (fill)
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
+        }
+        else if (shape.thickness == 0.0F)
         {
-            command.mode = graphics::DrawMode::triangleList;
+            // left bottom
+            vertices.emplace_back(Vector3F(left, bottom, 0.0F),
+                                  color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
+
+            // right bottom
+            vertices.emplace_back(Vector3F(right, bottom, 0.0F),
+                                  color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
 
-            for (std::uint16_t i = 0; i < edges.size(); ++i)
-                vertices.emplace_back(Vector3F(edges[i]), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            // right top
+            vertices.emplace_back(Vector3F(right, top, 0.0F),
+                                  color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
 
-            command.indexCount = static_cast<std::uint32_t>(edges.size() - 2) * 3;
+            // left top
+            vertices.emplace_back(Vector3F(left, top, 0.0F),
+                                  color, Vector2F(), Vector3F(0.0F, 0.0F, -1.0F));
 
-            for (std::uint16_t i = 1; i < edges.size() - 1; ++i)
+            for (std::uint16_t i = 0; i < 4; ++i)
             {
-                indices.push_back(startVertex);
                 indices.push_back(startVertex + i);
-                indices.push_back(startVertex + i + 1);
+                indices.push_back(startVertex + (i + 1) % 4);
             }
 
-            for (std::uint16_t i = 0; i < edges.size(); ++i)
-                boundingBox.insertPoint(Vector3F(edges[i]));
+            addDrawCommand(graphics::DrawMode::lineList, startIndex);
         }
         else
         {
-            if (thickness == 0.0F)
-            {
-                command.mode = graphics::DrawMode::lineStrip;
+            const float halfThickness = shape.thickness / 2.0F;
 
-                for (std::uint16_t i = 0; i < edges.size(); ++i)
-                    vertices.emplace_back(Vector3F(edges[i]), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            // left bottom
+            vertices.emplace_back(Vector3F{left - halfThickness, bottom - halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{left + halfThickness, bottom + halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                command.indexCount = static_cast<std::uint32_t>(edges.size()) + 1;
+            // right bottom
+            vertices.emplace_back(Vector3F{right + halfThickness, bottom - halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{right - halfThickness, bottom + halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                for (std::uint16_t i = 0; i < edges.size(); ++i)
-                    indices.push_back(startVertex + i);
+            // right top
+            vertices.emplace_back(Vector3F{right + halfThickness, top + halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{right - halfThickness, top - halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                indices.push_back(startVertex);
+            // left top
+            vertices.emplace_back(Vector3F{left - halfThickness, top + halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+            vertices.emplace_back(Vector3F{left + halfThickness, top - halfThickness, 0.0F},
+                                  color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-                for (std::uint16_t i = 0; i < edges.size(); ++i)
-                    boundingBox.insertPoint(Vector3F(edges[i]));
-            }
-            else
+            // bottom, right, top and left side
+            for (std::uint16_t side = 0; side < 4; ++side)
             {
-                // TODO: implement
-            }
-        }
+                const auto outer = static_cast<std::uint16_t>(startVertex + side * 2);
+                const auto nextOuter = static_cast<std::uint16_t>(startVertex + (side * 2 + 2) % 8);
 
-        drawCommands.push_back(command);
+                indices.push_back(outer);
+                indices.push_back(nextOuter);
+                indices.push_back(outer + 1);
 
-        dirty = true;
+                indices.push_back(nextOuter);
+                indices.push_back(nextOuter + 1);
+                indices.push_back(outer + 1);
+            }
+
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
+        }
     }
 
-    namespace
+    void ShapeRenderer::tessellatePolygon(const Shape& shape)
     {
-        std::vector<std::uint32_t> pascalsTriangleRow(std::uint32_t row)
+        const auto startIndex = static_cast<std::uint32_t>(indices.size());
+        const auto startVertex = static_cast<std::uint16_t>(vertices.size());
+        const auto edgeCount = static_cast<std::uint16_t>(shape.pointCount);
+
+        if (shape.fill)
         {
-            std::vector<std::uint32_t> ret;
-            ret.push_back(1);
-            for (std::uint32_t i = 0; i < row; ++i)
-                ret.push_back(ret[i] * (row - i) / (i + 1));
+            for (std::uint16_t i = 0; i < edgeCount; ++i)
+                vertices.emplace_back(Vector3F(points[shape.firstPoint + i]), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-            return ret;
+            for (std::uint16_t i = 1; i < edgeCount - 1; ++i)
+            {
+                indices.push_back(startVertex);
+                indices.push_back(startVertex + i);
+                indices.push_back(startVertex + i + 1);
+            }
+
+            addDrawCommand(graphics::DrawMode::triangleList, startIndex);
         }
-    }
+        else if (shape.thickness == 0.0F)
+        {
+            for (std::uint16_t i = 0; i < edgeCount; ++i)
+                vertices.emplace_back(Vector3F(points[shape.firstPoint + i]), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
 
-    void ShapeRenderer::curve(const std::vector<Vector2F>& controlPoints,
-                              Color color,
-                              std::uint32_t segments,
-                              float thickness)
-    {
-        assert(controlPoints.size() >= 2);
-        assert(thickness >= 0.0F);
+            for (std::uint16_t i = 0; i < edgeCount; ++i)
+            {
+                indices.push_back(startVertex + i);
+                indices.push_back(startVertex + (i + 1) % edgeCount);
+            }
 
-        DrawCommand command;
-        command.startIndex = static_cast<std::uint32_t>(indices.size());
+            addDrawCommand(graphics::DrawMode::lineList, startIndex);
+        }
+        else
+        {
+            // TODO: implement
+        }
+    }
 
+    void ShapeRenderer::tessellateCurve(const Shape& shape)
+    {
+        const auto startIndex = static_cast<std::uint32_t>(indices.size());
         const auto startVertex = static_cast<std::uint16_t>(vertices.size());
 
-        if (thickness == 0.0F)
+        if (shape.thickness == 0.0F)
         {
-            command.mode = graphics::DrawMode::lineStrip;
-            command.indexCount = 0;
+            std::uint32_t pointCount = 2;
 
-            if (controlPoints.size() == 2)
+            if (shape.pointCount == 2)
             {
-                for (std::uint16_t i = 0; i < controlPoints.size(); ++i)
-                {
-                    indices.push_back(startVertex + static_cast<std::uint16_t>(command.indexCount));
-                    ++command.indexCount;
-                    vertices.emplace_back(Vector3F(controlPoints[i]), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
-                    boundingBox.insertPoint(Vector3F(controlPoints[i]));
-                }
+                for (std::size_t i = 0; i < shape.pointCount; ++i)
+                    vertices.emplace_back(Vector3F(points[shape.firstPoint + i]), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
             }
             else
             {
-                const std::vector<std::uint32_t> binomialCoefficients = pascalsTriangleRow(static_cast<std::uint32_t>(controlPoints.size() - 1));
+                pointCount = shape.tessellatedSegments;
+                const std::vector<float>& weights = getCurveWeights(shape.pointCount, pointCount);
 
-                for (std::uint32_t segment = 0; segment < segments; ++segment)
+                for (std::uint32_t segment = 0; segment < pointCount; ++segment)
                 {
-                    auto t = static_cast<float>(segment) / static_cast<float>(segments - 1);
                     Vector2F position;
 
-                    for (std::uint16_t n = 0; n < controlPoints.size(); ++n)
-                        position += static_cast<float>(binomialCoefficients[n]) *
-                            powf(t, static_cast<float>(n)) *
-                            powf(1.0F - t, static_cast<float>(controlPoints.size() - n - 1)) *
-                            controlPoints[n];
-
-                    graphics::Vertex vertex(Vector3F(position), color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
+                    for (std::size_t n = 0; n < shape.pointCount; ++n)
+                        position += weights[segment * shape.pointCount + n] * points[shape.firstPoint + n];
 
-                    indices.push_back(startVertex + static_cast<std::uint16_t>(command.indexCount));
-                    ++command.indexCount;
-                    vertices.push_back(vertex);
-                    boundingBox.insertPoint(vertex.position);
+                    vertices.emplace_back(Vector3F(position), shape.color, Vector2F(), Vector3F{0.0F, 0.0F, -1.0F});
                 }
             }
+
+            for (std::uint32_t i = 0; i + 1 < pointCount; ++i)
+            {
+                indices.push_back(static_cast<std::uint16_t>(startVertex + i));
+                indices.push_back(static_cast<std::uint16_t>(startVertex + i + 1));
+            }
+
+            addDrawCommand(graphics::DrawMode::lineList, startIndex);
         }
         else
         {
             // TODO: implement
         }
+    }
+
+    const std::vector<Vector2F>& ShapeRenderer::getUnitCircle(std::uint32_t segments)
+    {
+        auto i = unitCircles.find(segments);
+
+        if (i == unitCircles.end())
+        {
+            std::vector<Vector2F> unitCircle;
+            unitCircle.reserve(segments + 1);
+
+            // the last point is the same as the first one
+            for (std::uint32_t segment = 0; segment <= segments; ++segment)
+                unitCircle.emplace_back(std::cos(segment * tau<float> / static_cast<float>(segments)),
+                                        std::sin(segment * tau<float> / static_cast<float>(segments)));
+
+            i = unitCircles.emplace(segments, std::move(unitCircle)).first;
+        }
 
-        drawCommands.push_back(command);
+        return i->second;
+    }
 
-        dirty = true;
+    const std::vector<float>& ShapeRenderer::getCurveWeights(std::size_t controlPointCount, std::uint32_t segments)
+    {
+        const auto key = std::make_pair(controlPointCount, segments);
+        auto i = curveWeights.find(key);
+
+        if (i == curveWeights.end())
+        {
+            const std::vector<std::uint32_t> binomialCoefficients = pascalsTriangleRow(static_cast<std::uint32_t>(controlPointCount - 1));
+
+            std::vector<float> weights;
+            weights.reserve(segments * controlPointCount);
+
+            for (std::uint32_t segment = 0; segment < segments; ++segment)
+            {
+                const auto t = static_cast<float>(segment) / static_cast<float>(segments - 1);
+
+                for (std::size_t n = 0; n < controlPointCount; ++n)
+                    weights.push_back(static_cast<float>(binomialCoefficients[n]) *
+                                      std::pow(t, static_cast<float>(n)) *
+                                      std::pow(1.0F - t, static_cast<float>(controlPointCount - n - 1)));
+            }
+
+            i = curveWeights.emplace(key, std::move(weights)).first;
+        }
+
+        return i->second;
     }
 }
@@ -3,6 +3,8 @@
 #ifndef OUZEL_SCENE_SHAPERENDERER_HPP
 #define OUZEL_SCENE_SHAPERENDERER_HPP
 
+#include <map>
+#include <unordered_map>
 #include <vector>
 #include "Component.hpp"
 #include "../graphics/Graphics.hpp"
@@ -30,6 +32,7 @@ namespace ouzel::scene
                   Color color,
                   float thickness = 0.0F);
 
+        // segments of 0 picks the segment count from the size of the circle or the curve on the screen
         void circle(const Vector2F& position,
                     float radius,
                     Color color,
@@ -65,6 +68,30 @@ namespace ouzel::scene
         }
 
     private:
+        // the shapes are tessellated when they are drawn and only again when they change,
+        // or the segment count of an adaptive shape changes
+        struct Shape final
+        {
+            enum class Type
+            {
+                line,
+                circle,
+                rectangle,
+                polygon,
+                curve
+            };
+
+            Type type;
+            Color color;
+            bool fill = false;
+            float thickness = 0.0F;
+            float radius = 0.0F;
+            std::uint32_t segments = 0;
+            std::uint32_t tessellatedSegments = 0;
+            std::size_t firstPoint = 0;
+            std::size_t pointCount = 0;
+        };
+
         struct DrawCommand final
         {
             graphics::DrawMode mode;
@@ -72,16 +99,39 @@ namespace ouzel::scene
             std::uint32_t startIndex;
         };
 
+        void addShape(const Shape& shape, const std::vector<Vector2F>& shapePoints);
+        std::uint32_t getSegmentCount(const Shape& shape, float pixelScale) const;
+
+        void tessellate();
+        void tessellateLine(const Shape& shape);
+        void tessellateCircle(const Shape& shape);
+        void tessellateRectangle(const Shape& shape);
+        void tessellatePolygon(const Shape& shape);
+        void tessellateCurve(const Shape& shape);
+        void addDrawCommand(graphics::DrawMode mode, std::uint32_t startIndex);
+
+        const std::vector<Vector2F>& getUnitCircle(std::uint32_t segments);
+        const std::vector<float>& getCurveWeights(std::size_t controlPointCount, std::uint32_t segments);
+
         const graphics::Shader* shader = nullptr;
         const graphics::BlendState* blendState = nullptr;
         graphics::Buffer indexBuffer;
         graphics::Buffer vertexBuffer;
 
+        std::vector<Shape> shapes;
+        std::vector<Vector2F> points;
+        bool adaptive = false;
+
+        // consecutive shapes of the same primitive type are drawn with one draw call
         std::vector<DrawCommand> drawCommands;
 
         std::vector<std::uint16_t> indices;
         std::vector<graphics::Vertex> vertices;
         bool dirty = false;
+
+        // points on the unit circle and Bernstein polynomials of the curves for the used segment counts
+        std::unordered_map<std::uint32_t, std::vector<Vector2F>> unitCircles;
+        std::map<std::pair<std::size_t, std::uint32_t>, std::vector<float>> curveWeights;
     };
 }
 
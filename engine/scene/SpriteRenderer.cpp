@@ -1,5 +1,6 @@
 // Copyright 2015-2020 Elviss Strazdins. All rights reserved.
 
+#include <iterator>
 #include "SpriteRenderer.hpp"
 #include "Camera.hpp"
 #include "SceneManager.hpp"
@@ -168,6 +169,8 @@ namespace ouzel::scene
 
     void SpriteRenderer::init(const SpriteData& spriteData)
     {
+        sourceName.clear();
+
         material = std::make_shared<graphics::Material>();
         material->cullMode = graphics::CullMode::none;
         material->blendState = spriteData.blendState ? spriteData.blendState : engine->getCache().getBlendState(blendAlpha);
@@ -185,6 +188,9 @@ namespace ouzel::scene
 
     void SpriteRenderer::init(const std::string& filename)
     {
+        sourceName = filename;
+        reloadCount = engine->getCache().getReloadCount();
+
         material = std::make_shared<graphics::Material>();
         material->cullMode = graphics::CullMode::none;
         material->shader = engine->getCache().getShader(shaderTexture);
@@ -222,6 +228,8 @@ namespace ouzel::scene
                               std::uint32_t spritesX, std::uint32_t spritesY,
                               const Vector2F& pivot)
     {
+        sourceName.clear();
+
         material = std::make_shared<graphics::Material>();
         material->cullMode = graphics::CullMode::none;
         material->shader = engine->getCache().getShader(shaderTexture);
@@ -333,6 +341,9 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
+        if (!sourceName.empty() && reloadCount != engine->getCache().getReloadCount())
+            reload();
+
         if (currentAnimation != animationQueue.end() &&
             currentAnimation->animation->frameInterval > 0.0F &&
             !currentAnimation->animation->frames.empty() &&
@@ -424,6 +435,31 @@ namespace ouzel::scene
         return i != animations.end();
     }
 
+    void SpriteRenderer::reload()
+    {
+        reloadCount = engine->getCache().getReloadCount();
+
+        const auto spriteData = engine->getCache().getSpriteData(sourceName);
+        if (!spriteData) return;
+
+        material->textures[0] = spriteData->texture;
+
+        // the queue points to the old animations, so it is rebuilt with the same names
+        std::vector<std::pair<std::string, bool>> queuedAnimations;
+        for (const auto& queuedAnimation : animationQueue)
+            queuedAnimations.emplace_back(queuedAnimation.animation->name, queuedAnimation.repeat);
+        const auto currentIndex = std::distance(animationQueue.cbegin(), currentAnimation);
+
+        animations = spriteData->animations;
+
+        animationQueue.clear();
+        for (const auto& [name, repeat] : queuedAnimations)
+            animationQueue.push_back({&animations[name], repeat});
+        currentAnimation = std::next(animationQueue.cbegin(), currentIndex);
+
+        updateBoundingBox();
+    }
+
     void SpriteRenderer::setAnimation(const std::string& newAnimation, bool repeat)
     {
         animationQueue.clear();
@@ -121,6 +121,7 @@ namespace ouzel::scene
 
     private:
         void updateBoundingBox();
+        void reload();
 
         std::shared_ptr<graphics::Material> material;
         std::map<std::string, SpriteData::Animation> animations;
@@ -141,6 +142,10 @@ namespace ouzel::scene
         bool running = false;
         float currentTime = 0.0F;
 
+        // the sprite data that the renderer was created from by name, loaded again when it is hot reloaded
+        std::string sourceName;
+        std::uint32_t reloadCount = 0;
+
         EventHandler updateHandler;
     };
 }
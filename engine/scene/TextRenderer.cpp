@@ -5,6 +5,7 @@
 #include "../core/Engine.hpp"
 #include "../graphics/Graphics.hpp"
 #include "../assets/Cache.hpp"
+#include "../utils/Utf8.hpp"
 #include "../utils/Utils.hpp"
 
 namespace ouzel::scene
@@ -31,6 +32,7 @@ namespace ouzel::scene
 
         font = engine->getCache().getFont(fontFile);
 
+        updateShader();
         updateText();
     }
 
@@ -38,6 +40,7 @@ namespace ouzel::scene
     {
         font = engine->getCache().getFont(fontFile);
 
+        updateShader();
         updateText();
     }
 
@@ -45,7 +48,7 @@ namespace ouzel::scene
     {
         textAnchor = newTextAnchor;
 
-        updateText();
+        updateVertices();
     }
 
     void TextRenderer::setFontSize(float newFontSize)
@@ -65,12 +68,16 @@ namespace ouzel::scene
                         renderViewProjection,
                         wireframe);
 
-        if (needsMeshUpdate)
+        if (needsIndexUpdate)
         {
-            indexBuffer.setData(indices.data(), static_cast<std::uint32_t>(getVectorSize(indices)));
-            vertexBuffer.setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
+            indexBuffer.setData(layout.indices.data(), static_cast<std::uint32_t>(getVectorSize(layout.indices)));
+            needsIndexUpdate = false;
+        }
 
-            needsMeshUpdate = false;
+        if (needsVertexUpdate)
+        {
+            vertexBuffer.setData(vertices.data(), static_cast<std::uint32_t>(getVectorSize(vertices)));
+            needsVertexUpdate = false;
         }
 
         const auto modelViewProj = renderViewProjection * transformMatrix;
@@ -90,7 +97,7 @@ namespace ouzel::scene
                                                   vertexShaderConstants);
         engine->getGraphics()->setTextures({wireframe ? whitePixelTexture->getResource() : texture ? texture->getResource() : 0U});
         engine->getGraphics()->draw(indexBuffer.getResource(),
-                                    static_cast<std::uint32_t>(indices.size()),
+                                    static_cast<std::uint32_t>(layout.indices.size()),
                                     sizeof(std::uint16_t),
                                     vertexBuffer.getResource(),
                                     graphics::DrawMode::triangleList,
@@ -99,6 +106,25 @@ namespace ouzel::scene
 
     void TextRenderer::setText(const std::string& newText)
     {
+        if (newText == text) return;
+
+        // only the appended characters are laid out if the font can add them to the current layout
+        if (font &&
+            newText.size() > text.size() &&
+            newText.compare(0, text.size(), text) == 0)
+        {
+            const std::u32string appendedText = utf8::toUtf32(newText.begin() + static_cast<std::ptrdiff_t>(text.size()),
+                                                              newText.end());
+            text = newText;
+
+            if (font->appendLayout(layout, appendedText))
+            {
+                needsIndexUpdate = true;
+                updateVertices();
+                return;
+            }
+        }
+
         text = newText;
 
         updateText();
@@ -109,23 +135,37 @@ namespace ouzel::scene
         color = newColor;
     }
 
+    void TextRenderer::updateShader()
+    {
+        // only the built-in shaders follow the font, a custom shader is kept
+        const auto textureShader = engine->getCache().getShader(shaderTexture);
+        const auto distanceFieldShader = engine->getCache().getShader(shaderDistanceField);
+
+        if (font && (shader == textureShader || shader == distanceFieldShader))
+            shader = font->isDistanceField() && distanceFieldShader ? distanceFieldShader : textureShader;
+    }
+
     void TextRenderer::updateText()
     {
-        boundingBox.reset();
+        layout = gui::Font::Layout{};
+        layout.fontSize = fontSize;
 
         if (font)
-        {
-            std::tie(indices, vertices, texture) = font->getRenderData(text, Color::white(), fontSize, textAnchor);
-            needsMeshUpdate = true;
+            font->appendLayout(layout, utf8::toUtf32(text));
 
-            for (const graphics::Vertex& vertex : vertices)
-                boundingBox.insertPoint(vertex.position);
-        }
-        else
-        {
-            indices.clear();
-            vertices.clear();
-            texture.reset();
-        }
+        needsIndexUpdate = true;
+        updateVertices();
+    }
+
+    void TextRenderer::updateVertices()
+    {
+        gui::Font::anchorLayout(layout, textAnchor, vertices);
+        texture = layout.texture;
+        needsVertexUpdate = true;
+
+        boundingBox.reset();
+
+        for (const graphics::Vertex& vertex : vertices)
+            boundingBox.insertPoint(vertex.position);
     }
 }
@@ -55,7 +55,9 @@ namespace ouzel::scene
         }
 
     private:
+        void updateShader();
         void updateText();
+        void updateVertices();
 
         const graphics::Shader* shader = nullptr;
         const graphics::BlendState* blendState = nullptr;
@@ -71,12 +73,14 @@ namespace ouzel::scene
         float fontSize = 1.0F;
         Vector2F textAnchor;
 
-        std::vector<std::uint16_t> indices;
+        // the text laid out without the anchor, the vertices are the anchored copy of its vertices
+        gui::Font::Layout layout;
         std::vector<graphics::Vertex> vertices;
 
         Color color = Color::white();
 
-        bool needsMeshUpdate = false;
+        bool needsIndexUpdate = false;
+        bool needsVertexUpdate = false;
     };
 }
 
@@ -4,96 +4,146 @@
 #define OUZEL_STORAGE_ARCHIVE_HPP
 
 #include <cstdint>
-#include <fstream>
 #include <map>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include "FileRegion.hpp"
+#include "FileView.hpp"
+#include "MappedFile.hpp"
 #include "Path.hpp"
+#include "../formats/Deflate.hpp"
 #include "../utils/Utils.hpp"
 
 namespace ouzel::storage
 {
+    // Zip archive, the file is memory mapped and the entries are never modified after loading,
+    // so all of the reading functions can be called from multiple threads at once
     class Archive final
     {
     public:
         Archive() = default;
 
-        explicit Archive(const Path& path):
-            file{path, std::ios::binary}
+        explicit Archive(const Path& initPath):
+            path{initPath},
+            file{MappedFile::map(path)}
         {
-            constexpr std::uint32_t centralDirectory = 0x02014B50U;
+            constexpr std::uint32_t endOfCentralDirectorySignature = 0x06054B50U;
+            constexpr std::uint32_t centralDirectorySignature = 0x02014B50U;
             constexpr std::uint32_t headerSignature = 0x04034B50U;
+            constexpr std::size_t endOfCentralDirectorySize = 22;
+            constexpr std::size_t centralDirectoryHeaderSize = 46;
+            constexpr std::size_t headerSize = 30;
 
-            for (;;)
+            if (file.size() < endOfCentralDirectorySize)
+                throw std::runtime_error("Invalid archive");
+
+            // the end of central directory record is followed by a comment of up to 65535 bytes
+            std::size_t endOfCentralDirectory = file.size() - endOfCentralDirectorySize;
+            const std::size_t searchEnd = endOfCentralDirectory > 65535 ? endOfCentralDirectory - 65535 : 0;
+            while (decodeLittleEndian<std::uint32_t>(file.data() + endOfCentralDirectory) != endOfCentralDirectorySignature)
             {
-                std::uint8_t signatureData[4];
-                file.read(reinterpret_cast<char*>(signatureData), sizeof(signatureData));
+                if (endOfCentralDirectory == searchEnd)
+                    throw std::runtime_error("End of central directory not found");
+                --endOfCentralDirectory;
+            }
 
-                if (decodeLittleEndian<std::uint32_t>(signatureData) == centralDirectory)
-                    break;
+            const auto entryCount = decodeLittleEndian<std::uint16_t>(file.data() + endOfCentralDirectory + 10);
+            const std::size_t centralDirectorySize = decodeLittleEndian<std::uint32_t>(file.data() + endOfCentralDirectory + 12);
+            const std::size_t centralDirectoryOffset = decodeLittleEndian<std::uint32_t>(file.data() + endOfCentralDirectory + 16);
 
-                if (decodeLittleEndian<std::uint32_t>(signatureData) != headerSignature)
-                    throw std::runtime_error("Bad signature");
+            if (centralDirectoryOffset == 0xFFFFFFFFU)
+                throw std::runtime_error("Zip64 archives are not supported");
 
-                file.seekg(2, std::ios::cur); // skip version
-                file.seekg(2, std::ios::cur); // skip flags
+            if (centralDirectoryOffset > endOfCentralDirectory ||
+                centralDirectorySize > endOfCentralDirectory - centralDirectoryOffset)
+                throw std::runtime_error("Invalid central directory");
 
-                std::uint8_t compressionData[2];
-                file.read(reinterpret_cast<char*>(&compressionData), sizeof(compressionData));
+            std::size_t offset = centralDirectoryOffset;
+            const std::size_t centralDirectoryEnd = centralDirectoryOffset + centralDirectorySize;
 
-                if (decodeLittleEndian<std::uint16_t>(compressionData) != 0x00)
-                    throw std::runtime_error("Unsupported compression");
-
-                file.seekg(2, std::ios::cur); // skip modification time
-                file.seekg(2, std::ios::cur); // skip modification date
-                file.seekg(4, std::ios::cur); // skip CRC-32
+            for (std::uint16_t i = 0; i < entryCount; ++i)
+            {
+                if (centralDirectoryEnd - offset < centralDirectoryHeaderSize)
+                    throw std::runtime_error("Invalid central directory");
 
-                std::uint8_t compressedSizeData[4];
-                file.read(reinterpret_cast<char*>(compressedSizeData), sizeof(compressedSizeData));
+                const auto header = file.data() + offset;
 
-                std::uint8_t uncompressedSizeData[4];
-                file.read(reinterpret_cast<char*>(uncompressedSizeData), sizeof(uncompressedSizeData));
-                const size_t uncompressedSize = decodeLittleEndian<std::uint32_t>(uncompressedSizeData);
+                if (decodeLittleEndian<std::uint32_t>(header) != centralDirectorySignature)
+                    throw std::runtime_error("Bad signature");
 
-                std::uint8_t fileNameLengthData[2];
-                file.read(reinterpret_cast<char*>(fileNameLengthData), sizeof(fileNameLengthData));
-                const size_t fileNameLength = decodeLittleEndian<std::uint16_t>(fileNameLengthData);
+                const auto flags = decodeLittleEndian<std::uint16_t>(header + 8);
+                const auto compression = decodeLittleEndian<std::uint16_t>(header + 10);
+                const std::size_t compressedSize = decodeLittleEndian<std::uint32_t>(header + 20);
+                const std::size_t uncompressedSize = decodeLittleEndian<std::uint32_t>(header + 24);
+                const std::size_t fileNameLength = decodeLittleEndian<std::uint16_t>(header + 28);
+                const std::size_t extraFieldLength = decodeLittleEndian<std::uint16_t>(header + 30);
+                const std::size_t commentLength = decodeLittleEndian<std::uint16_t>(header + 32);
+                const std::size_t headerOffset = decodeLittleEndian<std::uint32_t>(header + 42);
 
-                std::uint8_t extraFieldLengthData[2];
-                file.read(reinterpret_cast<char*>(extraFieldLengthData), sizeof(extraFieldLengthData));
-                const size_t extraFieldLength = decodeLittleEndian<std::uint16_t>(extraFieldLengthData);
+                const std::size_t recordSize = centralDirectoryHeaderSize + fileNameLength + extraFieldLength + commentLength;
+                if (centralDirectoryEnd - offset < recordSize)
+                    throw std::runtime_error("Invalid central directory");
 
-                auto name = std::make_unique<char[]>(fileNameLength + 1); // +1 for null character
+                std::string name(reinterpret_cast<const char*>(header + centralDirectoryHeaderSize), fileNameLength);
+                offset += recordSize;
 
-                file.read(name.get(), static_cast<std::streamsize>(fileNameLength));
+                if (!name.empty() && name.back() == '/') continue; // skip directories
 
-                Entry& entry = entries[name.get()];
-                entry.size = uncompressedSize;
+                // the local header can have a different extra field than the central directory
+                if (headerOffset > centralDirectoryOffset ||
+                    centralDirectoryOffset - headerOffset < headerSize ||
+                    decodeLittleEndian<std::uint32_t>(file.data() + headerOffset) != headerSignature)
+                    throw std::runtime_error("Bad signature");
 
-                file.seekg(static_cast<std::streamoff>(extraFieldLength),
-                           std::ios::cur); // skip extra field
+                const std::size_t localFileNameLength = decodeLittleEndian<std::uint16_t>(file.data() + headerOffset + 26);
+                const std::size_t localExtraFieldLength = decodeLittleEndian<std::uint16_t>(file.data() + headerOffset + 28);
+                const std::size_t dataOffset = headerOffset + headerSize + localFileNameLength + localExtraFieldLength;
 
-                entry.offset = file.tellg();
+                if (dataOffset > centralDirectoryOffset || compressedSize > centralDirectoryOffset - dataOffset)
+                    throw std::runtime_error("Invalid entry " + name);
 
-                file.seekg(static_cast<std::streamoff>(uncompressedSize),
-                           std::ios::cur); // skip uncompressed size
+                Entry& entry = entries[std::move(name)];
+                entry.compression = (flags & 0x01) ? Compression::unsupported : // encrypted
+                    (compression == 0) ? Compression::stored :
+                    (compression == 8) ? Compression::deflate :
+                    Compression::unsupported;
+                entry.offset = dataOffset;
+                entry.compressedSize = compressedSize;
+                entry.size = uncompressedSize;
             }
         }
 
-        std::vector<std::byte> readFile(const std::string& filename)
+        // stored entries point directly to the mapped archive, compressed entries are inflated
+        FileView getFileView(const std::string& filename) const
         {
-            const auto i = entries.find(filename);
+            const auto& entry = getEntry(filename);
 
-            if (i == entries.end())
-                throw std::runtime_error("File " + filename + " does not exist");
-
-            file.seekg(i->second.offset, std::ios::beg);
+            switch (entry.compression)
+            {
+                case Compression::stored:
+                    return file.subview(entry.offset, entry.size);
+                case Compression::deflate:
+                    return FileView{inflate(filename, entry)};
+                default:
+                    throw std::runtime_error("Unsupported compression of " + filename);
+            }
+        }
 
-            std::vector<std::byte> data(i->second.size);
-            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(i->second.size));
+        std::vector<std::byte> readFile(const std::string& filename) const
+        {
+            const auto& entry = getEntry(filename);
 
-            return data;
+            switch (entry.compression)
+            {
+                case Compression::stored:
+                    return std::vector<std::byte>(file.data() + entry.offset,
+                                                  file.data() + entry.offset + entry.size);
+                case Compression::deflate:
+                    return inflate(filename, entry);
+                default:
+                    throw std::runtime_error("Unsupported compression of " + filename);
+            }
         }
 
         bool fileExists(const std::string& filename) const
@@ -101,15 +151,54 @@ namespace ouzel::storage
             return entries.find(filename) != entries.end();
         }
 
+        FileRegion getFileRegion(const std::string& filename) const
+        {
+            const auto& entry = getEntry(filename);
+
+            if (entry.compression != Compression::stored)
+                throw std::runtime_error("File " + filename + " is compressed and can not be read directly");
+
+            return FileRegion{path, entry.offset, entry.size};
+        }
+
     private:
-        std::ifstream file;
+        enum class Compression
+        {
+            stored,
+            deflate,
+            unsupported
+        };
 
         struct Entry final
         {
-            std::streamoff offset;
-            std::size_t size;
+            Compression compression = Compression::stored;
+            std::size_t offset = 0;
+            std::size_t compressedSize = 0;
+            std::size_t size = 0;
         };
 
+        const Entry& getEntry(const std::string& filename) const
+        {
+            const auto i = entries.find(filename);
+
+            if (i == entries.end())
+                throw std::runtime_error("File " + filename + " does not exist");
+
+            return i->second;
+        }
+
+        std::vector<std::byte> inflate(const std::string& filename, const Entry& entry) const
+        {
+            auto result = deflate::decompress(file.data() + entry.offset, entry.compressedSize, entry.size);
+
+            if (result.size() != entry.size)
+                throw std::runtime_error("Size mismatch of " + filename);
+
+            return result;
+        }
+
+        Path path;
+        FileView file;
         std::map<std::string, Entry> entries;
     };
 }
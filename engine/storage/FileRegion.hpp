@@ -0,0 +1,20 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_FILEREGION_HPP
+#define OUZEL_STORAGE_FILEREGION_HPP
+
+#include <cstddef>
+#include "Path.hpp"
+
+namespace ouzel::storage
+{
+    // location of the contents of a file on disk (a whole file or an uncompressed archive entry)
+    struct FileRegion final
+    {
+        Path path;
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
+}
+
+#endif // OUZEL_STORAGE_FILEREGION_HPP
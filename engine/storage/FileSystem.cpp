@@ -32,6 +32,7 @@
 
 #include "FileSystem.hpp"
 #include "Archive.hpp"
+#include "MappedFile.hpp"
 #include "../core/Engine.hpp"
 #include "../utils/Log.hpp"
 
@@ -317,19 +318,19 @@ namespace ouzel::storage
             if (!asset)
                 throw std::runtime_error("Failed to open file " + std::string(filename));
 
-            std::vector<std::byte> data;
-            std::byte buffer[1024];
+            std::vector<std::byte> data(static_cast<std::size_t>(AAsset_getLength(asset)));
 
-            for (;;)
+            for (std::size_t offset = 0; offset < data.size();)
             {
-                const int bytesRead = AAsset_read(asset, buffer, sizeof(buffer));
+                const int bytesRead = AAsset_read(asset, data.data() + offset, data.size() - offset);
 
-                if (bytesRead < 0)
+                if (bytesRead <= 0)
+                {
+                    AAsset_close(asset);
                     throw std::runtime_error("Failed to read from file");
-                else if (bytesRead == 0)
-                    break;
+                }
 
-                data.insert(data.end(), buffer, buffer + bytesRead);
+                offset += static_cast<std::size_t>(bytesRead);
             }
 
             AAsset_close(asset);
@@ -344,20 +345,60 @@ namespace ouzel::storage
         if (path.isEmpty())
             throw std::runtime_error("Failed to find file " + std::string(filename));
 
-        std::ifstream file(path, std::ios::binary);
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
         if (!file)
             throw std::runtime_error("Failed to open file " + std::string(filename));
 
-        std::vector<std::byte> data;
-        std::byte buffer[1024];
+        // the whole file is read at once into a buffer of the right size
+        std::vector<std::byte> data(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+
+        if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+            throw std::runtime_error("Failed to read from file " + std::string(filename));
+
+        return data;
+    }
+
+    FileView FileSystem::mapFile(const Path& filename, const bool searchResources)
+    {
+        if (searchResources)
+            for (auto& archive : archives)
+                if (archive.second.fileExists(filename))
+                    return archive.second.getFileView(filename);
 
-        while (!file.eof())
+#if defined(__ANDROID__)
+        if (!filename.isAbsolute())
         {
-            file.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
-            data.insert(data.end(), buffer, buffer + file.gcount());
+            auto& engineAndroid = static_cast<core::android::Engine&>(engine);
+
+            // uncompressed assets are mapped directly from the APK
+            auto asset = AAssetManager_open(engineAndroid.getAssetManager(), filename.getNative().c_str(), AASSET_MODE_BUFFER);
+
+            if (!asset)
+                throw std::runtime_error("Failed to open file " + std::string(filename));
+
+            std::shared_ptr<AAsset> owner(asset, AAsset_close);
+
+            const auto buffer = AAsset_getBuffer(asset);
+            if (!buffer)
+                throw std::runtime_error("Failed to read from file " + std::string(filename));
+
+            const auto size = static_cast<std::size_t>(AAsset_getLength(asset));
+            return FileView{std::move(owner), static_cast<const std::byte*>(buffer), size};
         }
+#endif
 
-        return data;
+        const auto path = getPath(filename, searchResources);
+
+        // file does not exist
+        if (path.isEmpty())
+            throw std::runtime_error("Failed to find file " + std::string(filename));
+
+#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+        return MappedFile::map(path);
+#else
+        return FileView{readFile(filename, searchResources)};
+#endif
     }
 
     bool FileSystem::resourceFileExists(const Path& filename) const
@@ -31,6 +31,8 @@
 #  include <unistd.h>
 #endif
 #include "Archive.hpp"
+#include "FileRegion.hpp"
+#include "FileView.hpp"
 #include "Path.hpp"
 
 namespace ouzel::core
@@ -235,6 +237,21 @@ namespace ouzel::storage
 
         std::vector<std::byte> readFile(const Path& filename, const bool searchResources = true);
 
+        // maps the file to the memory instead of copying it (falls back to reading if the file can not be mapped)
+        FileView mapFile(const Path& filename, const bool searchResources = true);
+
+        // returns where the file is stored on disk, so that it can be streamed instead of read at once
+        FileRegion getFileRegion(const Path& filename, const bool searchResources = true) const
+        {
+            if (searchResources)
+                for (auto& archive : archives)
+                    if (archive.second.fileExists(filename))
+                        return archive.second.getFileRegion(filename);
+
+            const auto path = getPath(filename, searchResources);
+            return FileRegion{path, 0, getFileSize(path)};
+        }
+
         bool resourceFileExists(const Path& filename) const;
 
         Path getPath(const Path& filename, const bool searchResources = true) const
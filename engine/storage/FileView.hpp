@@ -0,0 +1,63 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_FILEVIEW_HPP
+#define OUZEL_STORAGE_FILEVIEW_HPP
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ouzel::storage
+{
+    // Read-only view of file contents, keeps the memory it points to (a mapping or a buffer) alive
+    class FileView final
+    {
+    public:
+        FileView() noexcept = default;
+
+        FileView(std::shared_ptr<const void> initOwner,
+                 const std::byte* initData,
+                 std::size_t initSize) noexcept:
+            owner{std::move(initOwner)},
+            pointer{initData},
+            length{initSize}
+        {
+        }
+
+        explicit FileView(std::vector<std::byte> buffer)
+        {
+            auto bufferOwner = std::make_shared<const std::vector<std::byte>>(std::move(buffer));
+            pointer = bufferOwner->data();
+            length = bufferOwner->size();
+            owner = std::move(bufferOwner);
+        }
+
+        auto data() const noexcept { return pointer; }
+        auto size() const noexcept { return length; }
+        auto empty() const noexcept { return length == 0; }
+
+        auto begin() const noexcept { return pointer; }
+        auto end() const noexcept { return pointer + length; }
+        auto cbegin() const noexcept { return pointer; }
+        auto cend() const noexcept { return pointer + length; }
+
+        const std::byte& operator[](std::size_t index) const noexcept { return pointer[index]; }
+
+        FileView subview(std::size_t offset, std::size_t size) const
+        {
+            if (offset > length || size > length - offset)
+                throw std::out_of_range("View out of range");
+
+            return FileView{owner, pointer + offset, size};
+        }
+
+    private:
+        std::shared_ptr<const void> owner;
+        const std::byte* pointer = nullptr;
+        std::size_t length = 0;
+    };
+}
+
+#endif // OUZEL_STORAGE_FILEVIEW_HPP
@@ -0,0 +1,183 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include "../core/Setup.h"
+
+#include <algorithm>
+#include <vector>
+#if defined(__linux__)
+#  include <poll.h>
+#  include <sys/inotify.h>
+#  include <unistd.h>
+#endif
+
+#include "FileWatcher.hpp"
+#include "../core/Engine.hpp"
+#include "../utils/Log.hpp"
+
+namespace ouzel::storage
+{
+    FileWatcher::FileWatcher(std::function<void(const Path&)> initCallback,
+                             std::chrono::milliseconds initPollInterval):
+        callback{std::move(initCallback)},
+        pollInterval{initPollInterval}
+    {
+#if defined(__linux__)
+        notifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notifyDescriptor == -1)
+            logger.log(Log::Level::warning) << "Failed to initialize inotify, falling back to polling";
+#endif
+
+        watchThread = thread::Thread(&FileWatcher::run, this);
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        running = false;
+        if (watchThread.isJoinable()) watchThread.join();
+
+#if defined(__linux__)
+        if (notifyDescriptor != -1) close(notifyDescriptor);
+#endif
+    }
+
+    void FileWatcher::addFile(const Path& path)
+    {
+        std::lock_guard lock(fileMutex);
+
+        FileTime modifyTime{FileTime::Type{}};
+        try
+        {
+            modifyTime = FileSystem::getModifyTime(path);
+        }
+        catch (const std::system_error&)
+        {
+            // the file can be created later
+        }
+
+        files[std::string(path)] = modifyTime;
+
+#if defined(__linux__)
+        // the directory is watched, because editors often replace the file instead of writing to it
+        if (notifyDescriptor != -1)
+        {
+            const auto directory = path.getDirectory();
+            if (directoryWatches.find(std::string(directory)) == directoryWatches.end())
+            {
+                const auto watch = inotify_add_watch(notifyDescriptor, directory.getNative().c_str(),
+                                                     IN_CLOSE_WRITE | IN_MOVED_TO);
+                if (watch == -1)
+                    throw std::system_error(errno, std::system_category(), "Failed to watch " + std::string(directory));
+
+                directoryWatches[std::string(directory)] = watch;
+                watchDirectories[watch] = directory;
+            }
+        }
+#endif
+    }
+
+    void FileWatcher::removeFile(const Path& path)
+    {
+        std::lock_guard lock(fileMutex);
+        files.erase(std::string(path));
+    }
+
+    void FileWatcher::run()
+    {
+        thread::setCurrentThreadName("File watcher");
+
+        try
+        {
+            while (running)
+            {
+#if defined(__linux__)
+                if (notifyDescriptor != -1)
+                {
+                    pollfd pollDescriptor{notifyDescriptor, POLLIN, 0};
+
+                    // the timeout limits how long the destructor waits for the thread to finish
+                    const auto result = ::poll(&pollDescriptor, 1, 100);
+                    if (result == -1 && errno != EINTR)
+                        throw std::system_error(errno, std::system_category(), "Failed to poll inotify");
+
+                    if (result > 0) readNotifications();
+                    continue;
+                }
+#endif
+                poll();
+
+                for (auto remaining = pollInterval; running && remaining.count() > 0; remaining -= std::chrono::milliseconds(100))
+                    std::this_thread::sleep_for(std::min(remaining, std::chrono::milliseconds(100)));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logger.log(Log::Level::error) << e.what();
+        }
+    }
+
+    void FileWatcher::poll()
+    {
+        std::vector<Path> modifiedFiles;
+
+        {
+            std::lock_guard lock(fileMutex);
+
+            for (auto& file : files)
+                try
+                {
+                    const auto modifyTime = FileSystem::getModifyTime(Path{file.first});
+                    if (!(modifyTime == file.second))
+                    {
+                        file.second = modifyTime;
+                        modifiedFiles.emplace_back(file.first);
+                    }
+                }
+                catch (const std::system_error&)
+                {
+                    // the file is being replaced
+                }
+        }
+
+        for (const auto& path : modifiedFiles)
+            callback(path);
+    }
+
+#if defined(__linux__)
+    void FileWatcher::readNotifications()
+    {
+        alignas(inotify_event) char buffer[4096];
+        std::vector<Path> modifiedFiles;
+
+        for (;;)
+        {
+            const auto length = read(notifyDescriptor, buffer, sizeof(buffer));
+            if (length == -1)
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::system_category(), "Failed to read inotify events");
+            }
+
+            std::lock_guard lock(fileMutex);
+
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                if (event->len == 0) continue;
+
+                const auto directory = watchDirectories.find(event->wd);
+                if (directory == watchDirectories.end()) continue;
+
+                const auto path = directory->second / event->name;
+                if (files.find(std::string(path)) != files.end())
+                    modifiedFiles.push_back(path);
+            }
+        }
+
+        for (const auto& path : modifiedFiles)
+            callback(path);
+    }
+#endif
+}
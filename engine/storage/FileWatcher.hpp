@@ -0,0 +1,60 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_FILEWATCHER_HPP
+#define OUZEL_STORAGE_FILEWATCHER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include "FileSystem.hpp"
+#include "Path.hpp"
+#include "../thread/Thread.hpp"
+
+namespace ouzel::storage
+{
+    // Watches files for modifications and calls the callback on the watcher thread,
+    // uses inotify on Linux and polls the modification times elsewhere (or if inotify fails)
+    class FileWatcher final
+    {
+    public:
+        explicit FileWatcher(std::function<void(const Path&)> initCallback,
+                             std::chrono::milliseconds initPollInterval = std::chrono::milliseconds(500));
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        FileWatcher(FileWatcher&&) = delete;
+        FileWatcher& operator=(FileWatcher&&) = delete;
+
+        void addFile(const Path& path);
+        void removeFile(const Path& path);
+
+        auto isUsingNotifications() const noexcept { return notifyDescriptor != -1; }
+
+    private:
+        void run();
+        void poll();
+#if defined(__linux__)
+        void readNotifications();
+#endif
+
+        std::function<void(const Path&)> callback;
+        std::chrono::milliseconds pollInterval;
+
+        std::mutex fileMutex;
+        std::map<std::string, FileTime> files; // modification times for polling
+#if defined(__linux__)
+        std::map<std::string, int> directoryWatches;
+        std::map<int, Path> watchDirectories;
+#endif
+
+        int notifyDescriptor = -1;
+        std::atomic_bool running{true};
+        thread::Thread watchThread;
+    };
+}
+
+#endif // OUZEL_STORAGE_FILEWATCHER_HPP
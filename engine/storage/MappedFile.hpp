@@ -0,0 +1,148 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_STORAGE_MAPPEDFILE_HPP
+#define OUZEL_STORAGE_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#if defined(_WIN32)
+#  pragma push_macro("WIN32_LEAN_AND_MEAN")
+#  pragma push_macro("NOMINMAX")
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <Windows.h>
+#  pragma pop_macro("WIN32_LEAN_AND_MEAN")
+#  pragma pop_macro("NOMINMAX")
+#elif defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+#include "FileView.hpp"
+#include "Path.hpp"
+
+namespace ouzel::storage
+{
+    // Read-only mapping of a whole file to the memory
+    class MappedFile final
+    {
+    public:
+        explicit MappedFile(const Path& path)
+        {
+#if defined(_WIN32)
+            file = CreateFileW(path.getNative().c_str(), GENERIC_READ, FILE_SHARE_READ,
+                               nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::system_error(GetLastError(), std::system_category(), "Failed to open file");
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize))
+            {
+                const auto error = GetLastError();
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to get file size");
+            }
+
+            size = static_cast<std::size_t>(fileSize.QuadPart);
+            if (size == 0) return; // empty files can not be mapped
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping)
+            {
+                const auto error = GetLastError();
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to create file mapping");
+            }
+
+            address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!address)
+            {
+                const auto error = GetLastError();
+                CloseHandle(mapping);
+                CloseHandle(file);
+                throw std::system_error(error, std::system_category(), "Failed to map file");
+            }
+#elif defined(__unix__) || defined(__APPLE__)
+            int fd = open(path.getNative().c_str(), O_RDONLY);
+            while (fd == -1 && errno == EINTR)
+                fd = open(path.getNative().c_str(), O_RDONLY);
+
+            if (fd == -1)
+                throw std::system_error(errno, std::system_category(), "Failed to open file");
+
+            struct stat s;
+            if (fstat(fd, &s) == -1)
+            {
+                const auto error = errno;
+                close(fd);
+                throw std::system_error(error, std::system_category(), "Failed to get file status");
+            }
+
+            size = static_cast<std::size_t>(s.st_size);
+            if (size == 0) // empty files can not be mapped
+            {
+                close(fd);
+                return;
+            }
+
+            address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            const auto error = errno;
+            close(fd); // the mapping stays valid after the descriptor is closed
+
+            if (address == MAP_FAILED)
+            {
+                address = nullptr;
+                throw std::system_error(error, std::system_category(), "Failed to map file");
+            }
+#else
+            throw std::runtime_error("File mapping not supported");
+#endif
+        }
+
+        ~MappedFile()
+        {
+#if defined(_WIN32)
+            if (address) UnmapViewOfFile(address);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#elif defined(__unix__) || defined(__APPLE__)
+            if (address) munmap(address, size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        auto getData() const noexcept { return static_cast<const std::byte*>(address); }
+        auto getSize() const noexcept { return size; }
+
+        // returns a view that keeps the mapping alive
+        static FileView map(const Path& path)
+        {
+            auto mappedFile = std::make_shared<const MappedFile>(path);
+            const auto data = mappedFile->getData();
+            const auto size = mappedFile->getSize();
+            return FileView{std::move(mappedFile), data, size};
+        }
+
+    private:
+#if defined(_WIN32)
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+        void* address = nullptr;
+        std::size_t size = 0;
+    };
+}
+
+#endif // OUZEL_STORAGE_MAPPEDFILE_HPP
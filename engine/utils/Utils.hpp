@@ -26,7 +26,7 @@ namespace ouzel
         T result = T(0);
 
         for (std::size_t i = 0; i < sizeof(T); ++i, ++iterator)
-            result |= static_cast<T>(static_cast<std::uint8_t>(*iterator) << ((sizeof(T) - i - 1) * 8));
+            result |= static_cast<T>(static_cast<T>(static_cast<std::uint8_t>(*iterator)) << ((sizeof(T) - i - 1) * 8));
 
         return result;
     }
@@ -37,7 +37,7 @@ namespace ouzel
         T result = T(0);
 
         for (std::size_t i = 0; i < sizeof(T); ++i, ++iterator)
-            result |= static_cast<T>(static_cast<std::uint8_t>(*iterator) << (i * 8));
+            result |= static_cast<T>(static_cast<T>(static_cast<std::uint8_t>(*iterator)) << (i * 8));
 
         return result;
     }
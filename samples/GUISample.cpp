@@ -116,10 +116,10 @@ namespace samples
         label1.setPosition(Vector2F(-88.0F, 108.0F));
         layer.addChild(&label1);
 
-        engine->getLocalization().addLanguage("latvian", engine->getFileSystem().readFile("lv.mo"));
+        engine->getLocalization().addLanguage("latvian", engine->getFileSystem().mapFile("lv.mo"));
         engine->getLocalization().setLanguage("latvian");
 
-        label2.setText(engine->getLocalization().getString("Ouzel"));
+        label2.setText(std::string{engine->getLocalization().getString("Ouzel")});
 
         label2.setPosition(Vector2F(10.0F, 0.0F));
         layer.addChild(&label2);
@@ -0,0 +1,25 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+cbuffer Constants: register(b0)
+{
+    float4 color;
+};
+
+struct VS2PS
+{
+    float4 position: SV_POSITION;
+    float4 color: COLOR;
+    float2 texCoord: TEXCOORD;
+};
+
+SamplerState sampler0;
+Texture2D texture0;
+
+void main(in VS2PS input, out float4 output0: SV_TARGET0)
+{
+    // median of the channels of multi-channel distance fields, single-channel ones have it in all channels
+    float4 texel = texture0.Sample(sampler0, input.texCoord);
+    float dist = min(max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b)), texel.a);
+    float width = fwidth(dist);
+    output0 = float4(1.0, 1.0, 1.0, smoothstep(0.5 - width, 0.5 + width, dist)) * input.color * color;
+}
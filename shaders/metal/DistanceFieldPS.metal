@@ -0,0 +1,31 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#include <metal_stdlib>
+#include <simd/simd.h>
+
+using namespace metal;
+
+typedef struct
+{
+    float4 color;
+} uniforms_t;
+
+typedef struct
+{
+    float4 position [[position]];
+    half4 color;
+    float2 texCoord;
+} VS2PS;
+
+// Fragment shader function
+fragment half4 mainPS(VS2PS input [[stage_in]],
+                      texture2d<float> tex2D [[texture(0)]],
+                      sampler sampler2D [[sampler(0)]],
+                      constant uniforms_t& uniforms [[buffer(1)]])
+{
+    // median of the channels of multi-channel distance fields, single-channel ones have it in all channels
+    float4 texel = tex2D.sample(sampler2D, input.texCoord);
+    float dist = min(max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b)), texel.a);
+    float width = fwidth(dist);
+    return input.color * half4(1.0h, 1.0h, 1.0h, half(smoothstep(0.5 - width, 0.5 + width, dist))) * half4(uniforms.color);
+}
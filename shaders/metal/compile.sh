@@ -22,6 +22,9 @@ $TOOLCHAIN/usr/bin/metallib -o TexturePSMacOS.metallib TexturePSMacOS.air
 $TOOLCHAIN/usr/bin/metal -c TextureVS.metal -target air64-apple-macos10.13 -ffast-math -o TextureVSMacOS.air -isysroot "$MACOS_SDK"
 $TOOLCHAIN/usr/bin/metallib -o TextureVSMacOS.metallib TextureVSMacOS.air
 
+$TOOLCHAIN/usr/bin/metal -c DistanceFieldPS.metal -target air64-apple-macos10.13 -ffast-math -o DistanceFieldPSMacOS.air -isysroot "$MACOS_SDK"
+$TOOLCHAIN/usr/bin/metallib -o DistanceFieldPSMacOS.metallib DistanceFieldPSMacOS.air
+
 # iOS
 IOS_SDK=`xcrun --sdk iphoneos --show-sdk-path`
 export SDKROOT="$IOS_SDK"
@@ -38,6 +41,9 @@ $TOOLCHAIN/usr/bin/metallib -o TexturePSIOS.metallib TexturePSIOS.air
 $TOOLCHAIN/usr/bin/metal -c TextureVS.metal -target air64-apple-ios11.0 -ffast-math -o TextureVSIOS.air -isysroot "$IOS_SDK"
 $TOOLCHAIN/usr/bin/metallib -o TextureVSIOS.metallib TextureVSIOS.air
 
+$TOOLCHAIN/usr/bin/metal -c DistanceFieldPS.metal -target air64-apple-ios11.0 -ffast-math -o DistanceFieldPSIOS.air -isysroot "$IOS_SDK"
+$TOOLCHAIN/usr/bin/metallib -o DistanceFieldPSIOS.metallib DistanceFieldPSIOS.air
+
 # tvOS
 TVOS_SDK=`xcrun --sdk appletvos --show-sdk-path`
 export SDKROOT="$TVOS_SDK"
@@ -54,20 +60,26 @@ $TOOLCHAIN/usr/bin/metallib -o TexturePSTVOS.metallib TexturePSTVOS.air
 $TOOLCHAIN/usr/bin/metal -c TextureVS.metal -target air64-apple-tvos11.3 -ffast-math -o TextureVSTVOS.air -isysroot "$TVOS_SDK"
 $TOOLCHAIN/usr/bin/metallib -o TextureVSTVOS.metallib TextureVSTVOS.air
 
+$TOOLCHAIN/usr/bin/metal -c DistanceFieldPS.metal -target air64-apple-tvos11.3 -ffast-math -o DistanceFieldPSTVOS.air -isysroot "$TVOS_SDK"
+$TOOLCHAIN/usr/bin/metallib -o DistanceFieldPSTVOS.metallib DistanceFieldPSTVOS.air
+
 xxd -i ColorPSMacOS.metallib ColorPSMacOS.h
 xxd -i ColorVSMacOS.metallib ColorVSMacOS.h
 xxd -i TexturePSMacOS.metallib TexturePSMacOS.h
 xxd -i TextureVSMacOS.metallib TextureVSMacOS.h
+xxd -i DistanceFieldPSMacOS.metallib DistanceFieldPSMacOS.h
 
 xxd -i ColorPSIOS.metallib ColorPSIOS.h
 xxd -i ColorVSIOS.metallib ColorVSIOS.h
 xxd -i TexturePSIOS.metallib TexturePSIOS.h
 xxd -i TextureVSIOS.metallib TextureVSIOS.h
+xxd -i DistanceFieldPSIOS.metallib DistanceFieldPSIOS.h
 
 xxd -i ColorPSTVOS.metallib ColorPSTVOS.h
 xxd -i ColorVSTVOS.metallib ColorVSTVOS.h
 xxd -i TexturePSTVOS.metallib TexturePSTVOS.h
 xxd -i TextureVSTVOS.metallib TextureVSTVOS.h
+xxd -i DistanceFieldPSTVOS.metallib DistanceFieldPSTVOS.h
 
 rm -rf ./*.air
 rm -rf ./*.metallib
\ No newline at end of file
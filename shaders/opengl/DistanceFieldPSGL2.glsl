@@ -0,0 +1,12 @@
+#version 120
+uniform vec4 color;
+uniform sampler2D texture0;
+varying vec4 exColor;
+varying vec2 exTexCoord;
+void main()
+{
+    vec4 texel = texture2D(texture0, exTexCoord);
+    float dist = min(max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b)), texel.a);
+    float width = fwidth(dist);
+    gl_FragColor = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - width, 0.5 + width, dist)) * exColor * color;
+}
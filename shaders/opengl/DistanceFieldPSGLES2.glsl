@@ -0,0 +1,19 @@
+#ifdef GL_OES_standard_derivatives
+#extension GL_OES_standard_derivatives : enable
+#endif
+precision mediump float;
+uniform lowp vec4 color;
+uniform lowp sampler2D texture0;
+varying lowp vec4 exColor;
+varying vec2 exTexCoord;
+void main()
+{
+    vec4 texel = texture2D(texture0, exTexCoord);
+    float dist = min(max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b)), texel.a);
+#ifdef GL_OES_standard_derivatives
+    float width = fwidth(dist);
+#else
+    float width = 0.0625;
+#endif
+    gl_FragColor = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - width, 0.5 + width, dist)) * exColor * color;
+}
@@ -0,0 +1,14 @@
+#version 300 es
+precision mediump float;
+uniform lowp vec4 color;
+uniform lowp sampler2D texture0;
+in lowp vec4 exColor;
+in vec2 exTexCoord;
+out vec4 outColor;
+void main()
+{
+    vec4 texel = texture(texture0, exTexCoord);
+    float dist = min(max(min(texel.r, texel.g), min(max(texel.r, texel.g), texel.b)), texel.a);
+    float width = fwidth(dist);
+    outColor = vec4(1.0, 1.0, 1.0, smoothstep(0.5 - width, 0.5 + width, dist)) * exColor * color;
+}
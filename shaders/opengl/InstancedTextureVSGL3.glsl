@@ -0,0 +1,18 @@
+#version 330
+in vec2 position0;
+in vec4 color0;
+in vec2 texCoord0;
+uniform mat4 modelViewProj;
+out vec4 exColor;
+out vec2 exTexCoord;
+void main()
+{
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 direction = corner * 2.0 - 1.0;
+    float c = cos(texCoord0.y);
+    float s = sin(texCoord0.y);
+    vec2 offset = vec2(direction.x * c - direction.y * s, direction.x * s + direction.y * c) * texCoord0.x;
+    gl_Position = modelViewProj * vec4(position0 + offset, 0.0, 1.0);
+    exColor = color0;
+    exTexCoord = vec2(corner.x, 1.0 - corner.y);
+}
@@ -3,27 +3,35 @@ xxd -i ColorPSGL2.glsl ColorPSGL2.h
 xxd -i ColorVSGL2.glsl ColorVSGL2.h
 xxd -i TexturePSGL2.glsl TexturePSGL2.h
 xxd -i TextureVSGL2.glsl TextureVSGL2.h
+xxd -i DistanceFieldPSGL2.glsl DistanceFieldPSGL2.h
 
 # OpenGL 3
 xxd -i ColorPSGL3.glsl ColorPSGL3.h
 xxd -i ColorVSGL3.glsl ColorVSGL3.h
 xxd -i TexturePSGL3.glsl TexturePSGL3.h
 xxd -i TextureVSGL3.glsl TextureVSGL3.h
+xxd -i DistanceFieldPSGL3.glsl DistanceFieldPSGL3.h
+xxd -i InstancedTextureVSGL3.glsl InstancedTextureVSGL3.h
 
 # OpenGL 4
 xxd -i ColorPSGL4.glsl ColorPSGL4.h
 xxd -i ColorVSGL4.glsl ColorVSGL4.h
 xxd -i TexturePSGL4.glsl TexturePSGL4.h
 xxd -i TextureVSGL4.glsl TextureVSGL4.h
+xxd -i DistanceFieldPSGL4.glsl DistanceFieldPSGL4.h
+xxd -i InstancedTextureVSGL4.glsl InstancedTextureVSGL4.h
 
 # OpenGL ES 2
 xxd -i ColorPSGLES2.glsl ColorPSGLES2.h
 xxd -i ColorVSGLES2.glsl ColorVSGLES2.h
 xxd -i TexturePSGLES2.glsl TexturePSGLES2.h
 xxd -i TextureVSGLES2.glsl TextureVSGLES2.h
+xxd -i DistanceFieldPSGLES2.glsl DistanceFieldPSGLES2.h
 
 # OpenGL ES 3
 xxd -i ColorPSGLES3.glsl ColorPSGLES3.h
 xxd -i ColorVSGLES3.glsl ColorVSGLES3.h
 xxd -i TexturePSGLES3.glsl TexturePSGLES3.h
-xxd -i TextureVSGLES3.glsl TextureVSGLES3.h
\ No newline at end of file
+xxd -i TextureVSGLES3.glsl TextureVSGLES3.h
+xxd -i DistanceFieldPSGLES3.glsl DistanceFieldPSGLES3.h
+xxd -i InstancedTextureVSGLES3.glsl InstancedTextureVSGLES3.h
\ No newline at end of file
@@ -24,19 +24,30 @@ namespace ouzel
             shader
         };
 
+        // block compression of the exported textures
+        enum class Compression
+        {
+            none,
+            bc1,
+            bc3
+        };
+
         Asset(const storage::Path& initPath,
               const std::string& initName,
               Type initType,
-              bool initMipmaps):
+              bool initMipmaps,
+              Compression initCompression = Compression::none):
             path(initPath),
             name(initName),
             type(initType),
-            mipmaps(initMipmaps) {}
+            mipmaps(initMipmaps),
+            compression(initCompression) {}
 
         const storage::Path path;
         const std::string name;
         const Type type = Type::empty;
         const bool mipmaps = false;
+        const Compression compression = Compression::none;
     };
 
     inline Asset::Type stringToAssetType(const std::string& s)
@@ -64,6 +75,18 @@ namespace ouzel
         else
             throw std::runtime_error("Invalid asset type");
     }
+
+    inline Asset::Compression stringToCompression(const std::string& s)
+    {
+        if (s == "none")
+            return Asset::Compression::none;
+        else if (s == "bc1")
+            return Asset::Compression::bc1;
+        else if (s == "bc3")
+            return Asset::Compression::bc3;
+        else
+            throw std::runtime_error("Invalid texture compression");
+    }
 }
 
 #endif // OUZEL_ASSET_HPP
@@ -3,11 +3,25 @@
 #ifndef OUZEL_OUZELPROJECT_HPP
 #define OUZEL_OUZELPROJECT_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
 #include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
 #include "Asset.hpp"
 #include "Target.hpp"
+#include "Texture.hpp"
+#include "assets/PackedBundle.hpp"
 #include "storage/FileSystem.hpp"
 #include "formats/Json.hpp"
+#include "thread/Thread.hpp"
 
 namespace ouzel
 {
@@ -67,7 +81,10 @@ namespace ouzel
                 assets.emplace_back(assetPath,
                                     assetName,
                                     assetType,
-                                    assetObject.hasMember("mipmaps") ? assetObject["mipmaps"].as<bool>() : false);
+                                    assetObject.hasMember("mipmaps") ? assetObject["mipmaps"].as<bool>() : false,
+                                    assetObject.hasMember("compression") ?
+                                        stringToCompression(assetObject["compression"].as<std::string>()) :
+                                        Asset::Compression::none);
             }
         }
 
@@ -82,31 +99,191 @@ namespace ouzel
         const storage::Path& getAssetsPath() const noexcept { return assetsPath; }
         const std::vector<Asset>& getAssets() const noexcept { return assets; }
 
+        // cooks the assets on all cores, textures are cached by the hash of their contents and settings
         void exportAssets(const std::string& targetName) const
         {
-            for (const auto& asset : assets)
+            const auto targetIterator = std::find_if(targets.begin(), targets.end(),
+                                                     [targetName](const auto& target) noexcept {
+                return target.name == targetName;
+            });
+
+            if (targetIterator == targets.end())
+                throw std::runtime_error("Target not found");
+
+            const storage::Path directoryPath = path.getDirectory();
+            const storage::Path cachePath = directoryPath / (targetName + ".cache");
+
+            const auto cacheType = storage::FileSystem::getFileType(cachePath);
+            if (cacheType == storage::FileType::notFound)
+                storage::FileSystem::createDirectory(cachePath);
+            else if (cacheType != storage::FileType::directory)
             {
-                const storage::Path assetPath = assetsPath / asset.path;
+                storage::FileSystem::deleteFile(cachePath);
+                storage::FileSystem::createDirectory(cachePath);
+            }
 
-                storage::Path resourceName = asset.path;
-                resourceName.replaceExtension("otexture");
-                const storage::Path resourcePath = assetPath / resourceName;
+            std::vector<CookedAsset> cookedAssets(assets.size());
+            std::atomic<std::size_t> nextAsset{0};
+            std::atomic<std::size_t> reusedCount{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
 
-                const auto targetIterator = std::find_if(targets.begin(), targets.end(),
-                                                         [targetName](const auto& target) noexcept {
-                    return target.name == targetName;
-                });
+            const auto cook = [&]() {
+                for (std::size_t i = nextAsset++; i < assets.size(); i = nextAsset++)
+                {
+                    try
+                    {
+                        cookedAssets[i] = cookAsset(assets[i], i, directoryPath, cachePath);
+                        if (cookedAssets[i].reused) ++reusedCount;
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard lock(errorMutex);
+                        if (!error) error = std::current_exception();
+                        nextAsset = assets.size();
+                    }
+                }
+            };
 
-                if (targetIterator == targets.end())
-                    throw std::runtime_error("Target not found");
+            {
+                const auto threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+                std::vector<thread::Thread> threads;
+                for (unsigned int i = 1; i < threadCount; ++i)
+                    threads.emplace_back(cook);
 
-                // TODO: check if input file exists
-                // TODO: check if output file exists and is older than the input file
-                // TODO: export input file to output file
-            }
+                cook();
+            } // the threads are joined here
+
+            if (error) std::rethrow_exception(error);
+
+            assets::packed::Writer writer;
+            for (std::size_t i = 0; i < assets.size(); ++i)
+                if (cookedAssets[i].exported)
+                    writer.addEntry(assets[i].name, cookedAssets[i].type, cookedAssets[i].encoding,
+                                    assets[i].mipmaps, std::move(cookedAssets[i].data));
+
+            const storage::Path bundlePath = directoryPath / (targetName + ".obundle");
+            const auto bundle = writer.write();
+
+            std::ofstream file(bundlePath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(bundle.data()), static_cast<std::streamsize>(bundle.size()));
+
+            if (!file)
+                throw std::runtime_error("Failed to write " + std::string(bundlePath));
+
+            std::cout << "Exported " << assets.size() << " assets to " << std::string(bundlePath)
+                << " (" << reusedCount << " reused from the cache)\n";
         }
 
     private:
+        struct CookedAsset final
+        {
+            bool exported = false;
+            bool reused = false;
+            assets::Loader::Type type = assets::Loader::Type::bank;
+            assets::packed::Encoding encoding = assets::packed::Encoding::source;
+            std::vector<std::byte> data;
+        };
+
+        // increase when the output of the cooking changes to invalidate the cache
+        static constexpr std::uint64_t cookVersion = 1;
+
+        static std::vector<std::byte> readFile(const storage::Path& filePath)
+        {
+            std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+            if (!file)
+                throw std::runtime_error("Failed to open " + std::string(filePath));
+
+            std::vector<std::byte> data(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0, std::ios::beg);
+            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file)
+                throw std::runtime_error("Failed to read " + std::string(filePath));
+
+            return data;
+        }
+
+        static CookedAsset cookAsset(const Asset& asset,
+                                     std::size_t assetIndex,
+                                     const storage::Path& directoryPath,
+                                     const storage::Path& cachePath)
+        {
+            CookedAsset result;
+
+            switch (asset.type)
+            {
+                case Asset::Type::empty:
+                case Asset::Type::shader:
+                    return result; // not loaded through bundles
+                case Asset::Type::texture:
+                {
+                    const auto data = readFile(directoryPath / asset.path);
+                    const auto contentHash = assets::packed::hash(std::string_view{reinterpret_cast<const char*>(data.data()), data.size()},
+                                                                  (cookVersion * 4 + static_cast<std::uint64_t>(asset.compression)) * 2 + (asset.mipmaps ? 1 : 0));
+
+                    std::ostringstream cacheName;
+                    cacheName << std::hex << std::setw(16) << std::setfill('0') << contentHash << ".otexture";
+                    const storage::Path cacheFilePath = cachePath / cacheName.str();
+
+                    result.exported = true;
+                    result.type = assets::Loader::Type::image;
+                    result.encoding = assets::packed::Encoding::texture;
+
+                    if (storage::FileSystem::getFileType(cacheFilePath) == storage::FileType::regular)
+                    {
+                        result.data = readFile(cacheFilePath);
+                        result.reused = true;
+                    }
+                    else
+                    {
+                        result.data = cookTexture(data, asset.mipmaps, asset.compression);
+
+                        // written to a temporary file first, so that an interrupted export does not leave a broken cache
+                        // assets with the same contents can be cooked at the same time, so the name includes the asset index
+                        const storage::Path temporaryPath = cacheFilePath + "." + std::to_string(assetIndex) + ".tmp";
+                        {
+                            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+                            file.write(reinterpret_cast<const char*>(result.data.data()),
+                                       static_cast<std::streamsize>(result.data.size()));
+                            if (!file)
+                                throw std::runtime_error("Failed to write " + std::string(temporaryPath));
+                        }
+                        storage::FileSystem::renameFile(temporaryPath, cacheFilePath);
+                    }
+
+                    return result;
+                }
+                default:
+                    result.exported = true;
+                    result.type = getLoaderType(asset);
+                    result.data = readFile(directoryPath / asset.path);
+                    return result;
+            }
+        }
+
+        static assets::Loader::Type getLoaderType(const Asset& asset)
+        {
+            switch (asset.type)
+            {
+                case Asset::Type::font: return assets::Loader::Type::font;
+                case Asset::Type::mesh:
+                {
+                    // skinned meshes are only loaded from glTF and Collada files
+                    auto extension = std::string(asset.path.getExtension());
+                    std::transform(extension.begin(), extension.end(), extension.begin(),
+                                   [](char c) noexcept { return static_cast<char>(std::tolower(c)); });
+                    return (extension == "obj") ? assets::Loader::Type::staticMesh : assets::Loader::Type::skinnedMesh;
+                }
+                case Asset::Type::texture: return assets::Loader::Type::image;
+                case Asset::Type::material: return assets::Loader::Type::material;
+                case Asset::Type::particleSystem: return assets::Loader::Type::particleSystem;
+                case Asset::Type::sprite: return assets::Loader::Type::sprite;
+                case Asset::Type::sound: return assets::Loader::Type::sound;
+                case Asset::Type::cue: return assets::Loader::Type::cue;
+                default: throw std::runtime_error("Unsupported asset type");
+            }
+        }
+
         const storage::Path path;
         std::string name;
         std::string identifier;
@@ -0,0 +1,382 @@
+// Copyright 2015-2020 Elviss Strazdins. All rights reserved.
+
+#ifndef OUZEL_TEXTURE_HPP
+#define OUZEL_TEXTURE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Asset.hpp"
+#include "assets/PackedBundle.hpp"
+#include "utils/Utils.hpp"
+#include "stb_image.h"
+
+namespace ouzel
+{
+    inline float srgbToLinear(std::uint8_t value) noexcept
+    {
+        const float c = value / 255.0F;
+        return (c <= 0.04045F) ? c / 12.92F : std::pow((c + 0.055F) / 1.055F, 2.4F);
+    }
+
+    inline std::uint8_t linearToSrgb(float value) noexcept
+    {
+        const float c = (value <= 0.0031308F) ? value * 12.92F : 1.055F * std::pow(value, 1.0F / 2.4F) - 0.055F;
+        return static_cast<std::uint8_t>(std::round(std::clamp(c, 0.0F, 1.0F) * 255.0F));
+    }
+
+    inline std::uint16_t packColor565(const float color[3]) noexcept
+    {
+        const auto r = static_cast<std::uint16_t>(std::round(std::clamp(color[0], 0.0F, 255.0F) * 31.0F / 255.0F));
+        const auto g = static_cast<std::uint16_t>(std::round(std::clamp(color[1], 0.0F, 255.0F) * 63.0F / 255.0F));
+        const auto b = static_cast<std::uint16_t>(std::round(std::clamp(color[2], 0.0F, 255.0F) * 31.0F / 255.0F));
+        return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    inline void unpackColor565(std::uint16_t color, int result[3]) noexcept
+    {
+        const int r = (color >> 11) & 0x1F;
+        const int g = (color >> 5) & 0x3F;
+        const int b = color & 0x1F;
+        result[0] = (r << 3) | (r >> 2);
+        result[1] = (g << 2) | (g >> 4);
+        result[2] = (b << 3) | (b >> 2);
+    }
+
+    // BC1 color block from the endpoints of a range fit along the principal axis of the colors,
+    // with transparency the three color mode is used and the pixels with alpha below 128 are transparent black
+    inline void compressColorBlock(const std::uint8_t block[16][4], bool transparency, std::uint8_t* destination)
+    {
+        const auto isTransparent = [transparency](const std::uint8_t* pixel) noexcept {
+            return transparency && pixel[3] < 128;
+        };
+
+        float mean[3] = {0.0F, 0.0F, 0.0F};
+        std::uint32_t count = 0;
+        for (std::size_t i = 0; i < 16; ++i)
+            if (!isTransparent(block[i]))
+            {
+                for (std::size_t c = 0; c < 3; ++c) mean[c] += block[i][c];
+                ++count;
+            }
+
+        std::uint16_t color0 = 0;
+        std::uint16_t color1 = 0;
+
+        if (count)
+        {
+            for (float& c : mean) c /= static_cast<float>(count);
+
+            float covariance[6] = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+            for (std::size_t i = 0; i < 16; ++i)
+                if (!isTransparent(block[i]))
+                {
+                    const float r = block[i][0] - mean[0];
+                    const float g = block[i][1] - mean[1];
+                    const float b = block[i][2] - mean[2];
+                    covariance[0] += r * r;
+                    covariance[1] += r * g;
+                    covariance[2] += r * b;
+                    covariance[3] += g * g;
+                    covariance[4] += g * b;
+                    covariance[5] += b * b;
+                }
+
+            // power iteration for the eigenvector with the largest eigenvalue, it starts from the covariance of
+            // the channel with the largest variance, which is not orthogonal to the axis unless all colors are equal
+            float axis[3];
+            if (covariance[0] >= covariance[3] && covariance[0] >= covariance[5])
+            {
+                axis[0] = covariance[0];
+                axis[1] = covariance[1];
+                axis[2] = covariance[2];
+            }
+            else if (covariance[3] >= covariance[5])
+            {
+                axis[0] = covariance[1];
+                axis[1] = covariance[3];
+                axis[2] = covariance[4];
+            }
+            else
+            {
+                axis[0] = covariance[2];
+                axis[1] = covariance[4];
+                axis[2] = covariance[5];
+            }
+
+            if (axis[0] == 0.0F && axis[1] == 0.0F && axis[2] == 0.0F)
+                axis[0] = axis[1] = axis[2] = 1.0F;
+
+            for (int iteration = 0; iteration < 8; ++iteration)
+            {
+                const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+                const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+                const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+                const float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+                if (length <= 0.0F) break;
+                axis[0] = x / length;
+                axis[1] = y / length;
+                axis[2] = z / length;
+            }
+
+            const float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+            float minProjection = 0.0F;
+            float maxProjection = 0.0F;
+            for (std::size_t i = 0; i < 16; ++i)
+                if (!isTransparent(block[i]))
+                {
+                    const float projection = ((block[i][0] - mean[0]) * axis[0] +
+                                              (block[i][1] - mean[1]) * axis[1] +
+                                              (block[i][2] - mean[2]) * axis[2]) / axisLengthSquared;
+                    minProjection = std::min(minProjection, projection);
+                    maxProjection = std::max(maxProjection, projection);
+                }
+
+            float minColor[3];
+            float maxColor[3];
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                minColor[c] = mean[c] + axis[c] * minProjection;
+                maxColor[c] = mean[c] + axis[c] * maxProjection;
+            }
+
+            color0 = packColor565(maxColor);
+            color1 = packColor565(minColor);
+        }
+
+        // the order of the endpoints selects the mode, color0 > color1 is the four color mode
+        const bool threeColorMode = transparency && count < 16;
+        if (threeColorMode ? color0 > color1 : color0 < color1)
+            std::swap(color0, color1);
+
+        int palette[4][3];
+        unpackColor565(color0, palette[0]);
+        unpackColor565(color1, palette[1]);
+        for (std::size_t c = 0; c < 3; ++c)
+            if (threeColorMode)
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            else
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+
+        const std::uint32_t paletteSize = (threeColorMode || color0 == color1) ? 3 : 4;
+
+        std::uint32_t indices = 0;
+        for (std::uint32_t i = 0; i < 16; ++i)
+        {
+            std::uint32_t index = 3;
+
+            if (!isTransparent(block[i]))
+            {
+                int bestDistance = std::numeric_limits<int>::max();
+                for (std::uint32_t p = 0; p < paletteSize; ++p)
+                {
+                    const int r = block[i][0] - palette[p][0];
+                    const int g = block[i][1] - palette[p][1];
+                    const int b = block[i][2] - palette[p][2];
+                    const int distance = r * r + g * g + b * b;
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        index = p;
+                    }
+                }
+            }
+
+            indices |= index << (i * 2);
+        }
+
+        encodeLittleEndian<std::uint16_t>(destination, color0);
+        encodeLittleEndian<std::uint16_t>(destination + 2, color1);
+        encodeLittleEndian<std::uint32_t>(destination + 4, indices);
+    }
+
+    // BC3 alpha block in the eight alpha mode between the smallest and the largest alpha
+    inline void compressAlphaBlock(const std::uint8_t block[16][4], std::uint8_t* destination)
+    {
+        std::uint8_t alpha0 = 0;
+        std::uint8_t alpha1 = 255;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            alpha0 = std::max(alpha0, block[i][3]);
+            alpha1 = std::min(alpha1, block[i][3]);
+        }
+
+        int palette[8] = {alpha0, alpha1};
+        for (int i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+
+        std::uint64_t indices = 0;
+        if (alpha0 > alpha1)
+            for (std::uint32_t i = 0; i < 16; ++i)
+            {
+                std::uint64_t index = 0;
+                int bestDistance = 256;
+                for (std::uint32_t p = 0; p < 8; ++p)
+                {
+                    const int distance = std::abs(block[i][3] - palette[p]);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        index = p;
+                    }
+                }
+
+                indices |= index << (i * 3);
+            }
+
+        destination[0] = alpha0;
+        destination[1] = alpha1;
+        for (std::size_t i = 0; i < 6; ++i)
+            destination[2 + i] = static_cast<std::uint8_t>(indices >> (i * 8));
+    }
+
+    // compresses an RGBA8 level, the last row and column are repeated in the blocks on the edges
+    inline std::vector<std::uint8_t> compressLevel(const std::vector<std::uint8_t>& level,
+                                                   std::uint32_t width, std::uint32_t height,
+                                                   assets::packed::TextureFormat textureFormat)
+    {
+        const auto blockSize = (textureFormat == assets::packed::TextureFormat::bc1) ? 8U : 16U;
+        const auto blocksX = (width + 3) / 4;
+        const auto blocksY = (height + 3) / 4;
+        std::vector<std::uint8_t> result(static_cast<std::size_t>(blocksX) * blocksY * blockSize);
+
+        for (std::uint32_t blockY = 0; blockY < blocksY; ++blockY)
+            for (std::uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                std::uint8_t block[16][4];
+                for (std::uint32_t y = 0; y < 4; ++y)
+                    for (std::uint32_t x = 0; x < 4; ++x)
+                    {
+                        const auto sourceX = std::min(blockX * 4 + x, width - 1);
+                        const auto sourceY = std::min(blockY * 4 + y, height - 1);
+                        const auto source = &level[(static_cast<std::size_t>(sourceY) * width + sourceX) * 4];
+                        std::copy(source, source + 4, block[y * 4 + x]);
+                    }
+
+                auto destination = &result[(static_cast<std::size_t>(blockY) * blocksX + blockX) * blockSize];
+
+                if (textureFormat == assets::packed::TextureFormat::bc1)
+                    compressColorBlock(block, true, destination);
+                else
+                {
+                    compressAlphaBlock(block, destination);
+                    compressColorBlock(block, false, destination + 8);
+                }
+            }
+
+        return result;
+    }
+
+    // decodes the image and stores it as RGBA8 (or block-compressed) with the mip chain in the packed bundle texture layout
+    inline std::vector<std::byte> cookTexture(const std::vector<std::byte>& file, bool mipmaps,
+                                              Asset::Compression compression = Asset::Compression::none)
+    {
+        int width;
+        int height;
+        int comp;
+
+        std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels{
+            stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.data()),
+                                  static_cast<int>(file.size()),
+                                  &width, &height, &comp, STBI_rgb_alpha),
+            stbi_image_free
+        };
+
+        if (!pixels)
+            throw std::runtime_error("Failed to load texture, reason: " + std::string(stbi_failure_reason()));
+
+        auto levelWidth = static_cast<std::uint32_t>(width);
+        auto levelHeight = static_cast<std::uint32_t>(height);
+
+        std::uint32_t levelCount = 1;
+        if (mipmaps)
+            for (auto w = levelWidth, h = levelHeight; w > 1 || h > 1; ++levelCount)
+            {
+                w = std::max(w >> 1, std::uint32_t(1));
+                h = std::max(h >> 1, std::uint32_t(1));
+            }
+
+        const auto textureFormat = (compression == Asset::Compression::bc1) ? assets::packed::TextureFormat::bc1 :
+            (compression == Asset::Compression::bc3) ? assets::packed::TextureFormat::bc3 :
+            assets::packed::TextureFormat::rgba8;
+
+        std::vector<std::byte> result(assets::packed::textureHeaderSize);
+        auto header = reinterpret_cast<std::uint8_t*>(result.data());
+        encodeLittleEndian<std::uint32_t>(header, levelWidth);
+        encodeLittleEndian<std::uint32_t>(header + 4, levelHeight);
+        encodeLittleEndian<std::uint32_t>(header + 8, levelCount);
+        encodeLittleEndian<std::uint32_t>(header + 12, static_cast<std::uint32_t>(textureFormat));
+
+        std::vector<std::uint8_t> level(pixels.get(), pixels.get() + static_cast<std::size_t>(levelWidth) * levelHeight * 4);
+
+        for (std::uint32_t i = 0; i < levelCount; ++i)
+        {
+            const auto offset = result.size();
+            result.resize(offset + assets::packed::getLevelSize(textureFormat, levelWidth, levelHeight));
+
+            // the mip chain is built from the uncompressed levels
+            if (textureFormat == assets::packed::TextureFormat::rgba8)
+                std::copy(level.begin(), level.end(), reinterpret_cast<std::uint8_t*>(result.data() + offset));
+            else
+            {
+                const auto compressed = compressLevel(level, levelWidth, levelHeight, textureFormat);
+                std::copy(compressed.begin(), compressed.end(), reinterpret_cast<std::uint8_t*>(result.data() + offset));
+            }
+
+            if (i + 1 == levelCount) break;
+
+            // box filter in linear space, the last row or column is repeated for odd sizes
+            const auto newWidth = std::max(levelWidth >> 1, std::uint32_t(1));
+            const auto newHeight = std::max(levelHeight >> 1, std::uint32_t(1));
+            std::vector<std::uint8_t> newLevel(static_cast<std::size_t>(newWidth) * newHeight * 4);
+
+            for (std::uint32_t y = 0; y < newHeight; ++y)
+                for (std::uint32_t x = 0; x < newWidth; ++x)
+                {
+                    const std::uint32_t x0 = std::min(x * 2, levelWidth - 1);
+                    const std::uint32_t x1 = std::min(x * 2 + 1, levelWidth - 1);
+                    const std::uint32_t y0 = std::min(y * 2, levelHeight - 1);
+                    const std::uint32_t y1 = std::min(y * 2 + 1, levelHeight - 1);
+
+                    const std::uint8_t* samples[4] = {
+                        &level[(y0 * levelWidth + x0) * 4],
+                        &level[(y0 * levelWidth + x1) * 4],
+                        &level[(y1 * levelWidth + x0) * 4],
+                        &level[(y1 * levelWidth + x1) * 4]
+                    };
+
+                    std::uint8_t* destination = &newLevel[(y * newWidth + x) * 4];
+
+                    for (std::size_t channel = 0; channel < 3; ++channel)
+                        destination[channel] = linearToSrgb((srgbToLinear(samples[0][channel]) +
+                                                             srgbToLinear(samples[1][channel]) +
+                                                             srgbToLinear(samples[2][channel]) +
+                                                             srgbToLinear(samples[3][channel])) / 4.0F);
+
+                    destination[3] = static_cast<std::uint8_t>((samples[0][3] + samples[1][3] +
+                                                                samples[2][3] + samples[3][3] + 2) / 4);
+                }
+
+            level = std::move(newLevel);
+            levelWidth = newWidth;
+            levelHeight = newHeight;
+        }
+
+        return result;
+    }
+}
+
+#endif // OUZEL_TEXTURE_HPP